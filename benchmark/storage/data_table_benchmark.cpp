@@ -110,6 +110,34 @@ BENCHMARK_DEFINE_F(DataTableBenchmark, Insert)(benchmark::State &state) {
   state.SetItemsProcessed(state.iterations() * num_inserts_);
 }
 
+// Insert the num_inserts_ of tuples into a DataTable from state.range(0) threads, to measure how inserts scale as
+// more threads contend on the table's blocks
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(DataTableBenchmark, ConcurrentInsert)(benchmark::State &state) {
+  const auto num_threads = static_cast<uint32_t>(state.range(0));
+  common::WorkerPool thread_pool(num_threads, {});
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    storage::DataTable table(common::ManagedPointer<storage::BlockStore>(&block_store_), layout_,
+                             storage::layout_version_t(0));
+    auto workload = [&](uint32_t id) {
+      // We can use dummy timestamps here since we're not invoking concurrency control
+      transaction::TransactionContext txn(transaction::timestamp_t(0), transaction::timestamp_t(0),
+                                          common::ManagedPointer(&buffer_pool_), DISABLED);
+      for (uint32_t i = 0; i < num_inserts_ / num_threads; i++) {
+        table.Insert(common::ManagedPointer(&txn), *redo_);
+      }
+    };
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * (num_inserts_ / num_threads) * num_threads);
+}
+
 // Read the num_reads_ of tuples in a random order from a DataTable concurrently
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(DataTableBenchmark, SelectRandom)(benchmark::State &state) {
@@ -261,6 +289,12 @@ BENCHMARK_REGISTER_F(DataTableBenchmark, Insert)
     ->Unit(benchmark::kMillisecond)
     ->UseRealTime()
     ->UseManualTime();
+BENCHMARK_REGISTER_F(DataTableBenchmark, ConcurrentInsert)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->UseManualTime()
+    ->RangeMultiplier(2)
+    ->Range(1, 32);
 BENCHMARK_REGISTER_F(DataTableBenchmark, SelectRandom)
     ->Unit(benchmark::kMillisecond)
     ->UseRealTime()
@@ -45,7 +45,7 @@ class IndexBenchmark : public benchmark::Fixture {
   storage::ProjectedRowInitializer tuple_initializer_ =
       storage::ProjectedRowInitializer::Create(std::vector<uint16_t>{1}, std::vector<uint16_t>{1});  // This is a dummy
 
-  // HashIndex or BwTreeIndex
+  // HashIndex, BwTreeIndex or BPlusTreeIndex
   common::ManagedPointer<storage::index::Index> index_;
   transaction::TimestampManager *timestamp_manager_;
   transaction::DeferredActionManager *deferred_action_manager_;
@@ -166,6 +166,53 @@ class IndexBenchmark : public benchmark::Fixture {
     txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
     return total_ns;
   }
+
+  // Split table_size_ random lookups evenly across num_threads threads, each with its own transaction and key buffer.
+  // Returns the wall clock time for all threads to finish.
+  uint64_t RunParallelWorkload(const uint32_t num_threads) {
+    common::WorkerPool thread_pool(num_threads, {});
+    const uint32_t lookups_per_thread = table_size_ / num_threads;
+
+    auto workload = [&](uint32_t id) {
+      std::default_random_engine thread_generator(id);
+      auto *const scan_txn = txn_manager_->BeginTransaction();
+      byte *const thread_key_buffer =
+          common::AllocationUtil::AllocateAligned(index_->GetProjectedRowInitializer().ProjectedRowSize());
+      auto *const scan_key_pr = index_->GetProjectedRowInitializer().InitializeRow(thread_key_buffer);
+
+      std::vector<storage::TupleSlot> results;
+      for (uint32_t i = 0; i < lookups_per_thread; i++) {
+        const uint32_t random_key = std::uniform_int_distribution(
+            static_cast<uint32_t>(0), static_cast<uint32_t>(table_size_ - 1))(thread_generator);
+        *reinterpret_cast<uint32_t *>(scan_key_pr->AccessForceNotNull(0)) = random_key;
+        index_->ScanKey(*scan_txn, *scan_key_pr, &results);
+        results.clear();
+      }
+
+      txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+      delete[] thread_key_buffer;
+    };
+
+    uint64_t elapsed_ns = 0;
+    {
+      common::ScopedTimer<std::chrono::nanoseconds> timer(&elapsed_ns);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+    }
+    return elapsed_ns;
+  }
+
+  // Lookup throughput of the given index type with state.range(0) threads
+  void ScalingBenchmark(benchmark::State *const state, const storage::index::IndexType type) {
+    const auto num_threads = static_cast<uint32_t>(state->range(0));
+    CreateIndex(type);
+    PopulateTableAndIndex();
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      const auto total_ns = RunParallelWorkload(num_threads);
+      state->SetIterationTime(static_cast<double>(total_ns) / 1000000000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * (table_size_ / num_threads) * num_threads);
+  }
 };
 
 // Determine required time to run key lookup with BwTree structure for index
@@ -199,10 +246,10 @@ BENCHMARK_DEFINE_F(IndexBenchmark, HashIndexRandomScanKey)(benchmark::State &sta
   state.SetItemsProcessed(state.iterations() * table_size_);
 }
 
-// Determine required time to run key lookup with BwTree structure for index
+// Determine required time to run key lookup with B+Tree structure for index
 // NOLINTNEXTLINE
 BENCHMARK_DEFINE_F(IndexBenchmark, BPlusTreeIndexRandomScanKey)(benchmark::State &state) {
-  // Create index using BwTree and populate associated table
+  // Create index using B+Tree and populate associated table
   CreateIndex(storage::index::IndexType::BPLUSTREE);
   PopulateTableAndIndex();
   // NOLINTNEXTLINE
@@ -215,6 +262,24 @@ BENCHMARK_DEFINE_F(IndexBenchmark, BPlusTreeIndexRandomScanKey)(benchmark::State
   state.SetItemsProcessed(state.iterations() * table_size_);
 }
 
+// Determine lookup throughput of the BwTree index as the number of threads grows
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(IndexBenchmark, BwTreeIndexParallelRandomScanKey)(benchmark::State &state) {
+  ScalingBenchmark(&state, storage::index::IndexType::BWTREE);
+}
+
+// Determine lookup throughput of the hash index as the number of threads grows
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(IndexBenchmark, HashIndexParallelRandomScanKey)(benchmark::State &state) {
+  ScalingBenchmark(&state, storage::index::IndexType::HASHMAP);
+}
+
+// Determine lookup throughput of the B+Tree index as the number of threads grows
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(IndexBenchmark, BPlusTreeIndexParallelRandomScanKey)(benchmark::State &state) {
+  ScalingBenchmark(&state, storage::index::IndexType::BPLUSTREE);
+}
+
 // ----------------------------------------------------------------------------
 // BENCHMARK REGISTRATION
 // ----------------------------------------------------------------------------
@@ -226,7 +291,22 @@ BENCHMARK_REGISTER_F(IndexBenchmark, HashIndexRandomScanKey)
     ->UseManualTime()
     ->Unit(benchmark::kMillisecond);
 BENCHMARK_REGISTER_F(IndexBenchmark, BPlusTreeIndexRandomScanKey)
-->UseManualTime()
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(IndexBenchmark, BwTreeIndexParallelRandomScanKey)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(IndexBenchmark, HashIndexParallelRandomScanKey)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(IndexBenchmark, BPlusTreeIndexParallelRandomScanKey)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime()
     ->Unit(benchmark::kMillisecond);
 // clang-format on
 
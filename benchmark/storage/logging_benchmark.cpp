@@ -1,3 +1,5 @@
+#include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "benchmark/benchmark.h"
@@ -13,7 +15,14 @@ namespace terrier {
 
 class LoggingBenchmark : public benchmark::Fixture {
  public:
-  void TearDown(const benchmark::State &state) final { unlink(LOG_FILE_NAME); }
+  void TearDown(const benchmark::State &state) final { RemoveLogFiles(); }
+
+  // Removes the files of every log stream
+  static void RemoveLogFiles() {
+    for (const auto &stream : storage::LogFile::StreamFilePaths(LOG_FILE_NAME)) {
+      for (const auto &path : stream) unlink(path.c_str());
+    }
+  }
 
   const std::vector<uint16_t> attr_sizes_ = {8, 8, 8, 8, 8, 8, 8, 8, 8, 8};
   const uint32_t initial_table_size_ = 1000000;
@@ -241,6 +250,52 @@ BENCHMARK_DEFINE_F(LoggingBenchmark, SingleStatementSelect)(benchmark::State &st
   state.SetItemsProcessed(state.iterations() * num_txns_ - abort_count);
 }
 
+/**
+ * Single statement insert throughput with as many concurrent transactions as there are cores, serialized by a varying
+ * number of log serializers, and written with posix calls or through io_uring.
+ */
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LoggingBenchmark, ParallelSerialization)(benchmark::State &state) {
+  uint64_t abort_count = 0;
+  const uint32_t txn_length = 1;
+  const std::vector<double> insert_update_select_ratio = {1, 0, 0};
+  const auto num_serializers = static_cast<uint32_t>(state.range(0));
+  const bool use_io_uring = state.range(1) != 0;
+  const uint32_t num_concurrent_txns = std::max(std::thread::hardware_concurrency(), num_concurrent_txns_);
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    RemoveLogFiles();
+    log_manager_ =
+        new storage::LogManager(LOG_FILE_NAME, num_log_buffers_, log_serialization_interval_, log_persist_interval_,
+                                log_persist_threshold_, common::ManagedPointer(&buffer_pool_),
+                                common::ManagedPointer<common::DedicatedThreadRegistry>(&thread_registry_),
+                                0 /* segment_size */, false /* adaptive_persist */, num_serializers, use_io_uring);
+    log_manager_->Start();
+    LargeDataTableBenchmarkObject tested(attr_sizes_, 0, txn_length, insert_update_select_ratio, &block_store_,
+                                         &buffer_pool_, &generator_, true, log_manager_);
+    // log all of the Inserts from table creation
+    log_manager_->ForceFlush();
+
+    gc_ = new storage::GarbageCollector(common::ManagedPointer(tested.GetTimestampManager()), DISABLED,
+                                        common::ManagedPointer(tested.GetTxnManager()), DISABLED);
+    gc_thread_ = new storage::GarbageCollectorThread(common::ManagedPointer(gc_), gc_period_);
+    const auto result = tested.SimulateOltp(num_txns_, num_concurrent_txns);
+    abort_count += result.first;
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      log_manager_->ForceFlush();
+    }
+    state.SetIterationTime(static_cast<double>(result.second + elapsed_ms) / 1000.0);
+    log_manager_->PersistAndStop();
+    delete log_manager_;
+    delete gc_thread_;
+    delete gc_;
+    RemoveLogFiles();
+  }
+  state.SetItemsProcessed(state.iterations() * num_txns_ - abort_count);
+}
+
 // ----------------------------------------------------------------------------
 // BENCHMARK REGISTRATION
 // ----------------------------------------------------------------------------
@@ -265,6 +320,12 @@ BENCHMARK_REGISTER_F(LoggingBenchmark, SingleStatementSelect)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
     ->MinTime(1);
+BENCHMARK_REGISTER_F(LoggingBenchmark, ParallelSerialization)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3)
+    ->RangeMultiplier(2)
+    ->Ranges({{1, 8}, {0, 1}});
 // clang-format on
 
 }  // namespace terrier
@@ -1,5 +1,4 @@
 // Perform parallel join
-// This will be supported after the parallel scans are added
 
 struct State {
   jht: JoinHashTable
@@ -88,7 +87,9 @@ fun main(execCtx: *ExecutionContext) -> int {
   @tlsReset(&tls, @sizeOf(ThreadState_1), _1_pipelineWorker_InitThreadState, _1_pipelineWorker_TearDownThreadState, execCtx)
 
   // Parallel scan
- @iterateTableParallel("test_1", &state, &tls, _1_pipelineWorker)
+  var oids: [1]uint32
+  oids[0] = 1 // colA
+  @iterateTableParallel(execCtx, "test_1", oids, &state, &tls, _1_pipelineWorker)
 
   // ---- Pipeline 1 End ---- //
   var off: uint32 = 0
@@ -1,12 +1,15 @@
 // Perform parallel scan
-// This is not yet supported with the current SQL table API.
+// select count(*) from test_1 WHERE colA < 500;
+//
+// Should output 500 (number of output rows)
 
 struct State {
+  count: int32
 }
 
-
 struct ThreadState_1 {
   filter: FilterManager
+  count: int32
 }
 
 fun _1_Lt500(pci: *ProjectedColumnsIterator) -> int32 {
@@ -32,6 +35,7 @@ fun _1_Lt500_Vec(pci: *ProjectedColumnsIterator) -> int32 {
 }
 
 fun _1_pipelineWorker_InitThreadState(execCtx: *ExecutionContext, state: *ThreadState_1) -> nil {
+  state.count = 0
   @filterManagerInit(&state.filter)
   @filterManagerInsertFilter(&state.filter, _1_Lt500, _1_Lt500_Vec)
   @filterManagerFinalize(&state.filter)
@@ -46,11 +50,22 @@ fun _1_pipelineWorker(query_state: *State, state: *ThreadState_1, tvi: *TableVec
   for (@tableIterAdvance(tvi)) {
     var pci = @tableIterGetPCI(tvi)
     @filtersRun(filter, pci)
+    for (; @pciHasNextFiltered(pci); @pciAdvanceFiltered(pci)) {
+      state.count = state.count + 1
+    }
+    @pciResetFiltered(pci)
   }
   return
 }
 
+fun _1_mergeCount(query_state: *State, state: *ThreadState_1) -> nil {
+  query_state.count = query_state.count + state.count
+}
+
 fun main(execCtx: *ExecutionContext) -> int {
+  var state: State
+  state.count = 0
+
   // Pipeline 1 - parallel scan table
 
   // First the thread state container
@@ -59,12 +74,15 @@ fun main(execCtx: *ExecutionContext) -> int {
   @tlsReset(&tls, @sizeOf(ThreadState_1), _1_pipelineWorker_InitThreadState, _1_pipelineWorker_TearDownThreadState, execCtx)
 
   // Now scan
-  @iterateTableParallel("test_1", &state, &tls, _1_pipelineWorker)
+  var oids: [1]uint32
+  oids[0] = 1 // colA
+  @iterateTableParallel(execCtx, "test_1", oids, &state, &tls, _1_pipelineWorker)
 
-  // Pipeline 2
+  // Pipeline 2 - sum up the counts of each thread
+  @tlsIterate(&tls, &state, _1_mergeCount)
 
   // Cleanup
   @tlsFree(&tls)
 
-  return 0
+  return state.count
 }
@@ -19,6 +19,8 @@ CodeGen::CodeGen(exec::ExecutionContext *exec_ctx)
       state_struct_{Context()->GetIdentifier("State")},
       state_var_{Context()->GetIdentifier("state")},
       exec_ctx_var_(Context()->GetIdentifier("execCtx")),
+      thread_state_var_(Context()->GetIdentifier("threadState")),
+      worker_tvi_var_(Context()->GetIdentifier("tvi")),
       main_fn_(Context()->GetIdentifier("main")),
       setup_fn_(Context()->GetIdentifier("setupFn")),
       teardown_fn_(Context()->GetIdentifier("teardownFn")) {}
@@ -53,6 +55,33 @@ util::RegionVector<ast::FieldDecl *> CodeGen::ExecParams() {
   return {{state_param, exec_ctx_param}, Region()};
 }
 
+util::RegionVector<ast::FieldDecl *> CodeGen::ThreadStateParams(ast::Identifier thread_state_type) {
+  // Exec Context Parameter
+  ast::Expr *exec_ctx_type = PointerType(BuiltinType(ast::BuiltinType::Kind::ExecutionContext));
+  ast::FieldDecl *exec_ctx_param = MakeField(exec_ctx_var_, exec_ctx_type);
+
+  // Thread state parameter
+  ast::FieldDecl *thread_state_param = MakeField(thread_state_var_, PointerType(thread_state_type));
+
+  // Function parameter
+  return {{exec_ctx_param, thread_state_param}, Region()};
+}
+
+util::RegionVector<ast::FieldDecl *> CodeGen::WorkerParams(ast::Identifier thread_state_type) {
+  // State parameter
+  ast::FieldDecl *state_param = MakeField(state_var_, PointerType(GetStateType()));
+
+  // Thread state parameter
+  ast::FieldDecl *thread_state_param = MakeField(thread_state_var_, PointerType(thread_state_type));
+
+  // Table vector iterator parameter
+  ast::Expr *tvi_type = PointerType(BuiltinType(ast::BuiltinType::Kind::TableVectorIterator));
+  ast::FieldDecl *tvi_param = MakeField(worker_tvi_var_, tvi_type);
+
+  // Function parameter
+  return {{state_param, thread_state_param, tvi_param}, Region()};
+}
+
 ast::Stmt *CodeGen::ExecCall(ast::Identifier fn_name) {
   ast::Expr *func = MakeExpr(fn_name);
   ast::Expr *state_arg = PointerTo(state_var_);
@@ -63,6 +92,10 @@ ast::Stmt *CodeGen::ExecCall(ast::Identifier fn_name) {
 
 ast::Expr *CodeGen::GetStateMemberPtr(ast::Identifier ident) { return PointerTo(MemberExpr(state_var_, ident)); }
 
+ast::Expr *CodeGen::GetThreadStateMemberPtr(ast::Identifier ident) {
+  return PointerTo(MemberExpr(thread_state_var_, ident));
+}
+
 ast::Identifier CodeGen::NewIdentifier(const std::string &prefix) {
   // TODO(Amadou/Wan): John notes that there could be an extra string allocation and deallocation for the id count.
   //  An explicit string formatting call could avoid this.
@@ -114,6 +147,21 @@ ast::Expr *CodeGen::TableIterInit(ast::Identifier tvi, uint32_t table_oid, ast::
   return Factory()->NewBuiltinCallExpr(fun, std::move(args));
 }
 
+ast::Expr *CodeGen::IterateTableParallel(uint32_t table_oid, ast::Identifier col_oids, ast::Identifier tls,
+                                         ast::Identifier worker) {
+  ast::Expr *fun = BuiltinFunction(ast::Builtin::TableIterParallel);
+  ast::Expr *exec_ctx_expr = MakeExpr(exec_ctx_var_);
+  ast::Expr *table_oid_expr = IntLiteral(static_cast<int64_t>(table_oid));
+  ast::Expr *col_oids_expr = MakeExpr(col_oids);
+  ast::Expr *state_expr = MakeExpr(state_var_);
+  ast::Expr *tls_ptr = PointerTo(tls);
+  ast::Expr *worker_expr = MakeExpr(worker);
+
+  util::RegionVector<ast::Expr *> args{
+      {exec_ctx_expr, table_oid_expr, col_oids_expr, state_expr, tls_ptr, worker_expr}, Region()};
+  return Factory()->NewBuiltinCallExpr(fun, std::move(args));
+}
+
 ast::Expr *CodeGen::PCIGet(ast::Identifier pci, type::TypeId type, bool nullable, uint32_t idx) {
   ast::Builtin builtin;
   switch (type) {
@@ -195,10 +243,12 @@ ast::Expr *CodeGen::ExecCtxGetMem() {
 ast::Expr *CodeGen::SizeOf(ast::Identifier type_name) { return OneArgCall(ast::Builtin::SizeOf, type_name, false); }
 
 ast::Expr *CodeGen::HTInitCall(ast::Builtin builtin, ast::Identifier object, ast::Identifier struct_type) {
+  return HTInitCall(builtin, GetStateMemberPtr(object), struct_type);
+}
+
+ast::Expr *CodeGen::HTInitCall(ast::Builtin builtin, ast::Expr *obj_ptr, ast::Identifier struct_type) {
   // Init Function
   ast::Expr *fun = BuiltinFunction(builtin);
-  // The object to initialize
-  ast::Expr *obj_ptr = GetStateMemberPtr(object);
   // Then get @execCtxGetMem(execCtx)
   ast::Expr *get_mem_call = ExecCtxGetMem();
   // Then get @sizeof(Struct)
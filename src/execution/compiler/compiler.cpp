@@ -10,9 +10,10 @@
 
 namespace terrier::execution::compiler {
 
-Compiler::Compiler(CodeGen *codegen, const planner::AbstractPlanNode *plan) : codegen_(codegen), plan_(plan) {
+Compiler::Compiler(CodeGen *codegen, const planner::AbstractPlanNode *plan, bool parallel_execution)
+    : codegen_(codegen), plan_(plan), parallel_execution_(parallel_execution) {
   // Make the pipelines
-  auto main_pipeline = std::make_unique<Pipeline>(codegen_);
+  auto main_pipeline = std::make_unique<Pipeline>(codegen_, parallel_execution_);
   MakePipelines(*plan, main_pipeline.get());
   // If the query has an ouput, make an output translator
   if (plan_->GetOutputSchema() != nullptr) {
@@ -55,7 +56,7 @@ ast::File *Compiler::Compile() {
   // over the list of pipelines. However, I find this easier to debug for now.
   uint32_t pipeline_idx = 0;
   for (auto &pipeline : pipelines_) {
-    top_level.emplace_back(pipeline->Produce(pipeline_idx++));
+    pipeline->Produce(&top_level, pipeline_idx++);
   }
 
   // Step 3: Make the main function
@@ -77,7 +78,7 @@ void Compiler::MakePipelines(const terrier::planner::AbstractPlanNode &op, Pipel
       auto bottom_translator = TranslatorFactory::CreateBottomTranslator(&op, codegen_);
       auto top_translator = TranslatorFactory::CreateTopTranslator(&op, bottom_translator.get(), codegen_);
       // The "build" side is a pipeline breaker. It belongs to a new pipeline.
-      auto next_pipeline = std::make_unique<Pipeline>(codegen_);
+      auto next_pipeline = std::make_unique<Pipeline>(codegen_, parallel_execution_);
       MakePipelines(*op.GetChild(0), next_pipeline.get());
       next_pipeline->Add(std::move(bottom_translator));
       pipelines_.emplace_back(std::move(next_pipeline));
@@ -91,7 +92,7 @@ void Compiler::MakePipelines(const terrier::planner::AbstractPlanNode &op, Pipel
       auto right_translator = TranslatorFactory::CreateRightTranslator(&op, left_translator.get(), codegen_);
 
       // The "build" side is a pipeline breaker. It belongs to a new pipeline.
-      auto next_pipeline = std::make_unique<Pipeline>(codegen_);
+      auto next_pipeline = std::make_unique<Pipeline>(codegen_, parallel_execution_);
       MakePipelines(*op.GetChild(0), next_pipeline.get());
       next_pipeline->Add(std::move(left_translator));
       pipelines_.emplace_back(std::move(next_pipeline));
@@ -16,7 +16,11 @@ AggregateBottomTranslator::AggregateBottomTranslator(const terrier::planner::Agg
       payload_struct_(codegen->NewIdentifier("AggPayload")),
       agg_payload_(codegen->NewIdentifier("agg_payload")),
       key_check_(codegen->NewIdentifier("aggKeyCheckFn")),
-      agg_ht_(codegen->NewIdentifier("agg_ht")) {}
+      agg_ht_(codegen->NewIdentifier("agg_ht")),
+      merge_key_check_(codegen->NewIdentifier("aggMergeKeyCheckFn")),
+      merge_fn_(codegen->NewIdentifier("aggMergeFn")),
+      merge_iter_(codegen->NewIdentifier("merge_iter")),
+      partial_(codegen->NewIdentifier("partial")) {}
 
 // Declare the hash table
 void AggregateBottomTranslator::InitializeStateFields(util::RegionVector<ast::FieldDecl *> *state_fields) {
@@ -34,6 +38,10 @@ void AggregateBottomTranslator::InitializeStructs(util::RegionVector<ast::Decl *
 // Create the key check function.
 void AggregateBottomTranslator::InitializeHelperFunctions(util::RegionVector<ast::Decl *> *decls) {
   GenSingleKeyCheckFn(decls);
+  if (parallelized_pipeline_) {
+    GenMergeKeyCheckFn(decls);
+    GenMergeFn(decls);
+  }
 }
 
 // Call @aggHTInit on the hash table
@@ -50,6 +58,37 @@ void AggregateBottomTranslator::InitializeTeardown(util::RegionVector<ast::Stmt
   teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
 }
 
+// Declare the thread local hash table
+void AggregateBottomTranslator::InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) {
+  // agg_ht : AggregationHashTable
+  ast::Expr *ht_type = codegen_->BuiltinType(ast::BuiltinType::Kind::AggregationHashTable);
+  thread_state_fields->emplace_back(codegen_->MakeField(agg_ht_, ht_type));
+}
+
+// Call @aggHTInit on the thread local hash table
+void AggregateBottomTranslator::InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) {
+  // @aggHTInit(&threadState.agg_ht, @execCtxGetMem(execCtx), @sizeOf(AggPayload))
+  ast::Expr *init_call = codegen_->HTInitCall(ast::Builtin::AggHashTableInit,
+                                              codegen_->GetThreadStateMemberPtr(agg_ht_), payload_struct_);
+  init_stmts->emplace_back(codegen_->MakeStmt(init_call));
+}
+
+// Call @aggHTFree on the thread local hash table
+void AggregateBottomTranslator::TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) {
+  ast::Expr *free_call =
+      codegen_->OneArgCall(ast::Builtin::AggHashTableFree, codegen_->GetThreadStateMemberPtr(agg_ht_));
+  teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
+}
+
+// @tlsIterate(&tls, state, aggMergeFn)
+void AggregateBottomTranslator::FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) {
+  ast::Expr *iterate_call =
+      codegen_->BuiltinCall(ast::Builtin::ThreadStateContainerIterate,
+                            {codegen_->PointerTo(tls), codegen_->MakeExpr(codegen_->GetStateVar()),
+                             codegen_->MakeExpr(merge_fn_)});
+  builder->Append(codegen_->MakeStmt(iterate_call));
+}
+
 void AggregateBottomTranslator::Produce(FunctionBuilder *builder) { child_translator_->Produce(builder); }
 
 void AggregateBottomTranslator::Abort(FunctionBuilder *builder) { child_translator_->Abort(builder); }
@@ -205,7 +244,7 @@ void AggregateBottomTranslator::FillValues(FunctionBuilder *builder) {
 // Generate var agg_payload = @ptrCast(*AggPayload, @aggHTLookup(&state.agg_ht, agg_hash_val, keyCheck, &agg_values))
 void AggregateBottomTranslator::GenLookupCall(FunctionBuilder *builder) {
   // First create @aggHTLookup((&state.agg_ht, agg_hash_val, keyCheck, &agg_values)
-  std::vector<ast::Expr *> lookup_args{codegen_->GetStateMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_),
+  std::vector<ast::Expr *> lookup_args{GetBuildMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_),
                                        codegen_->MakeExpr(key_check_), codegen_->PointerTo(agg_values_)};
   ast::Expr *lookup_call = codegen_->BuiltinCall(ast::Builtin::AggHashTableLookup, std::move(lookup_args));
 
@@ -229,7 +268,7 @@ void AggregateBottomTranslator::GenConstruct(FunctionBuilder *builder) {
   builder->StartIfStmt(cond);
 
   // Set agg_payload = @ptrCast(*AggPayload, @aggHTInsert(&state.agg_table, agg_hash_val))
-  std::vector<ast::Expr *> insert_args{codegen_->GetStateMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_)};
+  std::vector<ast::Expr *> insert_args{GetBuildMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_)};
   ast::Expr *insert_call = codegen_->BuiltinCall(ast::Builtin::AggHashTableInsert, std::move(insert_args));
   ast::Expr *cast_call = codegen_->PtrCast(payload_struct_, insert_call);
   builder->Append(codegen_->Assign(codegen_->MakeExpr(agg_payload_), cast_call));
@@ -300,6 +339,106 @@ void AggregateBottomTranslator::GenSingleKeyCheckFn(util::RegionVector<terrier::
   decls->emplace_back(builder.Finish());
 }
 
+void AggregateBottomTranslator::GenMergeKeyCheckFn(util::RegionVector<ast::Decl *> *decls) {
+  // Generate the function type (*AggPayload, *AggPayload) -> bool
+  ast::FieldDecl *param1 = codegen_->MakeField(agg_payload_, codegen_->PointerType(payload_struct_));
+  ast::FieldDecl *param2 = codegen_->MakeField(partial_, codegen_->PointerType(payload_struct_));
+  util::RegionVector<ast::FieldDecl *> params({param1, param2}, codegen_->Region());
+  ast::Expr *ret_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Bool);
+  FunctionBuilder builder(codegen_, merge_key_check_, std::move(params), ret_type);
+
+  // Compare group by terms one by one
+  for (uint32_t term_idx = 0; term_idx < num_group_by_terms_; term_idx++) {
+    ast::Expr *lhs = GetGroupByTerm(agg_payload_, term_idx);
+    ast::Expr *rhs = GetGroupByTerm(partial_, term_idx);
+    ast::Expr *cond = codegen_->Compare(parsing::Token::Type::BANG_EQUAL, lhs, rhs);
+    builder.StartIfStmt(cond);
+    builder.Append(codegen_->ReturnStmt(codegen_->BoolLiteral(false)));
+    builder.FinishBlockStmt();
+  }
+  builder.Append(codegen_->ReturnStmt(codegen_->BoolLiteral(true)));
+  decls->emplace_back(builder.Finish());
+}
+
+// The thread local hash tables could also be moved into the partitions of the global one and merged in parallel
+// (@aggHTMoveParts). The top translator iterates the global hash table directly though, so they are merged serially.
+void AggregateBottomTranslator::GenMergeFn(util::RegionVector<ast::Decl *> *decls) {
+  ast::Expr *ret_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Nil);
+  util::RegionVector<ast::FieldDecl *> params{codegen_->Region()};
+  params.emplace_back(codegen_->MakeField(codegen_->GetStateVar(), codegen_->PointerType(codegen_->GetStateType())));
+  params.emplace_back(
+      codegen_->MakeField(codegen_->GetThreadStateVar(), codegen_->PointerType(thread_state_struct_)));
+  FunctionBuilder builder(codegen_, merge_fn_, std::move(params), ret_type);
+
+  // var merge_iter: AggregationHashTableIterator
+  ast::Expr *iter_type = codegen_->BuiltinType(ast::BuiltinType::AggregationHashTableIterator);
+  builder.Append(codegen_->DeclareVariable(merge_iter_, iter_type, nullptr));
+
+  // for (@aggHTIterInit(&merge_iter, &threadState.agg_ht); @aggHTIterHasNext(&merge_iter);
+  //      @aggHTIterNext(&merge_iter)) {...}
+  ast::Expr *init_call = codegen_->BuiltinCall(ast::Builtin::AggHashTableIterInit,
+                                               {codegen_->PointerTo(merge_iter_),
+                                                codegen_->GetThreadStateMemberPtr(agg_ht_)});
+  ast::Expr *has_next_call = codegen_->OneArgCall(ast::Builtin::AggHashTableIterHasNext, merge_iter_, true);
+  ast::Expr *next_call = codegen_->OneArgCall(ast::Builtin::AggHashTableIterNext, merge_iter_, true);
+  builder.StartForStmt(codegen_->MakeStmt(init_call), has_next_call, codegen_->MakeStmt(next_call));
+
+  // var partial = @ptrCast(*AggPayload, @aggHTIterGetRow(&merge_iter))
+  ast::Expr *get_row_call = codegen_->OneArgCall(ast::Builtin::AggHashTableIterGetRow, merge_iter_, true);
+  builder.Append(codegen_->DeclareVariable(partial_, nullptr, codegen_->PtrCast(payload_struct_, get_row_call)));
+
+  // var hash_val = @hash(partial.group_by_term1, ...)
+  std::vector<ast::Expr *> hash_args{};
+  for (uint32_t term_idx = 0; term_idx < num_group_by_terms_; term_idx++) {
+    hash_args.emplace_back(GetGroupByTerm(partial_, term_idx));
+  }
+  // Same constant hash value as in GenHashCall
+  if (hash_args.empty()) {
+    hash_args.emplace_back(codegen_->IntToSql(0));
+  }
+  ast::Expr *hash_call = codegen_->BuiltinCall(ast::Builtin::Hash, std::move(hash_args));
+  builder.Append(codegen_->DeclareVariable(hash_val_, nullptr, hash_call));
+
+  // var agg_payload = @ptrCast(*AggPayload, @aggHTLookup(&state.agg_ht, hash_val, aggMergeKeyCheckFn, partial))
+  std::vector<ast::Expr *> lookup_args{codegen_->GetStateMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_),
+                                       codegen_->MakeExpr(merge_key_check_), codegen_->MakeExpr(partial_)};
+  ast::Expr *lookup_call = codegen_->BuiltinCall(ast::Builtin::AggHashTableLookup, std::move(lookup_args));
+  builder.Append(codegen_->DeclareVariable(agg_payload_, nullptr, codegen_->PtrCast(payload_struct_, lookup_call)));
+
+  // if (nil == agg_payload) {...}
+  ast::Expr *cond =
+      codegen_->Compare(parsing::Token::Type::EQUAL_EQUAL, codegen_->NilLiteral(), codegen_->MakeExpr(agg_payload_));
+  builder.StartIfStmt(cond);
+  // agg_payload = @ptrCast(*AggPayload, @aggHTInsert(&state.agg_ht, hash_val))
+  std::vector<ast::Expr *> insert_args{codegen_->GetStateMemberPtr(agg_ht_), codegen_->MakeExpr(hash_val_)};
+  ast::Expr *insert_call = codegen_->BuiltinCall(ast::Builtin::AggHashTableInsert, std::move(insert_args));
+  builder.Append(codegen_->Assign(codegen_->MakeExpr(agg_payload_), codegen_->PtrCast(payload_struct_, insert_call)));
+  // agg_payload.term_i = partial.term_i
+  for (uint32_t term_idx = 0; term_idx < num_group_by_terms_; term_idx++) {
+    builder.Append(codegen_->Assign(GetGroupByTerm(agg_payload_, term_idx), GetGroupByTerm(partial_, term_idx)));
+  }
+  // @aggInit(&agg_payload.expr_i)
+  for (uint32_t term_idx = 0; term_idx < op_->GetAggregateTerms().size(); term_idx++) {
+    ast::Expr *init_agg_call = codegen_->BuiltinCall(ast::Builtin::AggInit, {GetAggTerm(agg_payload_, term_idx, true)});
+    builder.Append(codegen_->MakeStmt(init_agg_call));
+  }
+  builder.FinishBlockStmt();
+
+  // @aggMerge(&agg_payload.expr_i, &partial.expr_i)
+  for (uint32_t term_idx = 0; term_idx < op_->GetAggregateTerms().size(); term_idx++) {
+    ast::Expr *merge_call = codegen_->BuiltinCall(
+        ast::Builtin::AggMerge, {GetAggTerm(agg_payload_, term_idx, true), GetAggTerm(partial_, term_idx, true)});
+    builder.Append(codegen_->MakeStmt(merge_call));
+  }
+  // Close the loop
+  builder.FinishBlockStmt();
+
+  // @aggHTIterClose(&merge_iter)
+  ast::Expr *close_call = codegen_->OneArgCall(ast::Builtin::AggHashTableIterClose, merge_iter_, true);
+  builder.Append(codegen_->MakeStmt(close_call));
+  decls->emplace_back(builder.Finish());
+}
+
 ///////////////////////////////////////////////
 ///// Top Translator
 ///////////////////////////////////////////////
@@ -20,8 +20,8 @@ HashJoinLeftTranslator::HashJoinLeftTranslator(const terrier::planner::HashJoinP
 void HashJoinLeftTranslator::Produce(FunctionBuilder *builder) {
   // Produce the rest of the pipeline
   child_translator_->Produce(builder);
-  // Call @joinHTBuild at the end of the pipeline
-  GenBuildCall(builder);
+  // Call @joinHTBuild at the end of the pipeline. Parallel pipelines build once every thread is done.
+  if (!parallelized_pipeline_) GenBuildCall(builder);
 }
 
 void HashJoinLeftTranslator::Abort(FunctionBuilder *builder) { child_translator_->Abort(builder); }
@@ -69,6 +69,40 @@ void HashJoinLeftTranslator::InitializeTeardown(util::RegionVector<ast::Stmt *>
   teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
 }
 
+// Declare the thread local hash table
+void HashJoinLeftTranslator::InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) {
+  // join_ht : JoinHashTable
+  ast::Expr *ht_type = codegen_->BuiltinType(ast::BuiltinType::Kind::JoinHashTable);
+  thread_state_fields->emplace_back(codegen_->MakeField(join_ht_, ht_type));
+}
+
+// Call @joinHTInit on the thread local hash table
+void HashJoinLeftTranslator::InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) {
+  // @joinHTInit(&threadState.join_ht, @execCtxGetMem(execCtx), @sizeOf(BuildRow))
+  ast::Expr *init_call = codegen_->HTInitCall(ast::Builtin::JoinHashTableInit,
+                                              codegen_->GetThreadStateMemberPtr(join_ht_), build_struct_);
+  init_stmts->emplace_back(codegen_->MakeStmt(init_call));
+}
+
+// Call @joinHTFree on the thread local hash table
+void HashJoinLeftTranslator::TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) {
+  ast::Expr *free_call =
+      codegen_->OneArgCall(ast::Builtin::JoinHashTableFree, codegen_->GetThreadStateMemberPtr(join_ht_));
+  teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
+}
+
+// Call @joinHTBuildParallel(&state.join_ht, &tls, offset)
+void HashJoinLeftTranslator::FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) {
+  // The thread local hash table is the first member of the thread state
+  ast::Identifier offset = codegen_->NewIdentifier("offset");
+  ast::Expr *offset_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Uint32);
+  builder->Append(codegen_->DeclareVariable(offset, offset_type, codegen_->IntLiteral(0)));
+  ast::Expr *build_call = codegen_->BuiltinCall(
+      ast::Builtin::JoinHashTableBuildParallel,
+      {codegen_->GetStateMemberPtr(join_ht_), codegen_->PointerTo(tls), codegen_->MakeExpr(offset)});
+  builder->Append(codegen_->MakeStmt(build_call));
+}
+
 // Call @joinHTBuild(&state.join_hash_table)
 void HashJoinLeftTranslator::GenBuildCall(FunctionBuilder *builder) {
   ast::Expr *build_call = codegen_->OneArgStateCall(ast::Builtin::JoinHashTableBuild, join_ht_);
@@ -93,7 +127,7 @@ void HashJoinLeftTranslator::GenHashCall(FunctionBuilder *builder) {
 // var build_row = @ptrCast(*BuildRow, @joinHTInsert(&state.join_table, hash_val))
 void HashJoinLeftTranslator::GenHTInsert(FunctionBuilder *builder) {
   // First create @joinHTInsert(&state.join_table, hash_val)
-  std::vector<ast::Expr *> insert_args{codegen_->GetStateMemberPtr(join_ht_), codegen_->MakeExpr(hash_val_)};
+  std::vector<ast::Expr *> insert_args{GetBuildMemberPtr(join_ht_), codegen_->MakeExpr(hash_val_)};
   ast::Expr *insert_call = codegen_->BuiltinCall(ast::Builtin::JoinHashTableInsert, std::move(insert_args));
 
   // Gen create @ptrcast(*BuildRow, ...)
@@ -26,6 +26,12 @@ SeqScanTranslator::SeqScanTranslator(const terrier::planner::SeqScanPlanNode *op
       pci_type_{codegen->Context()->GetIdentifier("ProjectedColumnsIterator")} {}
 
 void SeqScanTranslator::Produce(FunctionBuilder *builder) {
+  if (parallelized_pipeline_) {
+    // The worker is handed a TVI over its part of the table, see LaunchParallelScan
+    DoTableScan(builder);
+    return;
+  }
+
   SetOids(builder);
   DeclareTVI(builder);
 
@@ -78,6 +84,12 @@ void SeqScanTranslator::DoTableScan(FunctionBuilder *builder) {
   builder->FinishBlockStmt();
 }
 
+void SeqScanTranslator::LaunchParallelScan(FunctionBuilder *builder, ast::Identifier tls, ast::Identifier worker) {
+  SetOids(builder);
+  ast::Expr *scan_call = codegen_->IterateTableParallel(!op_->GetTableOid(), col_oids_, tls, worker);
+  builder->Append(codegen_->MakeStmt(scan_call));
+}
+
 void SeqScanTranslator::Consume(FunctionBuilder *builder) {
   // This is called in nested loop joins
   DoTableScan(builder);
@@ -125,13 +137,18 @@ void SeqScanTranslator::SetOids(FunctionBuilder *builder) {
 // Generate for(@tableIterAdvance(&tvi)) {...}
 void SeqScanTranslator::GenTVILoop(FunctionBuilder *builder) {
   // The advance call
-  ast::Expr *advance_call = codegen_->OneArgCall(ast::Builtin::TableIterAdvance, tvi_, true);
+  ast::Expr *advance_call = codegen_->OneArgCall(ast::Builtin::TableIterAdvance, TVIPtr());
   builder->StartForStmt(nullptr, advance_call, nullptr);
 }
 
+ast::Expr *SeqScanTranslator::TVIPtr() {
+  if (parallelized_pipeline_) return codegen_->MakeExpr(codegen_->GetWorkerTVIVar());
+  return codegen_->PointerTo(tvi_);
+}
+
 void SeqScanTranslator::DeclarePCI(FunctionBuilder *builder) {
   // Assign var pci = @tableIterGetPCI(&tvi)
-  ast::Expr *get_pci_call = codegen_->OneArgCall(ast::Builtin::TableIterGetPCI, tvi_, true);
+  ast::Expr *get_pci_call = codegen_->OneArgCall(ast::Builtin::TableIterGetPCI, TVIPtr());
   builder->Append(codegen_->DeclareVariable(pci_, nullptr, get_pci_call));
 }
 
@@ -19,8 +19,8 @@ SortBottomTranslator::SortBottomTranslator(const terrier::planner::OrderByPlanNo
 
 void SortBottomTranslator::Produce(FunctionBuilder *builder) {
   child_translator_->Produce(builder);
-  // At the end of the pipeline, call sorterSort.
-  GenSorterSort(builder);
+  // At the end of the pipeline, call sorterSort. Parallel pipelines sort once every thread is done.
+  if (!parallelized_pipeline_) GenSorterSort(builder);
 }
 
 void SortBottomTranslator::Abort(FunctionBuilder *builder) { child_translator_->Abort(builder); }
@@ -34,7 +34,7 @@ void SortBottomTranslator::Consume(FunctionBuilder *builder) {
 
 void SortBottomTranslator::GenSorterInsert(FunctionBuilder *builder) {
   // var sorter_row = @ptrCast(*SorterStruct, @sorterInsert(&state.sorter))
-  ast::Expr *insert_call = codegen_->OneArgStateCall(ast::Builtin::SorterInsert, sorter_);
+  ast::Expr *insert_call = codegen_->OneArgCall(ast::Builtin::SorterInsert, GetBuildMemberPtr(sorter_));
 
   // Gen create @ptrcast(*SorterStruct, ...)
   ast::Expr *cast_call = codegen_->PtrCast(sorter_struct_, insert_call);
@@ -98,6 +98,38 @@ void SortBottomTranslator::InitializeTeardown(execution::util::RegionVector<exec
   teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
 }
 
+void SortBottomTranslator::InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) {
+  // sorter: Sorter
+  ast::Expr *sorter_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Sorter);
+  thread_state_fields->emplace_back(codegen_->MakeField(sorter_, sorter_type));
+}
+
+void SortBottomTranslator::InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) {
+  // @sorterInit(&threadState.sorter, @execCtxGetMem(execCtx), sorterCompare, @sizeOf(SorterStruct))
+  std::vector<ast::Expr *> init_args{codegen_->GetThreadStateMemberPtr(sorter_), codegen_->ExecCtxGetMem(),
+                                     codegen_->MakeExpr(comp_fn_), codegen_->SizeOf(sorter_struct_)};
+  ast::Expr *init_call = codegen_->BuiltinCall(ast::Builtin::SorterInit, std::move(init_args));
+  init_stmts->emplace_back(codegen_->MakeStmt(init_call));
+}
+
+void SortBottomTranslator::TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) {
+  // @sorterFree(&threadState.sorter)
+  ast::Expr *free_call = codegen_->OneArgCall(ast::Builtin::SorterFree, codegen_->GetThreadStateMemberPtr(sorter_));
+  teardown_stmts->emplace_back(codegen_->MakeStmt(free_call));
+}
+
+void SortBottomTranslator::FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) {
+  // The thread local sorter is the first member of the thread state
+  ast::Identifier offset = codegen_->NewIdentifier("offset");
+  ast::Expr *offset_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Uint32);
+  builder->Append(codegen_->DeclareVariable(offset, offset_type, codegen_->IntLiteral(0)));
+  // @sorterSortParallel(&state.sorter, &tls, offset)
+  ast::Expr *sort_call = codegen_->BuiltinCall(
+      ast::Builtin::SorterSortParallel,
+      {codegen_->GetStateMemberPtr(sorter_), codegen_->PointerTo(tls), codegen_->MakeExpr(offset)});
+  builder->Append(codegen_->MakeStmt(sort_call));
+}
+
 ast::Expr *SortBottomTranslator::GetChildOutput(uint32_t child_idx, uint32_t attr_idx, terrier::type::TypeId type) {
   // Pass through to child node
   if (current_row_ == CurrentRow::Child) {
@@ -8,6 +8,13 @@ namespace terrier::execution::compiler {
 void Pipeline::Initialize(util::RegionVector<ast::Decl *> *decls, util::RegionVector<ast::FieldDecl *> *state_fields,
                           util::RegionVector<ast::Stmt *> *setup_stmts,
                           util::RegionVector<ast::Stmt *> *teardown_stmts) {
+  if (is_parallelizable_) {
+    thread_state_struct_ = codegen_->NewIdentifier("ThreadState");
+    init_thread_state_fn_ = codegen_->NewIdentifier("initThreadState");
+    teardown_thread_state_fn_ = codegen_->NewIdentifier("teardownThreadState");
+    worker_fn_ = codegen_->NewIdentifier("worker");
+  }
+
   for (uint32_t i = 0; i < pipeline_.size(); i++) {
     // Get previous, current, and parent translator
     OperatorTranslator *child_translator = nullptr;
@@ -15,18 +22,26 @@ void Pipeline::Initialize(util::RegionVector<ast::Decl *> *decls, util::RegionVe
     OperatorTranslator *curr_translator = pipeline_[i].get();
     if (i > 0) child_translator = pipeline_[i - 1].get();
     if (i < pipeline_.size() - 1) parent_translator = pipeline_[i + 1].get();
+    curr_translator->Prepare(child_translator, parent_translator, is_vectorizable_, is_parallelizable_,
+                             thread_state_struct_);
+  }
+
+  // The helper functions of the operators may refer to the thread state, so it is declared first
+  if (is_parallelizable_) GenThreadStateStruct(decls);
 
+  for (auto &translator : pipeline_) {
     // Initialize
-    curr_translator->Prepare(child_translator, parent_translator, is_vectorizable_, is_parallelizable_);
-    curr_translator->InitializeStateFields(state_fields);
-    curr_translator->InitializeStructs(decls);
-    curr_translator->InitializeHelperFunctions(decls);
-    curr_translator->InitializeSetup(setup_stmts);
-    curr_translator->InitializeTeardown(teardown_stmts);
+    translator->InitializeStateFields(state_fields);
+    translator->InitializeStructs(decls);
+    translator->InitializeHelperFunctions(decls);
+    translator->InitializeSetup(setup_stmts);
+    translator->InitializeTeardown(teardown_stmts);
   }
+
+  if (is_parallelizable_) GenThreadStateFunctions(decls);
 }
 
-ast::Decl *Pipeline::Produce(uint32_t pipeline_idx) {
+void Pipeline::Produce(util::RegionVector<ast::Decl *> *decls, uint32_t pipeline_idx) {
   pipeline_idx_ = pipeline_idx;
   // Function name
   ast::Identifier fn_name = GetPipelineName();
@@ -39,10 +54,95 @@ ast::Decl *Pipeline::Produce(uint32_t pipeline_idx) {
 
   FunctionBuilder builder{codegen_, fn_name, std::move(params), ret_type};
 
-  // for (const auto & translator: pipeline_) {
+  if (is_parallelizable_) {
+    decls->emplace_back(GenWorker());
+    GenParallelPipeline(&builder);
+  } else {
+    pipeline_[pipeline_.size() - 1]->Produce(&builder);
+  }
+  decls->emplace_back(builder.Finish());
+}
+
+void Pipeline::GenThreadStateStruct(util::RegionVector<ast::Decl *> *decls) {
+  util::RegionVector<ast::FieldDecl *> fields{codegen_->Region()};
+  // The pipeline breaker at the end comes first, so that its merge call finds its state at offset 0
+  for (auto translator = pipeline_.rbegin(); translator != pipeline_.rend(); ++translator) {
+    (*translator)->InitializeThreadStateFields(&fields);
+  }
+  // The worker only gets the thread state, so the execution context is kept there
+  ast::Expr *exec_ctx_type = codegen_->PointerType(codegen_->BuiltinType(ast::BuiltinType::Kind::ExecutionContext));
+  fields.emplace_back(codegen_->MakeField(codegen_->GetExecCtxVar(), exec_ctx_type));
+  decls->emplace_back(codegen_->MakeStruct(thread_state_struct_, std::move(fields)));
+}
+
+void Pipeline::GenThreadStateFunctions(util::RegionVector<ast::Decl *> *decls) {
+  ast::Expr *ret_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Nil);
+
+  // fun initThreadState(execCtx: *ExecutionContext, threadState: *ThreadState) -> nil
+  util::RegionVector<ast::Stmt *> init_stmts{codegen_->Region()};
+  // threadState.execCtx = execCtx
+  ast::Expr *exec_ctx_member = codegen_->MemberExpr(codegen_->GetThreadStateVar(), codegen_->GetExecCtxVar());
+  init_stmts.emplace_back(codegen_->Assign(exec_ctx_member, codegen_->MakeExpr(codegen_->GetExecCtxVar())));
+  for (auto &translator : pipeline_) {
+    translator->InitializeThreadState(&init_stmts);
+  }
+  FunctionBuilder init_builder{codegen_, init_thread_state_fn_, codegen_->ThreadStateParams(thread_state_struct_),
+                               ret_type};
+  for (const auto &stmt : init_stmts) {
+    init_builder.Append(stmt);
+  }
+  decls->emplace_back(init_builder.Finish());
+
+  // fun teardownThreadState(execCtx: *ExecutionContext, threadState: *ThreadState) -> nil
+  util::RegionVector<ast::Stmt *> teardown_stmts{codegen_->Region()};
+  for (auto &translator : pipeline_) {
+    translator->TearDownThreadState(&teardown_stmts);
+  }
+  FunctionBuilder teardown_builder{codegen_, teardown_thread_state_fn_,
+                                   codegen_->ThreadStateParams(thread_state_struct_), ret_type};
+  for (const auto &stmt : teardown_stmts) {
+    teardown_builder.Append(stmt);
+  }
+  decls->emplace_back(teardown_builder.Finish());
+}
+
+ast::Decl *Pipeline::GenWorker() {
+  // fun worker(state: *State, threadState: *ThreadState, tvi: *TableVectorIterator) -> nil
+  ast::Expr *ret_type = codegen_->BuiltinType(ast::BuiltinType::Kind::Nil);
+  FunctionBuilder builder{codegen_, worker_fn_, codegen_->WorkerParams(thread_state_struct_), ret_type};
+
+  // var execCtx = threadState.execCtx
+  ast::Expr *exec_ctx_member = codegen_->MemberExpr(codegen_->GetThreadStateVar(), codegen_->GetExecCtxVar());
+  builder.Append(codegen_->DeclareVariable(codegen_->GetExecCtxVar(), nullptr, exec_ctx_member));
+
   pipeline_[pipeline_.size() - 1]->Produce(&builder);
-  //}
   return builder.Finish();
 }
 
+void Pipeline::GenParallelPipeline(FunctionBuilder *builder) {
+  // var tls: ThreadStateContainer
+  ast::Identifier tls = codegen_->NewIdentifier("tls");
+  builder->Append(
+      codegen_->DeclareVariable(tls, codegen_->BuiltinType(ast::BuiltinType::Kind::ThreadStateContainer), nullptr));
+
+  // @tlsInit(&tls, @execCtxGetMem(execCtx))
+  ast::Expr *init_call = codegen_->BuiltinCall(ast::Builtin::ThreadStateContainerInit,
+                                               {codegen_->PointerTo(tls), codegen_->ExecCtxGetMem()});
+  builder->Append(codegen_->MakeStmt(init_call));
+
+  // @tlsReset(&tls, @sizeOf(ThreadState), initThreadState, teardownThreadState, execCtx)
+  ast::Expr *reset_call = codegen_->BuiltinCall(
+      ast::Builtin::ThreadStateContainerReset,
+      {codegen_->PointerTo(tls), codegen_->SizeOf(thread_state_struct_), codegen_->MakeExpr(init_thread_state_fn_),
+       codegen_->MakeExpr(teardown_thread_state_fn_), codegen_->MakeExpr(codegen_->GetExecCtxVar())});
+  builder->Append(codegen_->MakeStmt(reset_call));
+
+  // Run the worker over the table, then merge what the threads built
+  pipeline_[0]->LaunchParallelScan(builder, tls, worker_fn_);
+  pipeline_[pipeline_.size() - 1]->FinishParallelPipeline(builder, tls);
+
+  // @tlsFree(&tls)
+  builder->Append(codegen_->MakeStmt(codegen_->OneArgCall(ast::Builtin::ThreadStateContainerFree, tls, true)));
+}
+
 }  // namespace terrier::execution::compiler
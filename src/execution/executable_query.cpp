@@ -11,10 +11,11 @@
 namespace terrier::execution {
 
 ExecutableQuery::ExecutableQuery(const common::ManagedPointer<planner::AbstractPlanNode> physical_plan,
-                                 const common::ManagedPointer<exec::ExecutionContext> exec_ctx) {
+                                 const common::ManagedPointer<exec::ExecutionContext> exec_ctx,
+                                 const bool parallel_execution) {
   // Compile and check for errors
   compiler::CodeGen codegen(exec_ctx.Get());
-  compiler::Compiler compiler(&codegen, physical_plan.Get());
+  compiler::Compiler compiler(&codegen, physical_plan.Get(), parallel_execution);
   auto root = compiler.Compile();
   if (codegen.Reporter()->HasErrors()) {
     EXECUTION_LOG_ERROR("Type-checking error! \n {}", codegen.Reporter()->SerializeErrors());
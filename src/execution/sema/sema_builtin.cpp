@@ -986,36 +986,51 @@ void Sema::CheckBuiltinTableIterCall(ast::CallExpr *call, ast::Builtin builtin)
 }
 
 void Sema::CheckBuiltinTableIterParCall(ast::CallExpr *call) {
-  if (!CheckArgCount(call, 4)) {
+  if (!CheckArgCount(call, 6)) {
     return;
   }
 
   const auto &call_args = call->Arguments();
 
-  // First argument is table name as a string literal
-  if (!call_args[0]->IsStringLiteral()) {
-    ReportIncorrectCallArg(call, 0, ast::StringType::Get(GetContext()));
+  // First argument is the execution context
+  const auto exec_ctx_kind = ast::BuiltinType::ExecutionContext;
+  if (!IsPointerToSpecificBuiltin(call_args[0]->GetType(), exec_ctx_kind)) {
+    ReportIncorrectCallArg(call, 0, GetBuiltinType(exec_ctx_kind)->PointerTo());
+    return;
+  }
+
+  // Second argument is either the table name as a string literal, or the table oid as an integer literal
+  if (!call_args[1]->IsStringLiteral() && !call_args[1]->IsIntegerLiteral()) {
+    ReportIncorrectCallArg(call, 1, ast::StringType::Get(GetContext()));
+    return;
+  }
+
+  // Third argument is a fixed length uint32 array of column oids
+  auto *arr_type = call_args[2]->GetType()->SafeAs<ast::ArrayType>();
+  if (arr_type == nullptr || !arr_type->ElementType()->IsSpecificBuiltin(ast::BuiltinType::Uint32) ||
+      !arr_type->HasKnownLength()) {
+    ReportIncorrectCallArg(call, 2, "Third argument should be a fixed length uint32 array");
     return;
   }
 
-  // Second argument is an opaque query state. For now, check it's a pointer.
+  // Fourth argument is an opaque query state. For now, check it's a pointer.
   const auto void_kind = ast::BuiltinType::Nil;
-  if (!call_args[1]->GetType()->IsPointerType()) {
-    ReportIncorrectCallArg(call, 1, GetBuiltinType(void_kind)->PointerTo());
+  if (!call_args[3]->GetType()->IsPointerType()) {
+    ReportIncorrectCallArg(call, 3, GetBuiltinType(void_kind)->PointerTo());
     return;
   }
 
-  // Third argument is the thread state container
+  // Fifth argument is the thread state container
   const auto tls_kind = ast::BuiltinType::ThreadStateContainer;
-  if (!IsPointerToSpecificBuiltin(call_args[2]->GetType(), tls_kind)) {
-    ReportIncorrectCallArg(call, 2, GetBuiltinType(tls_kind)->PointerTo());
+  if (!IsPointerToSpecificBuiltin(call_args[4]->GetType(), tls_kind)) {
+    ReportIncorrectCallArg(call, 4, GetBuiltinType(tls_kind)->PointerTo());
     return;
   }
 
-  // Third argument is scanner function
-  auto *scan_fn_type = call_args[3]->GetType()->SafeAs<ast::FunctionType>();
+  // Sixth argument is scanner function
+  auto *scan_fn_type = call_args[5]->GetType()->SafeAs<ast::FunctionType>();
   if (scan_fn_type == nullptr) {
-    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[3]->GetType());
+    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[5]->GetType());
     return;
   }
   // Check type
@@ -1023,7 +1038,7 @@ void Sema::CheckBuiltinTableIterParCall(ast::CallExpr *call) {
   const auto &params = scan_fn_type->Params();
   if (params.size() != 3 || !params[0].type_->IsPointerType() || !params[1].type_->IsPointerType() ||
       !IsPointerToSpecificBuiltin(params[2].type_, tvi_kind)) {
-    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[3]->GetType());
+    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[5]->GetType());
     return;
   }
 
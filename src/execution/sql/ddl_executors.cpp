@@ -154,6 +154,8 @@ bool DDLExecutors::CreateIndex(const common::ManagedPointer<catalog::CatalogAcce
   auto *const index = index_builder.Build();
   bool result UNUSED_ATTRIBUTE = accessor->SetIndexPointer(index_oid, index);
   TERRIER_ASSERT(result, "CreateIndex succeeded, SetIndexPointer must also succeed.");
-  return true;
+  // Populate the Index with the tuples that are already in the table. If this fails (e.g. the tuples violate a
+  // uniqueness constraint), the txn must abort, which also cleans up the Index.
+  return index_builder.BulkInsert(index, accessor->GetTable(table), accessor->GetTxn());
 }
 }  // namespace terrier::execution::sql
@@ -1,4 +1,5 @@
 #include "execution/sql/index_iterator.h"
+#include "common/constants.h"
 #include "execution/sql/value.h"
 
 namespace terrier::execution::sql {
@@ -32,28 +33,30 @@ void IndexIterator::ScanKey() {
   // Scan the index
   tuples_.clear();
   curr_index_ = 0;
+  cursor_.reset();
   index_->ScanKey(*exec_ctx_->GetTxn(), *index_pr_, &tuples_);
 }
 
 void IndexIterator::ScanAscending(storage::index::ScanType scan_type, uint32_t limit) {
-  // Scan the index
+  // Open a cursor over the range, the slots are fetched in batches as the iterator advances
   tuples_.clear();
   curr_index_ = 0;
-  index_->ScanAscending(*exec_ctx_->GetTxn(), scan_type, num_attrs_, index_pr_, hi_index_pr_, limit, &tuples_);
+  cursor_ = index_->OpenAscendingCursor(*exec_ctx_->GetTxn(), scan_type, num_attrs_, index_pr_, hi_index_pr_, limit);
 }
 
 void IndexIterator::ScanDescending() {
-  // Scan the index
+  // Open a cursor over the range, the slots are fetched in batches as the iterator advances
   tuples_.clear();
   curr_index_ = 0;
-  index_->ScanDescending(*exec_ctx_->GetTxn(), *index_pr_, *hi_index_pr_, &tuples_);
+  cursor_ = index_->OpenDescendingCursor(*exec_ctx_->GetTxn(), *index_pr_, *hi_index_pr_, 0);
 }
 
 void IndexIterator::ScanLimitDescending(uint32_t limit) {
-  // Scan the index
+  // Open a cursor over the range, the slots are fetched in batches as the iterator advances
+  TERRIER_ASSERT(limit > 0, "Limit must be greater than 0.");
   tuples_.clear();
   curr_index_ = 0;
-  index_->ScanLimitDescending(*exec_ctx_->GetTxn(), *index_pr_, *hi_index_pr_, &tuples_, limit);
+  cursor_ = index_->OpenDescendingCursor(*exec_ctx_->GetTxn(), *index_pr_, *hi_index_pr_, limit);
 }
 
 bool IndexIterator::Advance() {
@@ -61,6 +64,11 @@ bool IndexIterator::Advance() {
     ++curr_index_;
     return true;
   }
+  // The current batch is exhausted, fetch the next one if the scan has more
+  if (cursor_ != nullptr && cursor_->Next(&tuples_, common::Constants::K_DEFAULT_VECTOR_SIZE)) {
+    curr_index_ = 1;
+    return true;
+  }
   return false;
 }
 
@@ -720,6 +720,8 @@ void JoinHashTable::MergeParallel(const ThreadStateContainer *thread_state_conta
       MergeIncomplete<false, true>(source);
     }
   });
+
+  built_ = true;
 }
 
 }  // namespace terrier::execution::sql
@@ -182,6 +182,16 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
 
   timer.ExitStage();
 
+  // A single sorter leaves nothing to merge (there are no splitters), so its sorted tuples are taken as they are
+  if (tl_sorters.size() == 1) {
+    Sorter *const tl_sorter = tl_sorters[0];
+    std::copy(tl_sorter->tuples_.begin(), tl_sorter->tuples_.end(), tuples_.begin());
+    owned_tuples_.emplace_back(std::move(tl_sorter->tuple_storage_));
+    tl_sorter->tuples_.clear();
+    sorted_ = true;
+    return;
+  }
+
   // -------------------------------------------------------
   // 3. Compute splitters
   // -------------------------------------------------------
@@ -4,10 +4,12 @@
 #include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "execution/exec/execution_context.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/util/timer.h"
 
 namespace terrier::execution::sql {
@@ -21,7 +23,15 @@ TableVectorIterator::~TableVectorIterator() {
 
 bool TableVectorIterator::Init() {
   // Find the table
-  table_ = exec_ctx_->GetAccessor()->GetTable(table_oid_);
+  InitProjection(exec_ctx_->GetAccessor()->GetTable(table_oid_));
+
+  // Begin iterating
+  iter_ = std::make_unique<storage::DataTable::SlotIterator>(table_->begin());
+  return true;
+}
+
+void TableVectorIterator::InitProjection(const common::ManagedPointer<storage::SqlTable> table) {
+  table_ = table;
   TERRIER_ASSERT(table_ != nullptr, "Table must exist!!");
 
   // Initialize the projected column
@@ -30,34 +40,49 @@ bool TableVectorIterator::Init() {
   buffer_ = exec_ctx_->GetMemoryPool()->AllocateAligned(pc_init.ProjectedColumnsSize(), alignof(uint64_t), false);
   projected_columns_ = pc_init.Initialize(buffer_);
   initialized_ = true;
-
-  // Begin iterating
-  iter_ = std::make_unique<storage::DataTable::SlotIterator>(table_->begin());
-  return true;
 }
 
 bool TableVectorIterator::Advance() {
   if (!initialized_) return false;
   // First check if the iterator ended.
-  if (*iter_ == table_->end()) {
+  const storage::DataTable::SlotIterator end = end_ == nullptr ? table_->end() : *end_;
+  if (*iter_ == end) {
     return false;
   }
   // Scan the table to set the projected column.
-  table_->Scan(exec_ctx_->GetTxn(), iter_.get(), projected_columns_);
+  table_->Scan(exec_ctx_->GetTxn(), iter_.get(), end, projected_columns_);
   pci_.SetProjectedColumn(projected_columns_);
   return true;
 }
 
 void TableVectorIterator::Reset() {
   if (!initialized_) return;
-  iter_ = std::make_unique<storage::DataTable::SlotIterator>(table_->begin());
+  iter_ = std::make_unique<storage::DataTable::SlotIterator>(begin_ == nullptr ? table_->begin() : *begin_);
 }
 
-bool TableVectorIterator::ParallelScan(uint32_t db_oid, uint32_t table_oid, void *const query_state,
+bool TableVectorIterator::ParallelScan(exec::ExecutionContext *const exec_ctx, const uint32_t table_oid,
+                                       uint32_t *const col_oids, const uint32_t num_oids, void *const query_state,
                                        ThreadStateContainer *const thread_states, const ScanFn scan_fn,
                                        const uint32_t min_grain_size) {
-  // TODO(Amadou): Implement Me!!
-  return false;
+  // Resolve the table once, the workers share it
+  const auto table = exec_ctx->GetAccessor()->GetTable(catalog::table_oid_t(table_oid));
+  if (table == nullptr) return false;
+
+  // The table is split at block boundaries up front, every task scans a range of whole blocks
+  const std::vector<storage::DataTable::SlotIterator> boundaries = table->BlockBoundaries();
+  const size_t num_blocks = boundaries.size() - 1;
+
+  tbb::task_scheduler_init sched;
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, std::max<uint32_t>(min_grain_size, 1)),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      TableVectorIterator iter(exec_ctx, table_oid, col_oids, num_oids);
+                      iter.InitProjection(table);
+                      iter.begin_ = std::make_unique<storage::DataTable::SlotIterator>(boundaries[range.begin()]);
+                      iter.end_ = std::make_unique<storage::DataTable::SlotIterator>(boundaries[range.end()]);
+                      iter.iter_ = std::make_unique<storage::DataTable::SlotIterator>(*iter.begin_);
+                      scan_fn(query_state, thread_states->AccessThreadStateOfCurrentThread(), &iter);
+                    });
+  return true;
 }
 
 }  // namespace terrier::execution::sql
@@ -579,7 +579,28 @@ void BytecodeGenerator::VisitBuiltinTableIterCall(ast::CallExpr *call, ast::Buil
 }
 
 void BytecodeGenerator::VisitBuiltinTableIterParallelCall(ast::CallExpr *call) {
-  UNREACHABLE("Parallel scan is not implemented yet!");
+  // The first argument is the execution context
+  LocalVar exec_ctx = VisitExpressionForRValue(call->Arguments()[0]);
+  // The second argument is either the table name or the table oid
+  auto *table_arg = call->Arguments()[1]->As<ast::LitExpr>();
+  catalog::table_oid_t table_oid;
+  if (table_arg->IsIntegerLiteral()) {
+    table_oid = catalog::table_oid_t(static_cast<uint32_t>(table_arg->Int64Val()));
+  } else {
+    auto ns_oid = exec_ctx_->GetAccessor()->GetDefaultNamespace();
+    table_oid = exec_ctx_->GetAccessor()->GetTableOid(ns_oid, table_arg->RawStringVal().Data());
+  }
+  TERRIER_ASSERT(table_oid != terrier::catalog::INVALID_TABLE_OID, "Table does not exists");
+  // The third argument is the array of oids
+  auto *arr_type = call->Arguments()[2]->GetType()->As<ast::ArrayType>();
+  LocalVar col_oids = VisitExpressionForLValue(call->Arguments()[2]);
+  // The fourth and fifth arguments are the query state and the thread state container
+  LocalVar query_state = VisitExpressionForRValue(call->Arguments()[3]);
+  LocalVar thread_states = VisitExpressionForRValue(call->Arguments()[4]);
+  // The last argument is the scan function
+  FunctionId scan_fn = LookupFuncIdByName(call->Arguments()[5]->As<ast::IdentifierExpr>()->Name().Data());
+  Emitter()->EmitParallelTableScan(exec_ctx, !table_oid, col_oids, static_cast<uint32_t>(arr_type->Length()),
+                                   query_state, thread_states, scan_fn);
 }
 
 void BytecodeGenerator::VisitBuiltinPCICall(ast::CallExpr *call, ast::Builtin builtin) {
@@ -555,14 +555,16 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
   }
 
   OP(ParallelScanTable) : {
-    auto db_oid = READ_UIMM4();
+    auto exec_ctx = frame->LocalAt<exec::ExecutionContext *>(READ_LOCAL_ID());
     auto table_oid = READ_UIMM4();
+    auto col_oids = frame->LocalAt<uint32_t *>(READ_LOCAL_ID());
+    auto num_oids = READ_UIMM4();
     auto query_state = frame->LocalAt<void *>(READ_LOCAL_ID());
     auto thread_state_container = frame->LocalAt<sql::ThreadStateContainer *>(READ_LOCAL_ID());
     auto scan_fn_id = READ_FUNC_ID();
 
     auto scan_fn = reinterpret_cast<sql::TableVectorIterator::ScanFn>(module_->GetRawFunctionImpl(scan_fn_id));
-    OpParallelScanTable(db_oid, table_oid, query_state, thread_state_container, scan_fn);
+    OpParallelScanTable(exec_ctx, table_oid, col_oids, num_oids, query_state, thread_state_container, scan_fn);
     DISPATCH_NEXT();
   }
 
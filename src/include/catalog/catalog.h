@@ -132,6 +132,7 @@ class Catalog {
 
  private:
   DISALLOW_COPY_AND_MOVE(Catalog);
+  friend class storage::CheckpointManager;
   friend class storage::RecoveryManager;
   const common::ManagedPointer<transaction::TransactionManager> txn_manager_;
   const common::ManagedPointer<storage::BlockStore> catalog_block_store_;
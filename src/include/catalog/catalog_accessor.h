@@ -332,6 +332,11 @@ class CatalogAccessor {
    */
   type_oid_t GetTypeOidFromTypeId(type::TypeId type);
 
+  /**
+   * @return the transaction context for this accessor
+   */
+  common::ManagedPointer<transaction::TransactionContext> GetTxn() const { return txn_; }
+
   /**
    * @return BlockStore to be used for CREATE operations
    */
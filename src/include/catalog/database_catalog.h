@@ -495,6 +495,7 @@ class DatabaseCatalog {
 
   friend class Catalog;
   friend class postgres::Builder;
+  friend class storage::CheckpointManager;
   friend class storage::RecoveryManager;
 
   /**
@@ -20,6 +20,7 @@ class TpccPlanTest;
 }  // namespace terrier
 
 namespace terrier::storage {
+class CheckpointManager;
 class RecoveryManager;
 }
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <immintrin.h>
+#include <atomic>
+
+#include "common/macros.h"
+
+namespace terrier::common {
+
+/**
+ * A version latch for optimistic lock coupling as described in Leis et al., "The ART of Practical Synchronization"
+ * (DaMoN 2016). Readers never write to the latch: they remember the version they observed before reading the protected
+ * data and validate that it is unchanged afterwards. Writers acquire the latch exclusively, which bumps the version and
+ * invalidates every concurrent optimistic reader.
+ *
+ * The 64-bit word is laid out as [version | locked bit | obsolete bit]. The version advances by one each time the
+ * latch is released by a writer.
+ *
+ * Since readers may observe partially written data, they must validate the version before they act on anything they
+ * read (e.g. dereference a pointer read from the protected data).
+ */
+class OptimisticLatch {
+ public:
+  /**
+   * Begins an optimistic read.
+   * @param[out] needs_restart set to true if the latch is currently held exclusively or the protected data is obsolete
+   * @return version to validate against once the read is complete
+   */
+  uint64_t ReadLockOrRestart(bool *const needs_restart) const {
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if (IsLocked(version) || IsObsolete(version)) {
+      _mm_pause();
+      *needs_restart = true;
+    }
+    return version;
+  }
+
+  /**
+   * Begins an optimistic read of data that writers leave untouched once they mark it obsolete, so that it can still be
+   * read (as a frozen snapshot) afterwards.
+   * @param[out] needs_restart set to true if the latch is currently held exclusively
+   * @param[out] obsolete set to true if the protected data is obsolete
+   * @return version to validate against once the read is complete
+   */
+  uint64_t ReadLockAllowObsoleteOrRestart(bool *const needs_restart, bool *const obsolete) const {
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if (IsLocked(version)) {
+      _mm_pause();
+      *needs_restart = true;
+    }
+    *obsolete = IsObsolete(version);
+    return version;
+  }
+
+  /**
+   * Checks that nothing was written to the protected data since the given version was observed.
+   * @param version version returned by ReadLockOrRestart
+   * @return true if the optimistic read is still valid
+   */
+  bool Validate(const uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version == version_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Ends (or checkpoints) an optimistic read.
+   * @param version version returned by ReadLockOrRestart
+   * @param[out] needs_restart set to true if the read is no longer valid
+   */
+  void ReadUnlockOrRestart(const uint64_t version, bool *const needs_restart) const {
+    if (!Validate(version)) *needs_restart = true;
+  }
+
+  /**
+   * Atomically converts an optimistic read into exclusive ownership of the latch.
+   * @param[in,out] version version returned by ReadLockOrRestart, updated to the locked version on success
+   * @param[out] needs_restart set to true if the latch changed since the version was observed
+   */
+  void UpgradeToWriteLockOrRestart(uint64_t *const version, bool *const needs_restart) {
+    if (version_.compare_exchange_strong(*version, *version + LOCKED_BIT)) {
+      *version += LOCKED_BIT;
+    } else {
+      _mm_pause();
+      *needs_restart = true;
+    }
+  }
+
+  /**
+   * Acquires the latch exclusively, failing if it is held or the protected data is obsolete.
+   * @param[out] needs_restart set to true if the latch could not be acquired
+   */
+  void WriteLockOrRestart(bool *const needs_restart) {
+    uint64_t version = ReadLockOrRestart(needs_restart);
+    if (*needs_restart) return;
+    UpgradeToWriteLockOrRestart(&version, needs_restart);
+  }
+
+  /**
+   * Acquires the latch exclusively, spinning until it is released by the current holder.
+   * @warning callers must acquire latches in a global order to avoid deadlock
+   * @return false if the protected data became obsolete, in which case the latch is not held
+   */
+  bool WriteLock() {
+    while (true) {
+      uint64_t version = version_.load(std::memory_order_acquire);
+      if (IsObsolete(version)) return false;
+      if (!IsLocked(version) && version_.compare_exchange_weak(version, version + LOCKED_BIT)) return true;
+      _mm_pause();
+    }
+  }
+
+  /**
+   * Releases exclusive ownership of the latch and advances the version.
+   */
+  void WriteUnlock() {
+    TERRIER_ASSERT(IsLocked(version_.load()), "Latch must be held to be released.");
+    version_.fetch_add(LOCKED_BIT, std::memory_order_release);
+  }
+
+  /**
+   * Releases exclusive ownership of the latch and marks the protected data as obsolete, causing all current and future
+   * readers to restart.
+   */
+  void WriteUnlockObsolete() {
+    TERRIER_ASSERT(IsLocked(version_.load()), "Latch must be held to be released.");
+    version_.fetch_add(LOCKED_BIT | OBSOLETE_BIT, std::memory_order_release);
+  }
+
+  /**
+   * @return true if the latch is currently held exclusively
+   */
+  bool IsLocked() const { return IsLocked(version_.load(std::memory_order_relaxed)); }
+
+ private:
+  static constexpr uint64_t OBSOLETE_BIT = 0b01;
+  static constexpr uint64_t LOCKED_BIT = 0b10;
+
+  static bool IsLocked(const uint64_t version) { return (version & LOCKED_BIT) == LOCKED_BIT; }
+  static bool IsObsolete(const uint64_t version) { return (version & OBSOLETE_BIT) == OBSOLETE_BIT; }
+
+  // Start at a non-zero version, so that a zero-initialized version is never mistaken for a valid read
+  std::atomic<uint64_t> version_ = 0b100;
+};
+
+}  // namespace terrier::common
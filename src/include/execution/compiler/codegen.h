@@ -99,6 +99,16 @@ class CodeGen {
    */
   ast::Identifier GetExecCtxVar() { return exec_ctx_var_; }
 
+  /**
+   * @return the thread state's identifier
+   */
+  ast::Identifier GetThreadStateVar() { return thread_state_var_; }
+
+  /**
+   * @return the identifier of the table vector iterator handed to the worker of a parallel pipeline
+   */
+  ast::Identifier GetWorkerTVIVar() { return worker_tvi_var_; }
+
   /**
    * Creates the File node for the query
    * @param top_level_decls the list of top level declarations
@@ -135,6 +145,22 @@ class CodeGen {
    */
   util::RegionVector<ast::FieldDecl *> ExecParams();
 
+  /**
+   * Functions that initialize or tear down the thread states of a parallel pipeline have the signature:
+   * (execCtx: *ExecutionContext, threadState: *ThreadState) -> nil
+   * @param thread_state_type identifier of the thread state struct
+   * @return the list of parameters of these functions
+   */
+  util::RegionVector<ast::FieldDecl *> ThreadStateParams(ast::Identifier thread_state_type);
+
+  /**
+   * The worker of a parallel pipeline has the signature:
+   * (state: *State, threadState: *ThreadState, tvi: *TableVectorIterator) -> nil
+   * @param thread_state_type identifier of the thread state struct
+   * @return the list of parameters of the worker
+   */
+  util::RegionVector<ast::FieldDecl *> WorkerParams(ast::Identifier thread_state_type);
+
   /**
    * Calls one of functions called by main
    * @return the fn_name(state, execCtx) call.
@@ -148,6 +174,13 @@ class CodeGen {
    */
   ast::Expr *GetStateMemberPtr(ast::Identifier ident);
 
+  /**
+   * Return a pointer to a thread state member
+   * @param ident identifier of the member
+   * @return the expression &threadState.ident
+   */
+  ast::Expr *GetThreadStateMemberPtr(ast::Identifier ident);
+
   /**
    * Creates a field declaration
    * @param field_name name of field
@@ -407,6 +440,17 @@ class CodeGen {
    */
   ast::Expr *TableIterInit(ast::Identifier tvi, uint32_t table_oid, ast::Identifier col_oids);
 
+  /**
+   * Call iterateTableParallel(execCtx, table_oid, col_oids, state, &tls, worker)
+   * @param table_oid The oid of the table to iterate through
+   * @param col_oids The identifier of the array of column oids to read.
+   * @param tls The identifier of the thread state container.
+   * @param worker The identifier of the function that scans each part of the table.
+   * @return The expression corresponding to the builtin call.
+   */
+  ast::Expr *IterateTableParallel(uint32_t table_oid, ast::Identifier col_oids, ast::Identifier tls,
+                                  ast::Identifier worker);
+
   /**
    * Call pciGetTypeNullable(pci, idx)
    * @param pci The identifier of the projected columns iterator
@@ -523,6 +567,15 @@ class CodeGen {
    */
   ast::Expr *HTInitCall(ast::Builtin builtin, ast::Identifier object, ast::Identifier struct_type);
 
+  /**
+   * Same as above, but for a hash table that is not a member of the state.
+   * @param builtin builtin function to call
+   * @param object_ptr pointer to the hash table to initialize.
+   * @param struct_type identifier of the build struct.
+   * @return The expression corresponding to the builtin call initializing the given hash table.
+   */
+  ast::Expr *HTInitCall(ast::Builtin builtin, ast::Expr *object_ptr, ast::Identifier struct_type);
+
   /**
    * This is for function this take one state argument.
    * @param builtin builtin function to call
@@ -557,6 +610,10 @@ class CodeGen {
   ast::Identifier state_var_;
   // Identifier of the execution context variable
   ast::Identifier exec_ctx_var_;
+  // Identifier of the thread state variable
+  ast::Identifier thread_state_var_;
+  // Identifier of the table vector iterator of a parallel pipeline's worker
+  ast::Identifier worker_tvi_var_;
   /**
    * Identifier of the main function.
    * Signature: (execCtx: *ExecutionContext) -> int32
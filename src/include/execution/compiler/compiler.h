@@ -20,8 +20,9 @@ class Compiler {
    * Constructor
    * @param codegen The code generator
    * @param plan The plan node to compile
+   * @param parallel_execution Whether pipelines made only of parallelizable operators run in parallel
    */
-  Compiler(CodeGen *codegen, const planner::AbstractPlanNode *plan);
+  Compiler(CodeGen *codegen, const planner::AbstractPlanNode *plan, bool parallel_execution = false);
 
   /**
    * Convert the plan to AST and type check it
@@ -47,6 +48,7 @@ class Compiler {
   ast::Decl *GenMainFunction();
   CodeGen *codegen_;
   const planner::AbstractPlanNode *plan_;
+  bool parallel_execution_;
   std::vector<std::unique_ptr<Pipeline>> pipelines_;
 };
 
@@ -37,10 +37,25 @@ class AggregateBottomTranslator : public OperatorTranslator {
   // Call @aggHTFree
   void InitializeTeardown(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
 
+  // Declare the thread local hash table
+  void InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) override;
+
+  // Call @aggHTInit on the thread local hash table
+  void InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) override;
+
+  // Call @aggHTFree on the thread local hash table
+  void TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
+
+  // Merge every thread local hash table into the global one
+  void FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) override;
+
   void Produce(FunctionBuilder *builder) override;
   void Abort(FunctionBuilder *builder) override;
   void Consume(FunctionBuilder *builder) override;
 
+  // Each thread aggregates into its own hash table
+  bool IsParallelizable() override { return true; }
+
   // Pass through to the child
   ast::Expr *GetChildOutput(uint32_t child_idx, uint32_t attr_idx, terrier::type::TypeId type) override;
 
@@ -121,6 +136,15 @@ class AggregateBottomTranslator : public OperatorTranslator {
   // Tuple at a time key check
   void GenSingleKeyCheckFn(util::RegionVector<ast::Decl *> *decls);
 
+  // Key check between an entry of the global hash table and an entry of a thread local one
+  void GenMergeKeyCheckFn(util::RegionVector<ast::Decl *> *decls);
+
+  /*
+   * fun mergeFn(state: *State, threadState: *ThreadState) -> nil
+   * Iterate through the thread local hash table, and merge every partial aggregate into the global hash table.
+   */
+  void GenMergeFn(util::RegionVector<ast::Decl *> *decls);
+
   // Make the top translator a friend class.
   friend class AggregateTopTranslator;
 
@@ -140,6 +164,10 @@ class AggregateBottomTranslator : public OperatorTranslator {
   ast::Identifier agg_payload_;
   ast::Identifier key_check_;
   ast::Identifier agg_ht_;
+  ast::Identifier merge_key_check_;
+  ast::Identifier merge_fn_;
+  ast::Identifier merge_iter_;
+  ast::Identifier partial_;
 };
 
 /**
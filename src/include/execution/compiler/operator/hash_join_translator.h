@@ -41,6 +41,21 @@ class HashJoinLeftTranslator : public OperatorTranslator {
   // Call @joinHTFree on the hash table
   void InitializeTeardown(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
 
+  // Add the thread local join hash table
+  void InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) override;
+
+  // Call @joinHTInit on the thread local hash table
+  void InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) override;
+
+  // Call @joinHTFree on the thread local hash table
+  void TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
+
+  // Build the global hash table from the thread local ones
+  void FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) override;
+
+  // Each thread inserts into its own hash table
+  bool IsParallelizable() override { return true; }
+
   ast::Expr *GetOutput(uint32_t attr_idx) override;
 
   ast::Expr *GetChildOutput(uint32_t child_idx, uint32_t attr_idx, terrier::type::TypeId type) override;
@@ -74,19 +74,56 @@ class OperatorTranslator : public ExpressionEvaluator {
    */
   virtual void Consume(FunctionBuilder *builder) = 0;
 
+  /**
+   * Add fields to the thread state struct of a parallel pipeline
+   * @param thread_state_fields list of fields of the thread state struct
+   */
+  virtual void InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) {}
+
+  /**
+   * Add statements to the function that initializes each thread state of a parallel pipeline
+   * @param init_stmts list of statements in the thread state initialization function
+   */
+  virtual void InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) {}
+
+  /**
+   * Add statements to the function that tears down each thread state of a parallel pipeline
+   * @param teardown_stmts list of statements in the thread state teardown function
+   */
+  virtual void TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) {}
+
+  /**
+   * Start the parallel scan that drives a parallel pipeline. Only called on the first operator of the pipeline.
+   * @param builder builder of the pipeline function
+   * @param tls identifier of the thread state container
+   * @param worker identifier of the function that runs the pipeline over each part of the scan
+   */
+  virtual void LaunchParallelScan(FunctionBuilder *builder, ast::Identifier tls, ast::Identifier worker) {
+    UNREACHABLE("This operator cannot start a parallel pipeline");
+  }
+
+  /**
+   * Merge the thread states once every thread of a parallel pipeline is done.
+   * @param builder builder of the pipeline function
+   * @param tls identifier of the thread state container
+   */
+  virtual void FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) {}
+
   /**
    * Setup state needed before generating code
    * @param child_translator the child translator
    * @param parent_translator the parent translator
    * @param vectorize whether the pipeline is vectorized
    * @param parallelize whether the pipeline is paralellized
+   * @param thread_state_struct identifier of the pipeline's thread state struct if it is parallelized
    */
   void Prepare(OperatorTranslator *child_translator, OperatorTranslator *parent_translator, bool vectorize,
-               bool parallelize) {
+               bool parallelize, ast::Identifier thread_state_struct) {
     child_translator_ = child_translator;
     parent_translator_ = parent_translator;
     vectorized_pipeline_ = vectorize;
     parallelized_pipeline_ = parallelize;
+    thread_state_struct_ = thread_state_struct;
   }
 
   /**
@@ -162,6 +199,16 @@ class OperatorTranslator : public ExpressionEvaluator {
   virtual const planner::AbstractPlanNode *Op() = 0;
 
  protected:
+  /**
+   * Pipeline breakers build their output in the thread state when the pipeline is parallelized, and in the state
+   * otherwise. The member has the same identifier in both structs.
+   * @param ident identifier of the member
+   * @return the expression &threadState.ident in parallel pipelines, &state.ident otherwise
+   */
+  ast::Expr *GetBuildMemberPtr(ast::Identifier ident) {
+    return parallelized_pipeline_ ? codegen_->GetThreadStateMemberPtr(ident) : codegen_->GetStateMemberPtr(ident);
+  }
+
   /**
    * The code generator to use
    */
@@ -186,5 +233,10 @@ class OperatorTranslator : public ExpressionEvaluator {
    * Whether the whole pipeline is produced in parallel mode
    */
   bool parallelized_pipeline_{false};
+
+  /**
+   * The thread state struct of the pipeline, if it is produced in parallel mode
+   */
+  ast::Identifier thread_state_struct_{nullptr};
 };
 }  // namespace terrier::execution::compiler
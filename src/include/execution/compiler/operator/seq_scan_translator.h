@@ -53,6 +53,13 @@ class SeqScanTranslator : public OperatorTranslator {
 
   // This is vectorizable only if the predicate is vectorizable
   bool IsVectorizable() override { return is_vectorizable_; }
+
+  // The table can be split among threads
+  bool IsParallelizable() override { return true; }
+
+  // @iterateTableParallel(execCtx, table_oid, col_oids, state, &tls, worker)
+  void LaunchParallelScan(FunctionBuilder *builder, ast::Identifier tls, ast::Identifier worker) override;
+
   /**
    * Recursively walk down the predicate tree to check if it is vectorizable.
    * @param predicate The predicate to check
@@ -82,6 +89,9 @@ class SeqScanTranslator : public OperatorTranslator {
   // for (@tableIterInit(&tvi, ...); @tableIterAdvance(&tvi);) {...}
   void GenTVILoop(FunctionBuilder *builder);
 
+  // &tvi, or the worker's tvi parameter in parallel pipelines
+  ast::Expr *TVIPtr();
+
   void DeclarePCI(FunctionBuilder *builder);
   void DeclareSlot(FunctionBuilder *builder);
 
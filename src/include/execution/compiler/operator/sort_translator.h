@@ -35,10 +35,25 @@ class SortBottomTranslator : public OperatorTranslator {
   // Call @asorterFree on the Sorter
   void InitializeTeardown(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
 
+  // Add the thread local sorter
+  void InitializeThreadStateFields(util::RegionVector<ast::FieldDecl *> *thread_state_fields) override;
+
+  // Call @sorterInit on the thread local sorter
+  void InitializeThreadState(util::RegionVector<ast::Stmt *> *init_stmts) override;
+
+  // Call @sorterFree on the thread local sorter
+  void TearDownThreadState(util::RegionVector<ast::Stmt *> *teardown_stmts) override;
+
+  // Sort the thread local sorters and merge them into the global one
+  void FinishParallelPipeline(FunctionBuilder *builder, ast::Identifier tls) override;
+
   void Produce(FunctionBuilder *builder) override;
   void Abort(FunctionBuilder *builder) override;
   void Consume(FunctionBuilder *builder) override;
 
+  // Each thread inserts into its own sorter
+  bool IsParallelizable() override { return true; }
+
   ast::Expr *GetChildOutput(uint32_t child_idx, uint32_t attr_idx, terrier::type::TypeId type) override;
   ast::Expr *GetOutput(uint32_t attr_idx) override;
 
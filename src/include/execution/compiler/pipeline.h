@@ -18,8 +18,9 @@ class Pipeline {
   /**
    * Constructor
    * @param codegen the code generator to use
+   * @param parallel_execution whether the pipeline runs in parallel when all of its operators are parallelizable
    */
-  explicit Pipeline(CodeGen *codegen) : codegen_(codegen) {}
+  Pipeline(CodeGen *codegen, bool parallel_execution) : codegen_(codegen), is_parallelizable_(parallel_execution) {}
 
   /**
    * Add an operator translator to the pipeline
@@ -50,17 +51,36 @@ class Pipeline {
 
   /**
    * Produce the code of this pipeline
+   * @param decls list of functions to which the functions generated by this pipeline are appended
    * @param pipeline_idx index of of this pipeline
-   * @return the function generated by this pipeline
    */
-  ast::Decl *Produce(uint32_t pipeline_idx);
+  void Produce(util::RegionVector<ast::Decl *> *decls, uint32_t pipeline_idx);
 
  private:
+  // struct ThreadState {...}
+  void GenThreadStateStruct(util::RegionVector<ast::Decl *> *decls);
+
+  // The functions that initialize and tear down each thread state
+  void GenThreadStateFunctions(util::RegionVector<ast::Decl *> *decls);
+
+  // The function that runs the pipeline over each part of the parallel scan
+  ast::Decl *GenWorker();
+
+  // The pipeline function of a parallel pipeline. It sets up the thread states, starts the parallel scan, and merges
+  // the thread states.
+  void GenParallelPipeline(FunctionBuilder *builder);
+
   CodeGen *codegen_;
   std::vector<std::unique_ptr<OperatorTranslator>> pipeline_{};
   uint32_t pipeline_idx_{0};
   bool is_vectorizable_{true};
-  bool is_parallelizable_{true};
+  bool is_parallelizable_;
+
+  // Structs and functions of a parallel pipeline
+  ast::Identifier thread_state_struct_{nullptr};
+  ast::Identifier init_thread_state_fn_{nullptr};
+  ast::Identifier teardown_thread_state_fn_{nullptr};
+  ast::Identifier worker_fn_{nullptr};
 };
 
 }  // namespace terrier::execution::compiler
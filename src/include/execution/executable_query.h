@@ -37,9 +37,10 @@ class ExecutableQuery {
    * @param physical_plan output from the optimizer
    * @param exec_ctx execution context to use for code generation. Note that this execution context need not be the one
    * used for Run.
+   * @param parallel_execution whether pipelines made only of parallelizable operators run in parallel
    */
   ExecutableQuery(common::ManagedPointer<planner::AbstractPlanNode> physical_plan,
-                  common::ManagedPointer<exec::ExecutionContext> exec_ctx);
+                  common::ManagedPointer<exec::ExecutionContext> exec_ctx, bool parallel_execution = false);
 
   /**
    *
@@ -5,6 +5,7 @@
 #include "catalog/catalog_defs.h"
 #include "execution/exec/execution_context.h"
 #include "execution/sql/projected_columns_iterator.h"
+#include "storage/index/index.h"
 #include "storage/storage_defs.h"
 
 namespace terrier::execution::sql {
@@ -103,7 +104,9 @@ class EXPORT IndexIterator {
   storage::ProjectedRow *index_pr_;
   storage::ProjectedRow *hi_index_pr_;
   storage::ProjectedRow *table_pr_;
+  // Slots of the current batch. Range scans refill it from cursor_, point lookups fill it once.
   std::vector<storage::TupleSlot> tuples_{};
+  std::unique_ptr<storage::index::IndexScanCursor> cursor_;
 };
 
 }  // namespace terrier::execution::sql
@@ -76,19 +76,30 @@ class EXPORT TableVectorIterator {
   /**
    * Perform a parallel scan over the table with ID @em table_oid using the
    * callback function @em scanner on each input vector projection from the
-   * source table. This call is blocking, meaning that it only returns after
-   * the whole table has been scanned. Iteration order is non-deterministic.
-   * @param db_oid The ID of the database containing the table
+   * source table. The table is split into ranges of whole blocks (morsels),
+   * which TBB workers pick up and scan with their own table vector iterator
+   * and their thread's state in @em thread_states. This call is blocking,
+   * meaning that it only returns after the whole table has been scanned.
+   * Iteration order is non-deterministic.
+   * @param exec_ctx The execution context of the query, whose transaction
+   *                 all workers scan with
    * @param table_oid The ID of the table
+   * @param col_oids The IDs of the columns to scan
+   * @param num_oids The number of columns to scan
    * @param query_state the query state
    * @param thread_states the thread state container
    * @param scan_fn The callback function invoked for vectors of table input
    * @param min_grain_size The minimum number of blocks to give a scan task
+   * @return True if the scan was performed; false if the table does not exist
    */
-  static bool ParallelScan(uint32_t db_oid, uint32_t table_oid, void *query_state, ThreadStateContainer *thread_states,
-                           ScanFn scan_fn, uint32_t min_grain_size = K_MIN_BLOCK_RANGE_SIZE);
+  static bool ParallelScan(exec::ExecutionContext *exec_ctx, uint32_t table_oid, uint32_t *col_oids,
+                           uint32_t num_oids, void *query_state, ThreadStateContainer *thread_states, ScanFn scan_fn,
+                           uint32_t min_grain_size = K_MIN_BLOCK_RANGE_SIZE);
 
  private:
+  // Initialize the projected columns for the given table
+  void InitProjection(common::ManagedPointer<storage::SqlTable> table);
+
   exec::ExecutionContext *exec_ctx_;
   const catalog::table_oid_t table_oid_;
   std::vector<catalog::col_oid_t> col_oids_{};
@@ -101,6 +112,9 @@ class EXPORT TableVectorIterator {
   storage::ProjectedColumns *projected_columns_ = nullptr;
   // Iterator of the slots in the PC
   std::unique_ptr<storage::DataTable::SlotIterator> iter_ = nullptr;
+  // Bounds of the scanned range, or nullptr to scan the whole table
+  std::unique_ptr<storage::DataTable::SlotIterator> begin_ = nullptr;
+  std::unique_ptr<storage::DataTable::SlotIterator> end_ = nullptr;
 
   bool initialized_ = false;
 };
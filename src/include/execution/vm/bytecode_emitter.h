@@ -321,9 +321,16 @@ class BytecodeEmitter {
 
   /**
    * Emit a parallel table scan
+   * @param exec_ctx execution context
+   * @param table_oid oid of the sql table
+   * @param col_oids array of oids
+   * @param num_oids length of the array
+   * @param query_state the query state
+   * @param thread_states the thread state container
+   * @param scan_fn function scanning a range of the table
    */
-  void EmitParallelTableScan(uint32_t db_oid, uint32_t table_oid, LocalVar ctx, LocalVar thread_states,
-                             FunctionId scan_fn);
+  void EmitParallelTableScan(LocalVar exec_ctx, uint32_t table_oid, LocalVar col_oids, uint32_t num_oids,
+                             LocalVar query_state, LocalVar thread_states, FunctionId scan_fn);
 
   // Reading integer values from an iterator
   /**
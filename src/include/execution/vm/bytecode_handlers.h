@@ -237,10 +237,12 @@ VM_OP_HOT void OpTableVectorIteratorGetPCI(terrier::execution::sql::ProjectedCol
   *pci = iter->GetProjectedColumnsIterator();
 }
 
-VM_OP_HOT void OpParallelScanTable(const uint32_t db_oid, const uint32_t table_oid, void *const query_state,
+VM_OP_HOT void OpParallelScanTable(terrier::execution::exec::ExecutionContext *const exec_ctx, const uint32_t table_oid,
+                                   uint32_t *const col_oids, const uint32_t num_oids, void *const query_state,
                                    terrier::execution::sql::ThreadStateContainer *const thread_states,
                                    const terrier::execution::sql::TableVectorIterator::ScanFn scanner) {
-  terrier::execution::sql::TableVectorIterator::ParallelScan(db_oid, table_oid, query_state, thread_states, scanner);
+  terrier::execution::sql::TableVectorIterator::ParallelScan(exec_ctx, table_oid, col_oids, num_oids, query_state,
+                                                             thread_states, scanner);
 }
 
 // ---------------------------------------------------------
@@ -115,8 +115,8 @@ namespace terrier::execution::vm {
   F(TableVectorIteratorReset, OperandType::Local)                                                                     \
   F(TableVectorIteratorFree, OperandType::Local)                                                                      \
   F(TableVectorIteratorGetPCI, OperandType::Local, OperandType::Local)                                                \
-  F(ParallelScanTable, OperandType::UImm4, OperandType::UImm4, OperandType::Local, OperandType::Local,                \
-    OperandType::FunctionId)                                                                                          \
+  F(ParallelScanTable, OperandType::Local, OperandType::UImm4, OperandType::Local, OperandType::UImm4,                \
+    OperandType::Local, OperandType::Local, OperandType::FunctionId)                                                  \
                                                                                                                       \
   /* ProjectedColumns Iterator (PCI) */                                                                               \
   F(PCIIsFiltered, OperandType::Local, OperandType::Local)                                                            \
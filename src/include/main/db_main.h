@@ -17,6 +17,9 @@
 #include "settings/settings_manager.h"
 #include "settings/settings_param.h"
 #include "storage/garbage_collector_thread.h"
+#include "storage/recovery/checkpoint_manager.h"
+#include "storage/recovery/disk_log_provider.h"
+#include "storage/recovery/recovery_manager.h"
 #include "transaction/deferred_action_manager.h"
 #include "transaction/transaction_manager.h"
 
@@ -120,15 +123,16 @@ class DBMain {
      * @param block_store_reuse_limit argument to the BlockStore
      * @param use_gc enable GarbageCollector
      * @param log_manager needed for safe destruction of StorageLayer
+     * @param num_gc_workers argument to the GarbageCollector
      */
     StorageLayer(const common::ManagedPointer<TransactionLayer> txn_layer, const uint64_t block_store_size_limit,
                  const uint64_t block_store_reuse_limit, const bool use_gc,
-                 const common::ManagedPointer<storage::LogManager> log_manager)
+                 const common::ManagedPointer<storage::LogManager> log_manager, const uint32_t num_gc_workers = 1)
         : deferred_action_manager_(txn_layer->GetDeferredActionManager()), log_manager_(log_manager) {
       if (use_gc)
-        garbage_collector_ = std::make_unique<storage::GarbageCollector>(txn_layer->GetTimestampManager(),
-                                                                         txn_layer->GetDeferredActionManager(),
-                                                                         txn_layer->GetTransactionManager(), DISABLED);
+        garbage_collector_ = std::make_unique<storage::GarbageCollector>(
+            txn_layer->GetTimestampManager(), txn_layer->GetDeferredActionManager(),
+            txn_layer->GetTransactionManager(), DISABLED, num_gc_workers);
 
       block_store_ = std::make_unique<storage::BlockStore>(block_store_size_limit, block_store_reuse_limit);
     }
@@ -298,12 +302,19 @@ class DBMain {
       auto buffer_segment_pool =
           std::make_unique<storage::RecordBufferSegmentPool>(record_buffer_segment_size_, record_buffer_segment_reuse_);
 
+      if (use_recovery_) {
+        TERRIER_ASSERT(use_logging_ && use_catalog_, "Recovery needs logging and the Catalog.");
+        // The new log starts out empty, recovery logs the recovered state in it
+        storage::RecoveryManager::SetAside(log_file_path_, checkpoint_file_path_);
+      }
+
       std::unique_ptr<storage::LogManager> log_manager = DISABLED;
       if (use_logging_) {
         log_manager = std::make_unique<storage::LogManager>(
             log_file_path_, num_log_manager_buffers_, std::chrono::microseconds{log_serialization_interval_},
             std::chrono::milliseconds{log_persist_interval_}, log_persist_threshold_,
-            common::ManagedPointer(buffer_segment_pool), common::ManagedPointer(thread_registry));
+            common::ManagedPointer(buffer_segment_pool), common::ManagedPointer(thread_registry), log_segment_size_,
+            log_adaptive_persist_, num_log_serializers_, log_io_uring_, log_compression_);
         log_manager->Start();
       }
 
@@ -312,14 +323,15 @@ class DBMain {
 
       auto storage_layer =
           std::make_unique<StorageLayer>(common::ManagedPointer(txn_layer), block_store_size_, block_store_reuse_,
-                                         use_gc_, common::ManagedPointer(log_manager));
+                                         use_gc_, common::ManagedPointer(log_manager), num_gc_workers_);
 
       std::unique_ptr<CatalogLayer> catalog_layer = DISABLED;
       if (use_catalog_) {
         TERRIER_ASSERT(use_gc_ && storage_layer->GetGarbageCollector() != DISABLED, "Catalog needs GarbageCollector.");
         catalog_layer =
             std::make_unique<CatalogLayer>(common::ManagedPointer(txn_layer), common::ManagedPointer(storage_layer),
-                                           common::ManagedPointer(log_manager), create_default_database_);
+                                           common::ManagedPointer(log_manager),
+                                           create_default_database_ && !use_recovery_);
       }
 
       std::unique_ptr<storage::GarbageCollectorThread> gc_thread = DISABLED;
@@ -327,8 +339,24 @@ class DBMain {
         TERRIER_ASSERT(use_gc_ && storage_layer->GetGarbageCollector() != DISABLED,
                        "GarbageCollectorThread needs GarbageCollector.");
         gc_thread = std::make_unique<storage::GarbageCollectorThread>(storage_layer->GetGarbageCollector(),
-                                                                      std::chrono::milliseconds{gc_interval_});
+                                                                      std::chrono::milliseconds{gc_interval_},
+                                                                      common::ManagedPointer(metrics_manager));
+      }
+
+      std::unique_ptr<storage::CheckpointManager> checkpoint_manager = DISABLED;
+      if (use_checkpoints_) {
+        TERRIER_ASSERT(use_recovery_, "Checkpoints are only of use to recovery.");
+        checkpoint_manager = std::make_unique<storage::CheckpointManager>(
+            checkpoint_file_path_, catalog_layer->GetCatalog(), txn_layer->GetTransactionManager(),
+            common::ManagedPointer(thread_registry));
+      }
+
+      if (use_recovery_) {
+        Recover(common::ManagedPointer(thread_registry), common::ManagedPointer(log_manager),
+                common::ManagedPointer(txn_layer), common::ManagedPointer(storage_layer),
+                common::ManagedPointer(catalog_layer), common::ManagedPointer(checkpoint_manager));
       }
+      if (use_checkpoints_) checkpoint_manager->StartCheckpointing(std::chrono::seconds{checkpoint_interval_});
 
       std::unique_ptr<optimizer::StatsStorage> stats_storage = DISABLED;
       if (use_stats_storage_) {
@@ -348,7 +376,7 @@ class DBMain {
         TERRIER_ASSERT(use_execution_ && execution_layer != DISABLED, "TrafficCopLayer needs ExecutionLayer.");
         traffic_cop = std::make_unique<trafficcop::TrafficCop>(
             txn_layer->GetTransactionManager(), catalog_layer->GetCatalog(), DISABLED,
-            common::ManagedPointer(stats_storage), optimizer_timeout_);
+            common::ManagedPointer(stats_storage), optimizer_timeout_, parallel_execution_);
       }
 
       std::unique_ptr<NetworkLayer> network_layer = DISABLED;
@@ -368,6 +396,7 @@ class DBMain {
       db_main->storage_layer_ = std::move(storage_layer);
       db_main->catalog_layer_ = std::move(catalog_layer);
       db_main->gc_thread_ = std::move(gc_thread);
+      db_main->checkpoint_manager_ = std::move(checkpoint_manager);
       db_main->stats_storage_ = std::move(stats_storage);
       db_main->execution_layer_ = std::move(execution_layer);
       db_main->traffic_cop_ = std::move(traffic_cop);
@@ -475,6 +504,87 @@ class DBMain {
       return *this;
     }
 
+    /**
+     * @param value LogManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetNumLogSerializers(const uint32_t value) {
+      num_log_serializers_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value LogManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetLogSegmentSize(const uint64_t value) {
+      log_segment_size_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value LogManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetLogAdaptivePersist(const bool value) {
+      log_adaptive_persist_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value LogManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetLogIoUring(const bool value) {
+      log_io_uring_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value LogManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetLogCompression(const bool value) {
+      log_compression_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value recover the previous run's checkpoint and log on Build()
+     * @return self reference for chaining
+     */
+    Builder &SetUseRecovery(const bool value) {
+      use_recovery_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value use component
+     * @return self reference for chaining
+     */
+    Builder &SetUseCheckpoints(const bool value) {
+      use_checkpoints_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value CheckpointManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetCheckpointFilePath(const std::string &value) {
+      checkpoint_file_path_ = value;
+      return *this;
+    }
+
+    /**
+     * @param value CheckpointManager argument
+     * @return self reference for chaining
+     */
+    Builder &SetCheckpointInterval(const uint64_t value) {
+      checkpoint_interval_ = value;
+      return *this;
+    }
+
     /**
      * @param value use component
      * @return self reference for chaining
@@ -484,6 +594,15 @@ class DBMain {
       return *this;
     }
 
+    /**
+     * @param value GarbageCollector argument
+     * @return self reference for chaining
+     */
+    Builder &SetNumGCWorkers(const uint32_t value) {
+      num_gc_workers_ = value;
+      return *this;
+    }
+
     /**
      * @param value use component
      * @return self reference for chaining
@@ -583,6 +702,15 @@ class DBMain {
       return *this;
     }
 
+    /**
+     * @param value TrafficCop argument
+     * @return self reference for chaining
+     */
+    Builder &SetParallelExecution(const bool value) {
+      parallel_execution_ = value;
+      return *this;
+    }
+
     /**
      * @param value use component
      * @return self reference for chaining
@@ -610,18 +738,29 @@ class DBMain {
     int32_t log_serialization_interval_ = 10;
     int32_t log_persist_interval_ = 10;
     uint64_t log_persist_threshold_ = static_cast<uint64_t>(1 << 20);
+    uint32_t num_log_serializers_ = 1;
+    uint64_t log_segment_size_ = 0;
+    bool log_adaptive_persist_ = true;
+    bool log_io_uring_ = false;
+    bool log_compression_ = false;
     bool use_logging_ = false;
+    bool use_recovery_ = false;
+    std::string checkpoint_file_path_ = "checkpoint.db";
+    int32_t checkpoint_interval_ = 60;
+    bool use_checkpoints_ = false;
     bool use_gc_ = false;
     bool use_catalog_ = false;
     bool create_default_database_ = true;
     uint64_t block_store_size_ = 1e5;
     uint64_t block_store_reuse_ = 1e3;
     int32_t gc_interval_ = 10;
+    uint32_t num_gc_workers_ = 1;
     bool use_gc_thread_ = false;
     bool use_stats_storage_ = false;
     bool use_execution_ = false;
     bool use_traffic_cop_ = false;
     uint64_t optimizer_timeout_ = 5000;
+    bool parallel_execution_ = true;
     uint16_t network_port_ = 15721;
     bool use_network_ = false;
 
@@ -648,14 +787,60 @@ class DBMain {
       log_persist_interval_ = settings_manager->GetInt(settings::Param::log_persist_interval);
       log_persist_threshold_ =
           static_cast<uint64_t>(settings_manager->GetInt64(settings::Param::log_persist_threshold));
+      num_log_serializers_ = static_cast<uint32_t>(settings_manager->GetInt(settings::Param::num_log_serializers));
+      log_segment_size_ = static_cast<uint64_t>(settings_manager->GetInt64(settings::Param::log_segment_size));
+      log_adaptive_persist_ = settings_manager->GetBool(settings::Param::log_adaptive_persist);
+      log_io_uring_ = settings_manager->GetBool(settings::Param::log_io_uring);
+      log_compression_ = settings_manager->GetBool(settings::Param::log_compression);
+
+      checkpoint_file_path_ = settings_manager->GetString(settings::Param::checkpoint_file_path);
+      checkpoint_interval_ = settings_manager->GetInt(settings::Param::checkpoint_interval);
 
       gc_interval_ = settings_manager->GetInt(settings::Param::gc_interval);
+      num_gc_workers_ = static_cast<uint32_t>(settings_manager->GetInt(settings::Param::num_gc_workers));
 
       network_port_ = static_cast<uint16_t>(settings_manager->GetInt(settings::Param::port));
       optimizer_timeout_ = static_cast<uint64_t>(settings_manager->GetInt(settings::Param::task_execution_timeout));
+      parallel_execution_ = settings_manager->GetBool(settings::Param::parallel_execution);
 
       return settings_manager;
     }
+
+    /**
+     * Recovers the checkpoint and log that were set aside before the log manager started. Recovery logs the recovered
+     * changes, so once they are persisted, the new log takes the place of what was set aside. With checkpoints, one is
+     * taken of the recovered state right away, which drops the log segments recovery wrote.
+     */
+    void Recover(const common::ManagedPointer<common::DedicatedThreadRegistry> thread_registry,
+                 const common::ManagedPointer<storage::LogManager> log_manager,
+                 const common::ManagedPointer<TransactionLayer> txn_layer,
+                 const common::ManagedPointer<StorageLayer> storage_layer,
+                 const common::ManagedPointer<CatalogLayer> catalog_layer,
+                 const common::ManagedPointer<storage::CheckpointManager> checkpoint_manager) {
+      const auto txn_manager = txn_layer->GetTransactionManager();
+      const auto catalog = catalog_layer->GetCatalog();
+      storage::DiskLogProvider log_provider(log_file_path_ + storage::RecoveryManager::SET_ASIDE_SUFFIX);
+      storage::RecoveryManager recovery_manager(
+          common::ManagedPointer<storage::AbstractLogProvider>(&log_provider), catalog, txn_manager,
+          txn_layer->GetDeferredActionManager(), thread_registry, storage_layer->GetBlockStore(),
+          checkpoint_file_path_ + storage::RecoveryManager::SET_ASIDE_SUFFIX);
+      recovery_manager.StartRecovery();
+      recovery_manager.WaitForRecoveryToFinish();
+
+      // The default database is only bootstrapped on the very first start, later ones recover it
+      if (create_default_database_) {
+        auto *txn = txn_manager->BeginTransaction();
+        if (catalog->GetDatabaseOid(common::ManagedPointer(txn), catalog::DEFAULT_DATABASE) ==
+            catalog::INVALID_DATABASE_OID) {
+          catalog->CreateDatabase(common::ManagedPointer(txn), catalog::DEFAULT_DATABASE, true);
+        }
+        txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+      }
+
+      log_manager->ForceFlush();
+      storage::RecoveryManager::RemoveSetAside(log_file_path_, checkpoint_file_path_);
+      if (checkpoint_manager != DISABLED) checkpoint_manager->Checkpoint();
+    }
   };
 
   /**
@@ -720,6 +905,13 @@ class DBMain {
     return common::ManagedPointer(gc_thread_);
   }
 
+  /**
+   * @return ManagedPointer to the component, can be nullptr if disabled
+   */
+  common::ManagedPointer<storage::CheckpointManager> GetCheckpointManager() const {
+    return common::ManagedPointer(checkpoint_manager_);
+  }
+
   /**
    * @return ManagedPointer to the component, can be nullptr if disabled
    */
@@ -755,6 +947,7 @@ class DBMain {
   std::unique_ptr<CatalogLayer> catalog_layer_;
   std::unique_ptr<storage::GarbageCollectorThread>
       gc_thread_;  // thread needs to die before manual invocations of GC in CatalogLayer and others
+  std::unique_ptr<storage::CheckpointManager> checkpoint_manager_;  // reads the catalog, so it stops before teardown
   std::unique_ptr<optimizer::StatsStorage> stats_storage_;
   std::unique_ptr<ExecutionLayer> execution_layer_;
   std::unique_ptr<trafficcop::TrafficCop> traffic_cop_;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -42,6 +43,8 @@ class ConnectionContext {
     accessor_ = nullptr;
     callback_ = nullptr;
     callback_arg_ = nullptr;
+    pending_commits_ = nullptr;
+    commit_pending_ = false;
   }
 
   /**
@@ -147,25 +150,46 @@ class ConnectionContext {
   /**
    * @param callback static method for callback in ConnectionHandle
    * @param callback_arg this from ConnectionHandle constructor
-   * @warning only to be used by ConnectionHandle's constructor
+   * @param pending_commits counter of the commits whose callback has yet to run, kept by the ConnectionHandlerTask
+   * @warning only to be used by ConnectionHandle's constructor and the ConnectionHandleFactory
    */
-  void SetCallback(const network::NetworkCallback callback, void *const callback_arg) {
+  void SetCallback(const network::NetworkCallback callback, void *const callback_arg,
+                   const common::ManagedPointer<std::atomic<uint32_t>> pending_commits) {
     callback_ = callback;
     callback_arg_ = callback_arg;
+    pending_commits_ = pending_commits;
   }
 
   /**
    * @return handle to the ConnectionHandle callback to issue a libevent wakeup in the event of WAIT_ON_TERRIER
-   * state. Currently not used, but may in the future for asynchronous execution.
+   * state, or nullptr if this ConnectionContext does not belong to a ConnectionHandle. Used to commit asynchronously.
    */
   network::NetworkCallback Callback() const { return callback_; }
 
   /**
    * @return args to the ConnectionHandle callback to issue a libevent wakeup in the event of WAIT_ON_TERRIER
-   * state. Currently not used, but may in the future for asynchronous execution.
+   * state. Used to commit asynchronously.
    */
   void *CallbackArg() const { return callback_arg_; }
 
+  /**
+   * @return counter of the commits whose callback has yet to run. It is incremented before a commit is issued with the
+   * callback, and decremented by the callback.
+   */
+  common::ManagedPointer<std::atomic<uint32_t>> PendingCommits() const { return pending_commits_; }
+
+  /**
+   * @return whether a commit was issued that the callback will signal the durability of, so that the response to the
+   * client must be held back until then
+   */
+  bool CommitPending() const { return commit_pending_; }
+
+  /**
+   * @param commit_pending new value
+   * @warning this should only be used by TrafficCop::EndTransaction and the ProtocolInterpreter
+   */
+  void SetCommitPending(const bool commit_pending) { commit_pending_ = commit_pending; }
+
  private:
   /**
    * This is a unique identifier (among currently open connections, not over the lifetime of the system) for this
@@ -208,11 +232,17 @@ class ConnectionContext {
   std::unique_ptr<catalog::CatalogAccessor> accessor_ = nullptr;
 
   /**
-   * ConnectionHandle callback stuff to issue a libevent wakeup in the event of WAIT_ON_TERRIER state. Currently
-   * not used, but may in the future for asynchronous execution.
+   * ConnectionHandle callback stuff to issue a libevent wakeup in the event of WAIT_ON_TERRIER state. Used as the
+   * commit callback, so that the thread of the ConnectionHandle does not block while a commit becomes durable.
+   */
+  network::NetworkCallback callback_ = nullptr;
+  void *callback_arg_ = nullptr;
+  common::ManagedPointer<std::atomic<uint32_t>> pending_commits_ = nullptr;
+
+  /**
+   * Whether a commit is waiting to become durable, see CommitPending
    */
-  network::NetworkCallback callback_;
-  void *callback_arg_;
+  bool commit_pending_ = false;
 };
 
 }  // namespace terrier::network
@@ -55,7 +55,7 @@ class ConnectionHandle {
         conn_handler_(handler),
         traffic_cop_(tcop),
         protocol_interpreter_(std::move(interpreter)) {
-    context_.SetCallback(Callback, this);
+    context_.SetCallback(Callback, this, handler->PendingCommits());
     context_.SetConnectionID(static_cast<connection_id_t>(sock_fd));
   }
 
@@ -118,9 +118,8 @@ class ConnectionHandle {
    * @return The transition to trigger in the state machine after
    */
   Transition Process() {
-    auto transition = protocol_interpreter_->Process(io_wrapper_->GetReadBuffer(), io_wrapper_->GetWriteQueue(),
-                                                     traffic_cop_, common::ManagedPointer(&context_));
-    return transition;
+    return protocol_interpreter_->Process(io_wrapper_->GetReadBuffer(), io_wrapper_->GetWriteQueue(), traffic_cop_,
+                                          common::ManagedPointer(&context_));
   }
 
   /**
@@ -165,14 +164,18 @@ class ConnectionHandle {
   void StopReceivingNetworkEvent() { EventUtil::EventDel(network_event_); }
 
   /**
-   * issues a libevent to wake up the state machine in the WAIT_ON_TERRIER state
+   * issues a libevent to wake up the state machine in the WAIT_ON_TERRIER state. This is the commit callback of the
+   * connection's txns, so that the state machine waits for commits to become durable without blocking the thread.
    * @param callback_args this for a ConnectionHandle in WAIT_ON_TERRIER state
    */
   static void Callback(void *callback_args) {
     auto *const handle = reinterpret_cast<ConnectionHandle *>(callback_args);
     TERRIER_ASSERT(handle->state_machine_.CurrentState() == ConnState::PROCESS,
                    "Should be waking up a ConnectionHandle that's in PROCESS state waiting on query result.");
+    const common::ManagedPointer<std::atomic<uint32_t>> pending_commits = handle->context_.PendingCommits();
     event_active(handle->workpool_event_, EV_WRITE, 0);
+    // The handle may already be served again, and the handler may free the event once it is told
+    pending_commits->fetch_sub(1);
   }
 
  private:
@@ -44,6 +44,11 @@ class ConnectionHandleFactory {
   ConnectionHandle &NewConnectionHandle(int conn_fd, std::unique_ptr<ProtocolInterpreter> interpreter,
                                         common::ManagedPointer<ConnectionHandlerTask> handler);
 
+  /**
+   * @return the traffic cop of the connections
+   */
+  common::ManagedPointer<trafficcop::TrafficCop> GetTrafficCop() const { return traffic_cop_; }
+
  private:
   /**
    * latch needed to protect multiple threads accessing reusable_handles_
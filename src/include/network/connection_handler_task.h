@@ -5,6 +5,7 @@
 #include <event2/event.h>
 #include <event2/listener.h>
 #include <unistd.h>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <utility>
@@ -34,6 +35,18 @@ class ConnectionHandlerTask : public common::NotifiableTask {
    */
   ConnectionHandlerTask(int task_id, common::ManagedPointer<ConnectionHandleFactory> connection_handle_factory);
 
+  /**
+   * Destroys this ConnectionHandlerTask once the commit callbacks of its connections have run. The callbacks come from
+   * the log manager's threads and wake up events of this task, which are freed with it, so the log is persisted if any
+   * of them are still pending.
+   */
+  ~ConnectionHandlerTask() override;
+
+  /**
+   * @return counter of the commits of this handler's connections whose callback has yet to run
+   */
+  common::ManagedPointer<std::atomic<uint32_t>> PendingCommits() { return common::ManagedPointer(&pending_commits_); }
+
   /**
    * @brief Notifies this ConnectionHandlerTask that a new client connection
    * should be handled at socket fd.
@@ -71,6 +84,8 @@ class ConnectionHandlerTask : public common::NotifiableTask {
   std::deque<std::pair<int, std::unique_ptr<ProtocolInterpreter>>> jobs_;
   event *notify_event_;
   common::ManagedPointer<ConnectionHandleFactory> connection_handle_factory_;
+  // Commit callbacks that have yet to wake up their connections
+  std::atomic<uint32_t> pending_commits_ = 0;
 };
 
 }  // namespace terrier::network
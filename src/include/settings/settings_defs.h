@@ -66,6 +66,17 @@ SETTING_int(
     terrier::settings::Callbacks::NoOp
 )
 
+// Number of garbage collector worker threads
+SETTING_int(
+    num_gc_workers,
+    "The number of threads the garbage collector hands its work to, partitioned by table (default: 1)",
+    1,
+    1,
+    64,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
 // Path to log file for WAL
 SETTING_string(
     log_file_path,
@@ -134,6 +145,73 @@ SETTING_int64(
     terrier::settings::Callbacks::NoOp
 )
 
+// Number of log serializers
+SETTING_int(
+    num_log_serializers,
+    "The number of threads serializing logs, each into its own log stream (default: 1)",
+    1,
+    1,
+    64,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+// Log segment size
+SETTING_int64(
+    log_segment_size,
+    "Size of a log segment file (bytes), or 0 to write the log to a single file (default: 0)",
+    0,
+    0,
+    (1LL << 34) /* 16GB */,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+// Adaptive log persisting
+SETTING_bool(
+    log_adaptive_persist,
+    "Tune the log persist interval and threshold to the commit rate, bounded by their settings (default: true)",
+    true,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+SETTING_bool(
+    log_io_uring,
+    "Write the log through io_uring, falling back to posix calls where unavailable (default: false)",
+    false,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+SETTING_bool(
+    log_compression,
+    "Compress the log, frames that do not get smaller are written as they are (default: false)",
+    false,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+// Path to checkpoint file
+SETTING_string(
+    checkpoint_file_path,
+    "The path to the checkpoint file (default: checkpoint.db)",
+    "checkpoint.db",
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
+// Checkpoint interval
+SETTING_int(
+    checkpoint_interval,
+    "Time between the start of two checkpoints (s) (default: 60)",
+    60,
+    1,
+    86400,
+    false,
+    terrier::settings::Callbacks::NoOp
+)
+
 SETTING_bool(
     metrics_logging,
     "Metrics collection for the Logging component.",
@@ -149,3 +227,11 @@ SETTING_bool(
     true,
     terrier::settings::Callbacks::MetricsTransaction
 )
+
+SETTING_bool(
+    metrics_gc,
+    "Metrics collection for the GarbageCollector component.",
+    false,
+    true,
+    terrier::settings::Callbacks::MetricsGC
+)
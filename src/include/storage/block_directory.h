@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+#include "storage/storage_defs.h"
+
+namespace terrier::storage {
+
+/**
+ * An append-only array of the blocks of a DataTable. Readers look up blocks by index without any synchronization
+ * besides reading Size(), so sequential scans never wait on the list of blocks.
+ *
+ * The blocks are stored in segments of doubling size that are never moved once allocated, so a block's entry stays
+ * valid for the lifetime of the directory. Appenders reserve an index, store their block in it, and then publish it by
+ * advancing Size() in index order, so every index below Size() is always populated. Appends are therefore blocking:
+ * an appender waits for every appender that reserved an earlier index to publish first.
+ */
+class BlockDirectory {
+ public:
+  BlockDirectory() = default;
+
+  /**
+   * Frees the segments of the directory. The blocks themselves are owned by the DataTable.
+   */
+  ~BlockDirectory() {
+    for (auto &segment : segments_) delete[] segment.load();
+  }
+
+  DISALLOW_COPY_AND_MOVE(BlockDirectory)
+
+  /**
+   * Appends a block to the end of the directory. Blocks until every earlier append has been published, so if an earlier
+   * appender is descheduled between its reservation and its publication, this waits until it runs again. Appends are
+   * rare, as they only happen when every block of the table is full.
+   * @param block the block to append
+   * @return index of the block in the directory
+   */
+  uint64_t Append(RawBlock *const block) {
+    const uint64_t index = reserved_.fetch_add(1);
+    uint32_t segment;
+    uint64_t offset;
+    Locate(index, &segment, &offset);
+    std::atomic<RawBlock *> *entries = segments_[segment].load();
+    if (entries == nullptr) {
+      // Whoever first reserves an index in the segment allocates it, but others might race to do so as well
+      auto *const allocated = new std::atomic<RawBlock *>[SegmentSize(segment)]();
+      if (segments_[segment].compare_exchange_strong(entries, allocated)) {
+        entries = allocated;
+      } else {
+        delete[] allocated;
+      }
+    }
+    entries[offset].store(block);
+    // Publish in index order, yielding so that earlier appenders that got descheduled can get to this point
+    uint64_t expected = index;
+    while (!size_.compare_exchange_weak(expected, index + 1)) {
+      expected = index;
+      std::this_thread::yield();
+    }
+    return index;
+  }
+
+  /**
+   * @return number of blocks in the directory. Every index below it refers to a block.
+   */
+  uint64_t Size() const { return size_.load(); }
+
+  /**
+   * @param index index of the block, must be less than Size()
+   * @return the block at the given index
+   */
+  RawBlock *At(const uint64_t index) const {
+    TERRIER_ASSERT(index < Size(), "Block index out of bounds.");
+    uint32_t segment;
+    uint64_t offset;
+    Locate(index, &segment, &offset);
+    return segments_[segment].load()[offset].load();
+  }
+
+ private:
+  // Segment i holds FIRST_SEGMENT_SIZE << i blocks, which is more than enough segments to hold any table
+  static constexpr uint64_t FIRST_SEGMENT_SIZE = 64;
+  static constexpr uint32_t NUM_SEGMENTS = 40;
+
+  static uint64_t SegmentSize(const uint32_t segment) { return FIRST_SEGMENT_SIZE << segment; }
+
+  static void Locate(const uint64_t index, uint32_t *const segment, uint64_t *const offset) {
+    // Segment i starts at index FIRST_SEGMENT_SIZE * (2^i - 1)
+    *segment = static_cast<uint32_t>(63 - __builtin_clzll(index / FIRST_SEGMENT_SIZE + 1));
+    *offset = index - FIRST_SEGMENT_SIZE * ((uint64_t{1} << *segment) - 1);
+    TERRIER_ASSERT(*segment < NUM_SEGMENTS, "Block directory is full.");
+  }
+
+  std::atomic<uint64_t> reserved_{0};
+  std::atomic<uint64_t> size_{0};
+  std::array<std::atomic<std::atomic<RawBlock *> *>, NUM_SEGMENTS> segments_{};
+};
+
+}  // namespace terrier::storage
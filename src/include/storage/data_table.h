@@ -1,10 +1,12 @@
 #pragma once
-#include <list>
+#include <array>
+#include <atomic>
 #include <unordered_map>
 #include <vector>
 
 #include "common/managed_pointer.h"
 #include "common/performance_counter.h"
+#include "storage/block_directory.h"
 #include "storage/projected_columns.h"
 #include "storage/storage_defs.h"
 #include "storage/tuple_access_strategy.h"
@@ -95,18 +97,20 @@ class DataTable {
 
    private:
     friend class DataTable;
-    /**
-     * @warning MUST BE CALLED ONLY WHEN CALLER HOLDS LOCK TO THE LIST OF RAW BLOCKS IN THE DATA TABLE
-     */
-    SlotIterator(const DataTable *table, std::list<RawBlock *>::const_iterator block, uint32_t offset_in_block)
-        : table_(table), block_(block) {
-      current_slot_ = {block == table->blocks_.end() ? nullptr : *block, offset_in_block};
+    SlotIterator(const DataTable *table, uint64_t block_index, uint32_t offset_in_block)
+        : table_(table), block_index_(block_index) {
+      current_slot_ = {block_index < table->blocks_.Size() ? table->blocks_.At(block_index) : nullptr,
+                       offset_in_block};
     }
 
+    // Moves the iterator to the given offset within the current block, or to the first slot of the next block if the
+    // offset is one past the last slot of the current block.
+    void AdvanceTo(uint32_t offset);
+
     // TODO(Tianyu): Can potentially collapse this information into the RawBlock so we don't have to hold a pointer to
     // the table anymore. Right now we need the table to know how many slots there are in the block
     const DataTable *table_;
-    std::list<RawBlock *>::const_iterator block_;
+    uint64_t block_index_;
     TupleSlot current_slot_;
   };
   /**
@@ -154,14 +158,28 @@ class DataTable {
    *                   always cleared of old values.
    */
   void Scan(common::ManagedPointer<transaction::TransactionContext> txn, SlotIterator *start_pos,
-            ProjectedColumns *out_buffer) const;
+            ProjectedColumns *out_buffer) const {
+    Scan(txn, start_pos, end(), out_buffer);
+  }
+
+  /**
+   * Sequentially scans the table like Scan, but stops at the given end position instead of the end of the table, so
+   * that a range of the table can be scanned independently of the rest (e.g. by one of the workers of a parallel scan).
+   *
+   * @param txn the calling transaction
+   * @param start_pos iterator to the starting location for the sequential scan
+   * @param end_pos iterator to one past the last slot to scan
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void Scan(common::ManagedPointer<transaction::TransactionContext> txn, SlotIterator *start_pos,
+            const SlotIterator &end_pos, ProjectedColumns *out_buffer) const;
 
   /**
    * @return the first tuple slot contained in the data table
    */
   SlotIterator begin() const {  // NOLINT for STL name compability
-    common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
-    return {this, blocks_.begin(), 0};
+    return {this, 0, 0};
   }
 
   /**
@@ -173,6 +191,13 @@ class DataTable {
    */
   SlotIterator end() const;  // NOLINT for STL name compability
 
+  /**
+   * Splits the table at its block boundaries, so that it can be scanned in parallel ranges of whole blocks. Blocks are
+   * only ever appended to the table, so the ranges between consecutive iterators stay valid as the table grows.
+   * @return iterators to the first slot of every block in the table, followed by end()
+   */
+  std::vector<SlotIterator> BlockBoundaries() const;
+
   /**
    * Update the tuple according to the redo buffer given, and update the version chain to link to an
    * undo record that is allocated in the txn. The undo record is populated with a before-image of the tuple in the
@@ -208,6 +233,18 @@ class DataTable {
    */
   bool Delete(common::ManagedPointer<transaction::TransactionContext> txn, TupleSlot slot);
 
+  /**
+   * Number of insertion heads per table. Inserting threads are spread over them, and each remembers the block its
+   * threads last inserted into.
+   */
+  static constexpr uint32_t NUM_INSERTION_HEADS = 32;
+
+  /**
+   * Number of versions below its own that Update looks at for one that can be pruned, before it leaves the version
+   * chain to the GC
+   */
+  static constexpr uint32_t MAX_PRUNE_DEPTH = 8;
+
   /**
    * Return a pointer to the performance counter for the data table.
    * @return pointer to the performance counter
@@ -243,20 +280,17 @@ class DataTable {
   // TODO(Tianyu): For now, on insertion, we simply sequentially go through a block and allocate a
   // new one when the current one is full. Needless to say, we will need to revisit this when extending GC to handle
   // deleted tuples and recycle slots
-  // TODO(Tianyu): Now that we are switching to a linked list, there probably isn't a reason for it
-  // to be latched. Could just easily write a lock-free one if there's performance gain(probably not). vector->list has
-  // negligible difference in insert performance (within margin of error) when benchmarked.
-  // We also might need our own implementation because we need to handle GC of an unlinked block, as a sequential scan
-  // might be on it
-  std::list<RawBlock *> blocks_;
-  // latch used to protect block list
-  mutable common::SpinLatch blocks_latch_;
-  // latch used to protect insertion_head_
-  mutable common::SpinLatch header_latch_;
-  std::list<RawBlock *>::iterator insertion_head_;
-  // Check if we need to advance the insertion_head_
-  // This function uses header_latch_ to ensure correctness
-  void CheckMoveHead(std::list<RawBlock *>::iterator block);
+  // We also might need to handle GC of an unlinked block, as a sequential scan might be on it
+  BlockDirectory blocks_;
+
+  // Each inserting thread is assigned one of these, and remembers the block it last inserted into there. Threads keep
+  // inserting into their own block until it fills up, so concurrent inserts mostly touch different blocks.
+  struct alignas(common::Constants::CACHELINE_SIZE) InsertionHead {
+    std::atomic<uint64_t> block_index_{0};
+  };
+  std::array<InsertionHead, NUM_INSERTION_HEADS> insertion_heads_;
+  // Index of the first block that may not be full yet. Threads whose block is full look for a new one from here.
+  std::atomic<uint64_t> first_free_block_{0};
   mutable DataTableCounter data_table_counter_;
 
   // A templatized version for select, so that we can use the same code for both row and column access.
@@ -265,6 +299,18 @@ class DataTable {
   bool SelectIntoBuffer(common::ManagedPointer<transaction::TransactionContext> txn, TupleSlot slot,
                         RowType *out_buffer) const;
 
+  // Materializes the visible tuples in slots [begin, end) of the given block into out_buffer, starting at offset
+  // filled of the buffer. Runs of tuples without a version chain are copied a column at a time. Returns the number of
+  // tuples in the buffer afterwards.
+  uint32_t ScanBlock(common::ManagedPointer<transaction::TransactionContext> txn, RawBlock *block, uint32_t begin,
+                     uint32_t end, ProjectedColumns *out_buffer, uint32_t filled) const;
+
+  // Copies slots [begin, end) of the given block into out_buffer at offset filled with std::memcpy, and returns whether
+  // none of the tuples acquired a version chain or got deleted in the meantime. All of the slots must be allocated,
+  // present and have no version chain when this is called, either individually or according to the version synopsis.
+  bool CopyUnversionedRange(RawBlock *block, uint32_t begin, uint32_t end, ProjectedColumns *out_buffer,
+                            uint32_t filled) const;
+
   void InsertInto(common::ManagedPointer<transaction::TransactionContext> txn, const ProjectedRow &redo,
                   TupleSlot dest);
   // Atomically read out the version pointer value.
@@ -291,6 +337,13 @@ class DataTable {
   bool CompareAndSwapVersionPtr(TupleSlot slot, const TupleAccessStrategy &accessor, UndoRecord *expected,
                                 UndoRecord *desired);
 
+  // Cuts off the versions below head that no running txn can see anymore, if one of the first MAX_PRUNE_DEPTH versions
+  // below head is older than oldest. Head must be the head of the version chain installed by the calling txn.
+  static void PruneVersionChain(UndoRecord *head, transaction::timestamp_t oldest);
+
+  // Maintains the version synopsis of the slot's block after its version pointer changed from previous to desired
+  static void UpdateVersionSynopsis(TupleSlot slot, UndoRecord *previous, UndoRecord *desired);
+
   // Allocates a new block to be used as insertion head.
   RawBlock *NewBlock();
 
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <queue>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "common/shared_latch.h"
+#include "common/worker_pool.h"
 #include "storage/access_observer.h"
 #include "storage/index/index.h"
 #include "transaction/transaction_context.h"
@@ -18,6 +21,10 @@ namespace terrier::storage {
  * Based on the contents of this queue, it unlinks the UndoRecords from their version chains when no running
  * transactions can view those versions anymore. It then stores those transactions to attempt to deallocate on the next
  * iteration if no running transactions can still hold references to them.
+ *
+ * The GC can hand its work to a number of worker threads. The UndoRecords to unlink are then partitioned by the
+ * DataTable they belong to, so that every version chain is only ever truncated by one thread, the transactions to
+ * deallocate are split evenly among the workers, and the indexes are garbage collected alongside.
  */
 class GarbageCollector {
  public:
@@ -31,19 +38,27 @@ class GarbageCollector {
    *                 it is not null. The observer can then gain insight invoke other components to perform actions.
    *                 The observer's function implementation needs to be lightweight because it is called on the GC
    *                 thread.
+   * @param num_workers number of threads the GC hands its work to, with 1 the thread invoking the GC does it itself
    */
   // TODO(Tianyu): Eventually the GC will be re-written to be purely on the deferred action manager. which will
   //  eliminate this perceived redundancy of taking in a transaction manager.
   GarbageCollector(const common::ManagedPointer<transaction::TimestampManager> timestamp_manager,
                    const common::ManagedPointer<transaction::DeferredActionManager> deferred_action_manager,
-                   const common::ManagedPointer<transaction::TransactionManager> txn_manager, AccessObserver *observer)
+                   const common::ManagedPointer<transaction::TransactionManager> txn_manager, AccessObserver *observer,
+                   const uint32_t num_workers = 1)
       : timestamp_manager_(timestamp_manager),
         deferred_action_manager_(deferred_action_manager),
         txn_manager_(txn_manager),
         observer_(observer),
-        last_unlinked_{0} {
+        last_unlinked_{0},
+        unlink_partitions_(num_workers) {
     TERRIER_ASSERT(txn_manager_->GCEnabled(),
                    "The TransactionManager needs to be instantiated with gc_enabled true for GC to work!");
+    TERRIER_ASSERT(num_workers > 0, "GC needs at least one worker");
+    if (num_workers > 1) {
+      worker_pool_ = std::make_unique<common::WorkerPool>(num_workers, common::TaskQueue());
+      worker_pool_->Startup();
+    }
   }
 
   ~GarbageCollector() {
@@ -75,6 +90,13 @@ class GarbageCollector {
   void UnregisterIndexForGC(common::ManagedPointer<index::Index> index);
 
  private:
+  // UndoRecords of the txns to unlink that belong to the tables of one worker
+  struct UnlinkPartition {
+    std::vector<std::pair<transaction::TransactionContext *, UndoRecord *>> records_;
+    // Varlen entries the records held that need to be freed, with the txn to hand them to
+    std::vector<std::pair<transaction::TransactionContext *, const byte *>> loose_ptrs_;
+  };
+
   /**
    * Process the deallocate queue
    * @return number of txns (not UndoRecords) processed for debugging/testing
@@ -92,13 +114,34 @@ class GarbageCollector {
    */
   void ProcessDeferredActions(transaction::timestamp_t oldest_txn);
 
+  // Truncates the version chains of the records of a partition, and reclaims what they leave behind
+  void UnlinkRecords(UnlinkPartition *partition, transaction::timestamp_t oldest_txn) const;
+
+  // Hands the varlen entries the workers found to their txns, once the workers are done
+  void CollectLoosePointers();
+
+  // Runs a task on a worker, or right away if the GC has no worker threads
+  template <class F>
+  void RunTask(const F &task) {
+    if (worker_pool_ != nullptr) {
+      worker_pool_->SubmitTask(task);
+    } else {
+      task();
+    }
+  }
+
   void ReclaimSlotIfDeleted(UndoRecord *undo_record) const;
 
-  void ReclaimBufferIfVarlen(transaction::TransactionContext *txn, UndoRecord *undo_record) const;
+  void ReclaimBufferIfVarlen(transaction::TransactionContext *txn, UndoRecord *undo_record,
+                             UnlinkPartition *partition) const;
 
   void TruncateVersionChain(DataTable *table, TupleSlot slot, transaction::timestamp_t oldest) const;
 
-  void ProcessIndexes();
+  /**
+   * Invoke garbage collection on every registered index, each as its own task. The caller must hold indexes_latch_
+   * until the tasks are done.
+   */
+  void ProcessIndexes(transaction::timestamp_t oldest_txn);
 
   const common::ManagedPointer<transaction::TimestampManager> timestamp_manager_;
   const common::ManagedPointer<transaction::DeferredActionManager> deferred_action_manager_;
@@ -110,6 +153,10 @@ class GarbageCollector {
   transaction::TransactionQueue txns_to_deallocate_;
   // queue of txns that need to be unlinked
   transaction::TransactionQueue txns_to_unlink_;
+  // number of txns in txns_to_unlink_ that were still visible to running txns on the last GC run
+  uint32_t unlink_backlog_ = 0;
+  std::vector<UnlinkPartition> unlink_partitions_;
+  std::unique_ptr<common::WorkerPool> worker_pool_;
 
   std::unordered_set<common::ManagedPointer<index::Index>> indexes_;
   common::SharedLatch indexes_latch_;
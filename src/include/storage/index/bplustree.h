@@ -1,12 +1,2020 @@
 #pragma once
 
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <deque>
 #include <functional>
+#include <iterator>
+#include <new>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/optimistic_latch.h"
+#include "common/spin_latch.h"
+#include "ips4o/ips4o.hpp"
 
 namespace terrier::storage::index {
+template <uint8_t KeySize>
+class CompactIntsKey;
+template <uint16_t KeySize>
+class NormalizedKey;
+
+/**
+ * Properties of the key types stored in a BPlusTree that the tree needs to know about for concurrency control.
+ * @tparam KeyType the type of keys stored in the BPlusTree
+ */
+template <typename KeyType>
+struct BPlusTreeKeyTraits {
+  /**
+   * Optimistic readers may observe a key that is being overwritten by a concurrent writer. If the key's comparator is
+   * safe to invoke on such a torn key (i.e. it cannot crash, only return a garbage answer that version validation later
+   * discards), readers compare keys in place. Otherwise every key is copied and validated before it is compared. This
+   * is the case for GenericKey, whose comparators interpret the key's contents to find attributes.
+   */
+  static constexpr bool TEARING_SAFE = std::is_arithmetic_v<KeyType>;
+
+  /**
+   * If true, the key type provides a static KeyType::SearchBound(keys, num_keys, key, upper) that finds the bound of a
+   * key in a small sorted array faster than a binary search does, which the tree uses on the last few keys of a node.
+   * It must order keys the same way as std::less<KeyType>, and be safe to run on torn keys.
+   */
+  static constexpr bool VECTORIZED_SEARCH = false;
+};
+
+/**
+ * CompactIntsKey comparisons are a memcmp over a fixed number of bytes, which is safe to run on torn keys. 8 and
+ * 16-byte keys are also compared several at a time with SIMD instructions when searching a node.
+ * @tparam KeySize number of bytes in the key
+ */
+template <uint8_t KeySize>
+struct BPlusTreeKeyTraits<CompactIntsKey<KeySize>> {
+  /**
+   * CompactIntsKey is safe to compare when torn.
+   */
+  static constexpr bool TEARING_SAFE = true;
 
+  /**
+   * CompactIntsKey::SearchBound is implemented for 8 and 16-byte keys.
+   */
+  static constexpr bool VECTORIZED_SEARCH = KeySize == 8 || KeySize == 16;
+};
+
+/**
+ * NormalizedKey comparisons are a memcmp over a fixed number of bytes, which is safe to run on torn keys.
+ * @tparam KeySize number of bytes in the key
+ */
+template <uint16_t KeySize>
+struct BPlusTreeKeyTraits<NormalizedKey<KeySize>> {
+  /**
+   * NormalizedKey is safe to compare when torn.
+   */
+  static constexpr bool TEARING_SAFE = true;
+
+  /**
+   * NormalizedKey has no vectorized search.
+   */
+  static constexpr bool VECTORIZED_SEARCH = false;
+};
+
+/**
+ * A concurrent B+Tree supporting non-unique keys, synchronized with optimistic lock coupling (Leis et al., "The ART of
+ * Practical Synchronization", DaMoN 2016).
+ *
+ * Every node carries a common::OptimisticLatch. Readers descend the tree without writing to shared memory: they record
+ * each node's version, read the node, and validate the version before acting on what they read, restarting the
+ * operation if validation fails. Writers descend the same way and only latch the nodes they modify. Full inner nodes
+ * are split eagerly on the way down so that a leaf split never needs to propagate more than one level.
+ *
+ * A key with a few values stores each of them in a separate entry, and these entries may span several adjacent leaves.
+ * Descending to a key always chooses the leftmost child that may contain it, so the leaf reached by the descent (the
+ * key's "target" leaf) holds the first of its entries, or is immediately to the left of it. New entries for a key are
+ * always added to its target leaf, and deletes begin from it, so holding the target leaf's latch serializes all
+ * modifications of a key's entries. Once a key has more than MAX_INLINE_VALUES values and they all sit in its target
+ * leaf, they move into a value page instead: a sorted array of values, referenced from the key's only entry, in which a
+ * value is found with a binary search. A page is only modified while the leaf holding its entry is latched, and grows
+ * or shrinks by being copied into a new page. Page values are returned in value order, inline values in insertion
+ * order.
+ *
+ * Deletes that leave a leaf underfull rebalance the tree: underfull inner nodes on the way down are merged with or
+ * refilled from a sibling, the leaf is merged into its left sibling if the two fit together, and an inner root with a
+ * single child is replaced by that child. Leaves that could not be merged are cleaned up by Compact, which repacks the
+ * leaves below each sparse bottom-level inner node. Live entries only ever move rightwards (into a new sibling when a
+ * leaf splits), or out of a leaf that is removed from the tree at the same time. A removed leaf is marked obsolete but
+ * keeps its entries and sibling links as a frozen snapshot, so a reader that walks sibling links to the right and
+ * reaches it through a stale link still sees every entry that existed when it started, exactly once. Readers walking
+ * to the left locate their position in the leaf that took over the entries instead.
+ *
+ * Nodes that are removed from the tree are not freed immediately, because optimistic readers may still be reading
+ * them. They are retired instead, and the owner of the tree frees them in batches through PerformGarbageCollection
+ * once every operation that started before they were unlinked has finished. A node pointer that was validated once
+ * therefore stays dereferenceable for the rest of the operation.
+ *
+ * An empty tree can also be bulk loaded from a batch of entries, which builds packed leaves and then each inner level
+ * bottom-up instead of inserting the entries one at a time.
+ *
+ * @tparam KeyType the type of keys stored in the tree
+ * @tparam ValueType the type of values stored in the tree
+ * @tparam KeyComparator functor defining a strict weak ordering on keys
+ * @tparam KeyEqualityChecker functor determining whether two keys are equal
+ * @tparam KeyHashFunc unused, kept for interface compatibility with the BwTree
+ * @tparam ValueEqualityChecker functor determining whether two values are equal
+ * @tparam ValueComparator functor defining a strict weak ordering on values that is consistent with
+ *                         ValueEqualityChecker, used to sort value pages
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator = std::less<KeyType>,
           typename KeyEqualityChecker = std::equal_to<KeyType>, typename KeyHashFunc = std::hash<KeyType>,
-          typename ValueEqualityChecker = std::equal_to<ValueType>>
-class BPlusTree {};
+          typename ValueEqualityChecker = std::equal_to<ValueType>, typename ValueComparator = std::less<ValueType>>
+class BPlusTree {
+ public:
+  /**
+   * A single entry in the tree
+   */
+  using KeyValuePair = std::pair<KeyType, ValueType>;
+
+  /**
+   * Number of bytes that a node is sized to occupy
+   */
+  static constexpr uint32_t NODE_SIZE = 4096;
+
+ private:
+  static constexpr bool TEARING_SAFE = BPlusTreeKeyTraits<KeyType>::TEARING_SAFE;
+  // The key type's search kernel implements the default ordering of keys, and cannot be used with any other comparator
+  static constexpr bool VECTORIZED_SEARCH =
+      BPlusTreeKeyTraits<KeyType>::VECTORIZED_SEARCH && std::is_same_v<KeyComparator, std::less<KeyType>>;
+  // Vectorized searches narrow a node down to this many keys with a binary search before comparing them all
+  static constexpr uint16_t VECTORIZED_SEARCH_WINDOW = 32;
+  // Bulk loads smaller than this many entries per thread are sorted by a single thread
+  static constexpr size_t BULK_LOAD_MIN_SORT_CHUNK = 1 << 16;
+
+  /**
+   * Header shared by inner nodes, leaves and value pages
+   */
+  struct BaseNode {
+    explicit BaseNode(const bool is_leaf, const bool is_value_page = false)
+        : is_leaf_(is_leaf), is_value_page_(is_value_page) {}
+
+    mutable common::OptimisticLatch latch_;
+    // Set on construction and never changed, so they can be read without validation
+    const bool is_leaf_;
+    const bool is_value_page_;
+    uint16_t size_ = 0;
+  };
+
+ public:
+  /**
+   * Maximum number of separator keys in an inner node
+   */
+  static constexpr uint16_t INNER_CAPACITY = static_cast<uint16_t>(std::max<size_t>(
+      4, (NODE_SIZE - sizeof(BaseNode) - sizeof(BaseNode *)) / (sizeof(KeyType) + sizeof(BaseNode *))));
+
+  /**
+   * Maximum number of entries in a leaf
+   */
+  static constexpr uint16_t LEAF_CAPACITY = static_cast<uint16_t>(std::max<size_t>(
+      4, (NODE_SIZE - sizeof(BaseNode) - 2 * sizeof(BaseNode *)) / (sizeof(KeyType) + sizeof(ValueType) + 1)));
+
+  /**
+   * Maximum number of values of a key that are stored in separate entries rather than in a value page
+   */
+  static constexpr uint16_t MAX_INLINE_VALUES = 8;
+
+ private:
+  // Nodes with fewer keys than this are merged with or refilled from a sibling
+  static constexpr uint16_t LEAF_MIN_SIZE = LEAF_CAPACITY / 4;
+  static constexpr uint16_t INNER_MIN_SIZE = INNER_CAPACITY / 4;
+  // Nodes are only merged (or packed by Compact) up to this size, so that a few inserts do not split them right away
+  static constexpr uint16_t LEAF_MERGE_SIZE = LEAF_CAPACITY * 3 / 4;
+  static constexpr uint16_t INNER_MERGE_SIZE = INNER_CAPACITY * 3 / 4;
+  // Number of deletes that left a leaf underfull without being able to merge it after which Compact is worthwhile
+  static constexpr uint32_t COMPACTION_THRESHOLD = 32;
+  // Smallest number of values a value page is allocated for
+  static constexpr uint32_t VALUE_PAGE_MIN_CAPACITY = 4 * MAX_INLINE_VALUES;
+
+  /**
+   * Inner node with size_ separator keys and size_ + 1 children. Every key in children_[i] is in the closed range
+   * [keys_[i - 1], keys_[i]].
+   */
+  struct InnerNode : public BaseNode {
+    InnerNode() : BaseNode(false) {}
+
+    KeyType keys_[INNER_CAPACITY];
+    BaseNode *children_[INNER_CAPACITY + 1];
+  };
+
+  /**
+   * Leaf holding size_ entries sorted by key, doubly linked with its siblings. The value of an entry flagged in
+   * is_page_ holds a pointer to the key's value page instead.
+   */
+  struct LeafNode : public BaseNode {
+    LeafNode() : BaseNode(true) {}
+
+    LeafNode *prev_ = nullptr;
+    LeafNode *next_ = nullptr;
+    KeyType keys_[LEAF_CAPACITY];
+    ValueType values_[LEAF_CAPACITY];
+    bool is_page_[LEAF_CAPACITY];
+  };
+
+  /**
+   * Sorted array of the values of one key, allocated in one block with its header. The latch is taken by writers in
+   * addition to the latch of the leaf holding the key's entry, so that readers of leaves that were removed from the
+   * tree, which still reference the page but are no longer latched, notice concurrent modifications. BaseNode::size_
+   * is unused, as a page may hold more values than it can count.
+   */
+  struct ValuePage : public BaseNode {
+    explicit ValuePage(const uint32_t capacity) : BaseNode(false, true), capacity_(capacity) {}
+
+    ValueType *Values() { return reinterpret_cast<ValueType *>(this + 1); }
+    const ValueType *Values() const { return reinterpret_cast<const ValueType *>(this + 1); }
+
+    const uint32_t capacity_;
+    uint32_t num_values_ = 0;
+  };
+  static_assert(std::is_trivially_copyable_v<ValueType> && sizeof(ValueType) >= sizeof(ValuePage *),
+                "Leaf entries store pointers to value pages in place of their value.");
+  static_assert(sizeof(ValuePage) % alignof(ValueType) == 0, "Values must be aligned after the page header.");
+
+  /**
+   * An entry of a leaf as it is stored, used to stage entries when building leaves
+   */
+  struct LeafEntry {
+    KeyType key_;
+    ValueType value_;
+    bool is_page_;
+  };
+
+ public:
+  /**
+   * Bidirectional iterator over the entries of the tree. It holds a consistent copy of one leaf at a time and moves to
+   * the next (or previous) leaf through the sibling links when it runs off the end of its copy. The iterator does not
+   * provide a snapshot of the whole tree: entries inserted or deleted concurrently may or may not be observed.
+   */
+  class Iterator {
+   public:
+    /**
+     * @return true if the iterator moved past the last entry of the tree
+     */
+    bool IsEnd() const { return offset_ == static_cast<int32_t>(entries_.size()) && next_ == nullptr; }
+
+    /**
+     * @return true if the iterator moved before the first entry of the tree
+     */
+    bool IsREnd() const { return offset_ == -1 && prev_ == nullptr; }
+
+    /**
+     * @return the current entry
+     */
+    const KeyValuePair &operator*() const {
+      TERRIER_ASSERT(!IsEnd() && !IsREnd(), "Cannot dereference an iterator that is out of range.");
+      return entries_[offset_];
+    }
+
+    /**
+     * @return pointer to the current entry
+     */
+    const KeyValuePair *operator->() const { return &(operator*()); }
+
+    /**
+     * Advances to the next entry in key order. Advancing an iterator that IsEnd() has no effect.
+     * @return self-reference
+     */
+    Iterator &operator++() {
+      if (IsEnd()) return *this;
+      offset_++;
+      SkipForward();
+      return *this;
+    }
+
+    /**
+     * Moves to the previous entry in key order. Moving an iterator that IsREnd() has no effect.
+     * @return self-reference
+     */
+    Iterator &operator--() {
+      if (IsREnd()) return *this;
+      offset_--;
+      SkipBackward();
+      return *this;
+    }
+
+   private:
+    friend class BPlusTree;
+
+    explicit Iterator(const BPlusTree *const tree) : tree_(tree) {}
+
+    // Loads the given leaf into this iterator, leaving the offset untouched
+    void Load(const LeafNode *const leaf) {
+      leaf_ = leaf;
+      tree_->ReadLeaf(leaf, &entries_, &prev_, &next_);
+    }
+
+    // Moves rightwards until the offset is on an entry or there are no more leaves
+    void SkipForward() {
+      while (offset_ == static_cast<int32_t>(entries_.size()) && next_ != nullptr) {
+        Load(next_);
+        offset_ = 0;
+      }
+    }
+
+    // Moves leftwards until the offset is on an entry or there are no more leaves
+    void SkipBackward() {
+      while (offset_ == -1 && prev_ != nullptr) {
+        // Every entry of the copy has been visited, so its first entry marks where to continue from
+        if (!entries_.empty()) {
+          boundary_values_.clear();
+          for (const auto &entry : entries_) {
+            if (!tree_->KeyCmpEqual(entry.first, entries_.front().first)) break;
+            boundary_values_.emplace_back(entry.second);
+          }
+          boundary_ = entries_.front();
+          has_boundary_ = true;
+        }
+        if (LoadPredecessor()) offset_ = static_cast<int32_t>(entries_.size()) - 1;
+      }
+    }
+
+    // Replaces the copy with the entries immediately before it. Returns false if a concurrent modification got in the
+    // way, in which case the copy is untouched and the caller tries again.
+    bool LoadPredecessor() {
+      std::vector<KeyValuePair> entries;
+      const LeafNode *prev;
+      const LeafNode *next;
+      const LeafNode *const current = leaf_;
+      if (!tree_->ReadLeaf(current, &entries, &prev, &next)) {
+        // The leaf is still part of the tree, so none of its entries moved to the left, and the entries we are looking
+        // for are in its left neighbour. That neighbour may have split since we read the link, in which case we walk
+        // right until we find our own leaf's immediate left neighbour again, or we would skip the entries that moved
+        // into the new siblings.
+        if (prev == nullptr) {
+          entries_.clear();
+          prev_ = nullptr;
+          return true;
+        }
+        const LeafNode *candidate = prev;
+        while (true) {
+          if (tree_->ReadLeaf(candidate, &entries, &prev, &next)) return false;
+          if (next == current) break;
+          if (next == nullptr) return false;
+          candidate = next;
+        }
+        leaf_ = candidate;
+        entries_ = std::move(entries);
+        prev_ = prev;
+        next_ = next;
+        return true;
+      }
+
+      // The leaf was removed from the tree, and its entries moved to the left. Removed leaves keep linking to a leaf
+      // at or before the position of their entries, so follow those links to a live leaf and gather its entries, and
+      // those of its right siblings, up to the last entry we visited.
+      const LeafNode *start = prev;
+      while (tree_->ReadLeaf(start, &entries, &prev, &next)) start = prev;
+      const LeafNode *const start_prev = prev;
+      const LeafNode *const start_next = next;
+      std::vector<KeyValuePair> gathered;
+      while (true) {
+        bool reached_boundary = !has_boundary_;
+        for (auto &entry : entries) {
+          if (has_boundary_ && !BeforeBoundary(entry)) {
+            reached_boundary = true;
+            break;
+          }
+          gathered.emplace_back(std::move(entry));
+        }
+        if (reached_boundary || next == nullptr) break;
+        if (tree_->ReadLeaf(next, &entries, &prev, &next)) return false;
+      }
+      leaf_ = start;
+      entries_ = std::move(gathered);
+      prev_ = start_prev;
+      next_ = start_next;
+      return true;
+    }
+
+    // Whether an entry comes before the last entry visited by a leftwards walk. Entries equal to the boundary's key are
+    // in insertion order, so they come before it unless they were visited already.
+    bool BeforeBoundary(const KeyValuePair &entry) const {
+      if (tree_->KeyCmpLess(entry.first, boundary_.first)) return true;
+      if (!tree_->KeyCmpEqual(entry.first, boundary_.first)) return false;
+      return std::none_of(boundary_values_.cbegin(), boundary_values_.cend(),
+                          [&](const ValueType &value) { return tree_->value_eq_obj_(value, entry.second); });
+    }
+
+    const BPlusTree *tree_;
+    const LeafNode *leaf_ = nullptr;
+    std::vector<KeyValuePair> entries_;
+    const LeafNode *prev_ = nullptr;
+    const LeafNode *next_ = nullptr;
+    int32_t offset_ = 0;
+    // The entry a leftwards walk visited last, and the values of the entries with its key in the same copy
+    KeyValuePair boundary_;
+    bool has_boundary_ = false;
+    std::vector<ValueType> boundary_values_;
+  };
+
+  /**
+   * Constructs an empty tree.
+   * @param key_cmp_obj key comparator
+   * @param key_eq_obj key equality checker
+   * @param value_eq_obj value equality checker
+   * @param value_cmp_obj value comparator
+   */
+  explicit BPlusTree(KeyComparator key_cmp_obj = KeyComparator{}, KeyEqualityChecker key_eq_obj = KeyEqualityChecker{},
+                     ValueEqualityChecker value_eq_obj = ValueEqualityChecker{},
+                     ValueComparator value_cmp_obj = ValueComparator{})
+      : key_cmp_obj_(key_cmp_obj),
+        key_eq_obj_(key_eq_obj),
+        value_eq_obj_(value_eq_obj),
+        value_cmp_obj_(value_cmp_obj),
+        root_(NewNode<LeafNode>()) {}
+
+  /**
+   * Frees every node in the tree, including retired ones. The caller must guarantee that no other thread is accessing
+   * the tree.
+   */
+  ~BPlusTree() {
+    FreeSubtree(root_.load());
+    for (auto *const node : retired_) FreeNode(node);
+    for (auto *const node : unstamped_) FreeNode(node);
+    for (auto &batch : stamped_) {
+      for (auto *const node : batch.second) FreeNode(node);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(BPlusTree)
+
+  /**
+   * Inserts a key-value pair.
+   * @param key key to insert
+   * @param value value to insert
+   * @param unique_key if true, fail the insert if any entry with the key already exists
+   * @return false if the key-value pair already exists (or the key exists for unique_key), true otherwise
+   */
+  bool Insert(const KeyType &key, const ValueType &value, const bool unique_key = false) {
+    bool UNUSED_ATTRIBUTE predicate_satisfied = false;
+    if (unique_key) {
+      return ConditionalInsert(
+          key, value, [](const ValueType &) { return true; }, &predicate_satisfied);
+    }
+    // Without a predicate, only the given value needs to be looked for among the existing ones
+    bool inserted = false;
+    while (!TryInsert(key, value, nullptr, &predicate_satisfied, &inserted)) {
+    }
+    return inserted;
+  }
+
+  /**
+   * Inserts a key-value pair only if the predicate is false for every value already associated with the key. The check
+   * and the insert are atomic with respect to all other modifications of the key.
+   * @param key key to insert
+   * @param value value to insert
+   * @param predicate evaluated on all existing values of the key
+   * @param[out] predicate_satisfied set to true if the predicate returned true for an existing value
+   * @return true if the pair was inserted, false if the predicate was satisfied or the pair already exists
+   */
+  bool ConditionalInsert(const KeyType &key, const ValueType &value,
+                         const std::function<bool(const ValueType &)> &predicate, bool *const predicate_satisfied) {
+    *predicate_satisfied = false;
+    bool inserted = false;
+    while (!TryInsert(key, value, &predicate, predicate_satisfied, &inserted)) {
+    }
+    return inserted;
+  }
+
+  /**
+   * Deletes a key-value pair.
+   * @param key key to delete
+   * @param value value to delete
+   * @return true if the pair existed and was removed, false otherwise
+   */
+  bool Delete(const KeyType &key, const ValueType &value) {
+    bool deleted = false;
+    bool underfull = false;
+    while (!TryDelete(key, value, &deleted, &underfull)) {
+    }
+    if (underfull && Rebalance(&key, false)) underfull_leaves_.fetch_add(1, std::memory_order_relaxed);
+    return deleted;
+  }
+
+  /**
+   * Finds all values associated with a key.
+   * @param key key to look up
+   * @param[out] value_list the values associated with the key are appended to this vector
+   */
+  void GetValue(const KeyType &key, std::vector<ValueType> *const value_list) const {
+    const LeafNode *last;
+    LeafNode *last_next;
+    CollectAllValues(FindLeaf(&key, false), key, value_list, &last, &last_next);
+  }
+
+  /**
+   * Finds all values associated with each key of a batch. The keys are looked up in sorted order, and a key whose
+   * entries begin in the leaf that the previous key ended in, or in that leaf's right sibling, is read from there
+   * without descending from the root again. Batches of sorted or clustered keys thus descend the tree about once per
+   * leaf they touch rather than once per key.
+   * @param keys keys to look up, in any order and possibly repeated
+   * @param[out] value_list the values of every key are appended to this vector, grouped by key in the order of keys
+   * @param[out] offsets cleared, then filled with keys.size() + 1 positions in value_list, such that the values of
+   *                     keys[i] are at [offsets[i], offsets[i + 1])
+   */
+  void GetValues(const std::vector<KeyType> &keys, std::vector<ValueType> *const value_list,
+                 std::vector<uint32_t> *const offsets) const {
+    std::vector<uint32_t> order(keys.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+      return KeyCmpLess(keys[lhs], keys[rhs]);
+    });
+
+    // Values are collected in key order first, and gathered into the order of the batch afterwards
+    std::vector<ValueType> sorted_values;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges(keys.size());
+    const LeafNode *leaf = nullptr;
+    LeafNode *next = nullptr;
+    for (uint32_t i = 0; i < order.size(); i++) {
+      const KeyType &key = keys[order[i]];
+      if (i > 0 && KeyCmpEqual(key, keys[order[i - 1]])) {
+        ranges[order[i]] = ranges[order[i - 1]];
+        continue;
+      }
+      const LeafNode *start;
+      if (leaf != nullptr && LeafCovers(leaf, key)) {
+        start = leaf;
+      } else if (next != nullptr && LeafCovers(next, key)) {
+        start = next;
+      } else {
+        start = FindLeaf(&key, false);
+      }
+      const auto begin = static_cast<uint32_t>(sorted_values.size());
+      CollectAllValues(start, key, &sorted_values, &leaf, &next);
+      ranges[order[i]] = {begin, static_cast<uint32_t>(sorted_values.size())};
+      // The next key in sorted order most likely starts in the sibling if it misses this leaf
+      if (next != nullptr) __builtin_prefetch(next);
+    }
+
+    offsets->clear();
+    offsets->reserve(keys.size() + 1);
+    value_list->reserve(value_list->size() + sorted_values.size());
+    for (const auto &range : ranges) {
+      offsets->emplace_back(static_cast<uint32_t>(value_list->size()));
+      value_list->insert(value_list->end(), sorted_values.begin() + range.first, sorted_values.begin() + range.second);
+    }
+    offsets->emplace_back(static_cast<uint32_t>(value_list->size()));
+  }
+
+  /**
+   * Loads a batch of entries into an empty tree. The entries are sorted by key (in parallel for large batches) and
+   * packed into leaves from left to right, after which each inner level is built from the level below it. The caller
+   * must guarantee that no other thread is accessing the tree.
+   * @param[in,out] entries entries to load, sorted by key in place
+   * @param unique_key if true, fail the load if any key occurs more than once
+   * @param fill_factor fraction of each node's capacity to fill, in (0, 1]. Leaving room in the nodes lets subsequent
+   *                    inserts proceed for a while before they need to split nodes.
+   * @return false if the tree is not empty or the entries violate unique_key, in which case the tree is not modified
+   */
+  bool BulkLoad(std::vector<KeyValuePair> *const entries, const bool unique_key, const double fill_factor) {
+    TERRIER_ASSERT(fill_factor > 0 && fill_factor <= 1, "Fill factor must be in (0, 1].");
+    BaseNode *const old_root = root_.load();
+    if (!old_root->is_leaf_ || old_root->size_ != 0) return false;
+
+    SortEntries(entries);
+    if (unique_key) {
+      for (size_t i = 1; i < entries->size(); i++) {
+        if (!KeyCmpLess((*entries)[i - 1].first, (*entries)[i].first)) return false;
+      }
+    }
+    if (entries->empty()) return true;
+
+    // Keys with more values than are stored inline get a value page
+    std::vector<LeafEntry> leaf_entries;
+    leaf_entries.reserve(entries->size());
+    for (size_t begin = 0, end = 0; begin < entries->size(); begin = end) {
+      while (end < entries->size() && !KeyCmpLess((*entries)[begin].first, (*entries)[end].first)) end++;
+      if (end - begin <= MAX_INLINE_VALUES) {
+        for (size_t i = begin; i < end; i++) leaf_entries.push_back({(*entries)[i].first, (*entries)[i].second, false});
+        continue;
+      }
+      ValuePage *const page = NewPage(static_cast<uint32_t>(end - begin));
+      for (size_t i = begin; i < end; i++) page->Values()[i - begin] = (*entries)[i].second;
+      page->num_values_ = static_cast<uint32_t>(end - begin);
+      std::sort(page->Values(), page->Values() + page->num_values_, value_cmp_obj_);
+      leaf_entries.push_back({(*entries)[begin].first, PageAsValue(page), true});
+    }
+
+    // Build the leaf level, spreading the entries evenly so that the last leaf is not left nearly empty
+    const size_t num_entries = leaf_entries.size();
+    const size_t leaf_fill = FillCount(LEAF_CAPACITY, fill_factor, 1);
+    const size_t num_leaves = (num_entries + leaf_fill - 1) / leaf_fill;
+    std::vector<BaseNode *> level;
+    // Smallest key in the subtree of each node of the current level, which becomes its separator in the parent
+    std::vector<KeyType> low_keys;
+    level.reserve(num_leaves);
+    low_keys.reserve(num_leaves);
+    LeafNode *prev = nullptr;
+    for (size_t i = 0; i < num_leaves; i++) {
+      const size_t begin = i * num_entries / num_leaves;
+      const size_t end = (i + 1) * num_entries / num_leaves;
+      auto *const leaf = NewNode<LeafNode>();
+      FillLeaf(leaf, leaf_entries.data() + begin, leaf_entries.data() + end);
+      leaf->prev_ = prev;
+      if (prev != nullptr) prev->next_ = leaf;
+      prev = leaf;
+      level.emplace_back(leaf);
+      low_keys.emplace_back(leaf->keys_[0]);
+    }
+
+    // Build inner levels until a single root remains. With at least three children per node, spreading the children
+    // evenly never leaves an inner node with a single child.
+    const size_t fanout = FillCount(INNER_CAPACITY + 1, fill_factor, 3);
+    while (level.size() > 1) {
+      const size_t num_nodes = (level.size() + fanout - 1) / fanout;
+      std::vector<BaseNode *> parents;
+      std::vector<KeyType> parent_low_keys;
+      parents.reserve(num_nodes);
+      parent_low_keys.reserve(num_nodes);
+      for (size_t i = 0; i < num_nodes; i++) {
+        const size_t begin = i * level.size() / num_nodes;
+        const size_t end = (i + 1) * level.size() / num_nodes;
+        auto *const inner = NewNode<InnerNode>();
+        inner->children_[0] = level[begin];
+        for (size_t j = begin + 1; j < end; j++) {
+          inner->keys_[j - begin - 1] = low_keys[j];
+          inner->children_[j - begin] = level[j];
+        }
+        inner->size_ = static_cast<uint16_t>(end - begin - 1);
+        parents.emplace_back(inner);
+        parent_low_keys.emplace_back(low_keys[begin]);
+      }
+      level = std::move(parents);
+      low_keys = std::move(parent_low_keys);
+    }
+
+    root_.store(level[0]);
+    RetireNode(old_root);
+    return true;
+  }
+
+  /**
+   * Frees retired nodes that no operation can be reading anymore. Epochs are opaque, monotonically increasing values
+   * such as transaction timestamps. Nodes retired before one call are stamped with the current epoch of the next call,
+   * which is then known to be later than the moment they were unlinked, and are freed once the oldest active epoch has
+   * caught up with their stamp. Must not be called concurrently with itself.
+   * @param oldest_active_epoch every operation on the tree that started before this epoch has finished
+   * @param current_epoch an epoch that no operation running at the time of the call has started at or after
+   * @return number of nodes freed
+   */
+  uint32_t PerformGarbageCollection(const uint64_t oldest_active_epoch, const uint64_t current_epoch) {
+    uint32_t num_freed = 0;
+    while (!stamped_.empty() && stamped_.front().first <= oldest_active_epoch) {
+      for (auto *const node : stamped_.front().second) FreeNode(node);
+      num_freed += static_cast<uint32_t>(stamped_.front().second.size());
+      stamped_.pop_front();
+    }
+
+    // The previous call took these nodes out of the retired list, after they were unlinked, so the current epoch is
+    // later than any operation that may still hold a pointer to them
+    if (!unstamped_.empty()) stamped_.emplace_back(current_epoch, std::move(unstamped_));
+    unstamped_.clear();
+    {
+      common::SpinLatch::ScopedSpinLatch guard(&retired_latch_);
+      unstamped_.swap(retired_);
+    }
+    return num_freed;
+  }
+
+  /**
+   * @return number of bytes allocated for the nodes of the tree, including retired nodes that were not freed yet
+   */
+  size_t GetHeapUsage() const { return heap_usage_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return true if enough deletes left leaves underfull that they could not be merged for Compact to be worthwhile
+   */
+  bool NeedsCompaction() const { return underfull_leaves_.load(std::memory_order_relaxed) >= COMPACTION_THRESHOLD; }
+
+  /**
+   * Shrinks the leaf level after deletes that merges could not clean up, such as a long run of nearly empty leaves
+   * next to full ones. The leaves below every bottom-level inner node that are less than half full on average are
+   * repacked into as few leaves as possible, after which the inner levels are rebalanced. Runs concurrently with all
+   * other operations except BulkLoad, and only latches the nodes below one inner node at a time.
+   * @return number of leaves removed from the tree
+   */
+  uint32_t Compact() {
+    underfull_leaves_.store(0, std::memory_order_relaxed);
+    uint32_t num_removed = 0;
+    // Every inner node is visited by descending to the upper bound of the previous one, starting from the leftmost
+    KeyType cursor;
+    bool has_cursor = false;
+    while (true) {
+      KeyType next_cursor;
+      bool has_next_cursor;
+      uint32_t num_leaves_removed;
+      while (!TryCompactLeaves(has_cursor ? &cursor : nullptr, &next_cursor, &has_next_cursor, &num_leaves_removed)) {
+      }
+      if (num_leaves_removed > 0) {
+        num_removed += num_leaves_removed;
+        Rebalance(has_cursor ? &cursor : nullptr, true);
+      }
+      if (!has_next_cursor) break;
+      cursor = next_cursor;
+      has_cursor = true;
+    }
+    return num_removed;
+  }
+
+  /**
+   * @return iterator positioned on the smallest entry of the tree
+   */
+  Iterator Begin() const {
+    Iterator itr(this);
+    itr.Load(FindLeaf(nullptr, false));
+    itr.offset_ = 0;
+    itr.SkipForward();
+    return itr;
+  }
+
+  /**
+   * @param key key to search for
+   * @return iterator positioned on the first entry whose key is not less than the given key
+   */
+  Iterator Begin(const KeyType &key) const {
+    Iterator itr(this);
+    itr.Load(FindLeaf(&key, false));
+    while (true) {
+      const auto &entries = itr.entries_;
+      const auto lower =
+          std::lower_bound(entries.cbegin(), entries.cend(), key,
+                           [&](const KeyValuePair &entry, const KeyType &k) { return KeyCmpLess(entry.first, k); });
+      itr.offset_ = static_cast<int32_t>(lower - entries.cbegin());
+      if (lower != entries.cend() || itr.next_ == nullptr) break;
+      itr.Load(itr.next_);
+    }
+    return itr;
+  }
+
+  /**
+   * @param key key to search for
+   * @return iterator positioned on the last entry whose key is not greater than the given key
+   */
+  Iterator ReverseBegin(const KeyType &key) const {
+    Iterator itr(this);
+    itr.Load(FindLeaf(&key, true));
+    while (true) {
+      const auto &entries = itr.entries_;
+      const auto upper =
+          std::upper_bound(entries.cbegin(), entries.cend(), key,
+                           [&](const KeyType &k, const KeyValuePair &entry) { return KeyCmpLess(k, entry.first); });
+      itr.offset_ = static_cast<int32_t>(upper - entries.cbegin());
+      // The leaf may have split after we found it, in which case entries not greater than the key may be further right
+      if (upper != entries.cend() || itr.next_ == nullptr) break;
+      itr.Load(itr.next_);
+    }
+    --itr;
+    return itr;
+  }
+
+  /**
+   * @param lhs first key
+   * @param rhs second key
+   * @return true if lhs < rhs
+   */
+  bool KeyCmpLess(const KeyType &lhs, const KeyType &rhs) const { return key_cmp_obj_(lhs, rhs); }
+
+  /**
+   * @param lhs first key
+   * @param rhs second key
+   * @return true if lhs <= rhs
+   */
+  bool KeyCmpLessEqual(const KeyType &lhs, const KeyType &rhs) const { return !key_cmp_obj_(rhs, lhs); }
+
+  /**
+   * @param lhs first key
+   * @param rhs second key
+   * @return true if lhs > rhs
+   */
+  bool KeyCmpGreater(const KeyType &lhs, const KeyType &rhs) const { return key_cmp_obj_(rhs, lhs); }
+
+  /**
+   * @param lhs first key
+   * @param rhs second key
+   * @return true if lhs >= rhs
+   */
+  bool KeyCmpGreaterEqual(const KeyType &lhs, const KeyType &rhs) const { return !key_cmp_obj_(lhs, rhs); }
+
+  /**
+   * @param lhs first key
+   * @param rhs second key
+   * @return true if lhs == rhs
+   */
+  bool KeyCmpEqual(const KeyType &lhs, const KeyType &rhs) const { return key_eq_obj_(lhs, rhs); }
+
+ private:
+  /**
+   * Binary search over the keys of a node that the caller holds the latch on, or that is read optimistically at the
+   * given version. For keys that are not safe to compare when torn, every probed key is copied and validated first.
+   * For key types with a vectorized search, the binary search stops once few keys are left and the key type's kernel
+   * compares the remaining ones.
+   * @param node node to search
+   * @param version version the node was read at
+   * @param key search key
+   * @param upper if true, find the first key greater than the search key instead of the first key not less than it
+   * @param[out] pos resulting position
+   * @return false if the node changed while it was being searched
+   */
+  template <typename Node>
+  bool Search(const Node *const node, const uint64_t version, const KeyType &key, const bool upper,
+              uint16_t *const pos) const {
+    uint16_t low = 0;
+    // Clamp the size in case it was read while being modified, we must never read past the end of the node
+    uint16_t high = std::min<uint16_t>(node->size_, ARRAY_NELEMS(node->keys_));
+    while (high - low > (VECTORIZED_SEARCH ? VECTORIZED_SEARCH_WINDOW : 0)) {
+      const uint16_t mid = static_cast<uint16_t>(low + (high - low) / 2);
+      bool go_right;
+      if constexpr (TEARING_SAFE) {
+        go_right = upper ? !KeyCmpLess(key, node->keys_[mid]) : KeyCmpLess(node->keys_[mid], key);
+      } else {
+        const KeyType probe = node->keys_[mid];
+        if (!node->latch_.Validate(version)) return false;
+        go_right = upper ? !KeyCmpLess(key, probe) : KeyCmpLess(probe, key);
+      }
+      if (go_right) {
+        low = static_cast<uint16_t>(mid + 1);
+      } else {
+        high = mid;
+      }
+    }
+    if constexpr (VECTORIZED_SEARCH) {
+      low = static_cast<uint16_t>(low + KeyType::SearchBound(node->keys_ + low, high - low, key, upper));
+    }
+    *pos = low;
+    return true;
+  }
+
+  /**
+   * Finds the position of the first key not less than the search key in a node the caller holds the latch on.
+   */
+  template <typename Node>
+  uint16_t LowerBound(const Node *const node, const KeyType &key) const {
+    if constexpr (VECTORIZED_SEARCH) {
+      // Keys with a vectorized search are safe to compare when torn, so Search never validates the version
+      uint16_t pos;
+      Search(node, 0, key, false, &pos);
+      return pos;
+    }
+    return static_cast<uint16_t>(std::lower_bound(node->keys_, node->keys_ + node->size_, key,
+                                                  [&](const KeyType &lhs, const KeyType &rhs) {
+                                                    return KeyCmpLess(lhs, rhs);
+                                                  }) -
+                                 node->keys_);
+  }
+
+  /**
+   * Optimistically descends to a leaf.
+   * @param key key to descend towards. nullptr descends to the leftmost leaf.
+   * @param upper if true, descend to the rightmost leaf that may hold the key instead of the leftmost
+   * @return the leaf
+   */
+  const LeafNode *FindLeaf(const KeyType *const key, const bool upper) const {
+    while (true) {
+      LeafNode *leaf;
+      uint64_t version;
+      if (TryFindLeaf(key, upper, &leaf, &version)) return leaf;
+    }
+  }
+
+  /**
+   * A single attempt at optimistically descending to a leaf.
+   * @param key key to descend towards. nullptr descends to the leftmost leaf.
+   * @param upper if true, descend to the rightmost leaf that may hold the key instead of the leftmost
+   * @param[out] leaf the leaf
+   * @param[out] leaf_version the version at which the leaf was reached
+   * @return false if the descent needs to restart
+   */
+  bool TryFindLeaf(const KeyType *const key, const bool upper, LeafNode **const leaf,
+                   uint64_t *const leaf_version) const {
+    bool needs_restart = false;
+    BaseNode *node = root_.load();
+    uint64_t version = node->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart || node != root_.load()) return false;
+
+    const InnerNode *parent = nullptr;
+    uint64_t parent_version = 0;
+    while (!node->is_leaf_) {
+      const auto *const inner = static_cast<const InnerNode *>(node);
+      if (parent != nullptr) {
+        parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+        if (needs_restart) return false;
+      }
+      parent = inner;
+      parent_version = version;
+
+      uint16_t pos = 0;
+      if (key != nullptr && !Search(inner, version, *key, upper, &pos)) return false;
+      node = inner->children_[pos];
+      inner->latch_.ReadUnlockOrRestart(version, &needs_restart);
+      if (needs_restart) return false;
+      version = node->latch_.ReadLockOrRestart(&needs_restart);
+      if (needs_restart) return false;
+    }
+    if (parent != nullptr) {
+      parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+      if (needs_restart) return false;
+    }
+    *leaf = static_cast<LeafNode *>(node);
+    *leaf_version = version;
+    return true;
+  }
+
+  /**
+   * Collects the values of all entries with the given key, following right siblings while the entries continue. If a
+   * leaf changes while it is read, the values collected so far are discarded and the search restarts from the root.
+   * @param leaf leaf to start from, which must not be past the first entry with the key
+   * @param key key to look for
+   * @param[out] values matching values are appended here
+   * @param[out] last the leaf the search ended in
+   * @param[out] last_next right sibling of last
+   */
+  void CollectAllValues(const LeafNode *leaf, const KeyType &key, std::vector<ValueType> *const values,
+                        const LeafNode **const last, LeafNode **const last_next) const {
+    const auto initial_size = values->size();
+    while (true) {
+      LeafNode *next = nullptr;
+      bool exhausted;
+      if (!CollectValues(leaf, key, values, &exhausted, &next, nullptr)) {
+        values->resize(initial_size);
+        leaf = FindLeaf(&key, false);
+        continue;
+      }
+      if (!exhausted || next == nullptr) {
+        *last = leaf;
+        *last_next = next;
+        return;
+      }
+      leaf = next;
+    }
+  }
+
+  /**
+   * Checks whether the first entry with the given key, if there is one, must be in a leaf. That is the case when the
+   * leaf is still in the tree, and the key is greater than the leaf's first key and not greater than its last key.
+   * @param leaf leaf to check
+   * @param key key to look for
+   * @return true if a search for the key may start at the leaf instead of descending from the root
+   */
+  bool LeafCovers(const LeafNode *const leaf, const KeyType &key) const {
+    bool needs_restart = false;
+    const uint64_t version = leaf->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart) return false;
+    const uint16_t size = std::min<uint16_t>(leaf->size_, LEAF_CAPACITY);
+    if (size == 0) return false;
+    const KeyType first = leaf->keys_[0];
+    const KeyType last = leaf->keys_[size - 1];
+    if (!leaf->latch_.Validate(version)) return false;
+    return KeyCmpLess(first, key) && !KeyCmpLess(last, key);
+  }
+
+  /**
+   * Optimistically collects the values of all entries with the given key in a leaf. A leaf that was removed from the
+   * tree is read as the snapshot it was frozen at, which holds exactly the entries that a reader who followed a link to
+   * it before it was removed has not seen yet.
+   * @param leaf leaf to read
+   * @param key key to look for
+   * @param[out] values matching values are appended here
+   * @param[out] exhausted true if the leaf ended before an entry with a greater key was seen
+   * @param[out] next right sibling of the leaf
+   * @param[out] has_page if not nullptr, set to whether the key's values are in a value page in this leaf, which is
+   *                      then not read. Otherwise the page's values are collected as well.
+   * @return false if the leaf changed while it was read, in which case values is restored
+   */
+  bool CollectValues(const LeafNode *const leaf, const KeyType &key, std::vector<ValueType> *const values,
+                     bool *const exhausted, LeafNode **const next, bool *const has_page) const {
+    bool needs_restart = false;
+    bool UNUSED_ATTRIBUTE obsolete;
+    const uint64_t version = leaf->latch_.ReadLockAllowObsoleteOrRestart(&needs_restart, &obsolete);
+    if (needs_restart) return false;
+
+    const auto initial_size = values->size();
+    uint16_t pos;
+    if (!Search(leaf, version, key, false, &pos)) return false;
+    const uint16_t size = std::min<uint16_t>(leaf->size_, LEAF_CAPACITY);
+    // A key with a value page has no other entries
+    ValueType page_value{};
+    bool page_found = false;
+    for (; pos < size; pos++) {
+      // Everything from the lower bound onwards is not less than the key, so it is equal iff the key is not less
+      bool equal;
+      if constexpr (TEARING_SAFE) {
+        equal = !KeyCmpLess(key, leaf->keys_[pos]);
+      } else {
+        const KeyType probe = leaf->keys_[pos];
+        if (!leaf->latch_.Validate(version)) {
+          values->resize(initial_size);
+          return false;
+        }
+        equal = !KeyCmpLess(key, probe);
+      }
+      if (!equal) break;
+      if (leaf->is_page_[pos]) {
+        page_value = leaf->values_[pos];
+        page_found = true;
+        continue;
+      }
+      values->emplace_back(leaf->values_[pos]);
+    }
+    *exhausted = pos == size;
+    *next = leaf->next_;
+
+    if (!leaf->latch_.Validate(version)) {
+      values->resize(initial_size);
+      return false;
+    }
+    if (has_page != nullptr) {
+      *has_page = page_found;
+    } else if (page_found && !ReadPage(AsPage(page_value), values)) {
+      values->resize(initial_size);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Reads a consistent copy of a leaf's contents, retrying until no writer interferes. A leaf that was removed from the
+   * tree is read as the snapshot it was frozen at.
+   * @param leaf leaf to read
+   * @param[out] entries entries of the leaf
+   * @param[out] prev left sibling of the leaf, or for a removed leaf, a leaf at or before where its entries moved
+   * @param[out] next right sibling of the leaf
+   * @return true if the leaf was removed from the tree
+   */
+  bool ReadLeaf(const LeafNode *const leaf, std::vector<KeyValuePair> *const entries, const LeafNode **const prev,
+                const LeafNode **const next) const {
+    while (true) {
+      bool needs_restart = false;
+      bool obsolete = false;
+      const uint64_t version = leaf->latch_.ReadLockAllowObsoleteOrRestart(&needs_restart, &obsolete);
+      if (needs_restart) continue;
+
+      const uint16_t size = std::min<uint16_t>(leaf->size_, LEAF_CAPACITY);
+      entries->clear();
+      entries->reserve(size);
+      std::vector<uint16_t> page_positions;
+      for (uint16_t i = 0; i < size; i++) {
+        entries->emplace_back(leaf->keys_[i], leaf->values_[i]);
+        if (leaf->is_page_[i]) page_positions.emplace_back(i);
+      }
+      *prev = leaf->prev_;
+      *next = leaf->next_;
+      if (!leaf->latch_.Validate(version)) continue;
+      if (page_positions.empty()) return obsolete;
+
+      // The copy is consistent, so its page pointers can be followed now
+      std::vector<KeyValuePair> expanded;
+      std::vector<ValueType> values;
+      bool valid = true;
+      uint16_t begin = 0;
+      for (const uint16_t pos : page_positions) {
+        std::move(entries->begin() + begin, entries->begin() + pos, std::back_inserter(expanded));
+        begin = static_cast<uint16_t>(pos + 1);
+        values.clear();
+        if (!ReadPage(AsPage((*entries)[pos].second), &values)) {
+          valid = false;
+          break;
+        }
+        for (const auto &value : values) expanded.emplace_back((*entries)[pos].first, value);
+      }
+      if (!valid) continue;
+      std::move(entries->begin() + begin, entries->end(), std::back_inserter(expanded));
+      *entries = std::move(expanded);
+      return obsolete;
+    }
+  }
+
+  /**
+   * Optimistically copies the values of a value page.
+   * @param page page to read, which must have been reached through a validated read of a leaf
+   * @param[out] values the page's values are appended here
+   * @return false if the page changed while it was read, in which case the appended values must be discarded
+   */
+  static bool ReadPage(const ValuePage *const page, std::vector<ValueType> *const values) {
+    bool needs_restart = false;
+    const uint64_t version = page->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart) return false;
+    const uint32_t num_values = std::min(page->num_values_, page->capacity_);
+    values->insert(values->end(), page->Values(), page->Values() + num_values);
+    return page->latch_.Validate(version);
+  }
+
+  /**
+   * A single attempt at a conditional insert.
+   * @param predicate evaluated on all existing values of the key, nullptr if the insert is unconditional
+   * @return false if the operation needs to restart
+   */
+  bool TryInsert(const KeyType &key, const ValueType &value,
+                 const std::function<bool(const ValueType &)> *const predicate, bool *const predicate_satisfied,
+                 bool *const inserted) {
+    bool needs_restart = false;
+    BaseNode *node = root_.load();
+    uint64_t version = node->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart || node != root_.load()) return false;
+
+    InnerNode *parent = nullptr;
+    uint64_t parent_version = 0;
+    uint16_t parent_pos = 0;
+
+    while (!node->is_leaf_) {
+      auto *const inner = static_cast<InnerNode *>(node);
+
+      // Split full inner nodes on the way down, so that the parent of a splitting node always has room for a separator
+      if (inner->size_ == INNER_CAPACITY) {
+        if (!LockWithParent(parent, &parent_version, inner, &version)) return false;
+        KeyType separator;
+        InnerNode *const right = SplitInner(inner, &separator);
+        InstallSplit(parent, parent_pos, inner, separator, right);
+        inner->latch_.WriteUnlock();
+        if (parent != nullptr) parent->latch_.WriteUnlock();
+        return false;
+      }
+
+      if (parent != nullptr) {
+        parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+        if (needs_restart) return false;
+      }
+      parent = inner;
+      parent_version = version;
+
+      if (!Search(inner, version, key, false, &parent_pos)) return false;
+      node = inner->children_[parent_pos];
+      inner->latch_.ReadUnlockOrRestart(version, &needs_restart);
+      if (needs_restart) return false;
+      version = node->latch_.ReadLockOrRestart(&needs_restart);
+      if (needs_restart) return false;
+    }
+
+    auto *const leaf = static_cast<LeafNode *>(node);
+    if (leaf->size_ == LEAF_CAPACITY) {
+      if (!LockWithParent(parent, &parent_version, leaf, &version)) return false;
+      KeyType separator;
+      LeafNode *const right = SplitLeaf(leaf, &separator);
+      InstallSplit(parent, parent_pos, leaf, separator, right);
+      leaf->latch_.WriteUnlock();
+      if (parent != nullptr) parent->latch_.WriteUnlock();
+      return false;
+    }
+
+    if (parent != nullptr) {
+      parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+      if (needs_restart) return false;
+    }
+    leaf->latch_.UpgradeToWriteLockOrRestart(&version, &needs_restart);
+    if (needs_restart) return false;
+
+    // We now hold the latch on the key's target leaf, so no one else can add or remove entries for this key. Check the
+    // existing entries, starting with the ones in this leaf.
+    const uint16_t first = LowerBound(leaf, key);
+    uint16_t pos = first;
+    for (; pos < leaf->size_ && !KeyCmpLess(key, leaf->keys_[pos]); pos++) {
+      if (leaf->is_page_[pos]) {
+        InsertIntoPage(leaf, pos, value, predicate, predicate_satisfied, inserted);
+        leaf->latch_.WriteUnlock();
+        return true;
+      }
+      if (!CheckExisting(leaf->values_[pos], value, predicate, predicate_satisfied)) {
+        leaf->latch_.WriteUnlock();
+        return true;
+      }
+    }
+
+    // The key's entries may continue into the right siblings. These can still be split by other writers, so read them
+    // optimistically, unless they hold the key's value page, which is only modified under the latch of its leaf.
+    bool only_in_leaf = true;
+    if (pos == leaf->size_) {
+      std::vector<ValueType> values;
+      LeafNode *sibling = leaf->next_;
+      bool exhausted = true;
+      while (exhausted && sibling != nullptr) {
+        LeafNode *next;
+        bool has_page;
+        if (!CollectValues(sibling, key, &values, &exhausted, &next, &has_page)) continue;
+        if (has_page) {
+          const bool done = InsertIntoSiblingPage(sibling, key, value, predicate, predicate_satisfied, inserted);
+          leaf->latch_.WriteUnlock();
+          return done;
+        }
+        sibling = next;
+      }
+      for (const auto &existing : values) {
+        if (!CheckExisting(existing, value, predicate, predicate_satisfied)) {
+          leaf->latch_.WriteUnlock();
+          return true;
+        }
+      }
+      only_in_leaf = values.empty();
+    }
+
+    if (only_in_leaf && pos - first >= MAX_INLINE_VALUES) {
+      // Move the key's values into a value page, which takes the place of the first of its entries
+      const auto num_values = static_cast<uint32_t>(pos - first + 1);
+      ValuePage *const page = NewPage(PageCapacity(num_values));
+      std::copy(leaf->values_ + first, leaf->values_ + pos, page->Values());
+      page->Values()[num_values - 1] = value;
+      page->num_values_ = num_values;
+      std::sort(page->Values(), page->Values() + num_values, value_cmp_obj_);
+      leaf->values_[first] = PageAsValue(page);
+      leaf->is_page_[first] = true;
+      MoveEntries(leaf, pos, leaf->size_, leaf, static_cast<uint16_t>(first + 1));
+      leaf->size_ = static_cast<uint16_t>(leaf->size_ - (pos - first - 1));
+      leaf->latch_.WriteUnlock();
+      *inserted = true;
+      return true;
+    }
+
+    // Insert after the existing entries for this key, so that entries with equal keys stay in insertion order
+    MoveEntries(leaf, pos, leaf->size_, leaf, static_cast<uint16_t>(pos + 1));
+    leaf->keys_[pos] = key;
+    leaf->values_[pos] = value;
+    leaf->is_page_[pos] = false;
+    leaf->size_++;
+    leaf->latch_.WriteUnlock();
+    *inserted = true;
+    return true;
+  }
+
+  /**
+   * Inserts a value into the value page of a key whose entry is in a right sibling of the key's latched target leaf.
+   * @return false if the operation needs to restart
+   */
+  bool InsertIntoSiblingPage(LeafNode *const sibling, const KeyType &key, const ValueType &value,
+                             const std::function<bool(const ValueType &)> *const predicate,
+                             bool *const predicate_satisfied, bool *const inserted) {
+    // Latching a leaf to the right of the latched target leaf follows the left-to-right latch order
+    if (!sibling->latch_.WriteLock()) return false;
+    // The page's entry may have moved since the sibling was read
+    const uint16_t pos = LowerBound(sibling, key);
+    const bool found = pos < sibling->size_ && sibling->is_page_[pos] && !KeyCmpLess(key, sibling->keys_[pos]);
+    if (found) InsertIntoPage(sibling, pos, value, predicate, predicate_satisfied, inserted);
+    sibling->latch_.WriteUnlock();
+    return found;
+  }
+
+  /**
+   * Inserts a value into the value page of a latched leaf's entry, growing the page if it is full.
+   */
+  void InsertIntoPage(LeafNode *const leaf, const uint16_t pos, const ValueType &value,
+                      const std::function<bool(const ValueType &)> *const predicate, bool *const predicate_satisfied,
+                      bool *const inserted) {
+    ValuePage *page = AsPage(leaf->values_[pos]);
+    if (predicate != nullptr) {
+      for (uint32_t i = 0; i < page->num_values_; i++) {
+        if (!CheckExisting(page->Values()[i], value, predicate, predicate_satisfied)) return;
+      }
+    }
+    const auto index = static_cast<uint32_t>(
+        std::lower_bound(page->Values(), page->Values() + page->num_values_, value, value_cmp_obj_) - page->Values());
+    if (index < page->num_values_ && value_eq_obj_(page->Values()[index], value)) return;
+
+    if (page->num_values_ == page->capacity_) page = ResizePage(leaf, pos, PageCapacity(page->num_values_ + 1));
+    const bool UNUSED_ATTRIBUTE locked = page->latch_.WriteLock();
+    TERRIER_ASSERT(locked, "Value pages are never obsolete.");
+    std::copy_backward(page->Values() + index, page->Values() + page->num_values_,
+                       page->Values() + page->num_values_ + 1);
+    page->Values()[index] = value;
+    page->num_values_++;
+    page->latch_.WriteUnlock();
+    *inserted = true;
+  }
+
+  /**
+   * Checks an existing value of the key being inserted.
+   * @return false if the insert must fail
+   */
+  bool CheckExisting(const ValueType &existing, const ValueType &value,
+                     const std::function<bool(const ValueType &)> *const predicate,
+                     bool *const predicate_satisfied) const {
+    if (value_eq_obj_(existing, value)) return false;
+    if (predicate != nullptr && (*predicate)(existing)) {
+      *predicate_satisfied = true;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * A single attempt at a delete.
+   * @param[out] underfull set to true if the delete left the leaf it removed the entry from underfull
+   * @return false if the operation needs to restart
+   */
+  bool TryDelete(const KeyType &key, const ValueType &value, bool *const deleted, bool *const underfull) {
+    LeafNode *leaf;
+    uint64_t version;
+    if (!TryFindLeaf(&key, false, &leaf, &version)) return false;
+    bool needs_restart = false;
+    leaf->latch_.UpgradeToWriteLockOrRestart(&version, &needs_restart);
+    if (needs_restart) return false;
+
+    // Walk the key's entries with latch coupling from left to right, which is the global latch order for leaves
+    while (true) {
+      uint16_t pos = LowerBound(leaf, key);
+      for (; pos < leaf->size_ && !KeyCmpLess(key, leaf->keys_[pos]); pos++) {
+        if (leaf->is_page_[pos]) {
+          *deleted = DeleteFromPage(leaf, pos, value);
+          *underfull = leaf->size_ < LEAF_MIN_SIZE;
+          leaf->latch_.WriteUnlock();
+          return true;
+        }
+        if (value_eq_obj_(leaf->values_[pos], value)) {
+          MoveEntries(leaf, static_cast<uint16_t>(pos + 1), leaf->size_, leaf, pos);
+          leaf->size_--;
+          *underfull = leaf->size_ < LEAF_MIN_SIZE;
+          leaf->latch_.WriteUnlock();
+          *deleted = true;
+          return true;
+        }
+      }
+
+      LeafNode *const next = leaf->next_;
+      if (pos < leaf->size_ || next == nullptr) {
+        leaf->latch_.WriteUnlock();
+        *deleted = false;
+        return true;
+      }
+      const bool UNUSED_ATTRIBUTE locked = next->latch_.WriteLock();
+      TERRIER_ASSERT(locked, "The right sibling of a latched leaf is never obsolete.");
+      leaf->latch_.WriteUnlock();
+      leaf = next;
+    }
+  }
+
+  /**
+   * Deletes a value from the value page of a latched leaf's entry. Once few values are left, they move back into
+   * separate entries if the leaf has room for them, and a page that is mostly empty is shrunk.
+   * @return true if the value was found
+   */
+  bool DeleteFromPage(LeafNode *const leaf, const uint16_t pos, const ValueType &value) {
+    ValuePage *const page = AsPage(leaf->values_[pos]);
+    const auto index = static_cast<uint32_t>(
+        std::lower_bound(page->Values(), page->Values() + page->num_values_, value, value_cmp_obj_) - page->Values());
+    if (index == page->num_values_ || !value_eq_obj_(page->Values()[index], value)) return false;
+
+    const uint32_t num_left = page->num_values_ - 1;
+    if (num_left <= MAX_INLINE_VALUES / 2 && leaf->size_ - 1 + num_left <= LEAF_CAPACITY) {
+      // The page is left untouched for readers of removed leaves that still reference it
+      MoveEntries(leaf, static_cast<uint16_t>(pos + 1), leaf->size_, leaf, static_cast<uint16_t>(pos + num_left));
+      const KeyType key = leaf->keys_[pos];
+      for (uint32_t i = 0, j = pos; i < page->num_values_; i++) {
+        if (i == index) continue;
+        leaf->keys_[j] = key;
+        leaf->values_[j] = page->Values()[i];
+        leaf->is_page_[j] = false;
+        j++;
+      }
+      leaf->size_ = static_cast<uint16_t>(leaf->size_ - 1 + num_left);
+      RetireNode(page);
+      return true;
+    }
+
+    const bool UNUSED_ATTRIBUTE locked = page->latch_.WriteLock();
+    TERRIER_ASSERT(locked, "Value pages are never obsolete.");
+    std::copy(page->Values() + index + 1, page->Values() + page->num_values_, page->Values() + index);
+    page->num_values_--;
+    page->latch_.WriteUnlock();
+    if (PageCapacity(num_left) < page->capacity_ / 2) ResizePage(leaf, pos, PageCapacity(num_left));
+    return true;
+  }
+
+  /**
+   * Rebalances the path to a key, restarting after every change until no node on it needs to be merged or refilled.
+   * @param key key to descend towards. nullptr descends to the leftmost leaf.
+   * @param upper if true, descend to the rightmost leaf that may hold the key instead of the leftmost
+   * @return true if the leaf at the end of the path is left underfull because no sibling had room for its entries
+   */
+  bool Rebalance(const KeyType *const key, const bool upper) {
+    bool underfull = false;
+    while (!TryRebalance(key, upper, &underfull)) {
+    }
+    return underfull;
+  }
+
+  /**
+   * A single pass of rebalancing the path to a key. An inner root with a single child is replaced by the child, and the
+   * first underfull node on the way down is merged with or refilled from a sibling.
+   * @param[out] underfull set to true if the leaf at the end of the path is underfull and could not be merged
+   * @return false if the tree changed or the pass needs to restart
+   */
+  bool TryRebalance(const KeyType *const key, const bool upper, bool *const underfull) {
+    bool needs_restart = false;
+    BaseNode *node = root_.load();
+    uint64_t version = node->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart || node != root_.load()) return false;
+
+    if (!node->is_leaf_ && node->size_ == 0) {
+      node->latch_.UpgradeToWriteLockOrRestart(&version, &needs_restart);
+      if (needs_restart) return false;
+      // The root only changes while the old root is latched, so it is still this node
+      TERRIER_ASSERT(node == root_.load(), "Root changed while it was latched.");
+      root_.store(static_cast<InnerNode *>(node)->children_[0]);
+      node->latch_.WriteUnlockObsolete();
+      RetireNode(node);
+      return false;
+    }
+
+    InnerNode *parent = nullptr;
+    uint64_t parent_version = 0;
+    uint16_t parent_pos = 0;
+    while (!node->is_leaf_) {
+      auto *const inner = static_cast<InnerNode *>(node);
+      if (parent != nullptr && parent->size_ > 0 && inner->size_ < INNER_MIN_SIZE) {
+        RebalanceInner(parent, parent_version, parent_pos, inner, version);
+        return false;
+      }
+
+      if (parent != nullptr) {
+        parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+        if (needs_restart) return false;
+      }
+      parent = inner;
+      parent_version = version;
+
+      parent_pos = 0;
+      if (key != nullptr && !Search(inner, version, *key, upper, &parent_pos)) return false;
+      node = inner->children_[parent_pos];
+      inner->latch_.ReadUnlockOrRestart(version, &needs_restart);
+      if (needs_restart) return false;
+      version = node->latch_.ReadLockOrRestart(&needs_restart);
+      if (needs_restart) return false;
+    }
+
+    auto *const leaf = static_cast<LeafNode *>(node);
+    if (parent != nullptr && parent->size_ > 0 && leaf->size_ < LEAF_MIN_SIZE) {
+      return TryMergeLeaf(parent, parent_version, parent_pos, leaf, version, underfull);
+    }
+    *underfull = parent != nullptr && leaf->size_ < LEAF_MIN_SIZE;
+    if (parent != nullptr) {
+      parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+      if (needs_restart) return false;
+    }
+    leaf->latch_.ReadUnlockOrRestart(version, &needs_restart);
+    return !needs_restart;
+  }
+
+  /**
+   * Merges an underfull inner node with a sibling, or evens out their sizes if they do not fit into one node. The node
+   * and its parent are read optimistically at the given versions; nothing happens if they changed since.
+   */
+  void RebalanceInner(InnerNode *const parent, uint64_t parent_version, const uint16_t pos, InnerNode *const node,
+                      uint64_t version) {
+    if (!LockWithParent(parent, &parent_version, node, &version)) return;
+    // Prefer the left sibling, and take the right one for the first child
+    const uint16_t right_pos = pos > 0 ? pos : static_cast<uint16_t>(pos + 1);
+    auto *const left = static_cast<InnerNode *>(parent->children_[right_pos - 1]);
+    auto *const right = static_cast<InnerNode *>(parent->children_[right_pos]);
+    bool needs_restart = false;
+    (node == left ? right : left)->latch_.WriteLockOrRestart(&needs_restart);
+    if (needs_restart) {
+      node->latch_.WriteUnlock();
+      parent->latch_.WriteUnlock();
+      return;
+    }
+
+    if (left->size_ + right->size_ + 1 <= INNER_MERGE_SIZE) {
+      MergeInner(parent, right_pos, left, right);
+      right->latch_.WriteUnlockObsolete();
+      RetireNode(right);
+    } else {
+      RedistributeInner(parent, right_pos, left, right);
+      right->latch_.WriteUnlock();
+    }
+    left->latch_.WriteUnlock();
+    parent->latch_.WriteUnlock();
+  }
+
+  /**
+   * Merges an underfull leaf with a sibling it fits together with. The leaf and its parent are read optimistically at
+   * the given versions.
+   * @param[out] underfull set to true if neither sibling has room for the leaf's entries
+   * @return false if the tree changed or the operation needs to restart
+   */
+  bool TryMergeLeaf(InnerNode *const parent, uint64_t parent_version, const uint16_t pos, LeafNode *const leaf,
+                    uint64_t version, bool *const underfull) {
+    // The sizes of the siblings are only estimates until they are latched, the merge checks them again
+    uint16_t right_pos = 0;
+    if (pos > 0 && parent->children_[pos - 1]->size_ + leaf->size_ <= LEAF_MERGE_SIZE) {
+      right_pos = pos;
+    } else if (pos < parent->size_ && parent->children_[pos + 1]->size_ + leaf->size_ <= LEAF_MERGE_SIZE) {
+      right_pos = static_cast<uint16_t>(pos + 1);
+    }
+    bool needs_restart = false;
+    if (right_pos == 0) {
+      parent->latch_.ReadUnlockOrRestart(parent_version, &needs_restart);
+      leaf->latch_.ReadUnlockOrRestart(version, &needs_restart);
+      *underfull = true;
+      return !needs_restart;
+    }
+
+    if (!LockWithParent(parent, &parent_version, leaf, &version)) return false;
+    auto *const left = static_cast<LeafNode *>(parent->children_[right_pos - 1]);
+    auto *const right = static_cast<LeafNode *>(parent->children_[right_pos]);
+    LeafNode *const sibling = leaf == left ? right : left;
+    sibling->latch_.WriteLockOrRestart(&needs_restart);
+    if (needs_restart) {
+      leaf->latch_.WriteUnlock();
+      parent->latch_.WriteUnlock();
+      return false;
+    }
+
+    if (left->size_ + right->size_ <= LEAF_MERGE_SIZE) {
+      MergeLeaves(parent, right_pos, left, right);
+      right->latch_.WriteUnlockObsolete();
+      RetireNode(right);
+    } else {
+      // The sibling grew since its size was estimated
+      right->latch_.WriteUnlock();
+    }
+    left->latch_.WriteUnlock();
+    parent->latch_.WriteUnlock();
+    return false;
+  }
+
+  /**
+   * Appends a latched leaf's entries to its latched left sibling and unlinks it from the tree. The removed leaf keeps
+   * its entries and sibling links, so that readers who reach it through a stale link read it as a frozen snapshot. The
+   * caller marks it obsolete and retires it.
+   */
+  void MergeLeaves(InnerNode *const parent, const uint16_t right_pos, LeafNode *const left, LeafNode *const right) {
+    MoveEntries(right, 0, right->size_, left, left->size_);
+    left->size_ = static_cast<uint16_t>(left->size_ + right->size_);
+    left->next_ = right->next_;
+    if (right->next_ != nullptr) {
+      // Latching the right neighbour while holding this leaf follows the left-to-right latch order
+      const bool UNUSED_ATTRIBUTE locked = right->next_->latch_.WriteLock();
+      TERRIER_ASSERT(locked, "The right sibling of a latched leaf is never obsolete.");
+      right->next_->prev_ = left;
+      right->next_->latch_.WriteUnlock();
+    }
+    RemoveChild(parent, right_pos);
+  }
+
+  /**
+   * Appends the separator and the contents of a latched inner node to its latched left sibling, and removes it from the
+   * parent. The caller marks it obsolete and retires it.
+   */
+  void MergeInner(InnerNode *const parent, const uint16_t right_pos, InnerNode *const left, InnerNode *const right) {
+    left->keys_[left->size_] = parent->keys_[right_pos - 1];
+    std::copy(right->keys_, right->keys_ + right->size_, left->keys_ + left->size_ + 1);
+    std::copy(right->children_, right->children_ + right->size_ + 1, left->children_ + left->size_ + 1);
+    left->size_ = static_cast<uint16_t>(left->size_ + right->size_ + 1);
+    RemoveChild(parent, right_pos);
+  }
+
+  /**
+   * Evens out the sizes of two latched adjacent inner nodes by rotating keys and children through their separator.
+   */
+  void RedistributeInner(InnerNode *const parent, const uint16_t right_pos, InnerNode *const left,
+                         InnerNode *const right) {
+    std::vector<KeyType> keys(left->keys_, left->keys_ + left->size_);
+    keys.emplace_back(parent->keys_[right_pos - 1]);
+    keys.insert(keys.end(), right->keys_, right->keys_ + right->size_);
+    std::vector<BaseNode *> children(left->children_, left->children_ + left->size_ + 1);
+    children.insert(children.end(), right->children_, right->children_ + right->size_ + 1);
+
+    const auto mid = static_cast<uint16_t>(keys.size() / 2);
+    std::copy(keys.cbegin(), keys.cbegin() + mid, left->keys_);
+    std::copy(children.cbegin(), children.cbegin() + mid + 1, left->children_);
+    left->size_ = mid;
+    parent->keys_[right_pos - 1] = keys[mid];
+    std::copy(keys.cbegin() + mid + 1, keys.cend(), right->keys_);
+    std::copy(children.cbegin() + mid + 1, children.cend(), right->children_);
+    right->size_ = static_cast<uint16_t>(keys.size() - mid - 1);
+  }
+
+  /**
+   * Removes a child (other than the first) and the separator to its left from a latched inner node.
+   */
+  static void RemoveChild(InnerNode *const parent, const uint16_t pos) {
+    TERRIER_ASSERT(pos > 0 && pos <= parent->size_, "Only a child with a separator to its left can be removed.");
+    std::copy(parent->keys_ + pos, parent->keys_ + parent->size_, parent->keys_ + pos - 1);
+    std::copy(parent->children_ + pos + 1, parent->children_ + parent->size_ + 1, parent->children_ + pos);
+    parent->size_--;
+  }
+
+  /**
+   * A single attempt at repacking the leaves below the bottom-level inner node that the rightmost descent towards a key
+   * reaches.
+   * @param key key to descend towards. nullptr descends to the leftmost bottom-level inner node.
+   * @param[out] next_key upper bound of the keys below the inner node, which leads to the next one
+   * @param[out] has_next_key set to false if the inner node is the rightmost one
+   * @param[out] num_removed number of leaves removed
+   * @return false if the operation needs to restart
+   */
+  bool TryCompactLeaves(const KeyType *const key, KeyType *const next_key, bool *const has_next_key,
+                        uint32_t *const num_removed) {
+    *has_next_key = false;
+    *num_removed = 0;
+    bool needs_restart = false;
+    BaseNode *node = root_.load();
+    uint64_t version = node->latch_.ReadLockOrRestart(&needs_restart);
+    if (needs_restart || node != root_.load()) return false;
+    if (node->is_leaf_) return true;
+
+    // The separators closest to the key on the way down bound the key ranges of the nodes below them, so the last one
+    // is the upper bound of the bottom-level inner node
+    auto *parent = static_cast<InnerNode *>(node);
+    while (true) {
+      uint16_t pos = 0;
+      if (key != nullptr && !Search(parent, version, *key, true, &pos)) return false;
+      if (pos < parent->size_) {
+        *next_key = parent->keys_[pos];
+        *has_next_key = true;
+      }
+      BaseNode *const child = parent->children_[pos];
+      parent->latch_.ReadUnlockOrRestart(version, &needs_restart);
+      if (needs_restart) return false;
+      if (child->is_leaf_) break;
+      parent = static_cast<InnerNode *>(child);
+      version = parent->latch_.ReadLockOrRestart(&needs_restart);
+      if (needs_restart) return false;
+    }
+
+    parent->latch_.UpgradeToWriteLockOrRestart(&version, &needs_restart);
+    if (needs_restart) return false;
+    std::vector<LeafNode *> children;
+    for (uint16_t i = 0; i <= parent->size_; i++) children.emplace_back(static_cast<LeafNode *>(parent->children_[i]));
+    const auto num_children = static_cast<uint16_t>(children.size());
+    const auto num_leaves_for = [](const size_t num_entries) {
+      return std::max<size_t>(1, (num_entries + LEAF_MERGE_SIZE - 1) / LEAF_MERGE_SIZE);
+    };
+    const auto worth_repacking = [&](const size_t num_entries) {
+      return num_leaves_for(num_entries) < num_children && num_entries < num_children * size_t{LEAF_CAPACITY} / 2;
+    };
+
+    // Decide optimistically first, latching the leaves would invalidate every reader's copy of them
+    size_t num_entries = 0;
+    for (uint16_t i = 0; i < num_children && !needs_restart; i++) {
+      const uint64_t leaf_version = children[i]->latch_.ReadLockOrRestart(&needs_restart);
+      num_entries += children[i]->size_;
+      children[i]->latch_.ReadUnlockOrRestart(leaf_version, &needs_restart);
+    }
+    if (needs_restart || !worth_repacking(num_entries)) {
+      parent->latch_.WriteUnlock();
+      return !needs_restart;
+    }
+
+    for (uint16_t i = 0; i < num_children; i++) {
+      children[i]->latch_.WriteLockOrRestart(&needs_restart);
+      if (needs_restart) {
+        for (uint16_t j = 0; j < i; j++) children[j]->latch_.WriteUnlock();
+        parent->latch_.WriteUnlock();
+        return false;
+      }
+    }
+    LeafNode *const after = children[num_children - 1]->next_;
+    if (after != nullptr) {
+      // Latching the right neighbour while holding the leaves to its left follows the left-to-right latch order
+      const bool UNUSED_ATTRIBUTE locked = after->latch_.WriteLock();
+      TERRIER_ASSERT(locked, "The right sibling of a latched leaf is never obsolete.");
+    }
+
+    std::vector<LeafEntry> entries;
+    for (const LeafNode *const leaf : children) {
+      for (uint16_t i = 0; i < leaf->size_; i++) {
+        entries.push_back({leaf->keys_[i], leaf->values_[i], leaf->is_page_[i]});
+      }
+    }
+    std::vector<LeafNode *> leaves;
+    if (worth_repacking(entries.size())) {
+      // The first leaf is refilled in place, and the entries of the others move into new leaves, which leaves the old
+      // leaves untouched as frozen snapshots
+      const size_t num_leaves = num_leaves_for(entries.size());
+      leaves.emplace_back(children[0]);
+      for (size_t i = 1; i < num_leaves; i++) leaves.emplace_back(NewNode<LeafNode>());
+      for (size_t i = 0; i < num_leaves; i++) {
+        const size_t begin = i * entries.size() / num_leaves;
+        const size_t end = (i + 1) * entries.size() / num_leaves;
+        LeafNode *const leaf = leaves[i];
+        FillLeaf(leaf, entries.data() + begin, entries.data() + end);
+        if (i > 0) {
+          leaf->prev_ = leaves[i - 1];
+          leaves[i - 1]->next_ = leaf;
+          parent->keys_[i - 1] = leaf->keys_[0];
+        }
+      }
+      leaves.back()->next_ = after;
+      if (after != nullptr) after->prev_ = leaves.back();
+      std::copy(leaves.cbegin() + 1, leaves.cend(), parent->children_ + 1);
+    }
+
+    if (after != nullptr) after->latch_.WriteUnlock();
+    if (!leaves.empty()) {
+      *num_removed = static_cast<uint32_t>(num_children - leaves.size());
+      for (uint16_t i = 1; i < num_children; i++) {
+        children[i]->latch_.WriteUnlockObsolete();
+        RetireNode(children[i]);
+      }
+      parent->size_ = static_cast<uint16_t>(leaves.size() - 1);
+    } else {
+      for (uint16_t i = 1; i < num_children; i++) children[i]->latch_.WriteUnlock();
+    }
+    children[0]->latch_.WriteUnlock();
+    parent->latch_.WriteUnlock();
+    return true;
+  }
+
+  /**
+   * Upgrades the optimistic reads of a node and its parent to write latches in preparation of splitting or merging the
+   * node.
+   * @return false if either latch could not be acquired, in which case no latch is held
+   */
+  bool LockWithParent(InnerNode *const parent, uint64_t *const parent_version, BaseNode *const node,
+                    uint64_t *const version) {
+    bool needs_restart = false;
+    if (parent != nullptr) {
+      parent->latch_.UpgradeToWriteLockOrRestart(parent_version, &needs_restart);
+      if (needs_restart) return false;
+    }
+    node->latch_.UpgradeToWriteLockOrRestart(version, &needs_restart);
+    if (needs_restart) {
+      if (parent != nullptr) parent->latch_.WriteUnlock();
+      return false;
+    }
+    if (parent == nullptr && node != root_.load()) {
+      node->latch_.WriteUnlock();
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Moves the upper half of a latched inner node into a new right sibling.
+   * @param node node to split
+   * @param[out] separator key to install in the parent between the two halves
+   * @return the new right sibling
+   */
+  InnerNode *SplitInner(InnerNode *const node, KeyType *const separator) {
+    auto *const right = NewNode<InnerNode>();
+    const uint16_t mid = static_cast<uint16_t>(node->size_ / 2);
+    right->size_ = static_cast<uint16_t>(node->size_ - mid - 1);
+    std::copy(node->keys_ + mid + 1, node->keys_ + node->size_, right->keys_);
+    std::copy(node->children_ + mid + 1, node->children_ + node->size_ + 1, right->children_);
+    *separator = node->keys_[mid];
+    node->size_ = mid;
+    return right;
+  }
+
+  /**
+   * Moves the upper half of a latched leaf into a new right sibling and links it into the leaf level.
+   * @param leaf leaf to split
+   * @param[out] separator key to install in the parent between the two halves
+   * @return the new right sibling
+   */
+  LeafNode *SplitLeaf(LeafNode *const leaf, KeyType *const separator) {
+    auto *const right = NewNode<LeafNode>();
+    const uint16_t mid = SplitPoint(leaf);
+    right->size_ = static_cast<uint16_t>(leaf->size_ - mid);
+    MoveEntries(leaf, mid, leaf->size_, right, 0);
+    right->prev_ = leaf;
+    right->next_ = leaf->next_;
+    if (right->next_ != nullptr) {
+      // Latching the right neighbour while holding this leaf follows the left-to-right latch order
+      const bool UNUSED_ATTRIBUTE locked = right->next_->latch_.WriteLock();
+      TERRIER_ASSERT(locked, "The right sibling of a latched leaf is never obsolete.");
+      right->next_->prev_ = right;
+      right->next_->latch_.WriteUnlock();
+    }
+    leaf->next_ = right;
+    leaf->size_ = mid;
+    *separator = right->keys_[0];
+    return right;
+  }
+
+  /**
+   * Chooses where to split a latched leaf: in the middle, or at the nearest boundary between two keys within a quarter
+   * of the leaf from it. Keeping a key's entries in one leaf lets them move into a value page once there are many.
+   */
+  uint16_t SplitPoint(const LeafNode *const leaf) const {
+    const auto mid = static_cast<uint16_t>(leaf->size_ / 2);
+    for (uint16_t distance = 0; distance <= leaf->size_ / 4; distance++) {
+      for (const int32_t pos : {mid - distance, mid + distance}) {
+        if (pos > 0 && pos < leaf->size_ && KeyCmpLess(leaf->keys_[pos - 1], leaf->keys_[pos])) {
+          return static_cast<uint16_t>(pos);
+        }
+      }
+    }
+    return mid;
+  }
+
+  /**
+   * Installs the separator and new right sibling produced by a split into the (latched) parent, growing a new root if
+   * the split node was the root.
+   */
+  void InstallSplit(InnerNode *const parent, const uint16_t pos, BaseNode *const left, const KeyType &separator,
+                    BaseNode *const right) {
+    if (parent == nullptr) {
+      auto *const new_root = NewNode<InnerNode>();
+      new_root->keys_[0] = separator;
+      new_root->children_[0] = left;
+      new_root->children_[1] = right;
+      new_root->size_ = 1;
+      root_.store(new_root);
+      return;
+    }
+    TERRIER_ASSERT(parent->size_ < INNER_CAPACITY, "Full inner nodes should have been split on the way down.");
+    TERRIER_ASSERT(parent->children_[pos] == left, "Split node should be the child that was descended into.");
+    std::copy_backward(parent->keys_ + pos, parent->keys_ + parent->size_, parent->keys_ + parent->size_ + 1);
+    std::copy_backward(parent->children_ + pos + 1, parent->children_ + parent->size_ + 1,
+                       parent->children_ + parent->size_ + 2);
+    parent->keys_[pos] = separator;
+    parent->children_[pos + 1] = right;
+    parent->size_++;
+  }
+
+  /**
+   * Sorts entries by key. Large batches are cut into one chunk per hardware thread, the chunks are sorted in parallel,
+   * and then sorted runs are merged pairwise, also in parallel.
+   */
+  void SortEntries(std::vector<KeyValuePair> *const entries) const {
+    const auto cmp = [this](const KeyValuePair &lhs, const KeyValuePair &rhs) {
+      return KeyCmpLess(lhs.first, rhs.first);
+    };
+    const size_t num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t num_chunks = std::clamp<size_t>(entries->size() / BULK_LOAD_MIN_SORT_CHUNK, 1, num_threads);
+    KeyValuePair *const data = entries->data();
+    std::vector<size_t> bounds(num_chunks + 1);
+    for (size_t i = 0; i <= num_chunks; i++) bounds[i] = i * entries->size() / num_chunks;
+
+    tbb::parallel_for(size_t(0), num_chunks,
+                      [&](const size_t i) { ips4o::sort(data + bounds[i], data + bounds[i + 1], cmp); });
+    for (size_t width = 1; width < num_chunks; width *= 2) {
+      tbb::parallel_for(size_t(0), num_chunks, 2 * width, [&](const size_t i) {
+        if (i + width >= num_chunks) return;
+        const size_t end = std::min(i + 2 * width, num_chunks);
+        std::inplace_merge(data + bounds[i], data + bounds[i + width], data + bounds[end], cmp);
+      });
+    }
+  }
+
+  /**
+   * Moves the entries [begin, end) of a leaf to a position in the same or another leaf. Overlapping ranges are allowed.
+   */
+  static void MoveEntries(const LeafNode *const from, const uint16_t begin, const uint16_t end, LeafNode *const to,
+                          const uint16_t dest) {
+    if (from != to || dest <= begin) {
+      std::copy(from->keys_ + begin, from->keys_ + end, to->keys_ + dest);
+      std::copy(from->values_ + begin, from->values_ + end, to->values_ + dest);
+      std::copy(from->is_page_ + begin, from->is_page_ + end, to->is_page_ + dest);
+    } else {
+      const auto dest_end = static_cast<uint16_t>(dest + end - begin);
+      std::copy_backward(from->keys_ + begin, from->keys_ + end, to->keys_ + dest_end);
+      std::copy_backward(from->values_ + begin, from->values_ + end, to->values_ + dest_end);
+      std::copy_backward(from->is_page_ + begin, from->is_page_ + end, to->is_page_ + dest_end);
+    }
+  }
+
+  /**
+   * Replaces the contents of a leaf with staged entries.
+   */
+  static void FillLeaf(LeafNode *const leaf, const LeafEntry *const begin, const LeafEntry *const end) {
+    for (const LeafEntry *entry = begin; entry != end; entry++) {
+      const auto pos = static_cast<uint16_t>(entry - begin);
+      leaf->keys_[pos] = entry->key_;
+      leaf->values_[pos] = entry->value_;
+      leaf->is_page_[pos] = entry->is_page_;
+    }
+    leaf->size_ = static_cast<uint16_t>(end - begin);
+  }
+
+  /**
+   * @return the value page whose pointer is stored in place of an entry's value
+   */
+  static ValuePage *AsPage(const ValueType &value) {
+    ValuePage *page;
+    std::memcpy(&page, &value, sizeof(page));
+    return page;
+  }
+
+  /**
+   * @return an entry's value holding a pointer to a value page
+   */
+  static ValueType PageAsValue(ValuePage *const page) {
+    static_assert(std::is_trivially_copyable_v<ValueType>, "The pointer is copied into the value's bytes.");
+    ValueType value{};
+    // Going through void * tells the compiler that overwriting the bytes of a non-trivial class such as TupleSlot is
+    // intended
+    std::memcpy(static_cast<void *>(&value), &page, sizeof(page));
+    return value;
+  }
+
+  /**
+   * @return capacity of a new value page for the given number of values, which leaves room to grow before the page
+   *         needs to be copied again
+   */
+  static uint32_t PageCapacity(const uint32_t num_values) { return std::max(VALUE_PAGE_MIN_CAPACITY, 2 * num_values); }
+
+  /**
+   * Copies the value page of a latched leaf's entry into a new page of a different capacity, and retires the old page.
+   * The old page is not modified, so readers that still reference it continue to see consistent values.
+   * @return the new page
+   */
+  ValuePage *ResizePage(LeafNode *const leaf, const uint16_t pos, const uint32_t capacity) {
+    ValuePage *const old_page = AsPage(leaf->values_[pos]);
+    TERRIER_ASSERT(old_page->num_values_ <= capacity, "Values must fit into the new page.");
+    ValuePage *const page = NewPage(capacity);
+    std::copy(old_page->Values(), old_page->Values() + old_page->num_values_, page->Values());
+    page->num_values_ = old_page->num_values_;
+    leaf->values_[pos] = PageAsValue(page);
+    RetireNode(old_page);
+    return page;
+  }
+
+  /**
+   * @return number of slots to fill in a node of the given capacity when bulk loading
+   */
+  static size_t FillCount(const size_t capacity, const double fill_factor, const size_t min_count) {
+    return std::clamp<size_t>(static_cast<size_t>(fill_factor * static_cast<double>(capacity)), min_count, capacity);
+  }
+
+  /**
+   * Allocates a node and accounts for it in the heap usage.
+   */
+  template <typename Node>
+  Node *NewNode() {
+    heap_usage_.fetch_add(sizeof(Node), std::memory_order_relaxed);
+    return new Node;
+  }
+
+  /**
+   * Allocates an empty value page and accounts for it in the heap usage.
+   */
+  ValuePage *NewPage(const uint32_t capacity) {
+    const size_t size = sizeof(ValuePage) + capacity * sizeof(ValueType);
+    heap_usage_.fetch_add(size, std::memory_order_relaxed);
+    return new (new std::byte[size]) ValuePage(capacity);
+  }
+
+  /**
+   * Frees a node or value page immediately. Only safe for nodes that no other thread can be reading. Freeing a leaf
+   * does not free the value pages it references, which may be shared with the leaf that took over its entries.
+   */
+  void FreeNode(BaseNode *const node) {
+    if (node->is_value_page_) {
+      auto *const page = static_cast<ValuePage *>(node);
+      heap_usage_.fetch_sub(sizeof(ValuePage) + page->capacity_ * sizeof(ValueType), std::memory_order_relaxed);
+      page->~ValuePage();
+      delete[] reinterpret_cast<std::byte *>(page);
+    } else if (node->is_leaf_) {
+      heap_usage_.fetch_sub(sizeof(LeafNode), std::memory_order_relaxed);
+      delete static_cast<LeafNode *>(node);
+    } else {
+      heap_usage_.fetch_sub(sizeof(InnerNode), std::memory_order_relaxed);
+      delete static_cast<InnerNode *>(node);
+    }
+  }
+
+  /**
+   * Hands a node that was unlinked from the tree over to garbage collection, which frees it once no operation can
+   * still be reading it.
+   */
+  void RetireNode(BaseNode *const node) {
+    common::SpinLatch::ScopedSpinLatch guard(&retired_latch_);
+    retired_.emplace_back(node);
+  }
+
+  /**
+   * Frees a node and all of its descendants, including value pages.
+   */
+  void FreeSubtree(BaseNode *const node) {
+    if (node->is_leaf_) {
+      auto *const leaf = static_cast<LeafNode *>(node);
+      for (uint16_t i = 0; i < leaf->size_; i++) {
+        if (leaf->is_page_[i]) FreeNode(AsPage(leaf->values_[i]));
+      }
+    } else {
+      auto *const inner = static_cast<InnerNode *>(node);
+      for (uint16_t i = 0; i <= inner->size_; i++) FreeSubtree(inner->children_[i]);
+    }
+    FreeNode(node);
+  }
+
+  const KeyComparator key_cmp_obj_;
+  const KeyEqualityChecker key_eq_obj_;
+  const ValueEqualityChecker value_eq_obj_;
+  const ValueComparator value_cmp_obj_;
+  // Declared before root_, which is allocated through NewNode
+  std::atomic<size_t> heap_usage_{0};
+  std::atomic<BaseNode *> root_;
+  // Deletes that left a leaf underfull without being able to merge it since the last Compact
+  std::atomic<uint32_t> underfull_leaves_{0};
+
+  // Nodes retired since the last garbage collection, appended to by any thread
+  common::SpinLatch retired_latch_;
+  std::vector<BaseNode *> retired_;
+  // Nodes retired before the last garbage collection, and batches of older nodes with the epoch they were stamped with.
+  // Only accessed by garbage collection.
+  std::vector<BaseNode *> unstamped_;
+  std::deque<std::pair<uint64_t, std::vector<BaseNode *>>> stamped_;
+};
 
 }  // namespace terrier::storage::index
@@ -17,32 +17,139 @@ template <uint8_t KeySize>
 class CompactIntsKey;
 template <uint16_t KeySize>
 class GenericKey;
+template <uint16_t KeySize>
+class NormalizedKey;
+template <typename KeyType>
+class BPlusTreeIndex;
+
+/**
+ * Cursor that follows the sibling links of the BPlusTree lazily, so it holds a copy of at most one leaf no matter
+ * how large the range is. The cursor only steps onto the next entry when asked for more slots, which means that a
+ * scan that stops at its limit never reads the leaf after its last result.
+ */
+template <typename KeyType>
+class BPlusTreeScanCursor final : public IndexScanCursor {
+ public:
+  /**
+   * Creates a cursor that starts on the entry the iterator is positioned on.
+   * @param tree tree to scan
+   * @param metadata metadata of the index, used to compare partial keys
+   * @param txn txn context for the calling txn, used for visibility checks
+   * @param itr iterator positioned on the first entry to consider
+   * @param ascending true to walk towards larger keys, false to walk towards smaller keys
+   * @param has_end_key false if an ascending scan has no upper bound
+   * @param end_key the last key of the range, inclusive
+   * @param num_attrs number of attributes of end_key to compare for ascending scans
+   * @param limit maximum number of slots to return in total, 0 for no limit
+   */
+  BPlusTreeScanCursor(const BPlusTree<KeyType, TupleSlot> *const tree, const IndexMetadata *const metadata,
+                      const transaction::TransactionContext &txn, typename BPlusTree<KeyType, TupleSlot>::Iterator itr,
+                      const bool ascending, const bool has_end_key, const KeyType &end_key, const uint32_t num_attrs,
+                      const uint32_t limit)
+      : tree_(tree),
+        metadata_(metadata),
+        txn_(&txn),
+        itr_(std::move(itr)),
+        ascending_(ascending),
+        has_end_key_(has_end_key),
+        end_key_(end_key),
+        num_attrs_(num_attrs),
+        limit_(limit) {}
+
+  bool Next(std::vector<TupleSlot> *const batch, const uint32_t max_slots) final {
+    TERRIER_ASSERT(max_slots > 0, "Batches must hold at least one slot.");
+    batch->clear();
+    while (batch->size() < max_slots && Fetch()) {
+      if (IsVisible()) {
+        batch->emplace_back(itr_->second);
+        returned_++;
+      }
+    }
+    return !batch->empty();
+  }
+
+  /**
+   * Appends every remaining slot of the range to the given vector.
+   * @param[out] value_list vector to append to
+   */
+  void DrainInto(std::vector<TupleSlot> *const value_list) {
+    while (Fetch()) {
+      if (IsVisible()) {
+        value_list->emplace_back(itr_->second);
+        returned_++;
+      }
+    }
+  }
+
+ private:
+  bool IsVisible() const { return BPlusTreeIndex<KeyType>::IsVisible(*txn_, itr_->second); }
+
+  // Moves onto the next entry of the range, returning false if there are no more entries or the limit was reached
+  bool Fetch() {
+    // Limit of 0 indicates "no limit"
+    if (limit_ != 0 && returned_ >= limit_) return false;
+    if (positioned_) {
+      if (ascending_) {
+        ++itr_;
+      } else {
+        --itr_;
+      }
+    }
+    positioned_ = true;
+    if (ascending_) {
+      return !itr_.IsEnd() && (!has_end_key_ || itr_->first.PartialLessThan(end_key_, metadata_, num_attrs_));
+    }
+    return !itr_.IsREnd() && tree_->KeyCmpGreaterEqual(itr_->first, end_key_);
+  }
+
+  const BPlusTree<KeyType, TupleSlot> *const tree_;
+  const IndexMetadata *const metadata_;
+  const transaction::TransactionContext *const txn_;
+  typename BPlusTree<KeyType, TupleSlot>::Iterator itr_;
+  const bool ascending_;
+  const bool has_end_key_;
+  const KeyType end_key_;
+  const uint32_t num_attrs_;
+  const uint32_t limit_;
+  uint32_t returned_ = 0;
+  // False until the first Fetch, which must consider the entry the iterator starts on
+  bool positioned_ = false;
+};
 
 /**
- * Wrapper around 15-721 Project 2's B+Tree
+ * Wrapper around the optimistic lock coupling BPlusTree.
  * @tparam KeyType the type of keys stored in the BPlusTree
  */
 template <typename KeyType>
 class BPlusTreeIndex final : public Index {
   friend class IndexBuilder;
+  // The scan cursor shares the index's visibility check
+  friend class BPlusTreeScanCursor<KeyType>;
 
  private:
-  explicit BPlusTreeIndex(IndexMetadata metadata)
-      : Index(std::move(metadata)), bplustree_{new BPlusTree<KeyType, TupleSlot>} {}
+  BPlusTreeIndex(IndexMetadata metadata, const double bulk_load_fill_factor)
+      : Index(std::move(metadata)),
+        bplustree_{new BPlusTree<KeyType, TupleSlot>},
+        bulk_load_fill_factor_(bulk_load_fill_factor) {}
 
   const std::unique_ptr<BPlusTree<KeyType, TupleSlot>> bplustree_;
+  const double bulk_load_fill_factor_;
 
  public:
   IndexType Type() const final { return IndexType::BPLUSTREE; }
 
-  void PerformGarbageCollection() final {
-    // FIXME(15-721 project2): invoke garbage collection on the underlying data structure
+  void PerformGarbageCollection(const transaction::timestamp_t oldest_txn,
+                                const transaction::timestamp_t current_time) final {
+    // Operations on the tree run either inside a txn, or within a GC pass: Compact on the worker that handles this
+    // index right here, and deletes deferred by txns on the GC thread after every worker of the pass has finished.
+    // Neither overlaps this call, and passes do not overlap each other, so the only operations that can still hold a
+    // node that was unlinked before current_time are txns, and it can be freed once every txn that started before
+    // current_time has finished. Compacting first lets the leaves it removes be stamped in this pass.
+    if (bplustree_->NeedsCompaction()) bplustree_->Compact();
+    bplustree_->PerformGarbageCollection(!oldest_txn, !current_time);
   }
 
-  size_t GetHeapUsage() const final {
-    // FIXME(15-721 project2): access the underlying data structure and report the heap usage
-    return 0;
-  }
+  size_t GetHeapUsage() const final { return bplustree_->GetHeapUsage(); }
 
   bool Insert(const common::ManagedPointer<transaction::TransactionContext> txn, const ProjectedRow &tuple,
               const TupleSlot location) final {
@@ -50,18 +157,14 @@ class BPlusTreeIndex final : public Index {
                    "This Insert is designed for secondary indexes with no uniqueness constraints.");
     KeyType index_key;
     index_key.SetFromProjectedRow(tuple, metadata_, metadata_.GetSchema().GetColumns().size());
-    // FIXME(15-721 project2): perform a non-unique unconditional insert into the underlying data structure of the
-    // key/value pair
-    const bool UNUSED_ATTRIBUTE result = true;
+    const bool result = bplustree_->Insert(index_key, location, false);
 
     TERRIER_ASSERT(
         result,
         "non-unique index shouldn't fail to insert. If it did, something went wrong deep inside the BPlusTree itself.");
     // Register an abort action with the txn context in case of rollback
     txn->RegisterAbortAction([=]() {
-      // FIXME(15-721 project2): perform a delete from the underlying data structure of the key/value pair
-      const bool UNUSED_ATTRIBUTE result = true;
-
+      const bool UNUSED_ATTRIBUTE result = bplustree_->Delete(index_key, location);
       TERRIER_ASSERT(result, "Delete on the index failed.");
     });
     return result;
@@ -72,27 +175,24 @@ class BPlusTreeIndex final : public Index {
     TERRIER_ASSERT(metadata_.GetSchema().Unique(), "This Insert is designed for indexes with uniqueness constraints.");
     KeyType index_key;
     index_key.SetFromProjectedRow(tuple, metadata_, metadata_.GetSchema().GetColumns().size());
-    bool predicate_satisfied UNUSED_ATTRIBUTE = false;
+    bool predicate_satisfied = false;
 
     // The predicate checks if any matching keys have write-write conflicts or are still visible to the calling txn.
-    auto predicate UNUSED_ATTRIBUTE = [txn](const TupleSlot slot) -> bool {
+    auto predicate = [txn](const TupleSlot slot) -> bool {
       const auto *const data_table = slot.GetBlock()->data_table_;
       const auto has_conflict = data_table->HasConflict(*txn, slot);
       const auto is_visible = data_table->IsVisible(*txn, slot);
       return has_conflict || is_visible;
     };
 
-    // FIXME(15-721 project2): perform a non-unique CONDITIONAL insert into the underlying data structure of the
-    // key/value pair
-    const bool UNUSED_ATTRIBUTE result = true;
+    const bool result = bplustree_->ConditionalInsert(index_key, location, predicate, &predicate_satisfied);
 
     TERRIER_ASSERT(predicate_satisfied != result, "If predicate is not satisfied then insertion should succeed.");
 
     if (result) {
       // Register an abort action with the txn context in case of rollback
       txn->RegisterAbortAction([=]() {
-        // FIXME(15-721 project2): perform a delete from the underlying data structure of the key/value pair
-        const bool UNUSED_ATTRIBUTE result = true;
+        const bool UNUSED_ATTRIBUTE result = bplustree_->Delete(index_key, location);
         TERRIER_ASSERT(result, "Delete on the index failed.");
       });
     } else {
@@ -105,6 +205,19 @@ class BPlusTreeIndex final : public Index {
     return result;
   }
 
+  bool BulkInsert(const common::ManagedPointer<transaction::TransactionContext> txn,
+                  const std::vector<std::pair<const ProjectedRow *, TupleSlot>> &entries) final {
+    const auto num_attrs = metadata_.GetSchema().GetColumns().size();
+    std::vector<std::pair<KeyType, TupleSlot>> index_entries(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+      index_entries[i].first.SetFromProjectedRow(*entries[i].first, metadata_, num_attrs);
+      index_entries[i].second = entries[i].second;
+    }
+
+    // No abort actions are needed: the index is not visible to anyone else, and is thrown away if the txn aborts
+    return bplustree_->BulkLoad(&index_entries, metadata_.GetSchema().Unique(), bulk_load_fill_factor_);
+  }
+
   void Delete(const common::ManagedPointer<transaction::TransactionContext> txn, const ProjectedRow &tuple,
               const TupleSlot location) final {
     KeyType index_key;
@@ -117,9 +230,7 @@ class BPlusTreeIndex final : public Index {
     // Register a deferred action for the GC with txn manager. See base function comment.
     txn->RegisterCommitAction([=](transaction::DeferredActionManager *deferred_action_manager) {
       deferred_action_manager->RegisterDeferredAction([=]() {
-        // FIXME(15-721 project2): perform a delete from the underlying data structure of the key/value pair
-        const bool UNUSED_ATTRIBUTE result = true;
-
+        const bool UNUSED_ATTRIBUTE result = bplustree_->Delete(index_key, location);
         TERRIER_ASSERT(result, "Deferred delete on the index failed.");
       });
     });
@@ -136,7 +247,7 @@ class BPlusTreeIndex final : public Index {
     index_key.SetFromProjectedRow(key, metadata_, metadata_.GetSchema().GetColumns().size());
 
     // Perform lookup in BPlusTree
-    // FIXME(15-721 project2): perform a lookup of the underlying data structure of the key
+    bplustree_->GetValue(index_key, &results);
 
     // Avoid resizing our value_list, even if it means over-provisioning
     value_list->reserve(results.size());
@@ -150,10 +261,75 @@ class BPlusTreeIndex final : public Index {
                    "Invalid number of results for unique index.");
   }
 
+  void ScanKeyBatch(const transaction::TransactionContext &txn, const std::vector<const ProjectedRow *> &keys,
+                    std::vector<TupleSlot> *value_list, std::vector<uint32_t> *offsets) final {
+    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+
+    // Build search keys
+    const auto num_attrs = metadata_.GetSchema().GetColumns().size();
+    std::vector<KeyType> index_keys(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) index_keys[i].SetFromProjectedRow(*keys[i], metadata_, num_attrs);
+
+    // Perform lookups in BPlusTree
+    bplustree_->GetValues(index_keys, value_list, offsets);
+
+    // Perform visibility check on results, compacting each key's range in place
+    uint32_t write_pos = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      const uint32_t begin = (*offsets)[i];
+      (*offsets)[i] = write_pos;
+      for (uint32_t pos = begin; pos < (*offsets)[i + 1]; pos++) {
+        if (IsVisible(txn, (*value_list)[pos])) (*value_list)[write_pos++] = (*value_list)[pos];
+      }
+      TERRIER_ASSERT(!(metadata_.GetSchema().Unique()) || write_pos - (*offsets)[i] <= 1,
+                     "Invalid number of results for unique index.");
+    }
+    offsets->back() = write_pos;
+    value_list->resize(write_pos);
+  }
+
   void ScanAscending(const transaction::TransactionContext &txn, ScanType scan_type, uint32_t num_attrs,
                      ProjectedRow *low_key, ProjectedRow *high_key, uint32_t limit,
                      std::vector<TupleSlot> *value_list) final {
     TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+    BPlusTreeScanCursor<KeyType> cursor = MakeAscendingCursor(txn, scan_type, num_attrs, low_key, high_key, limit);
+    cursor.DrainInto(value_list);
+  }
+
+  void ScanDescending(const transaction::TransactionContext &txn, const ProjectedRow &low_key,
+                      const ProjectedRow &high_key, std::vector<TupleSlot> *value_list) final {
+    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+    BPlusTreeScanCursor<KeyType> cursor = MakeDescendingCursor(txn, low_key, high_key, 0);
+    cursor.DrainInto(value_list);
+  }
+
+  void ScanLimitDescending(const transaction::TransactionContext &txn, const ProjectedRow &low_key,
+                           const ProjectedRow &high_key, std::vector<TupleSlot> *value_list,
+                           const uint32_t limit) final {
+    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+    TERRIER_ASSERT(limit > 0, "Limit must be greater than 0.");
+    BPlusTreeScanCursor<KeyType> cursor = MakeDescendingCursor(txn, low_key, high_key, limit);
+    cursor.DrainInto(value_list);
+  }
+
+  std::unique_ptr<IndexScanCursor> OpenAscendingCursor(const transaction::TransactionContext &txn,
+                                                       ScanType scan_type, uint32_t num_attrs, ProjectedRow *low_key,
+                                                       ProjectedRow *high_key, uint32_t limit) final {
+    return std::make_unique<BPlusTreeScanCursor<KeyType>>(
+        MakeAscendingCursor(txn, scan_type, num_attrs, low_key, high_key, limit));
+  }
+
+  std::unique_ptr<IndexScanCursor> OpenDescendingCursor(const transaction::TransactionContext &txn,
+                                                        const ProjectedRow &low_key, const ProjectedRow &high_key,
+                                                        uint32_t limit) final {
+    return std::make_unique<BPlusTreeScanCursor<KeyType>>(MakeDescendingCursor(txn, low_key, high_key, limit));
+  }
+
+ private:
+  BPlusTreeScanCursor<KeyType> MakeAscendingCursor(const transaction::TransactionContext &txn,
+                                                   const ScanType scan_type, const uint32_t num_attrs,
+                                                   ProjectedRow *const low_key, ProjectedRow *const high_key,
+                                                   const uint32_t limit) const {
     TERRIER_ASSERT(scan_type == ScanType::Closed || scan_type == ScanType::OpenLow || scan_type == ScanType::OpenHigh ||
                        scan_type == ScanType::OpenBoth,
                    "Invalid scan_type passed into BPlusTreeIndex::Scan");
@@ -166,33 +342,25 @@ class BPlusTreeIndex final : public Index {
     if (low_key_exists) index_low_key.SetFromProjectedRow(*low_key, metadata_, num_attrs);
     if (high_key_exists) index_high_key.SetFromProjectedRow(*high_key, metadata_, num_attrs);
 
-    // FIXME(15-721 project2): perform a lookup of the underlying data structure of the key
-  }
-
-  void ScanDescending(const transaction::TransactionContext &txn, const ProjectedRow &low_key,
-                      const ProjectedRow &high_key, std::vector<TupleSlot> *value_list) final {
-    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
-
-    // Build search keys
-    KeyType index_low_key, index_high_key;
-    index_low_key.SetFromProjectedRow(low_key, metadata_, metadata_.GetSchema().GetColumns().size());
-    index_high_key.SetFromProjectedRow(high_key, metadata_, metadata_.GetSchema().GetColumns().size());
-
-    // FIXME(15-721 project2): perform a lookup of the underlying data structure of the key
+    // Perform lookup in BPlusTree
+    auto scan_itr = low_key_exists ? bplustree_->Begin(index_low_key) : bplustree_->Begin();
+    return BPlusTreeScanCursor<KeyType>(bplustree_.get(), &metadata_, txn, std::move(scan_itr), true, high_key_exists,
+                                        index_high_key, num_attrs, limit);
   }
 
-  void ScanLimitDescending(const transaction::TransactionContext &txn, const ProjectedRow &low_key,
-                           const ProjectedRow &high_key, std::vector<TupleSlot> *value_list,
-                           const uint32_t limit) final {
-    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
-    TERRIER_ASSERT(limit > 0, "Limit must be greater than 0.");
-
+  BPlusTreeScanCursor<KeyType> MakeDescendingCursor(const transaction::TransactionContext &txn,
+                                                    const ProjectedRow &low_key, const ProjectedRow &high_key,
+                                                    const uint32_t limit) const {
     // Build search keys
+    const auto num_attrs = static_cast<uint32_t>(metadata_.GetSchema().GetColumns().size());
     KeyType index_low_key, index_high_key;
-    index_low_key.SetFromProjectedRow(low_key, metadata_, metadata_.GetSchema().GetColumns().size());
-    index_high_key.SetFromProjectedRow(high_key, metadata_, metadata_.GetSchema().GetColumns().size());
+    index_low_key.SetFromProjectedRow(low_key, metadata_, num_attrs);
+    index_high_key.SetFromProjectedRow(high_key, metadata_, num_attrs);
 
-    // FIXME(15-721 project2): perform a lookup of the underlying data structure of the key
+    // Perform lookup in BPlusTree, starting from the last entry that is not greater than the high key
+    auto scan_itr = bplustree_->ReverseBegin(index_high_key);
+    return BPlusTreeScanCursor<KeyType>(bplustree_.get(), &metadata_, txn, std::move(scan_itr), false, true,
+                                        index_low_key, num_attrs, limit);
   }
 };
 
@@ -205,4 +373,10 @@ extern template class BPlusTreeIndex<GenericKey<64>>;
 extern template class BPlusTreeIndex<GenericKey<128>>;
 extern template class BPlusTreeIndex<GenericKey<256>>;
 
+extern template class BPlusTreeIndex<NormalizedKey<16>>;
+extern template class BPlusTreeIndex<NormalizedKey<32>>;
+extern template class BPlusTreeIndex<NormalizedKey<64>>;
+extern template class BPlusTreeIndex<NormalizedKey<128>>;
+extern template class BPlusTreeIndex<NormalizedKey<256>>;
+
 }  // namespace terrier::storage::index
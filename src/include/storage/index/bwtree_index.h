@@ -35,7 +35,10 @@ class BwTreeIndex final : public Index {
  public:
   IndexType Type() const final { return IndexType::BWTREE; }
 
-  void PerformGarbageCollection() final { bwtree_->PerformGarbageCollection(); };
+  void PerformGarbageCollection(transaction::timestamp_t oldest_txn, transaction::timestamp_t current_time) final {
+    // The BwTree protects its nodes with its own epoch manager
+    bwtree_->PerformGarbageCollection();
+  };
 
   bool Insert(const common::ManagedPointer<transaction::TransactionContext> txn, const ProjectedRow &tuple,
               const TupleSlot location) final {
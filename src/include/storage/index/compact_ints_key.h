@@ -141,6 +141,17 @@ class CompactIntsKey {
     return true;
   }
 
+  /**
+   * Finds the lower (or upper) bound of a key in a sorted array of keys. Only implemented for 8 and 16-byte keys, which
+   * are compared several at a time with AVX2 or AVX-512 when the CPU supports it.
+   * @param keys sorted array of keys to search
+   * @param num_keys number of keys in the array
+   * @param key search key
+   * @param upper if true, count the keys not greater than the search key instead of the keys less than it
+   * @return number of keys in the array that are less than (or, if upper, not greater than) the search key
+   */
+  static uint32_t SearchBound(const CompactIntsKey *keys, uint32_t num_keys, const CompactIntsKey &key, bool upper);
+
  private:
   byte key_data_[KeySize];
 
@@ -343,6 +354,13 @@ static_assert(sizeof(CompactIntsKey<16>) == 16, "size of the class should be 16
 static_assert(sizeof(CompactIntsKey<24>) == 24, "size of the class should be 24 bytes");
 static_assert(sizeof(CompactIntsKey<32>) == 32, "size of the class should be 32 bytes");
 
+template <>
+uint32_t CompactIntsKey<8>::SearchBound(const CompactIntsKey *keys, uint32_t num_keys, const CompactIntsKey &key,
+                                        bool upper);
+template <>
+uint32_t CompactIntsKey<16>::SearchBound(const CompactIntsKey *keys, uint32_t num_keys, const CompactIntsKey &key,
+                                         bool upper);
+
 extern template class CompactIntsKey<8>;
 extern template class CompactIntsKey<16>;
 extern template class CompactIntsKey<24>;
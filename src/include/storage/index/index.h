@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,6 +23,47 @@ enum ScanType : uint32_t {
   OpenBoth  /* [begin(), end()] range scan */
 };
 
+/**
+ * Resumable cursor over a range of an index. Each call to Next returns the next batch of visible slots in the cursor's
+ * order, so callers can consume a large range with bounded memory, stop whenever they have seen enough, and resume
+ * after yielding. A cursor must not outlive the transaction or the index it was created from.
+ */
+class IndexScanCursor {
+ public:
+  virtual ~IndexScanCursor() = default;
+
+  /**
+   * Fetches the next batch of visible slots.
+   * @param[out] batch cleared, then filled with up to max_slots slots
+   * @param max_slots maximum number of slots to return, must be greater than 0
+   * @return false if the range is exhausted and batch is empty, true otherwise
+   */
+  virtual bool Next(std::vector<TupleSlot> *batch, uint32_t max_slots) = 0;
+};
+
+/**
+ * Cursor over a result set that was materialized up front, for index types that cannot scan incrementally.
+ */
+class MaterializedScanCursor final : public IndexScanCursor {
+ public:
+  /**
+   * @param slots the whole result set, in the order it should be returned
+   */
+  explicit MaterializedScanCursor(std::vector<TupleSlot> slots) : slots_(std::move(slots)) {}
+
+  bool Next(std::vector<TupleSlot> *const batch, const uint32_t max_slots) final {
+    TERRIER_ASSERT(max_slots > 0, "Batches must hold at least one slot.");
+    const size_t end = std::min(slots_.size(), offset_ + max_slots);
+    batch->assign(slots_.cbegin() + offset_, slots_.cbegin() + end);
+    offset_ = end;
+    return !batch->empty();
+  }
+
+ private:
+  std::vector<TupleSlot> slots_;
+  size_t offset_ = 0;
+};
+
 /**
  * Wrapper class for the various types of indexes in our system. Semantically, we expect updates on indexed attributes
  * to be modeled as a delete and an insert (see bwtree_index_test.cpp CommitUpdate1, CommitUpdate2, etc.). This
@@ -69,8 +112,10 @@ class Index {
 
   /**
    * Invoke garbage collection on the index. For some underlying index types this may be a no-op.
+   * @param oldest_txn start time of the oldest running transaction, every txn that started before it has finished
+   * @param current_time a timestamp that no txn running at the time of the call started at or after
    */
-  virtual void PerformGarbageCollection() {}
+  virtual void PerformGarbageCollection(transaction::timestamp_t oldest_txn, transaction::timestamp_t current_time) {}
 
   /**
    * @return number of bytes allocated on the heap for this index data structure
@@ -98,6 +143,27 @@ class Index {
   virtual bool InsertUnique(common::ManagedPointer<transaction::TransactionContext> txn, const ProjectedRow &tuple,
                             TupleSlot location) = 0;
 
+  /**
+   * Inserts a batch of key-value pairs into a newly created index, e.g. when an index is built on a table that already
+   * holds data. Index types that support it build their structure directly from the whole batch, which is much cheaper
+   * than inserting the pairs one at a time. The default implementation falls back to Insert (or InsertUnique for unique
+   * indexes) for every pair.
+   * @param txn txn context for the calling txn, which must be the txn that created the index
+   * @param entries keys and the values to associate with them
+   * @return true if every pair was inserted, false otherwise (e.g. the batch violates a uniqueness constraint)
+   * @warning the index must be empty and not yet visible to other txns
+   */
+  virtual bool BulkInsert(const common::ManagedPointer<transaction::TransactionContext> txn,
+                          const std::vector<std::pair<const ProjectedRow *, TupleSlot>> &entries) {
+    const bool unique = metadata_.GetSchema().Unique();
+    for (const auto &entry : entries) {
+      if (!(unique ? InsertUnique(txn, *entry.first, entry.second) : Insert(txn, *entry.first, entry.second))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   /**
    * Doesn't immediately call delete on the index. Registers a commit action in the txn that will eventually register a
    * deferred action for the GC to safely call delete on the index when no more transactions need to access the key.
@@ -117,6 +183,30 @@ class Index {
   virtual void ScanKey(const transaction::TransactionContext &txn, const ProjectedRow &key,
                        std::vector<TupleSlot> *value_list) = 0;
 
+  /**
+   * Finds all the values associated with each key of a batch, e.g. the probe keys of an index nested-loop join. Index
+   * types that support it share work between the lookups; the others look up one key at a time.
+   * @param txn txn context for the calling txn, used for visibility checks
+   * @param keys the keys to look for, in any order
+   * @param[out] value_list the values associated with the keys, grouped by key in the order of keys
+   * @param[out] offsets keys.size() + 1 positions in value_list, such that the values of keys[i] are at
+   *                     [offsets[i], offsets[i + 1])
+   */
+  virtual void ScanKeyBatch(const transaction::TransactionContext &txn, const std::vector<const ProjectedRow *> &keys,
+                            std::vector<TupleSlot> *value_list, std::vector<uint32_t> *offsets) {
+    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+    offsets->clear();
+    offsets->reserve(keys.size() + 1);
+    std::vector<TupleSlot> results;
+    for (const auto *const key : keys) {
+      offsets->emplace_back(static_cast<uint32_t>(value_list->size()));
+      results.clear();
+      ScanKey(txn, *key, &results);
+      value_list->insert(value_list->end(), results.begin(), results.end());
+    }
+    offsets->emplace_back(static_cast<uint32_t>(value_list->size()));
+  }
+
   /**
    * Finds all the values between the given keys in our index, sorted in ascending order.
    * @param txn txn context for the calling txn, used for visibility checks
@@ -158,6 +248,49 @@ class Index {
     TERRIER_ASSERT(false, "You called a method on an index type that hasn't implemented it.");
   }
 
+  /**
+   * Opens a cursor over the values between the given keys, in ascending order. The keys are copied, so the caller may
+   * reuse the ProjectedRows once this returns. Index types that cannot scan incrementally materialize the result of
+   * ScanAscending instead.
+   * @param txn txn context for the calling txn, used for visibility checks. Must outlive the cursor.
+   * @param scan_type Scan Type
+   * @param num_attrs Number of attributes to compare
+   * @param low_key the key to start at
+   * @param high_key the key to end at
+   * @param limit maximum number of values the cursor returns in total, 0 for no limit
+   * @return cursor positioned before the first value of the range
+   */
+  virtual std::unique_ptr<IndexScanCursor> OpenAscendingCursor(const transaction::TransactionContext &txn,
+                                                               ScanType scan_type, uint32_t num_attrs,
+                                                               ProjectedRow *low_key, ProjectedRow *high_key,
+                                                               uint32_t limit) {
+    std::vector<TupleSlot> slots;
+    ScanAscending(txn, scan_type, num_attrs, low_key, high_key, limit, &slots);
+    return std::make_unique<MaterializedScanCursor>(std::move(slots));
+  }
+
+  /**
+   * Opens a cursor over the values between the given keys, in descending order. The keys are copied, so the caller may
+   * reuse the ProjectedRows once this returns. Index types that cannot scan incrementally materialize the result of
+   * ScanDescending or ScanLimitDescending instead.
+   * @param txn txn context for the calling txn, used for visibility checks. Must outlive the cursor.
+   * @param low_key the key to end at
+   * @param high_key the key to start at
+   * @param limit maximum number of values the cursor returns in total, 0 for no limit
+   * @return cursor positioned before the first value of the range
+   */
+  virtual std::unique_ptr<IndexScanCursor> OpenDescendingCursor(const transaction::TransactionContext &txn,
+                                                                const ProjectedRow &low_key,
+                                                                const ProjectedRow &high_key, uint32_t limit) {
+    std::vector<TupleSlot> slots;
+    if (limit == 0) {
+      ScanDescending(txn, low_key, high_key, &slots);
+    } else {
+      ScanLimitDescending(txn, low_key, high_key, &slots, limit);
+    }
+    return std::make_unique<MaterializedScanCursor>(std::move(slots));
+  }
+
   /**
    * @return mapping from key oid to projected row offset
    */
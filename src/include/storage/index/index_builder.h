@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 #include <vector>
 
@@ -14,7 +16,11 @@
 #include "storage/index/index.h"
 #include "storage/index/index_defs.h"
 #include "storage/index/index_metadata.h"
+#include "storage/index/normalized_key.h"
 #include "storage/projected_row.h"
+#include "storage/sql_table.h"
+#include "storage/storage_util.h"
+#include "transaction/transaction_context.h"
 
 namespace terrier::storage::index {
 
@@ -24,6 +30,7 @@ namespace terrier::storage::index {
 class IndexBuilder {
  private:
   catalog::IndexSchema key_schema_;
+  double bulk_load_fill_factor_ = BPLUSTREE_DEFAULT_FILL_FACTOR;
 
  public:
   IndexBuilder() = default;
@@ -38,7 +45,8 @@ class IndexBuilder {
     const auto &key_cols = key_schema_.GetColumns();
 
     // Check if it's a simple key: that is all attributes are integral and not NULL-able. Simple keys are compatible
-    // with CompactIntsKey and HashKey. Otherwise we fall back to GenericKey.
+    // with CompactIntsKey and HashKey. Otherwise BPlusTree indexes fall back to NormalizedKey if the key fits in one,
+    // and everything else falls back to GenericKey.
     bool simple_key = true;
     for (uint16_t i = 0; simple_key && i < key_cols.size(); i++) {
       const auto &attr = key_cols[i];
@@ -58,6 +66,8 @@ class IndexBuilder {
       case IndexType::BPLUSTREE: {
         if (simple_key && metadata.KeySize() <= COMPACTINTSKEY_MAX_SIZE)
           return BuildBPlusTreeIntsKey(std::move(metadata));
+        if (metadata.NormalizedKeySize() <= NORMALIZEDKEY_MAX_SIZE)
+          return BuildBPlusTreeNormalizedKey(std::move(metadata));
         return BuildBPlusTreeGenericKey(std::move(metadata));
       }
       default:
@@ -74,6 +84,71 @@ class IndexBuilder {
     return *this;
   }
 
+  /**
+   * @param fill_factor fraction of each node to fill when bulk loading a BPlusTree index, in (0, 1]
+   * @return the builder object
+   */
+  IndexBuilder &SetBulkLoadFillFactor(const double fill_factor) {
+    TERRIER_ASSERT(fill_factor > 0 && fill_factor <= 1, "Fill factor must be in (0, 1].");
+    bulk_load_fill_factor_ = fill_factor;
+    return *this;
+  }
+
+  /**
+   * Populates an index that was just built for the current key schema with every tuple of its table that is visible to
+   * the given txn. The keys of all tuples are materialized first and handed to the index in a single BulkInsert.
+   * @param index index to populate
+   * @param sql_table table that the index is defined on
+   * @param txn txn that created the index
+   * @return false if the tuples could not all be inserted, e.g. because they violate the index's uniqueness constraint
+   * @warning the index must be empty and not yet visible to other txns
+   */
+  bool BulkInsert(Index *const index, const common::ManagedPointer<SqlTable> sql_table,
+                  const common::ManagedPointer<transaction::TransactionContext> txn) const {
+    // A table column can appear in the key more than once, but may only be projected once
+    const auto &indexed_oids = key_schema_.GetIndexedColOids();
+    std::vector<catalog::col_oid_t> table_oids(indexed_oids.cbegin(), indexed_oids.cend());
+    std::sort(table_oids.begin(), table_oids.end());
+    table_oids.erase(std::unique(table_oids.begin(), table_oids.end()), table_oids.end());
+    const auto table_pr_init = sql_table->InitializerForProjectedRow(table_oids);
+    const auto table_pr_map = sql_table->ProjectionMapForOids(table_oids);
+    auto *const table_buffer = common::AllocationUtil::AllocateAligned(table_pr_init.ProjectedRowSize());
+    auto *const table_pr = table_pr_init.InitializeRow(table_buffer);
+
+    // Keys are materialized into large buffers rather than allocating every key separately
+    const auto &key_pr_init = index->GetProjectedRowInitializer();
+    const uint32_t key_pr_size = StorageUtil::PadUpToSize(sizeof(uint64_t), key_pr_init.ProjectedRowSize());
+    std::vector<byte *> key_buffers;
+    uint32_t keys_in_buffer = BULK_INSERT_KEYS_PER_BUFFER;
+    std::vector<std::pair<const ProjectedRow *, TupleSlot>> entries;
+
+    const auto &key_cols = key_schema_.GetColumns();
+    for (auto it = sql_table->begin(); it != sql_table->end(); ++it) {
+      if (!sql_table->Select(txn, *it, table_pr)) continue;
+      if (keys_in_buffer == BULK_INSERT_KEYS_PER_BUFFER) {
+        key_buffers.emplace_back(common::AllocationUtil::AllocateAligned(key_pr_size * BULK_INSERT_KEYS_PER_BUFFER));
+        keys_in_buffer = 0;
+      }
+      auto *const key_pr = key_pr_init.InitializeRow(key_buffers.back() + key_pr_size * keys_in_buffer++);
+      for (uint32_t i = 0; i < key_cols.size(); i++) {
+        const auto key_offset = index->GetKeyOidToOffsetMap().at(key_cols[i].Oid());
+        const auto table_offset = table_pr_map.at(indexed_oids[i]);
+        if (table_pr->IsNull(table_offset)) {
+          key_pr->SetNull(key_offset);
+        } else {
+          std::memcpy(key_pr->AccessForceNotNull(key_offset), table_pr->AccessWithNullCheck(table_offset),
+                      AttrSizeBytes(key_cols[i].AttrSize()));
+        }
+      }
+      entries.emplace_back(key_pr, *it);
+    }
+
+    const bool result = index->BulkInsert(txn, entries);
+    for (auto *const key_buffer : key_buffers) delete[] key_buffer;
+    delete[] table_buffer;
+    return result;
+  }
+
  private:
   Index *BuildBwTreeIntsKey(IndexMetadata metadata) const {
     metadata.SetKeyKind(IndexKeyKind::COMPACTINTSKEY);
@@ -161,18 +236,38 @@ class IndexBuilder {
     TERRIER_ASSERT(key_size <= COMPACTINTSKEY_MAX_SIZE, "Key size exceeds maximum for this key type.");
     Index *index = nullptr;
     if (key_size <= 8) {
-      index = new BPlusTreeIndex<CompactIntsKey<8>>(std::move(metadata));
+      index = new BPlusTreeIndex<CompactIntsKey<8>>(std::move(metadata), bulk_load_fill_factor_);
     } else if (key_size <= 16) {
-      index = new BPlusTreeIndex<CompactIntsKey<16>>(std::move(metadata));
+      index = new BPlusTreeIndex<CompactIntsKey<16>>(std::move(metadata), bulk_load_fill_factor_);
     } else if (key_size <= 24) {
-      index = new BPlusTreeIndex<CompactIntsKey<24>>(std::move(metadata));
+      index = new BPlusTreeIndex<CompactIntsKey<24>>(std::move(metadata), bulk_load_fill_factor_);
     } else if (key_size <= 32) {
-      index = new BPlusTreeIndex<CompactIntsKey<32>>(std::move(metadata));
+      index = new BPlusTreeIndex<CompactIntsKey<32>>(std::move(metadata), bulk_load_fill_factor_);
     }
     TERRIER_ASSERT(index != nullptr, "Failed to create an IntsKey index.");
     return index;
   }
 
+  Index *BuildBPlusTreeNormalizedKey(IndexMetadata metadata) const {
+    metadata.SetKeyKind(IndexKeyKind::NORMALIZEDKEY);
+    const auto key_size = metadata.NormalizedKeySize();
+    TERRIER_ASSERT(key_size <= NORMALIZEDKEY_MAX_SIZE, "Key size exceeds maximum for this key type.");
+    Index *index = nullptr;
+    if (key_size <= 16) {
+      index = new BPlusTreeIndex<NormalizedKey<16>>(std::move(metadata), bulk_load_fill_factor_);
+    } else if (key_size <= 32) {
+      index = new BPlusTreeIndex<NormalizedKey<32>>(std::move(metadata), bulk_load_fill_factor_);
+    } else if (key_size <= 64) {
+      index = new BPlusTreeIndex<NormalizedKey<64>>(std::move(metadata), bulk_load_fill_factor_);
+    } else if (key_size <= 128) {
+      index = new BPlusTreeIndex<NormalizedKey<128>>(std::move(metadata), bulk_load_fill_factor_);
+    } else if (key_size <= 256) {
+      index = new BPlusTreeIndex<NormalizedKey<256>>(std::move(metadata), bulk_load_fill_factor_);
+    }
+    TERRIER_ASSERT(index != nullptr, "Failed to create a NormalizedKey index.");
+    return index;
+  }
+
   Index *BuildBPlusTreeGenericKey(IndexMetadata metadata) const {
     metadata.SetKeyKind(IndexKeyKind::GENERICKEY);
     const auto pr_size = metadata.GetInlinedPRInitializer().ProjectedRowSize();
@@ -184,11 +279,11 @@ class IndexBuilder {
     TERRIER_ASSERT(key_size <= GENERICKEY_MAX_SIZE, "Key size exceeds maximum for this key type.");
 
     if (key_size <= 64) {
-      index = new BPlusTreeIndex<GenericKey<64>>(std::move(metadata));
+      index = new BPlusTreeIndex<GenericKey<64>>(std::move(metadata), bulk_load_fill_factor_);
     } else if (key_size <= 128) {
-      index = new BPlusTreeIndex<GenericKey<128>>(std::move(metadata));
+      index = new BPlusTreeIndex<GenericKey<128>>(std::move(metadata), bulk_load_fill_factor_);
     } else if (key_size <= 256) {
-      index = new BPlusTreeIndex<GenericKey<256>>(std::move(metadata));
+      index = new BPlusTreeIndex<GenericKey<256>>(std::move(metadata), bulk_load_fill_factor_);
     }
     TERRIER_ASSERT(index != nullptr, "Failed to create an GenericKey index.");
     return index;
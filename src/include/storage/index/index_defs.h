@@ -12,11 +12,21 @@ enum class IndexType : char { BWTREE = 'B', HASHMAP = 'H', BPLUSTREE = 'P' };
 /**
  * Internal enum to stash with the index to represent its key type. We don't need to persist this.
  */
-enum class IndexKeyKind : uint8_t { COMPACTINTSKEY, GENERICKEY, HASHKEY };
+enum class IndexKeyKind : uint8_t { COMPACTINTSKEY, GENERICKEY, HASHKEY, NORMALIZEDKEY };
 
 /**
  * Types that can be used in simple keys, i.e. CompactIntsKey and HashKey
  */
 constexpr std::array<type::TypeId, 4> NUMERIC_KEY_TYPES{type::TypeId::TINYINT, type::TypeId::SMALLINT,
                                                         type::TypeId::INTEGER, type::TypeId::BIGINT};
+
+/**
+ * Fraction of each node that is filled when a BPlusTree index is bulk loaded, leaving room for subsequent inserts
+ */
+constexpr double BPLUSTREE_DEFAULT_FILL_FACTOR = 0.9;
+
+/**
+ * Number of keys that IndexBuilder::BulkInsert materializes into each of its key buffers
+ */
+constexpr uint32_t BULK_INSERT_KEYS_PER_BUFFER = 1 << 14;
 }  // namespace terrier::storage::index
@@ -29,6 +29,7 @@ class IndexMetadata {
         inlined_attr_sizes_(std::move(other.inlined_attr_sizes_)),
         must_inline_varlen_(other.must_inline_varlen_),
         compact_ints_offsets_(std::move(other.compact_ints_offsets_)),
+        normalized_offsets_(std::move(other.normalized_offsets_)),
         key_oid_to_offset_(std::move(other.key_oid_to_offset_)),
         initializer_(std::move(other.initializer_)),
         inlined_initializer_(std::move(other.inlined_initializer_)),
@@ -45,6 +46,7 @@ class IndexMetadata {
         inlined_attr_sizes_(ComputeInlinedAttributeSizes(key_schema_)),
         must_inline_varlen_(ComputeMustInlineVarlen(key_schema_)),
         compact_ints_offsets_(ComputeCompactIntsOffsets(attr_sizes_)),
+        normalized_offsets_(ComputeNormalizedOffsets(key_schema_)),
         key_oid_to_offset_(ComputeKeyOidToOffset(key_schema_, ComputePROffsets(inlined_attr_sizes_))),
         initializer_(
             ProjectedRowInitializer::Create(GetRealAttrSizes(attr_sizes_), ComputePROffsets(inlined_attr_sizes_))),
@@ -77,6 +79,16 @@ class IndexMetadata {
    */
   const std::vector<uint8_t> &GetCompactIntsOffsets() const { return compact_ints_offsets_; }
 
+  /**
+   * @return offsets to write into for normalized keys (key schema order), followed by the normalized key's size
+   */
+  const std::vector<uint32_t> &GetNormalizedOffsets() const { return normalized_offsets_; }
+
+  /**
+   * @return number of bytes that a NormalizedKey needs to hold the key
+   */
+  uint32_t NormalizedKeySize() const { return normalized_offsets_.back(); }
+
   /**
    * @return mapping from key oid to projected row offset
    */
@@ -122,6 +134,7 @@ class IndexMetadata {
   std::vector<uint16_t> inlined_attr_sizes_;                                    // for GenericKey
   bool must_inline_varlen_;                                                     // for GenericKey
   std::vector<uint8_t> compact_ints_offsets_;                                   // for CompactIntsKey
+  std::vector<uint32_t> normalized_offsets_;                                    // for NormalizedKey
   std::unordered_map<catalog::indexkeycol_oid_t, uint16_t> key_oid_to_offset_;  // for execution layer
   ProjectedRowInitializer initializer_;                                         // user-facing initializer
   ProjectedRowInitializer inlined_initializer_;                                 // for GenericKey, internal only
@@ -218,6 +231,33 @@ class IndexMetadata {
     return scan;
   }
 
+  /**
+   * Computes the offsets of each attribute in a normalized key, plus the key's total size.
+   * e.g.   if the key schema is {INTEGER, nullable BIGINT, VARCHAR(5)}
+   *        then returned offsets are {0, 4, 13, 20}
+   *        since nullable attributes have an extra NULL indicator byte and varlens a 2-byte length after their content
+   */
+  static std::vector<uint32_t> ComputeNormalizedOffsets(const catalog::IndexSchema &key_schema) {
+    std::vector<uint32_t> offsets;
+    const auto &key_cols = key_schema.GetColumns();
+    offsets.reserve(key_cols.size() + 1);
+    offsets.emplace_back(0);
+    for (const auto &key : key_cols) {
+      uint32_t size = key.Nullable() ? 1 : 0;
+      switch (key.Type()) {
+        case type::TypeId::VARBINARY:
+        case type::TypeId::VARCHAR:
+          size += key.MaxVarlenSize() + static_cast<uint32_t>(sizeof(uint16_t));
+          break;
+        default:
+          size += type::TypeUtil::GetTypeSize(key.Type());
+          break;
+      }
+      offsets.emplace_back(offsets.back() + size);
+    }
+    return offsets;
+  }
+
   /**
    * Computes the projected row offsets given the attribute sizes.
    * e.g.   if attr_sizes is {4, 4, 8, 1, 2}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+
+#include "portable_endian/portable_endian.h"
+#include "storage/index/index_metadata.h"
+#include "storage/projected_row.h"
+#include "storage/storage_defs.h"
+#include "xxHash/xxh3.h"
+
+namespace terrier::storage::index {
+
+// This is the maximum number of bytes to pack into a single NormalizedKey template. Keys whose normalized form does not
+// fit fall back to GenericKey.
+constexpr uint16_t NORMALIZEDKEY_MAX_SIZE = 256;
+
+/**
+ * NormalizedKey is an order-preserving binary encoding of the same keys that GenericKey supports, for use in ordered
+ * indexes. Two keys compare the same way as their GenericKey counterparts when their bytes are compared with memcmp, so
+ * comparisons need neither per-column type dispatch nor the index metadata, and the key stores no metadata pointer.
+ *
+ * Every column is encoded at a fixed offset computed by IndexMetadata:
+ * - nullable columns start with a byte that is 0 for NULL (which then sorts first) and 1 otherwise
+ * - integers are stored big-endian with the sign bit flipped, unsigned types (DATE, TIMESTAMP) big-endian
+ * - DECIMAL is stored as its IEEE 754 bits, with every bit flipped for negative values and only the sign bit otherwise
+ * - VARCHAR and VARBINARY are stored as their content zero-padded to the column's maximum length, followed by the
+ *   content's length. Comparing the padded content first and the length second matches comparing the varlens.
+ *
+ * Varlens are always inlined, so unlike GenericKey, comparisons never chase pointers to varlen content.
+ * @tparam KeySize number of bytes for the key's internal buffer
+ */
+template <uint16_t KeySize>
+class NormalizedKey {
+ public:
+  static_assert(KeySize > 0 && KeySize <= NORMALIZEDKEY_MAX_SIZE);
+
+  /**
+   * @return underlying byte array, exposed for hasher and comparators
+   */
+  const byte *KeyData() const { return key_data_; }
+
+  /**
+   * Set the NormalizedKey's data based on a ProjectedRow and associated index metadata
+   * @param from ProjectedRow to generate NormalizedKey representation of
+   * @param metadata index information, primarily the key schema and the precomputed offsets of each column
+   * @param num_attrs Number of attributes
+   */
+  void SetFromProjectedRow(const storage::ProjectedRow &from, const IndexMetadata &metadata, size_t num_attrs) {
+    const auto &key_cols = metadata.GetSchema().GetColumns();
+    const auto &normalized_offsets = metadata.GetNormalizedOffsets();
+    TERRIER_ASSERT(from.NumColumns() == key_cols.size(),
+                   "ProjectedRow should have the same number of columns at the original key schema.");
+    TERRIER_ASSERT(num_attrs > 0 && num_attrs <= key_cols.size(), "Number of attributes violates invariant");
+    TERRIER_ASSERT(normalized_offsets.back() <= KeySize, "Normalized key will access out of bounds.");
+
+    // Attributes that are not set compare as NULL (or, for non-nullable columns, as the smallest possible value)
+    std::memset(key_data_, 0, KeySize);
+
+    for (uint16_t i = 0; i < num_attrs; i++) {
+      byte *to = key_data_ + normalized_offsets[i];
+      const byte *const attr = from.AccessWithNullCheck(static_cast<uint16_t>(from.ColumnIds()[i]));
+      if (key_cols[i].Nullable()) {
+        if (attr == nullptr) continue;
+        *to++ = static_cast<byte>(1);
+      }
+      TERRIER_ASSERT(attr != nullptr, "Non-nullable attribute should not be NULL.");
+
+      switch (key_cols[i].Type()) {
+        case type::TypeId::BOOLEAN:
+        case type::TypeId::TINYINT:
+          *to = static_cast<byte>(*reinterpret_cast<const uint8_t *>(attr) ^ 0x80u);
+          break;
+        case type::TypeId::SMALLINT:
+          WriteBigEndian(to, static_cast<uint16_t>(*reinterpret_cast<const uint16_t *>(attr) ^ 0x8000u));
+          break;
+        case type::TypeId::INTEGER:
+          WriteBigEndian(to, *reinterpret_cast<const uint32_t *>(attr) ^ (uint32_t{1} << 31));
+          break;
+        case type::TypeId::DATE:
+          WriteBigEndian(to, *reinterpret_cast<const uint32_t *>(attr));
+          break;
+        case type::TypeId::BIGINT:
+          WriteBigEndian(to, *reinterpret_cast<const uint64_t *>(attr) ^ (uint64_t{1} << 63));
+          break;
+        case type::TypeId::DECIMAL: {
+          // -0.0 and 0.0 compare as equal, so both must have the same encoding
+          const double attr_value = *reinterpret_cast<const double *>(attr);
+          const double value = attr_value == 0 ? 0 : attr_value;
+          uint64_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          WriteBigEndian(to, (bits >> 63) == 0 ? bits ^ (uint64_t{1} << 63) : ~bits);
+          break;
+        }
+        case type::TypeId::TIMESTAMP:
+          WriteBigEndian(to, *reinterpret_cast<const uint64_t *>(attr));
+          break;
+        case type::TypeId::VARCHAR:
+        case type::TypeId::VARBINARY: {
+          const auto &varlen = *reinterpret_cast<const VarlenEntry *>(attr);
+          const uint16_t max_size = key_cols[i].MaxVarlenSize();
+          TERRIER_ASSERT(varlen.Size() <= max_size, "Varlen exceeds the maximum size of its column.");
+          std::memcpy(to, varlen.Content(), varlen.Size());
+          WriteBigEndian(to + max_size, static_cast<uint16_t>(varlen.Size()));
+          break;
+        }
+        default:
+          throw std::runtime_error("Unknown TypeId in terrier::storage::index::NormalizedKey.");
+      }
+    }
+  }
+
+  /**
+   * Returns whether this key is less than another key up to num_attrs for comparison.
+   * @param rhs other key to compare against
+   * @param metadata IndexMetadata
+   * @param num_attrs attributes to compare against
+   * @returns whether this is less than other
+   */
+  bool PartialLessThan(const NormalizedKey<KeySize> &rhs, const IndexMetadata *metadata, size_t num_attrs) const {
+    TERRIER_ASSERT(num_attrs > 0 && num_attrs <= metadata->GetSchema().GetColumns().size(),
+                   "Invalid num_attrs for normalized key");
+    // Columns are laid out in key order, so the first num_attrs columns are a prefix of the key
+    return std::memcmp(key_data_, rhs.key_data_, metadata->GetNormalizedOffsets()[num_attrs]) <= 0;
+  }
+
+ private:
+  byte key_data_[KeySize];
+
+  template <typename IntType>
+  static void WriteBigEndian(byte *const to, const IntType data) {
+    IntType big_endian;
+    if constexpr (sizeof(IntType) == sizeof(uint16_t)) {
+      big_endian = htobe16(data);
+    } else if constexpr (sizeof(IntType) == sizeof(uint32_t)) {
+      big_endian = htobe32(data);
+    } else {
+      big_endian = htobe64(data);
+    }
+    std::memcpy(to, &big_endian, sizeof(IntType));
+  }
+};
+
+extern template class NormalizedKey<16>;
+extern template class NormalizedKey<32>;
+extern template class NormalizedKey<64>;
+extern template class NormalizedKey<128>;
+extern template class NormalizedKey<256>;
+
+}  // namespace terrier::storage::index
+
+namespace std {
+
+/**
+ * Implements std::hash for NormalizedKey. Allows the class to be used with containers that expect STL interface.
+ * @tparam KeySize number of bytes for the key's internal buffer
+ */
+template <uint16_t KeySize>
+struct hash<terrier::storage::index::NormalizedKey<KeySize>> {
+  /**
+   * @param key key to be hashed
+   * @return hash of the key's underlying data
+   */
+  size_t operator()(const terrier::storage::index::NormalizedKey<KeySize> &key) const {
+    return static_cast<size_t>(XXH3_64bits(key.KeyData(), KeySize));
+  }
+};
+
+/**
+ * Implements std::equal_to for NormalizedKey. Allows the class to be used with containers that expect STL interface.
+ * @tparam KeySize number of bytes for the key's internal buffer
+ */
+template <uint16_t KeySize>
+struct equal_to<terrier::storage::index::NormalizedKey<KeySize>> {
+  /**
+   * @param lhs first key to be compared
+   * @param rhs second key to be compared
+   * @return true if first key is equal to the second key
+   */
+  bool operator()(const terrier::storage::index::NormalizedKey<KeySize> &lhs,
+                  const terrier::storage::index::NormalizedKey<KeySize> &rhs) const {
+    return std::memcmp(lhs.KeyData(), rhs.KeyData(), KeySize) == 0;
+  }
+};
+
+/**
+ * Implements std::less for NormalizedKey. Allows the class to be used with containers that expect STL interface.
+ * @tparam KeySize number of bytes for the key's internal buffer
+ */
+template <uint16_t KeySize>
+struct less<terrier::storage::index::NormalizedKey<KeySize>> {
+  /**
+   * @param lhs first key to be compared
+   * @param rhs second key to be compared
+   * @return true if first key is less than the second key
+   */
+  bool operator()(const terrier::storage::index::NormalizedKey<KeySize> &lhs,
+                  const terrier::storage::index::NormalizedKey<KeySize> &rhs) const {
+    return std::memcmp(lhs.KeyData(), rhs.KeyData(), KeySize) < 0;
+  }
+};
+}  // namespace std
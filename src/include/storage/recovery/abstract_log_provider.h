@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -16,14 +17,23 @@ namespace terrier::storage {
  */
 class AbstractLogProvider {
  public:
+  virtual ~AbstractLogProvider() = default;
+
   /**
    * Provide next available log record
    * @warning Can be a blocking call if provider is waiting to receive more logs
    * @return next log record along with vector of varlen entry pointers. nullptr log record if no more logs will be
    * provided.
    */
-  std::pair<LogRecord *, std::vector<byte *>> GetNextRecord() {
-    return HasMoreRecords() ? ReadNextRecord() : std::make_pair(nullptr, std::vector<byte *>());
+  virtual std::pair<LogRecord *, std::vector<byte *>> GetNextRecord() {
+    if (truncated_ || !HasMoreRecords()) return {nullptr, {}};
+    auto record = ReadNextRecord();
+    if (!truncated_) return record;
+    // The log ends in the middle of the record, e.g. because a crash tore the write of its tail. Its transaction had
+    // not committed, as its commit record would have come after it.
+    delete[] reinterpret_cast<byte *>(record.first);
+    for (auto *varlen : record.second) delete[] varlen;
+    return {nullptr, {}};
   }
 
  protected:
@@ -46,17 +56,29 @@ class AbstractLogProvider {
   virtual bool Read(void *dest, uint32_t size) = 0;
 
  private:
-  // TODO(Gus): Support a more fail-safe way than just throwing an exception
+  // Whether the log ended in the middle of a record
+  bool truncated_ = false;
+
+  /**
+   * Read bytes from the log provider. If the log ends first, the bytes are zeroed and the log is marked as truncated.
+   * @param dest pointer location to read into
+   * @param size number of bytes to read
+   */
+  void ReadOrTruncate(void *dest, uint32_t size) {
+    if (!truncated_ && Read(dest, size)) return;
+    truncated_ = true;
+    std::memset(dest, 0, size);
+  }
+
   /**
-   * Read a value of the specified type from log provider. An exception is thrown if the reading failed
+   * Read a value of the specified type from log provider. If the log ends first, the value is zero.
    * @tparam T type of value to read
    * @return the value read
    */
   template <class T>
   T ReadValue() {
     T result;
-    bool ret UNUSED_ATTRIBUTE = Read(&result, sizeof(T));
-    TERRIER_ASSERT(ret, "Reading of value failed");
+    ReadOrTruncate(&result, sizeof(T));
     return result;
   }
 
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/catalog_defs.h"
+#include "common/dedicated_thread_owner.h"
+#include "storage/projected_columns.h"
+#include "storage/projected_row.h"
+#include "storage/sql_table.h"
+#include "transaction/transaction_manager.h"
+
+namespace terrier::storage {
+
+/**
+ * A batch of tuples of one table, as stored in a checkpoint. A checkpoint file starts with a magic number and the
+ * timestamp of its snapshot, followed by sections in a columnar layout modeled after Arrow's:
+ * ------------------------------------------------------------------------------------------------------------------
+ * | size (64) | checksum (32) | db_oid (32) | table_oid (32) | num_tuples (32) | num_cols (16) |
+ * ------------------------------------------------------------------------------------------------------------------
+ * | tuple_slots[num_tuples] (64) | col_oids[num_cols] (32) | attr_sizes[num_cols] (16) | column 0 | column 1 | ... |
+ * ------------------------------------------------------------------------------------------------------------------
+ * where size counts the bytes after the checksum, the checksum is a CRC32C of the size and those bytes, and every
+ * column is a validity bitmap of num_tuples bits followed by either num_tuples fixed size values, or by num_tuples + 1
+ * 32-bit offsets into the varlen data that follows them.
+ *
+ * The tuple slots are the ones the tuples had when the checkpoint was taken, so that records in the log tail that
+ * refer to them can be mapped to the tuples' new slots.
+ */
+class CheckpointSection {
+ public:
+  /**
+   * Reads the next section from a checkpoint file.
+   * @param fd file descriptor of the checkpoint file, positioned at the start of a section
+   * @return the section, or nullptr if the end of the file has been reached
+   * @throw runtime_error if the file ends in the middle of a section, or the section is corrupted
+   */
+  static std::unique_ptr<CheckpointSection> Read(int fd);
+
+  /**
+   * @return database the tuples belong to
+   */
+  catalog::db_oid_t DatabaseOid() const { return db_oid_; }
+
+  /**
+   * @return table the tuples belong to
+   */
+  catalog::table_oid_t TableOid() const { return table_oid_; }
+
+  /**
+   * @return number of tuples in the section
+   */
+  uint32_t NumTuples() const { return num_tuples_; }
+
+  /**
+   * @return oids of the columns in the section, which include every column of the table
+   */
+  const std::vector<catalog::col_oid_t> &ColumnOids() const { return col_oids_; }
+
+  /**
+   * @param row index of a tuple in the section
+   * @return the slot that tuple had when the checkpoint was taken
+   */
+  TupleSlot OriginalTupleSlot(uint32_t row) const;
+
+  /**
+   * @param row index of a tuple in the section
+   * @param col index of a column in the section
+   * @return true if the value is null
+   */
+  bool IsNull(uint32_t row, uint16_t col) const;
+
+  /**
+   * Copies a tuple into a ProjectedRow. Varlen values that are not inlined are copied into new buffers owned by the
+   * VarlenEntry, which the table takes over on insert.
+   * @param row index of a tuple in the section
+   * @param pr row to fill, must contain all columns of the section
+   * @param pr_map projection map of the row
+   */
+  void CopyToRow(uint32_t row, ProjectedRow *pr, const ProjectionMap &pr_map) const;
+
+ private:
+  friend class CheckpointManager;
+
+  catalog::db_oid_t db_oid_;
+  catalog::table_oid_t table_oid_;
+  uint32_t num_tuples_;
+  std::vector<catalog::col_oid_t> col_oids_;
+  std::vector<uint16_t> attr_sizes_;
+  // where the tuple slots start in contents_
+  const byte *slots_;
+  // per column, where the validity bitmap, offsets (varlen only) and values start in contents_
+  std::vector<const byte *> validity_;
+  std::vector<const byte *> offsets_;
+  std::vector<const byte *> values_;
+  std::unique_ptr<byte[]> contents_;
+};
+
+/**
+ * The checkpoint manager periodically writes a consistent snapshot of every SqlTable, including the catalog tables, to
+ * a checkpoint file. The snapshot is read with a regular transaction, so checkpointing does not block other
+ * transactions. After a restart, the RecoveryManager loads the latest checkpoint and only replays transactions from the
+ * log that committed after the checkpoint's snapshot.
+ *
+ * A checkpoint is written to a temporary file first and renamed over the previous one once it is persisted, so that
+ * there is always a complete checkpoint on disk. Log segments that only hold transactions the new checkpoint covers
+ * are removed afterwards.
+ */
+class CheckpointManager : public common::DedicatedThreadOwner {
+  /**
+   * Task that takes a checkpoint at a fixed interval in the background.
+   */
+  class CheckpointTask : public common::DedicatedThreadTask {
+   public:
+    /**
+     * @param checkpoint_manager pointer to checkpoint manager who started the task
+     * @param checkpoint_interval time between the start of two checkpoints
+     */
+    CheckpointTask(CheckpointManager *checkpoint_manager, std::chrono::milliseconds checkpoint_interval)
+        : checkpoint_manager_(checkpoint_manager), checkpoint_interval_(checkpoint_interval) {}
+
+    /**
+     * Takes checkpoints until terminated
+     */
+    void RunTask() override;
+
+    /**
+     * Signals the task to stop. An ongoing checkpoint is finished first.
+     */
+    void Terminate() override;
+
+   private:
+    CheckpointManager *checkpoint_manager_;
+    const std::chrono::milliseconds checkpoint_interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool run_task_ = true;
+  };
+
+ public:
+  /**
+   * Magic number at the start of every checkpoint file
+   */
+  static constexpr uint64_t MAGIC = 0x544E494F504B4843;  // "CHKPOINT"
+
+  /**
+   * @param checkpoint_path path of the checkpoint file
+   * @param catalog catalog to find the tables to checkpoint with
+   * @param txn_manager transaction manager to read the snapshot with
+   * @param thread_registry thread registry to register the background task with
+   */
+  CheckpointManager(std::string checkpoint_path, const common::ManagedPointer<catalog::Catalog> catalog,
+                    const common::ManagedPointer<transaction::TransactionManager> txn_manager,
+                    const common::ManagedPointer<common::DedicatedThreadRegistry> thread_registry)
+      : DedicatedThreadOwner(thread_registry),
+        checkpoint_path_(std::move(checkpoint_path)),
+        catalog_(catalog),
+        txn_manager_(txn_manager) {}
+
+  /**
+   * Stops taking checkpoints in the background, if it was started
+   */
+  ~CheckpointManager() override {
+    if (checkpoint_task_ != nullptr) StopCheckpointing();
+  }
+
+  /**
+   * Takes a checkpoint right away.
+   * @return the timestamp of the checkpoint's snapshot. Every transaction that committed before it is in the
+   * checkpoint.
+   */
+  transaction::timestamp_t Checkpoint();
+
+  /**
+   * Starts taking checkpoints in the background.
+   * @param checkpoint_interval time between the start of two checkpoints
+   */
+  void StartCheckpointing(std::chrono::milliseconds checkpoint_interval) {
+    TERRIER_ASSERT(checkpoint_task_ == nullptr, "Checkpointing already started");
+    checkpoint_task_ = thread_registry_->RegisterDedicatedThread<CheckpointTask>(
+        this /* dedicated thread owner */, this /* task arg */, checkpoint_interval);
+  }
+
+  /**
+   * Stops taking checkpoints in the background, waiting for an ongoing checkpoint to finish.
+   */
+  void StopCheckpointing() {
+    TERRIER_ASSERT(checkpoint_task_ != nullptr, "Checkpointing must already have been started");
+    if (!thread_registry_->StopTask(this, checkpoint_task_.CastManagedPointerTo<common::DedicatedThreadTask>())) {
+      throw std::runtime_error("Checkpoint task termination failed");
+    }
+    checkpoint_task_ = nullptr;
+  }
+
+ private:
+  // Number of tuples read and written as one section
+  static constexpr uint32_t TUPLES_PER_SECTION = 1024;
+
+  const std::string checkpoint_path_;
+  const common::ManagedPointer<catalog::Catalog> catalog_;
+  const common::ManagedPointer<transaction::TransactionManager> txn_manager_;
+  common::ManagedPointer<CheckpointTask> checkpoint_task_ = nullptr;
+  // Only one checkpoint is written at a time
+  std::mutex checkpoint_latch_;
+
+  /**
+   * Writes the header and the sections of every table to a checkpoint file.
+   * @param txn snapshot transaction
+   * @param fd file descriptor of the checkpoint file
+   */
+  void WriteCheckpoint(common::ManagedPointer<transaction::TransactionContext> txn, int fd);
+
+  /**
+   * Writes all visible tuples of a table as sections.
+   * @param txn snapshot transaction
+   * @param fd file descriptor of the checkpoint file
+   * @param db_oid database of the table
+   * @param table_oid oid of the table
+   * @param table the table
+   * @param excluded_oids columns that are written as null, because their values are meaningless after a restart
+   */
+  void WriteTable(common::ManagedPointer<transaction::TransactionContext> txn, int fd, catalog::db_oid_t db_oid,
+                  catalog::table_oid_t table_oid, SqlTable *table,
+                  const std::vector<catalog::col_oid_t> &excluded_oids = {});
+
+  /**
+   * Serializes the tuples in a ProjectedColumns as a section.
+   * @param fd file descriptor of the checkpoint file
+   * @param db_oid database of the table
+   * @param table_oid oid of the table
+   * @param table the table the tuples were read from
+   * @param col_oids oids of the columns, in projection order
+   * @param excluded columns that are written as null, in projection order
+   * @param columns the tuples
+   */
+  void WriteSection(int fd, catalog::db_oid_t db_oid, catalog::table_oid_t table_oid, const SqlTable &table,
+                    const std::vector<catalog::col_oid_t> &col_oids, const std::vector<bool> &excluded,
+                    ProjectedColumns *columns);
+};
+
+}  // namespace terrier::storage
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "storage/recovery/abstract_log_provider.h"
 #include "storage/write_ahead_log/log_io.h"
 
@@ -9,18 +12,46 @@ namespace terrier::storage {
 /**
  * @brief Log provider for logs stored on disk
  * Provides logs to the recovery manager from logs persisted on disk. The log file is read in using the
- * BufferedLogReader.
+ * BufferedLogReader. A segmented log is read segment after segment.
+ *
+ * A log written by several serializers consists of one stream per serializer. A transaction's records are all in one
+ * stream, so the streams are merged by only interleaving them at commit records, which are handed out in commit
+ * timestamp order. Every stream is only read up to the last serialization round that was persisted in all of them.
  */
 class DiskLogProvider : public AbstractLogProvider {
  public:
   /**
-   * @param log_file_path path to log file to read logs from
+   * @param log_file_path path to log file to read logs from, or prefix of the log segments
    */
-  explicit DiskLogProvider(const std::string &log_file_path) : in_(BufferedLogReader(log_file_path.c_str())) {}
+  explicit DiskLogProvider(const std::string &log_file_path)
+      : DiskLogProvider(LogFile::StreamFilePaths(log_file_path)) {}
+
+  /**
+   * Provide next available log record, merged from all log streams
+   * @return next log record along with vector of varlen entry pointers. nullptr log record if no more logs will be
+   * provided.
+   */
+  std::pair<LogRecord *, std::vector<byte *>> GetNextRecord() override;
 
  private:
-  // Buffered log file reader
+  // Buffered log file reader of the first stream
   storage::BufferedLogReader in_;
+  // Providers of the other streams, empty if the log has a single stream
+  std::vector<std::unique_ptr<DiskLogProvider>> other_streams_;
+  // Next record of every stream, which is always a commit record, or nullptr once the stream is exhausted
+  std::vector<std::pair<LogRecord *, std::vector<byte *>>> heads_;
+  // Whether the head of a stream has been read already
+  std::vector<bool> head_read_;
+
+  explicit DiskLogProvider(std::vector<std::vector<std::string>> stream_file_paths);
+
+  /**
+   * @param stream index of a stream, 0 is the one read by this provider
+   * @return next record of the stream
+   */
+  std::pair<LogRecord *, std::vector<byte *>> GetNextStreamRecord(uint32_t stream) {
+    return stream == 0 ? AbstractLogProvider::GetNextRecord() : other_streams_[stream - 1]->GetNextRecord();
+  }
 
   /**
    * @return true if log file contains more records, false otherwise
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,8 +19,11 @@
 #include "catalog/postgres/pg_constraint.h"
 #include "catalog/postgres/pg_database.h"
 #include "catalog/postgres/pg_index.h"
+#include "catalog/postgres/pg_language.h"
 #include "catalog/postgres/pg_namespace.h"
+#include "catalog/postgres/pg_proc.h"
 #include "common/dedicated_thread_owner.h"
+#include "common/worker_pool.h"
 #include "storage/recovery/abstract_log_provider.h"
 #include "storage/sql_table.h"
 #include "transaction/transaction_manager.h"
@@ -63,19 +72,25 @@ class RecoveryManager : public common::DedicatedThreadOwner {
    * @param deferred_action_manager manager to use for deferred deletes
    * @param thread_registry thread registry to register tasks
    * @param store block store used for SQLTable creation during recovery
+   * @param checkpoint_path path of the checkpoint to recover from before replaying the log, empty if there is none
+   * @param num_replay_threads number of threads to replay committed transactions with. With more than one, the log is
+   * decoded in the background and changes to different tables are replayed in parallel.
    */
   explicit RecoveryManager(const common::ManagedPointer<AbstractLogProvider> log_provider,
                            const common::ManagedPointer<catalog::Catalog> catalog,
                            const common::ManagedPointer<transaction::TransactionManager> txn_manager,
                            const common::ManagedPointer<transaction::DeferredActionManager> deferred_action_manager,
                            const common::ManagedPointer<terrier::common::DedicatedThreadRegistry> thread_registry,
-                           const common::ManagedPointer<BlockStore> store)
+                           const common::ManagedPointer<BlockStore> store, std::string checkpoint_path = "",
+                           const uint32_t num_replay_threads = 1)
       : DedicatedThreadOwner(thread_registry),
         log_provider_(log_provider),
         catalog_(catalog),
         txn_manager_(txn_manager),
         deferred_action_manager_(deferred_action_manager),
         block_store_(store),
+        checkpoint_path_(std::move(checkpoint_path)),
+        num_replay_threads_(num_replay_threads),
         recovered_txns_(0) {
     // Initialize catalog_table_schemas_ map
     catalog_table_schemas_[catalog::postgres::CLASS_TABLE_OID] = catalog::postgres::Builder::GetClassTableSchema();
@@ -86,6 +101,9 @@ class RecoveryManager : public common::DedicatedThreadOwner {
         catalog::postgres::Builder::GetConstraintTableSchema();
     catalog_table_schemas_[catalog::postgres::INDEX_TABLE_OID] = catalog::postgres::Builder::GetIndexTableSchema();
     catalog_table_schemas_[catalog::postgres::TYPE_TABLE_OID] = catalog::postgres::Builder::GetTypeTableSchema();
+    catalog_table_schemas_[catalog::postgres::LANGUAGE_TABLE_OID] =
+        catalog::postgres::Builder::GetLanguageTableSchema();
+    catalog_table_schemas_[catalog::postgres::PRO_TABLE_OID] = catalog::postgres::Builder::GetProcTableSchema();
   }
 
   /**
@@ -107,7 +125,103 @@ class RecoveryManager : public common::DedicatedThreadOwner {
     }
   }
 
+  /**
+   * Suffix of the paths that the log and checkpoint of the previous run are set aside at for recovery
+   */
+  static constexpr const char *SET_ASIDE_SUFFIX = ".recovery";
+
+  /**
+   * Sets the log and checkpoint of the previous run aside, so that the log of the new run, which also logs the
+   * recovered changes, starts out empty. Timestamps start over with every run, so a checkpoint can only be recovered
+   * with a log of the run that took it. If the previous run crashed while recovering, what it set aside is kept and
+   * what it wrote in their place is removed instead. The log manager must not have been started yet.
+   * @param log_file_path path to the log file
+   * @param checkpoint_path path of the checkpoint file
+   */
+  static void SetAside(const std::string &log_file_path, const std::string &checkpoint_path);
+
+  /**
+   * Removes the log and checkpoint that SetAside set aside. This must only be called once the recovered state is
+   * persisted in the new log, as a restart no longer recovers from what was set aside afterwards.
+   * @param log_file_path path to the log file
+   * @param checkpoint_path path of the checkpoint file
+   */
+  static void RemoveSetAside(const std::string &log_file_path, const std::string &checkpoint_path);
+
  private:
+  /**
+   * A table whose changes are replayed in parallel, along with what is needed to replay them without going through the
+   * catalog. Looked up once per table until the next catalog change.
+   */
+  struct ReplayTarget {
+    /**
+     * @param table the table
+     * @param indexes indexes on the table
+     * @param col_oids oids of all columns of the table
+     */
+    ReplayTarget(common::ManagedPointer<SqlTable> table,
+                 std::vector<std::pair<common::ManagedPointer<index::Index>, const catalog::IndexSchema &>> indexes,
+                 const std::vector<catalog::col_oid_t> &col_oids)
+        : table_(table),
+          indexes_(std::move(indexes)),
+          row_initializer_(table->InitializerForProjectedRow(col_oids)),
+          row_map_(table->ProjectionMapForOids(col_oids)) {}
+
+    /** the table */
+    const common::ManagedPointer<SqlTable> table_;
+    /** indexes on the table */
+    const std::vector<std::pair<common::ManagedPointer<index::Index>, const catalog::IndexSchema &>> indexes_;
+    /** initializer for rows with all columns of the table, the layout of inserted rows */
+    const ProjectedRowInitializer row_initializer_;
+    /** projection map for rows with all columns of the table */
+    const ProjectionMap row_map_;
+  };
+
+  /**
+   * A committed transaction whose changes have been handed to the replay partitions
+   */
+  struct DispatchedTransaction {
+    /** buffered changes of the transaction */
+    std::vector<std::pair<LogRecord *, std::vector<byte *>>> changes_;
+    /** number of partitions that have not finished replaying their part of the transaction */
+    std::atomic<uint32_t> remaining_pieces_ = 0;
+  };
+
+  /**
+   * The changes of a committed transaction to the tables of one partition
+   */
+  struct ReplayPiece {
+    /** transaction the changes belong to */
+    DispatchedTransaction *txn_ = nullptr;
+    /** the changes, in log order, along with the table they modify */
+    std::vector<std::pair<LogRecord *, const ReplayTarget *>> records_;
+  };
+
+  /**
+   * A set of tables whose changes are replayed by one worker at a time, in commit order. Transactions only need to be
+   * ordered when they change the same table, so different partitions replay independently.
+   */
+  struct ReplayPartition {
+    /** protects pending_ and scheduled_ */
+    std::mutex latch_;
+    /** pieces waiting to be replayed */
+    std::queue<ReplayPiece> pending_;
+    /** true if a task is replaying this partition's pieces */
+    bool scheduled_ = false;
+    /** tuple slot mappings added by this partition since the last barrier, merged into tuple_slot_map_ at it */
+    std::unordered_map<TupleSlot, TupleSlot> inserted_slots_;
+    /** tuple slot mappings removed by this partition since the last barrier */
+    std::unordered_set<TupleSlot> deleted_slots_;
+  };
+
+  // Number of partitions per replay thread. More partitions than threads keep a few hot tables from being stuck
+  // behind each other in one partition.
+  static constexpr uint32_t PARTITIONS_PER_REPLAY_THREAD = 4;
+
+  // Maximum number of transactions handed to the partitions but not yet replayed. Bounds the memory held by buffered
+  // log records when decoding outpaces replay.
+  static constexpr uint32_t MAX_DISPATCHED_TXNS = 16384;
+
   FRIEND_TEST(RecoveryTests, DoubleRecoveryTest);
   friend class RecoveryTests;
   friend class terrier::RecoveryBenchmark;
@@ -129,6 +243,25 @@ class RecoveryManager : public common::DedicatedThreadOwner {
   // tables during recovery
   const common::ManagedPointer<BlockStore> block_store_;
 
+  // Checkpoint written by a CheckpointManager, loaded before the log is replayed. Empty if there is none.
+  const std::string checkpoint_path_;
+
+  // Number of threads to replay the log with, replay is serial if this is 1
+  const uint32_t num_replay_threads_;
+
+  // Used during parallel replay. Workers and partitions that replay committed transactions on user tables.
+  std::unique_ptr<common::WorkerPool> replay_pool_;
+  std::vector<ReplayPartition> replay_partitions_;
+
+  // Used during parallel replay. Tables that transactions have been dispatched to since the last catalog change.
+  std::unordered_map<catalog::db_oid_t, std::unordered_map<catalog::table_oid_t, std::unique_ptr<ReplayTarget>>>
+      replay_targets_;
+
+  // Used during parallel replay. Number of dispatched transactions that have not been fully replayed yet.
+  std::mutex dispatched_txns_latch_;
+  std::condition_variable dispatched_txns_cv_;
+  uint32_t num_dispatched_txns_ = 0;
+
   // Used during recovery from log. Maps old tuple slot to new tuple slot
   // TODO(Gus): This map may get huge, benchmark whether this becomes a problem and if we need a more sophisticated data
   // structure
@@ -156,16 +289,25 @@ class RecoveryManager : public common::DedicatedThreadOwner {
   uint32_t recovered_txns_;
 
   /**
-   * Recovers the databases using the provided log provider
-   * @return number of committed transactions replayed
+   * Recovers the databases from the checkpoint, if there is one, and the provided log provider
+   */
+  void Recover() {
+    RecoverFromLogs(checkpoint_path_.empty() ? transaction::INITIAL_TXN_TIMESTAMP : RecoverFromCheckpoint());
+  }
+
+  /**
+   * Loads the tables from the checkpoint. Catalog tables are loaded first, then the tables and indexes they describe
+   * are recreated, user tables are loaded in parallel and finally indexes on user tables are built.
+   * @return timestamp of the checkpoint's snapshot, INITIAL_TXN_TIMESTAMP if there is no checkpoint file
    */
-  void Recover() { RecoverFromLogs(); }
+  transaction::timestamp_t RecoverFromCheckpoint();
 
   /**
    * Recovers the databases from the logs.
-   * @note this is a separate method so in the future, we can also have a RecoverFromCheckpoint method
+   * @param checkpoint_ts timestamp of the checkpoint's snapshot. Transactions that committed before it are already in
+   * the checkpoint and are skipped.
    */
-  void RecoverFromLogs();
+  void RecoverFromLogs(transaction::timestamp_t checkpoint_ts = transaction::INITIAL_TXN_TIMESTAMP);
 
   /**
    * @brief Replay a committed transaction corresponding to txn_id.
@@ -173,6 +315,46 @@ class RecoveryManager : public common::DedicatedThreadOwner {
    */
   void ProcessCommittedTransaction(transaction::timestamp_t txn_id);
 
+  /**
+   * Replays a committed transaction. If replay is parallel and the transaction only changes user tables, its changes
+   * are handed to the replay partitions. Otherwise, it is replayed once all dispatched transactions are done.
+   * @param txn_id start timestamp for committed transaction
+   */
+  void ReplayCommittedTransaction(transaction::timestamp_t txn_id);
+
+  /**
+   * Splits a committed transaction's changes by partition and queues them for replay
+   * @param txn_id start timestamp for committed transaction
+   */
+  void DispatchCommittedTransaction(transaction::timestamp_t txn_id);
+
+  /**
+   * Replays a partition's pieces until there are none left
+   * @param partition partition to replay
+   */
+  void ReplayPartitionPieces(ReplayPartition *partition);
+
+  /**
+   * Replays the changes of one transaction to a partition's tables in a new transaction. Index changes are applied
+   * after the table changes, one table and index at a time.
+   * @param partition partition the changes belong to
+   * @param piece changes to replay
+   */
+  void ReplayPartitionPiece(ReplayPartition *partition, const ReplayPiece &piece);
+
+  /**
+   * Waits for all dispatched transactions to be replayed, and merges the partitions' tuple slot mappings. Must be
+   * called before anything else reads tuple_slot_map_ or changes the catalog.
+   */
+  void WaitForDispatchedTransactions();
+
+  /**
+   * @param db_oid database of the table
+   * @param table_oid oid of the table
+   * @return cached pointers to replay changes to a user table with
+   */
+  const ReplayTarget *GetReplayTarget(catalog::db_oid_t db_oid, catalog::table_oid_t table_oid);
+
   /**
    * Defers log records deletes with the transaction manager
    * @param txn_id txn_id for txn who's records to delete
@@ -213,6 +395,35 @@ class RecoveryManager : public common::DedicatedThreadOwner {
     return db_catalog_ptr;
   }
 
+  /**
+   * Creates a database whose entry in pg_database is being recovered, along with its catalog tables
+   * @param txn transaction to create the database with
+   * @param db_oid oid of the database
+   * @param name name of the database
+   * @return slot of the database's new entry in pg_database
+   */
+  TupleSlot RecreateDatabase(transaction::TransactionContext *txn, catalog::db_oid_t db_oid, const std::string &name);
+
+  /**
+   * Sets the schema and table pointers of a table whose entries in pg_class and pg_attribute have been recovered,
+   * creating the table if it is not a catalog table
+   * @param txn transaction to use for catalog changes
+   * @param db_oid database of the table
+   * @param table_oid oid of the table
+   * @return pointer to the table
+   */
+  SqlTable *RecreateTable(transaction::TransactionContext *txn, catalog::db_oid_t db_oid,
+                          catalog::table_oid_t table_oid);
+
+  /**
+   * Sets the schema and index pointers of an index whose entries in pg_class, pg_attribute and pg_index have been
+   * recovered. Indexes that are not on catalog tables are built from the current contents of their table.
+   * @param txn transaction to use for catalog changes
+   * @param db_oid database of the index
+   * @param index_oid oid of the index
+   */
+  void RecreateIndex(transaction::TransactionContext *txn, catalog::db_oid_t db_oid, catalog::index_oid_t index_oid);
+
   /**
    * @param txn transaction to use for catalog lookup
    * @param db_oid database oid for requested table
@@ -238,6 +449,17 @@ class RecoveryManager : public common::DedicatedThreadOwner {
                             catalog::table_oid_t table_oid, common::ManagedPointer<storage::SqlTable> table_ptr,
                             const TupleSlot &tuple_slot, ProjectedRow *table_pr, bool insert);
 
+  /**
+   * Builds an index key from a row of the indexed table
+   * @param index index to build the key for
+   * @param schema schema of the index
+   * @param table_pr row with all columns of the table
+   * @param pr_map projection map of the row
+   * @param index_pr key to fill in
+   */
+  static void BuildIndexKey(common::ManagedPointer<index::Index> index, const catalog::IndexSchema &schema,
+                            const ProjectedRow &table_pr, const ProjectionMap &pr_map, ProjectedRow *index_pr);
+
   /**
    * NYS = Not yet supported
    * Returns whether a delete or redo record is a special case catalog record. The special cases we consider are:
@@ -150,6 +150,20 @@ class SqlTable {
     return table_.data_table_->Scan(txn, start_pos, out_buffer);
   }
 
+  /**
+   * Sequentially scans the table like Scan, but stops at the given end position instead of the end of the table.
+   *
+   * @param txn the calling transaction
+   * @param start_pos iterator to the starting location for the sequential scan
+   * @param end_pos iterator to one past the last slot to scan
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void Scan(const common::ManagedPointer<transaction::TransactionContext> txn, DataTable::SlotIterator *const start_pos,
+            const DataTable::SlotIterator &end_pos, ProjectedColumns *const out_buffer) const {
+    return table_.data_table_->Scan(txn, start_pos, end_pos, out_buffer);
+  }
+
   /**
    * @return the first tuple slot contained in the underlying DataTable
    */
@@ -160,6 +174,11 @@ class SqlTable {
    */
   DataTable::SlotIterator end() const { return table_.data_table_->end(); }  // NOLINT for STL name compability
 
+  /**
+   * @return iterators to the first slot of every block in the underlying DataTable, followed by end()
+   */
+  std::vector<DataTable::SlotIterator> BlockBoundaries() const { return table_.data_table_->BlockBoundaries(); }
+
   /**
    * Generates an ProjectedColumnsInitializer for the execution layer to use. This performs the translation from col_oid
    * to col_id for the Initializer's constructor so that the execution layer doesn't need to know anything about col_id.
@@ -202,7 +221,8 @@ class SqlTable {
   ProjectionMap ProjectionMapForOids(const std::vector<catalog::col_oid_t> &col_oids);
 
  private:
-  friend class RecoveryManager;  // Needs access to OID and ID mappings
+  friend class CheckpointManager;  // Needs access to the layout and OID mappings
+  friend class RecoveryManager;    // Needs access to OID and ID mappings
   friend class terrier::RandomSqlTableTransaction;
   friend class terrier::LargeSqlTableTestObject;
   friend class RecoveryTests;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <functional>
 #include <ostream>
 #include <string>
@@ -56,10 +58,10 @@ class alignas(common::Constants::BLOCK_SIZE) RawBlock {
   DataTable *data_table_;
 
   /**
-   * Padding for flags or whatever we may want in the future. Determined by size of layout_version below. See
+   * NUMA node whose free lists the BlockStore returns this block to. Determined by size of layout_version below. See
    * tuple_access_strategy.h for more details on Block header layout.
    */
-  uint16_t padding_;
+  uint16_t numa_node_;
 
   /**
    * Layout version.
@@ -74,6 +76,17 @@ class alignas(common::Constants::BLOCK_SIZE) RawBlock {
    * If the first bit is 0, the block is insertable, otherwise one txn is inserting to this block
    */
   std::atomic<uint32_t> insert_head_;
+  /**
+   * Version synopsis of this block: the number of slots in the block with a version chain. Writers increment it when
+   * they install the first version of a slot and the GC decrements it when it truncates a version chain entirely.
+   * Every present tuple of a block where this is 0 is visible to all running transactions as it is stored in the block,
+   * so readers can skip the MVCC checks for the whole block.
+   */
+  std::atomic<uint32_t> num_versioned_slots_;
+  /**
+   * Padding to keep contents 8-byte aligned, which the Arrow metadata at their start relies on.
+   */
+  uint32_t padding_;
   /**
    * Access controller of this block that coordinates access among Arrow readers, transactional workers
    * and the transformation thread. In practice this can be used almost like a lock.
@@ -84,7 +97,7 @@ class alignas(common::Constants::BLOCK_SIZE) RawBlock {
    * Contents of the raw block.
    */
   byte content_[common::Constants::BLOCK_SIZE - sizeof(uintptr_t) - sizeof(uint16_t) - sizeof(layout_version_t) -
-                sizeof(uint32_t) - sizeof(BlockAccessController)];
+                sizeof(uint32_t) - sizeof(uint32_t) - sizeof(uint32_t) - sizeof(BlockAccessController)];
   // A Block needs to always be aligned to 1 MB, so we can get free bytes to
   // store offsets within a block in one 8-byte word
 
@@ -95,6 +108,7 @@ class alignas(common::Constants::BLOCK_SIZE) RawBlock {
    */
   uint32_t GetInsertHead() { return INT32_MAX & insert_head_.load(); }
 };
+static_assert(sizeof(RawBlock) == common::Constants::BLOCK_SIZE, "a RawBlock's header and contents must fill a block");
 
 /**
  * A TupleSlot represents a physical location of a tuple in memory.
@@ -159,42 +173,143 @@ class TupleSlot {
 
  private:
   friend struct std::hash<TupleSlot>;
+  friend struct std::less<TupleSlot>;
   // Block pointers are always aligned to 1 mb, thus we get 5 free bytes to
   // store the offset.
   uintptr_t bytes_;
 };
 
 /**
- * Allocator that allocates a block
+ * A block store hands out the blocks that DataTables are made of. It has the same interface and limits as an object
+ * pool, but allocates blocks out of large regions that are mapped directly from the OS, backed by huge pages when
+ * possible, so that scans over many blocks need fewer TLB entries. Regions are placed on the NUMA node of the thread
+ * that needed them, and free blocks are kept in lock-free per-node free lists, so that threads get blocks that are
+ * local to them without latching.
+ *
+ * Blocks that are released while the store already holds reuse_limit free blocks have their memory given back to the
+ * OS, but keep their address range so that it can be reused without mapping more memory.
  */
-class BlockAllocator {
+class BlockStore {
  public:
   /**
-   * Allocates a new object by calling its constructor.
-   * @return a pointer to the allocated object.
+   * Initializes a new block store with the supplied limits.
+   * @param size_limit the maximum number of blocks the store backs with memory, including reusable ones
+   * @param reuse_limit the maximum number of released blocks the store keeps around for reuse
    */
-  RawBlock *New() { return new RawBlock(); }
+  BlockStore(uint64_t size_limit, uint64_t reuse_limit);
 
   /**
-   * Reuse a reused chunk of memory to be handed out again
-   * @param reused memory location, possibly filled with junk bytes
+   * Unmaps the memory of the store, unless some blocks were never released.
    */
-  void Reuse(RawBlock *const reused) { /* no operation required */
-  }
+  ~BlockStore();
+
+  DISALLOW_COPY_AND_MOVE(BlockStore)
+
+  /**
+   * Returns a block, preferably one on the NUMA node of the calling thread. Blocks that are newly allocated are zeroed,
+   * reused blocks may contain junk.
+   * @throw NoMoreObjectException if the block store has reached the limit of how many blocks it may hand out.
+   * @throw AllocatorFailureException if memory for the block cannot be mapped.
+   * @return pointer to the block
+   */
+  RawBlock *Get();
+
+  /**
+   * Releases the block given, allowing it to be reused or its memory to be given back to the OS. It is unsafe to
+   * access after entering this call.
+   * @param block pointer to the block to release
+   */
+  void Release(RawBlock *block);
+
+  /**
+   * Set the block store's size limit. The operation fails if more blocks than that are already backed by memory.
+   * @param new_size the new size limit
+   * @return true if new_size is successfully set and false the operation fails
+   */
+  bool SetSizeLimit(uint64_t new_size);
 
   /**
-   * Deletes the object by calling its destructor.
-   * @param ptr a pointer to the object to be deleted.
+   * Set the reuse limit to a new value, giving the memory of any reusable blocks in excess of it back to the OS.
+   * @param new_reuse_limit the new reuse limit
    */
-  void Delete(RawBlock *const ptr) { delete ptr; }
+  void SetReuseLimit(uint64_t new_reuse_limit);
+
+  /**
+   * @return size limit of the block store
+   */
+  uint64_t GetSizeLimit() const { return size_limit_.load(); }
+
+ private:
+  // Nodes beyond this are folded onto the lower ones
+  static constexpr uint32_t MAX_NUMA_NODES = 8;
+  // Regions of 64 blocks are mapped at a time, aligned to huge page boundaries
+  static constexpr uint64_t BLOCKS_PER_REGION = 64;
+  static constexpr uint64_t REGION_SIZE = BLOCKS_PER_REGION * common::Constants::BLOCK_SIZE;
+  static constexpr uint64_t HUGE_PAGE_SIZE = 2 * common::Constants::MB;
+
+  // Free blocks are kept in nodes outside of the blocks, so that a thread that is about to pop a block never reads the
+  // memory of a block that someone else popped and is writing to. Nodes are stored in segments of doubling size that
+  // are never moved or freed while the store is alive, and their links are only ever accessed atomically.
+  struct FreeNode {
+    RawBlock *block_;
+    std::atomic<uint64_t> next_;
+  };
+
+  // Segment i holds FIRST_NODE_SEGMENT_SIZE << i nodes, so that all node indexes fit in 32 bits
+  static constexpr uint64_t FIRST_NODE_SEGMENT_SIZE = 64;
+  static constexpr uint32_t NUM_NODE_SEGMENTS = 25;
+
+  // A lock-free stack of nodes, linked by their indexes. The head holds the index of the top node plus one, or 0 if the
+  // stack is empty, in its low half and a counter that is bumped on every change to prevent ABA in its high half.
+  class FreeList {
+   public:
+    void Push(BlockStore *store, uint32_t index);
+    bool Pop(BlockStore *store, uint32_t *index);
+
+   private:
+    std::atomic<uint64_t> head_{0};
+  };
+
+  // A mapped region of memory, which blocks are carved out of in order
+  struct Region {
+    byte *base_;
+    std::atomic<uint64_t> next_block_{0};
+    Region *next_region_ = nullptr;
+  };
+
+  struct alignas(common::Constants::CACHELINE_SIZE) Node {
+    // released blocks that are still backed by memory
+    FreeList reusable_;
+    // Released blocks whose memory was given back to the OS. These cannot be linked through their own memory without
+    // faulting it back in, but are only touched on the slow path that calls into the OS anyway.
+    common::SpinLatch unbacked_latch_;
+    std::vector<RawBlock *> unbacked_;
+    // region that new blocks for this node are carved out of
+    std::atomic<Region *> region_{nullptr};
+  };
+
+  static uint32_t CurrentNumaNode();
+  static Region *MapRegion(uint32_t node);
+  FreeNode *NodeAt(uint32_t index) const;
+  void PushReusable(uint32_t node, RawBlock *block);
+  RawBlock *NewBlock(uint32_t node);
+  RawBlock *PopReusable(uint32_t node);
+  void Unback(RawBlock *block);
+
+  std::array<Node, MAX_NUMA_NODES> nodes_;
+  // every region ever mapped, for unmapping them in the destructor
+  std::atomic<Region *> regions_{nullptr};
+  std::array<std::atomic<FreeNode *>, NUM_NODE_SEGMENTS> node_segments_{};
+  std::atomic<uint32_t> num_nodes_{0};
+  // nodes that currently hold no block
+  FreeList spare_nodes_;
+  std::atomic<uint64_t> size_limit_;
+  std::atomic<uint64_t> reuse_limit_;
+  // number of blocks backed by memory, including the ones handed out and the reusable ones
+  std::atomic<uint64_t> current_size_{0};
+  std::atomic<uint64_t> num_reusable_{0};
 };
 
-/**
- * A block store is essentially an object pool. However, all blocks should be
- * aligned, so we will need to use the default constructor instead of raw
- * malloc.
- */
-using BlockStore = common::ObjectPool<RawBlock, BlockAllocator>;
 /**
  * Used by SqlTable to map between col_oids in Schema and col_ids in BlockLayout
  */
@@ -434,4 +549,20 @@ struct hash<terrier::storage::TupleSlot> {
    */
   size_t operator()(const terrier::storage::TupleSlot &slot) const { return hash<uintptr_t>()(slot.bytes_); }
 };
+
+/**
+ * Implements std::less for TupleSlot. The order has no meaning beyond being consistent with equality, which lets
+ * ordered containers (such as the value pages of a BPlusTree) hold TupleSlots.
+ */
+template <>
+struct less<terrier::storage::TupleSlot> {
+  /**
+   * @param lhs first slot
+   * @param rhs second slot
+   * @return true if the first slot is ordered before the second
+   */
+  bool operator()(const terrier::storage::TupleSlot &lhs, const terrier::storage::TupleSlot &rhs) const {
+    return lhs.bytes_ < rhs.bytes_;
+  }
+};
 }  // namespace std
@@ -44,9 +44,11 @@ class TupleAccessStrategy {
   /*
    * Block Header layout:
    * -----------------------------------------------------------------------------------------------------------------
-   * | data_table *(64) | padding (16) | layout_version (16) | insert_head (32) |        control_block (64)          |
+   * | data_table *(64) | numa_node (16) | layout_version (16) | insert_head (32) | num_versioned_slots (32) |
    * -----------------------------------------------------------------------------------------------------------------
-   * | ArrowBlockMetadata | attr_offsets[num_col] (32) | bitmap for slots (64-bit aligned) | data (64-bit aligned)   |
+   * | control_block (64) | ArrowBlockMetadata | attr_offsets[num_col] (32) | bitmap for slots (64-bit aligned) |
+   * -----------------------------------------------------------------------------------------------------------------
+   * | data (64-bit aligned)                                                                                          |
    * -----------------------------------------------------------------------------------------------------------------
    *
    * Note that we will never need to span a tuple across multiple pages if we enforce
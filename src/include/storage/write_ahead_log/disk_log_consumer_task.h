@@ -18,21 +18,28 @@ class DiskLogConsumerTask : public common::DedicatedThreadTask {
  public:
   /**
    * Constructs a new DiskLogConsumerTask
-   * @param persist_interval Interval time for when to persist log file
-   * @param persist_threshold threshold of data written since the last persist to trigger another persist
-   * @param buffers pointer to list of all buffers used by log manager, used to persist log file
+   * @param persist_interval Interval time for when to persist log file. When adapting, this is the longest interval.
+   * @param persist_threshold threshold of data written since the last persist to trigger another persist. When
+   * adapting, this is the largest threshold.
+   * @param log_files the log file of every log stream, used to persist
    * @param empty_buffer_queue pointer to queue to push empty buffers to
    * @param filled_buffer_queue pointer to queue to pop filled buffers from
+   * @param adaptive_persist whether to tune the persist interval and threshold to the observed commit rate and persist
+   * latency
    */
   explicit DiskLogConsumerTask(const std::chrono::milliseconds persist_interval, uint64_t persist_threshold,
-                               std::vector<BufferedLogWriter> *buffers,
+                               std::vector<LogFile *> log_files,
                                common::ConcurrentBlockingQueue<BufferedLogWriter *> *empty_buffer_queue,
-                               common::ConcurrentQueue<storage::SerializedLogs> *filled_buffer_queue)
+                               common::ConcurrentQueue<storage::SerializedLogs> *filled_buffer_queue,
+                               const bool adaptive_persist = false)
       : run_task_(false),
+        max_persist_interval_(persist_interval),
+        max_persist_threshold_(persist_threshold),
+        adaptive_persist_(adaptive_persist),
         persist_interval_(persist_interval),
         persist_threshold_(persist_threshold),
         current_data_written_(0),
-        buffers_(buffers),
+        log_files_(std::move(log_files)),
         empty_buffer_queue_(empty_buffer_queue),
         filled_buffer_queue_(filled_buffer_queue) {}
 
@@ -53,22 +60,31 @@ class DiskLogConsumerTask : public common::DedicatedThreadTask {
   // Stores callbacks for commit records written to disk but not yet persisted
   std::vector<storage::CommitCallback> commit_callbacks_;
 
+  // Configured persist interval and threshold, which adaptive persisting does not go over
+  const std::chrono::microseconds max_persist_interval_;
+  const uint64_t max_persist_threshold_;
+  // Whether the interval and threshold below are tuned to the workload
+  const bool adaptive_persist_;
   // Interval time for when to persist log file
-  const std::chrono::milliseconds persist_interval_;
+  std::chrono::microseconds persist_interval_;
   // Threshold of data written since the last persist to trigger another persist
   uint64_t persist_threshold_;
   // Amount of data written since last persist
   uint64_t current_data_written_;
+  // Moving averages of how long a persist takes, and of the rates at which commits and bytes arrive, in microseconds
+  double avg_persist_us_ = 0;
+  double avg_commits_per_us_ = 0;
+  double avg_bytes_per_us_ = 0;
 
-  // This stores a reference to all the buffers the log manager has created. Used for persisting
-  std::vector<BufferedLogWriter> *buffers_;
+  // The log files the buffers are written to. Used for persisting
+  std::vector<LogFile *> log_files_;
   // The queue containing empty buffers. Task will enqueue a buffer into this queue when it has flushed its logs
   common::ConcurrentBlockingQueue<BufferedLogWriter *> *empty_buffer_queue_;
   // The queue containing filled buffers. Task should dequeue filled buffers from this queue to flush
   common::ConcurrentQueue<SerializedLogs> *filled_buffer_queue_;
 
   // Flag used by the serializer thread to signal the disk log consumer task thread to persist the data on disk
-  volatile bool do_persist_;
+  volatile bool do_persist_ = false;
 
   // Synchronisation primitives to synchronise persisting buffers to disk
   std::mutex persist_lock_;
@@ -89,10 +105,22 @@ class DiskLogConsumerTask : public common::DedicatedThreadTask {
   void WriteBuffersToLogFile();
 
   /*
-   * Persists the log file on disk by calling fsync, as well as calling callbacks for all committed transactions that
-   * were persisted
+   * Persists the log file on disk by calling fdatasync, as well as calling callbacks for all committed transactions
+   * that were persisted
    * @return number of buffers persisted, used for metrics
    */
   uint64_t PersistLogFile();
+
+  /*
+   * Retunes the persist interval and threshold after a persist, so that a persist waits about as long as the previous
+   * one took, and groups the commits that arrive meanwhile. When commits are too rare to be grouped, every write is
+   * persisted right away instead.
+   * @param since_last_persist time between the previous persist and this one
+   * @param persist_us time this persist took
+   * @param num_commits number of commits persisted
+   * @param num_bytes number of bytes persisted
+   */
+  void AdaptPersistInterval(std::chrono::microseconds since_last_persist, uint64_t persist_us, uint64_t num_commits,
+                            uint64_t num_bytes);
 };
 }  // namespace terrier::storage
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "common/macros.h"
+
+namespace terrier::storage {
+
+/**
+ * Minimal wrapper around a Linux io_uring instance, driven through the raw system calls so that no library is needed.
+ * Only what the log needs is supported: writes at a given offset and fdatasync, submitted in batches and reaped in any
+ * order. A ring must only be used by one thread at a time.
+ */
+class IoUring {
+ public:
+  /**
+   * Result of a finished request
+   */
+  struct Completion {
+    /**
+     * value given when the request was queued
+     */
+    uint64_t user_data_;
+    /**
+     * result of the request as returned by the corresponding system call, or the negated errno on failure
+     */
+    int32_t result_;
+  };
+
+  /**
+   * Sets up a new ring
+   * @param num_entries number of requests that can be queued at once, rounded up to a power of two by the kernel
+   * @return the ring, or nullptr if io_uring is not supported by the platform or kernel, or not permitted
+   */
+  static std::unique_ptr<IoUring> Create(uint32_t num_entries);
+
+  DISALLOW_COPY_AND_MOVE(IoUring)
+
+  /**
+   * Tears down the ring. Requests still in flight finish in the background, so their buffers must outlive them.
+   */
+  ~IoUring();
+
+  /**
+   * Queues a write of a buffer at an offset into a file, like pwrite
+   * @param fd file to write to
+   * @param buf bytes to write, which must not be touched until the request completes
+   * @param nbyte number of bytes to write
+   * @param offset position in the file to write at
+   * @param user_data value returned with the completion
+   * @return false if the submission queue is full, in which case nothing was queued
+   */
+  bool QueueWrite(int fd, const void *buf, uint32_t nbyte, uint64_t offset, uint64_t user_data);
+
+  /**
+   * Queues an fdatasync of a file, which only starts once every request queued before it has completed
+   * @param fd file to persist
+   * @param user_data value returned with the completion
+   * @return false if the submission queue is full, in which case nothing was queued
+   */
+  bool QueueDataSync(int fd, uint64_t user_data);
+
+  /**
+   * Hands all queued requests to the kernel
+   * @throws runtime_error if the kernel refused them
+   */
+  void Submit() { Enter(0); }
+
+  /**
+   * Hands all queued requests to the kernel, and returns the result of one of the requests in flight, blocking until
+   * one finishes if necessary
+   * @return the completion
+   * @throws runtime_error if the kernel refused the requests
+   */
+  Completion WaitCompletion();
+
+ private:
+  const int ring_fd_;
+  const uint32_t num_entries_;
+  // Mappings of the rings shared with the kernel, the second one is nullptr if both rings share the first mapping
+  void *sq_ring_ = nullptr, *cq_ring_ = nullptr;
+  uint64_t sq_ring_size_ = 0, cq_ring_size_ = 0;
+  void *sqes_ = nullptr;
+  uint64_t sqes_size_ = 0;
+  // Pointers into the mappings
+  uint32_t *sq_head_, *sq_tail_, *sq_mask_, *sq_array_;
+  uint32_t *cq_head_, *cq_tail_, *cq_mask_;
+  void *cqes_;
+  // Queued requests the kernel was not told about yet
+  uint32_t to_submit_ = 0;
+
+  explicit IoUring(int ring_fd, uint32_t num_entries) : ring_fd_(ring_fd), num_entries_(num_entries) {}
+
+  // Returns the next free submission queue entry zeroed out, or nullptr if the queue is full
+  void *NextEntry();
+  // Queues the entry returned by NextEntry once it is filled in
+  void PushEntry();
+  bool PopCompletion(Completion *completion);
+  void Enter(uint32_t min_complete);
+};
+
+}  // namespace terrier::storage
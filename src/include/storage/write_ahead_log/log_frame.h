@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+
+namespace terrier::storage {
+
+/**
+ * The log is written as a sequence of frames, one per flushed log buffer. A frame is a header followed by the bytes of
+ * the buffer, which may be compressed:
+ * ----------------------------------------------------------------------------------
+ * | magic (16) | flags (16) | size (32) | decoded_size (32) | checksum (32) | payload |
+ * ----------------------------------------------------------------------------------
+ * where size is the length of the payload, decoded_size that of the buffer it decodes to, and the checksum is a CRC32C
+ * of the rest of the header and the payload. A frame that fails the checksum because a crash tore the write of it ends
+ * the log. Such frames are cut off when the log is opened again, so anywhere but in the last file of the log, a bad
+ * frame means the log is corrupted.
+ *
+ * A log written by several serializers marks the end of every serialization round in each of its streams with a frame
+ * that holds the number of the round instead of records, see LogFile::MarkRounds.
+ *
+ * Compression uses the LZ4 block format: a sequence of literal runs, each followed by a back reference of at least
+ * MIN_MATCH bytes into the up to 64KB of data before it.
+ */
+class LogFrame {
+ public:
+  LogFrame() = delete;
+
+  /**
+   * Marks the start of a frame
+   */
+  static constexpr uint16_t MAGIC = 0x4657;  // "WF"
+  /**
+   * Flag set on frames whose payload is compressed
+   */
+  static constexpr uint16_t COMPRESSED = 0x1;
+  /**
+   * Flag set on frames that mark the end of a serialization round. Their payload is the uncompressed 64-bit number of
+   * the round.
+   */
+  static constexpr uint16_t END_OF_ROUND = 0x2;
+  /**
+   * Size of the frame header in bytes
+   */
+  static constexpr uint32_t HEADER_SIZE = 16;
+
+  /**
+   * Fills in the header of a frame
+   * @param frame start of the frame, followed by the payload
+   * @param flags flags of the frame
+   * @param size length of the payload
+   * @param decoded_size length of the buffer the payload decodes to
+   */
+  static void WriteHeader(byte *frame, uint16_t flags, uint32_t size, uint32_t decoded_size);
+
+  /**
+   * Checks the header of a frame, without checking its checksum
+   * @param frame start of the frame, of which at least HEADER_SIZE bytes must be readable
+   * @param max_size largest payload or decoded buffer a valid frame can have
+   * @param[out] flags flags of the frame
+   * @param[out] size length of the payload
+   * @param[out] decoded_size length of the buffer the payload decodes to
+   * @return false if this is not the start of a valid frame
+   */
+  static bool ReadHeader(const byte *frame, uint32_t max_size, uint16_t *flags, uint32_t *size,
+                         uint32_t *decoded_size);
+
+  /**
+   * @param frame start of a frame whose header has been read, and that is followed by its whole payload
+   * @return whether the checksum of the frame matches its contents
+   */
+  static bool Verify(const byte *frame);
+
+  /**
+   * Computes a CRC32C, with the SSE4.2 crc32 instruction where the build targets it
+   * @param data bytes to checksum
+   * @param size number of bytes
+   * @param crc checksum of the bytes before, to continue from
+   * @return the checksum
+   */
+  static uint32_t Checksum(const void *data, uint32_t size, uint32_t crc = 0);
+
+  /**
+   * Compresses a buffer
+   * @param src bytes to compress
+   * @param size number of bytes
+   * @param[out] dest where to write the compressed bytes
+   * @param capacity space available at dest
+   * @return length of the compressed bytes, or 0 if they would not fit into capacity
+   */
+  static uint32_t Compress(const byte *src, uint32_t size, byte *dest, uint32_t capacity);
+
+  /**
+   * Decompresses a buffer compressed with Compress. Malformed input is detected rather than trusted.
+   * @param src compressed bytes
+   * @param size number of compressed bytes
+   * @param[out] dest where to write the decompressed bytes
+   * @param decoded_size number of bytes the input decompresses to
+   * @return false if the input is malformed, or does not decompress to exactly decoded_size bytes
+   */
+  static bool Decompress(const byte *src, uint32_t size, byte *dest, uint32_t decoded_size);
+
+ private:
+  // Shortest back reference worth encoding
+  static constexpr uint32_t MIN_MATCH = 4;
+  // A buffer ends in at least this many literals, and no match starts within the last MATCH_LIMIT bytes
+  static constexpr uint32_t LAST_LITERALS = 5;
+  static constexpr uint32_t MATCH_LIMIT = 12;
+  // Farthest back a match can reference
+  static constexpr uint32_t MAX_OFFSET = UINT16_MAX;
+  // Number of bits of the hash of 4 bytes used to find earlier occurrences of them
+  static constexpr uint32_t HASH_BITS = 12;
+};
+
+}  // namespace terrier::storage
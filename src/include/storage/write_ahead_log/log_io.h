@@ -6,10 +6,17 @@
 #include <unistd.h>
 #include <cerrno>
 #include <cstring>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "common/constants.h"
 #include "common/macros.h"
+#include "common/spin_latch.h"
 #include "loggers/storage_logger.h"
+#include "storage/write_ahead_log/io_uring.h"
+#include "storage/write_ahead_log/log_frame.h"
+#include "transaction/transaction_defs.h"
 
 namespace terrier::storage {
 
@@ -68,29 +75,271 @@ struct PosixIoWrappers {
    * @throws runtime_error if the underlying posix call failed
    */
   static void WriteFully(int fd, const void *buf, size_t nbyte);
+
+  /**
+   * Wrapper around the posix pwrite call, where a single function call will always write the entire buffer out.
+   * @param fd posix fildes arg
+   * @param buf posix buf arg
+   * @param nbyte posix nbyte arg
+   * @param offset posix offset arg
+   * @throws runtime_error if the underlying posix call failed
+   */
+  static void WriteFullyAt(int fd, const void *buf, size_t nbyte, off_t offset);
+
+  /**
+   * Wrapper around the posix fdatasync call
+   * @param fd posix fildes arg
+   * @throws runtime_error if the underlying posix call failed
+   */
+  static void DataSync(int fd);
+
+  /**
+   * Persists the entries of the directory that a file is in, e.g. after creating, renaming or removing the file
+   * @param path path of the file
+   * @throws runtime_error if the underlying posix call failed
+   */
+  static void SyncParentDirectory(const std::string &path);
+
+  /**
+   * Reserves disk space for a file without changing its size, so that appending to it later does not have to allocate
+   * blocks, and persisting it only has to update its size. This is only a hint, and does nothing where unsupported.
+   * @param fd posix fildes arg
+   * @param offset start of the range to reserve
+   * @param len length of the range to reserve
+   */
+  static void Preallocate(int fd, off_t offset, off_t len);
+};
+
+/**
+ * The write ahead log on disk. The log is either a single file that grows forever, or a sequence of segment files named
+ * after the log file path with an increasing number appended (e.g. wal.log.0000000001). Segments are preallocated, and
+ * a new one is started when the serializer ends the current one. Segments whose transactions all finished before a
+ * checkpoint was taken can be removed.
+ *
+ * With several log serializers, every serializer writes its own log stream. The first stream is at the log file path,
+ * the others at the path followed by ".stream" and the stream's number, and each can be segmented in the same way.
+ * Every stream then marks the end of each serialization round, so that recovery can stop all of them at the last round
+ * that was persisted in every stream. The number of serializers must not change between runs, as the rounds of the
+ * streams would no longer line up.
+ *
+ * Writes can go through io_uring instead of posix calls. They are then gathered into large batches, several of which
+ * are written at once while the next one is filled, and a persist is an fdatasync queued behind them. Where io_uring is
+ * not available, the log falls back to posix calls.
+ *
+ * Writing and persisting must happen from a single thread, removing segments may happen concurrently.
+ */
+class LogFile {
+ public:
+  /**
+   * Opens the log for appending. When segmented, a new segment is started after any existing ones.
+   * @param log_file_path path to the log file, or prefix of the segment files
+   * @param segment_size size of a segment in bytes, or 0 to write a single file
+   * @param use_io_uring whether to write through io_uring where available
+   */
+  LogFile(std::string log_file_path, uint64_t segment_size, bool use_io_uring = false);
+
+  /**
+   * @param log_file_path path to the log file, or prefix of the segment files
+   * @return paths of all files of the log in order: the single log file if there is one, followed by all segments
+   */
+  static std::vector<std::string> FilePaths(const std::string &log_file_path);
+
+  /**
+   * @param log_file_path path to the log file
+   * @param stream number of a log stream
+   * @return path to the log file of the stream, or prefix of its segment files
+   */
+  static std::string StreamPath(const std::string &log_file_path, uint32_t stream);
+
+  /**
+   * @param log_file_path path to the log file
+   * @return paths of all files of every log stream, as returned by FilePaths for each stream in order
+   */
+  static std::vector<std::vector<std::string>> StreamFilePaths(const std::string &log_file_path);
+
+  /**
+   * Renames every file of every stream of a log, so that they are the files of a log at another path
+   * @param log_file_path path to the log file
+   * @param new_log_file_path path to the log file after renaming
+   */
+  static void Rename(const std::string &log_file_path, const std::string &new_log_file_path);
+
+  /**
+   * Removes every file of every stream of a log
+   * @param log_file_path path to the log file
+   */
+  static void Remove(const std::string &log_file_path);
+
+  /**
+   * @param stream_file_paths paths of all files of every stream of a log, as returned by StreamFilePaths
+   * @return the last serialization round that ends in every stream of the log, or 0 if there is none
+   */
+  static uint64_t CommonRound(const std::vector<std::vector<std::string>> &stream_file_paths);
+
+  /**
+   * Cuts every stream of a log written by several serializers back to the end of the last round that ends in all of
+   * them. A crash can leave a round persisted in some streams but not in others, and none of its transactions were
+   * reported as committed. Appending to the streams would otherwise bury such a round in the middle of the log. Must be
+   * called before the streams are opened.
+   * @param log_file_path path to the log file
+   * @return the last round left in the log, or 0 if there is none
+   */
+  static uint64_t TruncateToCommonRound(const std::string &log_file_path);
+
+  /**
+   * @return size of a segment in bytes, or 0 if the log is a single file
+   */
+  uint64_t SegmentSize() const { return segment_size_; }
+
+  /**
+   * @return whether writes go through io_uring, which is not the case if it was not asked for or is unavailable
+   */
+  bool UsesIoUring() const { return ring_ != nullptr; }
+
+  /**
+   * Makes the log mark the ends of serialization rounds, which the streams of a log written by several serializers do.
+   * Every segment then starts with the marker of the last round that ended before it, so that removing the segments
+   * before it does not lose that marker.
+   * @param last_round the last round in the log, as returned by TruncateToCommonRound, after which rounds are numbered
+   */
+  void MarkRounds(uint64_t last_round);
+
+  /**
+   * Appends the marker of the end of the next serialization round, without persisting it
+   */
+  void EndRound() {
+    TERRIER_ASSERT(marks_rounds_, "The log does not mark rounds");
+    last_round_++;
+    WriteRoundMarker();
+  }
+
+  /**
+   * Appends to the log, without persisting the write
+   * @param data memory location of the bytes to write
+   * @param size number of bytes to write
+   */
+  void Write(const void *data, uint32_t size);
+
+  /**
+   * Persists everything written to the log so far
+   */
+  void Persist() {
+    if (!unpersisted_) return;
+    if (ring_ == nullptr) {
+      PosixIoWrappers::DataSync(out_);
+    } else {
+      PersistBatches();
+    }
+    unpersisted_ = false;
+  }
+
+  /**
+   * Persists and closes the current segment, and starts a new one. Must only be called at a record boundary.
+   * @param max_txn_begin newest start timestamp of any transaction with records in the current segment
+   */
+  void EndSegment(transaction::timestamp_t max_txn_begin);
+
+  /**
+   * Removes the oldest segments that only contain records of transactions that started before the given timestamp.
+   * Segments written before the log was opened are removed as well, as every transaction in them has finished.
+   * @param oldest_txn start timestamp of the oldest transaction whose records are still needed, e.g. the oldest
+   * transaction that was running when a checkpoint was started
+   * @return number of segments removed
+   */
+  uint32_t RemoveSegmentsBefore(transaction::timestamp_t oldest_txn);
+
+  /**
+   * Gives back preallocated space and closes the log. Must be called before the object is destructed.
+   */
+  void Close();
+
+ private:
+  // Amount of space reserved ahead of the end of a single file log
+  static constexpr uint64_t PREALLOCATION_SIZE = 1U << 24U;
+  // Size of a batch of writes handed to io_uring at once, and how many batches there are
+  static constexpr uint32_t IO_BATCH_SIZE = 1U << 18U;
+  static constexpr uint32_t NUM_IO_BATCHES = 8;
+  // Marks the completion of an fdatasync, other completions carry the index of the batch that was written
+  static constexpr uint64_t SYNC_REQUEST = UINT64_MAX;
+
+  // Writes gathered for io_uring, which are in flight until their completion is reaped
+  struct IoBatch {
+    byte *buffer_;
+    uint32_t size_ = 0;
+    // Position of the batch in the file
+    uint64_t offset_ = 0;
+    bool in_flight_ = false;
+  };
+
+  const std::string log_file_path_;
+  const uint64_t segment_size_;
+  int out_;  // fd of the file being appended to
+  uint64_t size_ = 0;
+  uint64_t preallocated_size_ = 0;
+  // Whether anything was written since the last persist
+  bool unpersisted_ = false;
+  uint64_t segment_id_ = 0;
+  // Whether the ends of rounds are marked, and the last round that ended
+  bool marks_rounds_ = false;
+  uint64_t last_round_ = 0;
+
+  // nullptr if writing with posix calls
+  std::unique_ptr<IoUring> ring_;
+  // Page aligned memory backing the batches
+  byte *batch_memory_ = nullptr;
+  std::vector<IoBatch> batches_;
+  // The batch being filled
+  uint32_t current_batch_ = 0;
+  bool sync_in_flight_ = false;
+  // Whether a write or persist through io_uring failed and was redone synchronously, without being persisted since
+  bool needs_sync_ = false;
+
+  // Protects closed_segments_
+  common::SpinLatch segments_latch_;
+  // Segments that are no longer written to, oldest first, along with the newest start timestamp of a transaction with
+  // records in them. Segments from before the log was opened have INVALID_TXN_TIMESTAMP.
+  std::vector<std::pair<uint64_t, transaction::timestamp_t>> closed_segments_;
+
+  std::string SegmentPath(uint64_t segment_id) const;
+  void OpenSegment();
+  void WriteRoundMarker();
+  // Hands the current batch to io_uring, and waits until the next one is free to be filled
+  void SubmitBatch();
+  // Submits what is gathered, then waits for every write and an fdatasync after them to complete
+  void PersistBatches();
+  // Waits for one request to complete, and finishes it synchronously if it failed
+  void ReapCompletion();
 };
 // TODO(Tianyu):  we need control over when and what to flush as the log manager. Thus, we need to write our
 // own wrapper around lower level I/O functions. I could be wrong, and in that case we should
 // revert to using STL.
 /**
- * Handles buffered writes to the write ahead log, and provides control over flushing.
+ * Handles buffered writes to the write ahead log, and provides control over flushing. Every flush writes the buffer as
+ * one LogFrame.
  */
 class BufferedLogWriter {
-  // TODO(Tianyu): Checksum
  public:
   /**
-   * Instantiates a new BufferedLogWriter to write to the specified log file.
+   * Instantiates a new BufferedLogWriter to write to the specified log.
    *
-   * @param log_file_path path to the the log file to write to. New entries are appended to the end of the file if the
-   * file already exists; otherwise, a file is created.
+   * @param out the log to write to. New entries are appended to its end.
+   * @param compress whether to compress the frames written, which are written uncompressed if that does not make them
+   * smaller
    */
-  explicit BufferedLogWriter(const char *log_file_path)
-      : out_(PosixIoWrappers::Open(log_file_path, O_WRONLY | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR)) {}
+  explicit BufferedLogWriter(LogFile *out, bool compress = false)
+      : out_(out),
+        compressed_(compress ? new byte[LogFrame::HEADER_SIZE + common::Constants::LOG_BUFFER_SIZE] : nullptr) {}
 
   /**
-   * Must call before object is destructed
+   * Points the writer at another log. Buffers are shared between log streams, so a serializer points a buffer at its
+   * stream before filling it.
+   * @param out the log to write to. Must only be changed while nothing is buffered.
    */
-  void Close() { PosixIoWrappers::Close(out_); }
+  void SetLogFile(LogFile *out) {
+    TERRIER_ASSERT(buffer_size_ == 0 && !ends_segment_ && !ends_round_ && !sealed_,
+                   "Buffered writes would go to the wrong log");
+    out_ = out;
+  }
 
   /**
    * Write to the log file the given amount of bytes from the given location in memory, but buffer the write so the
@@ -103,61 +352,106 @@ class BufferedLogWriter {
    * offset when calling this function again after flushing.
    */
   uint32_t BufferWrite(const void *data, uint32_t size) {
+    TERRIER_ASSERT(!sealed_, "Writing to a buffer that was sealed already");
     // If we still do not have buffer space after flush, the write is too large to be buffered. We partially write the
     // buffer and return the number of bytes written
     if (!CanBuffer(size)) {
       size = common::Constants::LOG_BUFFER_SIZE - buffer_size_;
     }
-    std::memcpy(buffer_ + buffer_size_, data, size);
+    std::memcpy(buffer_ + LogFrame::HEADER_SIZE + buffer_size_, data, size);
     buffer_size_ += size;
     return size;
   }
 
   /**
-   * Call fsync to make sure that all writes are consistent.
+   * Encodes the buffered writes as a frame, compressing them if enabled. Serializers seal buffers before handing them
+   * over, so that compressing them does not hold up flushing. Nothing can be buffered until the frame is flushed.
    */
-  void Persist() {
-    if (fsync(out_) == -1) throw std::runtime_error("fsync failed with errno " + std::to_string(errno));
-  }
+  void SealFrame();
 
   /**
-   * Flush any buffered writes.
+   * Flush any buffered writes, mark the end of the round if the buffer ends it, and start a new segment if the buffer
+   * ends the current one.
    * @return amount of data flushed
    */
   uint64_t FlushBuffer() {
-    auto size = buffer_size_;
-    WriteUnsynced(buffer_, buffer_size_);
+    if (!sealed_) SealFrame();
+    auto size = frame_size_;
+    // Nothing is written for an empty buffer, which is only handed over to end a round or segment
+    if (buffer_size_ > 0) out_->Write(frame_compressed_ ? compressed_.get() : buffer_, frame_size_);
     buffer_size_ = 0;
+    sealed_ = false;
+    // The marker goes before a segment ends, so that the next segment starts with it
+    if (ends_round_) {
+      out_->EndRound();
+      ends_round_ = false;
+    }
+    if (ends_segment_) {
+      out_->EndSegment(segment_max_txn_begin_);
+      ends_segment_ = false;
+    }
     return size;
   }
 
+  /**
+   * Marks the buffer as the last one of the current log segment. Must only be called at a record boundary.
+   * @param max_txn_begin newest start timestamp of any transaction with records in the segment
+   */
+  void EndSegment(const transaction::timestamp_t max_txn_begin) {
+    ends_segment_ = true;
+    segment_max_txn_begin_ = max_txn_begin;
+  }
+
+  /**
+   * Marks the buffer as the last one of the current serialization round in its log stream, see LogFile::MarkRounds
+   */
+  void EndRound() { ends_round_ = true; }
+
   /**
    * @return if the buffer is full
    */
   bool IsBufferFull() { return buffer_size_ == common::Constants::LOG_BUFFER_SIZE; }
 
  private:
-  int out_;  // fd of the output files
-  char buffer_[common::Constants::LOG_BUFFER_SIZE];
+  LogFile *out_;
+  // Buffered writes, behind room for the frame header
+  byte buffer_[LogFrame::HEADER_SIZE + common::Constants::LOG_BUFFER_SIZE];
+  // Frame with the compressed contents of the buffer, or nullptr if not compressing
+  std::unique_ptr<byte[]> compressed_;
+  // Whether the frame is encoded, and whether it is the one in compressed_ rather than in buffer_
+  bool sealed_ = false;
+  bool frame_compressed_ = false;
+  uint32_t frame_size_ = 0;
 
   uint32_t buffer_size_ = 0;
+  bool ends_round_ = false;
+  bool ends_segment_ = false;
+  transaction::timestamp_t segment_max_txn_begin_ = transaction::INITIAL_TXN_TIMESTAMP;
 
   bool CanBuffer(uint32_t size) { return common::Constants::LOG_BUFFER_SIZE - buffer_size_ >= size; }
-
-  void WriteUnsynced(const void *data, uint32_t size) { PosixIoWrappers::WriteFully(out_, data, size); }
 };
 
 /**
- * Buffered reads from the write ahead log
+ * Buffered reads from the write ahead log. The log is read a frame at a time. A frame that fails its checksum or cannot
+ * be decoded ends the log if it is in the last file, as a write torn by a crash would. Anywhere else it means that the
+ * log is corrupted, and reading throws. Round markers are not part of the contents read.
  */
 class BufferedLogReader {
-  // TODO(Tianyu): Checksum
  public:
   /**
    * Instantiates a new BufferedLogReader to read from the specified log file.
    * @param log_file_path path to the the log file to read from.
    */
-  explicit BufferedLogReader(const char *log_file_path) : in_(PosixIoWrappers::Open(log_file_path, O_RDONLY)) {}
+  explicit BufferedLogReader(const char *log_file_path)
+      : BufferedLogReader(std::vector<std::string>{std::string(log_file_path)}) {}
+
+  /**
+   * Instantiates a new BufferedLogReader to read from the specified log files, as if they were one file.
+   * @param log_file_paths paths to the log files to read from, in order
+   */
+  explicit BufferedLogReader(std::vector<std::string> log_file_paths)
+      : in_(log_file_paths.empty() ? -1 : PosixIoWrappers::Open(log_file_paths.front().c_str(), O_RDONLY)),
+        paths_(std::move(log_file_paths)) {}
 
   /**
    * Closes log file if it has not been closed already. While Read will close the file if it reaches the end, this will
@@ -167,15 +461,29 @@ class BufferedLogReader {
     if (in_ != -1) PosixIoWrappers::Close(in_);
   }
 
+  /**
+   * Ends the log after the marker of the given serialization round, or at the marker of any later one, see
+   * LogFile::MarkRounds. Must be called before anything is read.
+   * @param round last round to read, or 0 to read nothing
+   */
+  void StopAfterRound(const uint64_t round) {
+    stop_round_ = round;
+    // Rounds are numbered from 1
+    stopped_ = round == 0;
+  }
+
   /**
    * @return if there are contents left in the write ahead log
    */
-  bool HasMore() { return filled_size_ > read_head_ || in_ != -1; }
+  bool HasMore() {
+    if (read_head_ == filled_size_) RefillBuffer();
+    return read_head_ < filled_size_;
+  }
 
   /**
    * Read the specified number of bytes into the target location from the write ahead log. The method reads as many as
    * possible if there are not enough bytes in the log and returns false. The underlying log file fd is automatically
-   * closed when all remaining bytes are buffered.
+   * closed when all remaining frames are buffered.
    *
    * @param dest pointer location to read into
    * @param size number of bytes to read
@@ -198,9 +506,22 @@ class BufferedLogReader {
   }
 
  private:
-  int in_;  // or -1 if closed
+  // Amount of the log read from disk at once, which holds at least one whole frame
+  static constexpr uint32_t RAW_BUFFER_SIZE = 16 * common::Constants::LOG_BUFFER_SIZE;
+
+  int in_;  // or -1 if closed, which happens once the current file is read to the end
+  // Files to read from, and the one in_ refers to
+  std::vector<std::string> paths_;
+  uint32_t current_path_ = 0;
+  // Round after whose marker the log ends, and whether its marker was read
+  uint64_t stop_round_ = UINT64_MAX;
+  bool stopped_ = false;
+  // Frames read from disk but not decoded yet
+  uint32_t raw_head_ = 0, raw_size_ = 0;
+  byte raw_[RAW_BUFFER_SIZE];
+  // Contents of the last decoded frame
   uint32_t read_head_ = 0, filled_size_ = 0;
-  char buffer_[common::Constants::LOG_BUFFER_SIZE];
+  byte buffer_[common::Constants::LOG_BUFFER_SIZE];
 
   void ReadFromBuffer(void *dest, uint32_t size) {
     TERRIER_ASSERT(read_head_ + size <= filled_size_, "Not enough bytes in buffer for the read");
@@ -208,6 +529,12 @@ class BufferedLogReader {
     read_head_ += size;
   }
 
+  // Decodes the next frame into the buffer, or leaves the buffer empty if the log ends
   void RefillBuffer();
+  // Reads from disk until the given number of bytes are buffered, returns false if the current file ends before
+  bool FillRawBuffer(uint32_t size);
+
+  // Drops what is left of the current file, returns false if there is no file after it
+  bool OpenNextFile();
 };
 }  // namespace terrier::storage
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <string>
@@ -29,13 +30,16 @@ namespace terrier::storage {
  * adds them to the serializer task's flush queue (flush_queue_)
  *      2. The LogSerializerTask will periodically process and serialize buffers in its flush queue
  * and hand them over to the consumer queue (filled_buffer_queue_). The reason this is done in the background and not as
- * soon as logs are received is to reduce the amount of time a transaction spends interacting with the log manager
+ * soon as logs are received is to reduce the amount of time a transaction spends interacting with the log manager.
+ * With more than one serializer, transactions are spread over as many log streams, each serialized by its own worker.
  *      3. When a buffer of logs is handed over to a consumer, the consumer will wake up and process the logs. In the
  * case of the DiskLogConsumerTask, this means writing it to the log file.
  *      4. The DiskLogConsumer task will persist the log file when:
  *          a) Someone calls ForceFlush on the LogManager, or
  *          b) Periodically
  *          c) A sufficient amount of data has been written since the last persist
+ *      With adaptive persisting, the interval and threshold follow the commit rate and the time a persist takes, so
+ * that a persist is shared by as many commits as possible without making any of them wait longer than a persist would.
  *      5. When the persist is done, the `DiskLogConsumerTask` will call the commit callbacks for any CommitRecords that
  * were just persisted.
  */
@@ -45,7 +49,8 @@ class LogManager : public common::DedicatedThreadOwner {
    * Constructs a new LogManager, writing its logs out to the given file.
    *
    * @param log_file_path path to the desired log file location. If the log file does not exist, one will be created;
-   *                      otherwise, changes are appended to the end of the file.
+   *                      otherwise, changes are appended to the end of the file. When segmented, this is the prefix of
+   *                      the segment files.
    * @param num_buffers Number of buffers to use for buffering logs
    * @param serialization_interval Interval time between log serializations
    * @param persist_interval Interval time between log flushing
@@ -53,19 +58,35 @@ class LogManager : public common::DedicatedThreadOwner {
    * @param buffer_pool the object pool to draw log buffers from. This must be the same pool transactions draw their
    *                    buffers from
    * @param thread_registry DedicatedThreadRegistry dependency injection
+   * @param segment_size size in bytes after which a new log segment is started, or 0 to log to a single file
+   * @param adaptive_persist whether to tune the persist interval and threshold to the workload, using the given ones as
+   *                         upper bounds
+   * @param num_serializers number of workers serializing logs, each into its own log stream
+   * @param use_io_uring whether to write the log through io_uring, falling back to posix calls where unavailable
+   * @param compress whether to compress the log
    */
   LogManager(std::string log_file_path, uint64_t num_buffers, std::chrono::microseconds serialization_interval,
              std::chrono::milliseconds persist_interval, uint64_t persist_threshold,
              common::ManagedPointer<RecordBufferSegmentPool> buffer_pool,
-             common::ManagedPointer<terrier::common::DedicatedThreadRegistry> thread_registry)
+             common::ManagedPointer<terrier::common::DedicatedThreadRegistry> thread_registry,
+             const uint64_t segment_size = 0, const bool adaptive_persist = false, const uint32_t num_serializers = 1,
+             const bool use_io_uring = false, const bool compress = false)
       : DedicatedThreadOwner(thread_registry),
         run_log_manager_(false),
         log_file_path_(std::move(log_file_path)),
-        num_buffers_(num_buffers),
+        // Every serializer may hold on to a partially filled buffer, and one more is needed to make progress
+        num_buffers_(std::max<uint64_t>(num_buffers, num_serializers + 1)),
         buffer_pool_(buffer_pool.Get()),
         serialization_interval_(serialization_interval),
         persist_interval_(persist_interval),
-        persist_threshold_(persist_threshold) {}
+        persist_threshold_(persist_threshold),
+        segment_size_(segment_size),
+        adaptive_persist_(adaptive_persist),
+        num_serializers_(num_serializers),
+        use_io_uring_(use_io_uring),
+        compress_(compress) {
+    TERRIER_ASSERT(num_serializers_ > 0, "Need at least one log serializer");
+  }
   /**
    * Starts log manager. Does the following in order:
    *    1. Initialize buffers to pass serialized logs to log consumers
@@ -100,6 +121,21 @@ class LogManager : public common::DedicatedThreadOwner {
    */
   void AddBufferToFlushQueue(RecordBufferSegment *buffer_segment);
 
+  /**
+   * Removes log segments that are no longer needed for recovery, because every transaction with records in them
+   * started before the given timestamp. Does nothing if the log is not segmented.
+   * @param oldest_txn start timestamp of the oldest transaction whose records are still needed, e.g. the oldest
+   *                   transaction running when the latest checkpoint was started
+   * @return number of segments removed
+   */
+  uint32_t RemoveSegmentsBefore(const transaction::timestamp_t oldest_txn) {
+    TERRIER_ASSERT(run_log_manager_, "Log segments can only be removed while the log manager is running");
+    if (segment_size_ == 0) return 0;
+    uint32_t removed = 0;
+    for (const auto &log_file : log_files_) removed += log_file->RemoveSegmentsBefore(oldest_txn);
+    return removed;
+  }
+
   /**
    * For testing only
    * @return number of buffers used for logging
@@ -117,7 +153,7 @@ class LogManager : public common::DedicatedThreadOwner {
     if (new_num_buffers >= num_buffers_) {
       // Add in new buffers
       for (size_t i = 0; i < new_num_buffers - num_buffers_; i++) {
-        buffers_.emplace_back(BufferedLogWriter(log_file_path_.c_str()));
+        buffers_.emplace_back(BufferedLogWriter(log_files_.front().get(), compress_));
         empty_buffer_queue_.Enqueue(&buffers_[num_buffers_ + i]);
       }
       num_buffers_ = new_num_buffers;
@@ -140,6 +176,9 @@ class LogManager : public common::DedicatedThreadOwner {
   //  (e.g. logs can be streamed out to the network for remote replication)
   RecordBufferSegmentPool *buffer_pool_;
 
+  // The file of every log stream, open while the log manager is running
+  std::vector<std::unique_ptr<LogFile>> log_files_;
+
   // This stores a reference to all the buffers the serializer or the log consumer threads use
   std::vector<BufferedLogWriter> buffers_;
   // The queue containing empty buffers which the serializer thread will use. We use a blocking queue because the
@@ -160,6 +199,16 @@ class LogManager : public common::DedicatedThreadOwner {
   const std::chrono::milliseconds persist_interval_;
   // Threshold used by disk consumer task
   uint64_t persist_threshold_;
+  // Size of a log segment, or 0 if the log is a single file
+  const uint64_t segment_size_;
+  // Whether the disk consumer task adapts the persist interval and threshold
+  const bool adaptive_persist_;
+  // Number of log streams serialized in parallel
+  const uint32_t num_serializers_;
+  // Whether log files are written through io_uring
+  const bool use_io_uring_;
+  // Whether log frames are compressed
+  const bool compress_;
 
   /**
    * If the central registry wants to removes our thread used for the disk log consumer task, we only allow removal if
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <utility>
@@ -7,6 +8,7 @@
 #include "common/container/concurrent_blocking_queue.h"
 #include "common/container/concurrent_queue.h"
 #include "common/dedicated_thread_task.h"
+#include "common/worker_pool.h"
 #include "storage/record_buffer.h"
 #include "storage/write_ahead_log/log_record.h"
 
@@ -15,6 +17,11 @@ namespace terrier::storage {
 /**
  * Task that processes buffers handed over by transactions and serializes them into consumer buffers.
  * Transactions will wait to be GC'd until their logs are
+ *
+ * Serialization can be spread over several workers, each writing its own log stream. All records of a transaction go
+ * to the same stream, so recovery can merge the streams by commit timestamp. The task itself serializes the first
+ * stream, and workers from a pool the others. Commit callbacks are only handed over once every stream has handed over
+ * the buffers serialized before them, so a transaction is never reported persistent before one it may depend on.
  */
 class LogSerializerTask : public common::DedicatedThreadTask {
  public:
@@ -24,19 +31,31 @@ class LogSerializerTask : public common::DedicatedThreadTask {
    * @param empty_buffer_queue pointer to queue to pop empty buffers from
    * @param filled_buffer_queue pointer to queue to push filled buffers to
    * @param disk_log_writer_thread_cv pointer to condition variable to notify consumer when a new buffer has handed over
+   * @param log_files the log file of every log stream, one stream is serialized per file
+   * @param segment_size number of bytes after which the serializer ends the current log segment, or 0 if the log is a
+   * single file
    */
   explicit LogSerializerTask(const std::chrono::microseconds serialization_interval,
                              RecordBufferSegmentPool *buffer_pool,
                              common::ConcurrentBlockingQueue<BufferedLogWriter *> *empty_buffer_queue,
                              common::ConcurrentQueue<storage::SerializedLogs> *filled_buffer_queue,
-                             std::condition_variable *disk_log_writer_thread_cv)
+                             std::condition_variable *disk_log_writer_thread_cv,
+                             const std::vector<LogFile *> &log_files, const uint64_t segment_size = 0)
       : run_task_(false),
         serialization_interval_(serialization_interval),
         buffer_pool_(buffer_pool),
-        filled_buffer_(nullptr),
+        streams_(log_files.size()),
         empty_buffer_queue_(empty_buffer_queue),
         filled_buffer_queue_(filled_buffer_queue),
-        disk_log_writer_thread_cv_(disk_log_writer_thread_cv) {}
+        disk_log_writer_thread_cv_(disk_log_writer_thread_cv),
+        segment_size_(segment_size) {
+    TERRIER_ASSERT(!log_files.empty(), "Need at least one log stream");
+    for (uint32_t i = 0; i < log_files.size(); i++) streams_[i].log_file_ = log_files[i];
+    if (streams_.size() > 1) {
+      serializer_pool_ = std::make_unique<common::WorkerPool>(streams_.size() - 1, common::TaskQueue());
+      serializer_pool_->Startup();
+    }
+  }
 
   /**
    * Runs main disk log writer loop. Called by thread registry upon initialization of thread
@@ -67,6 +86,29 @@ class LogSerializerTask : public common::DedicatedThreadTask {
 
  private:
   friend class LogManager;
+
+  /**
+   * State of the serialization of one log stream
+   */
+  struct LogStream {
+    // The file the stream is written to
+    LogFile *log_file_ = nullptr;
+    // Buffers of transactions to serialize into this stream in the current round
+    std::vector<RecordBufferSegment *> pending_;
+    // Current buffer we are serializing logs to
+    BufferedLogWriter *filled_buffer_ = nullptr;
+    // Commit callbacks for commit records serialized in the current round
+    std::vector<CommitCallback> commits_;
+    // Transactions serialized in the current round, to bulk remove them from the timestamp manager
+    std::unordered_map<transaction::TimestampManager *, std::vector<transaction::timestamp_t>> serialized_txns_;
+    // Bytes serialized into the current segment so far
+    uint64_t segment_bytes_ = 0;
+    // Newest start timestamp of a transaction with records in the current segment
+    transaction::timestamp_t segment_max_txn_begin_ = transaction::INITIAL_TXN_TIMESTAMP;
+    // Bytes and records serialized in the current round, used for metrics
+    uint64_t num_bytes_ = 0, num_records_ = 0;
+  };
+
   // Flag to signal task to run or stop
   bool run_task_;
   // Interval for serialization
@@ -86,10 +128,10 @@ class LogSerializerTask : public common::DedicatedThreadTask {
   // Stores unserialized buffers handed off by transactions
   std::queue<RecordBufferSegment *> flush_queue_;
 
-  // Current buffer we are serializing logs to
-  BufferedLogWriter *filled_buffer_;
-  // Commit callbacks for commit records currently in filled_buffer
-  std::vector<std::pair<transaction::callback_fn, void *>> commits_in_buffer_;
+  // One per log stream
+  std::vector<LogStream> streams_;
+  // Serializes all streams but the first, or nullptr if there is only one
+  std::unique_ptr<common::WorkerPool> serializer_pool_;
 
   // Used by the serializer thread to store buffers it has grabbed from the log manager
   std::queue<RecordBufferSegment *> temp_flush_queue_;
@@ -107,6 +149,9 @@ class LogSerializerTask : public common::DedicatedThreadTask {
   // Condition variable to signal disk log consumer task thread that a new full buffer has been pushed to the queue
   std::condition_variable *disk_log_writer_thread_cv_;
 
+  // Size at which a log segment is ended, or 0 if the log is not segmented
+  const uint64_t segment_size_;
+
   /**
    * Main serialization loop. Calls Process every interval. Processes all the accumulated log records and
    * serializes them to log consumer tasks.
@@ -121,48 +166,67 @@ class LogSerializerTask : public common::DedicatedThreadTask {
    */
   bool Process();
 
+  /**
+   * @param buffer a buffer of log records of a single transaction
+   * @return the stream the transaction's records are serialized to
+   */
+  LogStream *StreamOf(RecordBufferSegment *buffer);
+
+  /**
+   * Serialize out and release all buffers pending for a stream
+   * @param stream the stream to serialize
+   */
+  void SerializeStream(LogStream *stream);
+
   /**
    * Serialize out the task buffer to the current serialization buffer
+   * @param stream the stream to serialize to
    * @param buffer_to_serialize the iterator to the redo buffer to be serialized
    * @return pair representing number of bytes and number of records serialized, used for metrics
    */
-  std::pair<uint64_t, uint64_t> SerializeBuffer(IterableBufferSegment<LogRecord> *buffer_to_serialize);
+  std::pair<uint64_t, uint64_t> SerializeBuffer(LogStream *stream,
+                                                IterableBufferSegment<LogRecord> *buffer_to_serialize);
 
   /**
    * Serialize out the record to the log
+   * @param stream the stream to serialize to
    * @param record the redo record to serialise
    * @return bytes serialized, used for metrics
    */
-  uint64_t SerializeRecord(const LogRecord &record);
+  uint64_t SerializeRecord(LogStream *stream, const LogRecord &record);
 
   /**
    * Serialize the data pointed to by val to current serialization buffer
    * @tparam T Type of the value
+   * @param stream the stream to serialize to
    * @param val The value to write to the buffer
    * @return bytes written, used for metrics
    */
   template <class T>
-  uint32_t WriteValue(const T &val) {
-    return WriteValue(&val, sizeof(T));
+  uint32_t WriteValue(LogStream *stream, const T &val) {
+    return WriteValue(stream, &val, sizeof(T));
   }
 
   /**
    * Serialize the data pointed to by val to current serialization buffer
+   * @param stream the stream to serialize to
    * @param val the value
    * @param size size of the value to serialize
    * @return bytes written, used for metrics
    */
-  uint32_t WriteValue(const void *val, uint32_t size);
+  uint32_t WriteValue(LogStream *stream, const void *val, uint32_t size);
 
   /**
-   * Returns the current buffer to serialize logs to
+   * Returns the current buffer to serialize logs of a stream to
+   * @param stream the stream to serialize to
    * @return buffer to write to
    */
-  BufferedLogWriter *GetCurrentWriteBuffer();
+  BufferedLogWriter *GetCurrentWriteBuffer(LogStream *stream);
 
   /**
-   * Hand over the current buffer and commit callbacks for commit records in that buffer to the log consumer task
+   * Hand over the current buffer of a stream to the log consumer task
+   * @param stream the stream whose buffer to hand over
    */
-  void HandFilledBufferToWriter();
+  void HandFilledBufferToWriter(LogStream *stream);
 };
 }  // namespace terrier::storage
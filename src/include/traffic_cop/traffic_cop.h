@@ -42,16 +42,19 @@ class TrafficCop {
    * @param replication_log_provider if given, the tcop will forward replication logs to this provider
    * @param stats_storage for optimizer calls
    * @param optimizer_timeout for optimizer calls
+   * @param parallel_execution whether generated code may run its pipelines in parallel
    */
   TrafficCop(common::ManagedPointer<transaction::TransactionManager> txn_manager,
              common::ManagedPointer<catalog::Catalog> catalog,
              common::ManagedPointer<storage::ReplicationLogProvider> replication_log_provider,
-             common::ManagedPointer<optimizer::StatsStorage> stats_storage, uint64_t optimizer_timeout)
+             common::ManagedPointer<optimizer::StatsStorage> stats_storage, uint64_t optimizer_timeout,
+             bool parallel_execution)
       : txn_manager_(txn_manager),
         catalog_(catalog),
         replication_log_provider_(replication_log_provider),
         stats_storage_(stats_storage),
-        optimizer_timeout_(optimizer_timeout) {}
+        optimizer_timeout_(optimizer_timeout),
+        parallel_execution_(parallel_execution) {}
 
   virtual ~TrafficCop() = default;
 
@@ -61,6 +64,11 @@ class TrafficCop {
    */
   void HandBufferToReplication(std::unique_ptr<network::ReadBuffer> buffer);
 
+  /**
+   * Persists the log, so that the callbacks of every commit issued so far have run once this returns
+   */
+  void FlushLog() const;
+
   /**
    * Create a temporary namespace for a connection
    * @param connection_id the unique connection ID to use for the namespace name
@@ -151,6 +159,7 @@ class TrafficCop {
   common::ManagedPointer<storage::ReplicationLogProvider> replication_log_provider_;
   common::ManagedPointer<optimizer::StatsStorage> stats_storage_;
   uint64_t optimizer_timeout_;
+  bool parallel_execution_;
 };
 
 }  // namespace terrier::trafficcop
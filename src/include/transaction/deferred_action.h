@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+#include "transaction/transaction_defs.h"
+
+namespace terrier::transaction {
+/**
+ * A DeferredAction is an action that can only be safely performed after all transactions that could
+ * have access to something has finished. (e.g. pruning of version chains)
+ *
+ * When applied, the start time of the oldest transaction alive in the system is supplied. The reason
+ * for this is that this value can be larger than the timestamp the action originally registered for,
+ * and in cases such as GC knowing the actual time enables optimizations. Actions that do not need it can take no
+ * arguments instead.
+ *
+ * Unlike std::function, closures of up to INLINE_SIZE bytes (e.g. an index, a key and a TupleSlot for a deferred index
+ * delete) are stored in the object itself instead of on the heap. Actions are only ever moved, never copied.
+ */
+class DeferredAction {
+ public:
+  /**
+   * Size of the largest closure that is stored without a heap allocation
+   */
+  static constexpr uint32_t INLINE_SIZE = 48;
+
+  /**
+   * Wraps the given callable in a deferred action
+   * @tparam F type of the callable, invocable with either the oldest running txn's start time or no arguments
+   * @param action the callable to wrap
+   */
+  template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, DeferredAction>>>
+  explicit DeferredAction(F &&action) {
+    using Fn = std::decay_t<F>;
+    static_assert(std::is_invocable_v<Fn &, timestamp_t> || std::is_invocable_v<Fn &>,
+                  "A deferred action takes either the oldest running txn's start time or nothing");
+    if constexpr (StoredInline<Fn>()) {
+      new (storage_) Fn(std::forward<F>(action));
+    } else {
+      *reinterpret_cast<Fn **>(storage_) = new Fn(std::forward<F>(action));
+    }
+    ops_ = &OPS<Fn>;
+  }
+
+  /**
+   * Takes over the action of other, which is left empty
+   * @param other the action to move from
+   */
+  DeferredAction(DeferredAction &&other) noexcept : ops_(other.ops_) {
+    if (ops_ != nullptr) ops_->move_(other.storage_, storage_);
+    other.ops_ = nullptr;
+  }
+
+  /**
+   * Destroys the action held by this and takes over the action of other, which is left empty
+   * @param other the action to move from
+   * @return self-reference
+   */
+  DeferredAction &operator=(DeferredAction &&other) noexcept {
+    if (this == &other) return *this;
+    if (ops_ != nullptr) ops_->destroy_(storage_);
+    ops_ = other.ops_;
+    if (ops_ != nullptr) ops_->move_(other.storage_, storage_);
+    other.ops_ = nullptr;
+    return *this;
+  }
+
+  DISALLOW_COPY(DeferredAction)
+
+  ~DeferredAction() {
+    if (ops_ != nullptr) ops_->destroy_(storage_);
+  }
+
+  /**
+   * Performs the action
+   * @param oldest_txn start time of the oldest running txn
+   */
+  void operator()(const timestamp_t oldest_txn) {
+    TERRIER_ASSERT(ops_ != nullptr, "Invoking a deferred action that was moved from");
+    ops_->invoke_(storage_, oldest_txn);
+  }
+
+ private:
+  // Type-erased operations on the stored closure
+  struct Ops {
+    void (*invoke_)(void *, timestamp_t);
+    void (*move_)(void *, void *);
+    void (*destroy_)(void *);
+  };
+
+  template <class Fn>
+  static constexpr bool StoredInline() {
+    return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<Fn>;
+  }
+
+  template <class Fn>
+  static Fn *Get(void *storage) {
+    if constexpr (StoredInline<Fn>()) {
+      return std::launder(reinterpret_cast<Fn *>(storage));
+    } else {
+      return *reinterpret_cast<Fn **>(storage);
+    }
+  }
+
+  template <class Fn>
+  static void Invoke(void *const storage, const timestamp_t oldest_txn) {
+    if constexpr (std::is_invocable_v<Fn &, timestamp_t>) {
+      (*Get<Fn>(storage))(oldest_txn);
+    } else {
+      (*Get<Fn>(storage))();
+    }
+  }
+
+  template <class Fn>
+  static void Move(void *const from, void *const to) {
+    if constexpr (StoredInline<Fn>()) {
+      new (to) Fn(std::move(*Get<Fn>(from)));
+      Get<Fn>(from)->~Fn();
+    } else {
+      *reinterpret_cast<Fn **>(to) = Get<Fn>(from);
+    }
+  }
+
+  template <class Fn>
+  static void Destroy(void *const storage) {
+    if constexpr (StoredInline<Fn>()) {
+      Get<Fn>(storage)->~Fn();
+    } else {
+      delete Get<Fn>(storage);
+    }
+  }
+
+  template <class Fn>
+  static constexpr Ops OPS{&Invoke<Fn>, &Move<Fn>, &Destroy<Fn>};
+
+  alignas(std::max_align_t) byte storage_[INLINE_SIZE];
+  const Ops *ops_ = nullptr;
+};
+}  // namespace terrier::transaction
@@ -1,10 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <queue>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "common/constants.h"
+#include "common/spin_latch.h"
 #include "storage/garbage_collector.h"
 #include "storage/write_ahead_log/log_manager.h"
+#include "transaction/deferred_action.h"
 #include "transaction/timestamp_manager.h"
 #include "transaction/transaction_defs.h"
 
@@ -25,39 +32,35 @@ class DeferredActionManager {
       : timestamp_manager_(timestamp_manager) {}
 
   ~DeferredActionManager() {
-    common::SpinLatch::ScopedSpinLatch guard(&deferred_actions_latch_);
     TERRIER_ASSERT(back_log_.empty(), "Backlog is not empty");
-    TERRIER_ASSERT(new_deferred_actions_.empty(), "Some deferred actions remaining at time of destruction");
+    for (auto &shard : shards_) {
+      common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+      TERRIER_ASSERT(shard.new_deferred_actions_.empty(), "Some deferred actions remaining at time of destruction");
+    }
   }
 
   /**
    * Adds the action to a buffered list of deferred actions.  This action will
    * be triggered no sooner than when the epoch (timestamp of oldest running
    * transaction) is more recent than the time this function was called.
+   * @tparam F type of the action, invocable with either the oldest running txn's start time or no arguments
    * @param a functional implementation of the action that is deferred. @see DeferredAction
+   * @return the timestamp the action was registered at
    */
-  timestamp_t RegisterDeferredAction(const DeferredAction &a) {
-    common::SpinLatch::ScopedSpinLatch guard(&deferred_actions_latch_);
+  template <class F>
+  timestamp_t RegisterDeferredAction(F &&a) {
+    // Threads mostly register into a shard of their own, so that they do not contend on the latch with each other.
+    Shard *const shard = &shards_[std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_SHARDS];
+    DeferredAction action(std::forward<F>(a));
+    common::SpinLatch::ScopedSpinLatch guard(&shard->latch_);
     // Timestamp needs to be fetched inside the critical section such that actions in the
     // deferred action queue is in order. This simplifies the interleavings we need to deal
-    // with in the face of DDL changes.
-    timestamp_t result = timestamp_manager_->CurrentTime();
-    new_deferred_actions_.emplace(result, a);
+    // with in the face of DDL changes. ProcessNewActions relies on this to order the shards.
+    const timestamp_t result = timestamp_manager_->CurrentTime();
+    shard->new_deferred_actions_.emplace_back(result, std::move(action));
     return result;
   }
 
-  /**
-   * Adds the action to a buffered list of deferred actions.  This action will
-   * be triggered no sooner than when the epoch (timestamp of oldest running
-   * transaction) is more recent than the time this function was called.
-   * @param a functional implementation of the action that is deferred
-   */
-  timestamp_t RegisterDeferredAction(const std::function<void()> &a) {
-    // TODO(Tianyu): Will this be a performance problem? Hopefully C++ is smart enough
-    // to optimize out this call...
-    return RegisterDeferredAction([=](timestamp_t /*unused*/) { a(); });
-  }
-
   /**
    * Clear the queue and apply as many actions as possible
    * @return numbers of deferred actions processed
@@ -92,10 +95,24 @@ class DeferredActionManager {
   }
 
  private:
+  // Number of shards new deferred actions are registered into
+  static constexpr uint32_t NUM_SHARDS = 16;
+
+  using TimestampedAction = std::pair<timestamp_t, DeferredAction>;
+
+  // New actions registered by the threads that map to this shard, in the order of their timestamps
+  struct alignas(common::Constants::CACHELINE_SIZE) Shard {
+    std::vector<TimestampedAction> new_deferred_actions_;
+    common::SpinLatch latch_;
+  };
+
   const common::ManagedPointer<TimestampManager> timestamp_manager_;
-  // TODO(Tianyu): We might want to change this data structure to be more specialized than std::queue
-  std::queue<std::pair<timestamp_t, DeferredAction>> new_deferred_actions_, back_log_;
-  common::SpinLatch deferred_actions_latch_;
+  std::array<Shard, NUM_SHARDS> shards_;
+  std::queue<TimestampedAction> back_log_;
+  // Buffers the new actions of each shard are handed off in, and merged into. Only used by Process, and kept around so
+  // that neither Process nor the registering threads need to allocate once they are large enough.
+  std::array<std::vector<TimestampedAction>, NUM_SHARDS> handoff_;
+  std::vector<TimestampedAction> new_actions_local_;
 
   uint32_t ClearBacklog(timestamp_t oldest_txn) {
     uint32_t processed = 0;
@@ -114,26 +131,32 @@ class DeferredActionManager {
 
   uint32_t ProcessNewActions(timestamp_t oldest_txn) {
     uint32_t processed = 0;
-    // swap the new actions queue with a local queue, so the rest of the system can continue
-    // while we process actions
-    std::queue<std::pair<timestamp_t, DeferredAction>> new_actions_local;
-    {
-      common::SpinLatch::ScopedSpinLatch guard(&deferred_actions_latch_);
-      new_actions_local = std::move(new_deferred_actions_);
+    // swap each shard's new actions with an empty handoff buffer, so the rest of the system can continue
+    // while we process actions. All shards are swapped under all of their latches at once: as timestamps are fetched
+    // under a shard's latch, an action that misses this snapshot is stamped no earlier than every action in it, so it
+    // can never run before an action with a larger timestamp. Registering threads only ever hold one latch.
+    for (auto &shard : shards_) shard.latch_.Lock();
+    for (uint32_t i = 0; i < NUM_SHARDS; i++) shards_[i].new_deferred_actions_.swap(handoff_[i]);
+    for (auto &shard : shards_) shard.latch_.Unlock();
+    for (auto &handoff : handoff_) {
+      for (auto &action : handoff) new_actions_local_.emplace_back(std::move(action));
+      handoff.clear();
     }
+    // Each shard is in order already, merge them into one order. Actions with equal timestamps were registered
+    // concurrently, so their order does not matter.
+    std::stable_sort(new_actions_local_.begin(), new_actions_local_.end(),
+                     [](const TimestampedAction &a, const TimestampedAction &b) { return a.first < b.first; });
 
-    // Iterate through the new actions queue and execute as many as possible
-    while (!new_actions_local.empty() && oldest_txn >= new_actions_local.front().first) {
-      new_actions_local.front().second(oldest_txn);
+    // Iterate through the new actions and execute as many as possible
+    auto it = new_actions_local_.begin();
+    for (; it != new_actions_local_.end() && oldest_txn >= it->first; ++it) {
+      it->second(oldest_txn);
       processed++;
-      new_actions_local.pop();
     }
 
     // Add the rest to back log otherwise
-    while (!new_actions_local.empty()) {
-      back_log_.push(new_actions_local.front());
-      new_actions_local.pop();
-    }
+    for (; it != new_actions_local_.end(); ++it) back_log_.push(std::move(*it));
+    new_actions_local_.clear();
     return processed;
   }
 };
@@ -1,8 +1,10 @@
 #pragma once
-#include <algorithm>
-#include <unordered_set>
+#include <array>
+#include <atomic>
+#include <set>
 #include <vector>
 
+#include "common/constants.h"
 #include "common/spin_latch.h"
 #include "common/strong_typedef.h"
 #include "transaction/transaction_defs.h"
@@ -20,8 +22,10 @@ class TransactionManager;
 class TimestampManager {
  public:
   ~TimestampManager() {
-    TERRIER_ASSERT(curr_running_txns_.empty(),
-                   "Destroying the TimestampManager while txns are still running. That seems wrong.");
+    for (const auto &shard UNUSED_ATTRIBUTE : shards_) {
+      TERRIER_ASSERT(shard.running_txns_.empty(),
+                     "Destroying the TimestampManager while txns are still running. That seems wrong.");
+    }
   }
 
   /**
@@ -37,10 +41,9 @@ class TimestampManager {
   /**
    * Get the oldest transaction alive (by start timestamp given out by this timestamp manager at this time)
    * Because of concurrent operations, it is not guaranteed that upon return the txn is still alive. However,
-   * it is guaranteed that the return timestamp is older than any transactions live.
-   * @warning If logging is enabled, txns are not removed from the txn set until they are serialized. Thus, the active
-   * txn set can grow greatly in size, making this call expensive. Consider using CachedOldestTransactionStartTime for
-   * better peformance at the cost of a more stale timestamp.
+   * it is guaranteed that the return timestamp is older than any transactions live. This only takes the latch of each
+   * shard of the active txn set in turn and looks at its oldest txn, so its cost does not grow with the number of
+   * running txns.
    * @return timestamp that is older than any transactions alive
    */
   timestamp_t OldestTransactionStartTime();
@@ -48,39 +51,51 @@ class TimestampManager {
   /**
    * Get the cached timestamp of the oldest active txn. The cached timestamp is only refreshed upon every invocation of
    * OldestTransactionStartTime, so it may be stale. On the other hand, this function does not require taking a latch or
-   * iterating through the running txns set, making it much cheaper than OldestTransactionStartTime. This has the same
+   * looking at the running txns, making it much cheaper than OldestTransactionStartTime. This has the same
    * correctness guarantee as OldestTransactionStartTime, but may cause performance degradations for processes that rely
    * on very fresh oldest txn timestamps
    * @return timestamp that is older than any transactions alive
    */
   timestamp_t CachedOldestTransactionStartTime();
 
+  /**
+   * Get the cached timestamp of the oldest active txn like CachedOldestTransactionStartTime, but refresh it first if
+   * the clock advanced by more than CACHE_REFRESH_INTERVAL ticks since it was last refreshed. Only one caller does the
+   * refresh, so the cost of OldestTransactionStartTime is spread over many calls. This is meant for the critical path
+   * of txns that profit from a reasonably fresh timestamp, such as pruning the version chains they write to.
+   * @return timestamp that is older than any transactions alive
+   */
+  timestamp_t RecentOldestTransactionStartTime();
+
+  /**
+   * Number of ticks of the clock after which RecentOldestTransactionStartTime refreshes the cached timestamp
+   */
+  static constexpr uint64_t CACHE_REFRESH_INTERVAL = 256;
+
  private:
-  // TransactionManager needs to be able to use the curr_running_txns_latch to guard more than just the
-  // duration of the following method calls --- things such as adding to the GC queue needs to be atomic
-  // along with removing a transaction from the table of active transactions. We need this for correctness
-  // in the deferred action framework when dropping tables.
   friend class TransactionManager;
   friend class storage::LogSerializerTask;
-  timestamp_t BeginTransaction() {
-    timestamp_t start_time;
-    {
-      common::SpinLatch::ScopedSpinLatch running_guard(&curr_running_txns_latch_);
-      // There is a three-way race that needs to be prevented.  Specifically, we
-      // cannot allow both a transaction to commit and the GC to poll for the
-      // oldest running transaction in between this transaction acquiring its
-      // begin timestamp and getting inserted into the current running
-      // transactions list.  Using the current running transactions latch
-      // prevents the GC from polling and stops the race.  This allows us to
-      // replace acquiring a shared instance of the commit latch with a
-      // read-only spin-latch and move the allocation out of a critical section.
-      start_time = time_++;
-
-      const auto ret UNUSED_ATTRIBUTE = curr_running_txns_.emplace(start_time);
-      TERRIER_ASSERT(ret.second, "commit start time should be globally unique");
-    }  // Release latch on current running transactions
-    return start_time;
-  }
+
+  // Number of shards the active txn set is split into. A txn goes into the shard given by its start timestamp, so
+  // that consecutive txns, and the bulk removals of the log serializer, land on different latches.
+  static constexpr uint32_t NUM_SHARDS = 64;
+  // Number of slots txns announce that they are acquiring their start timestamp in, see BeginTransaction
+  static constexpr uint32_t NUM_BEGIN_SLOTS = 128;
+  // Value of a begin slot no txn holds
+  static constexpr timestamp_t FREE_SLOT = INVALID_TXN_TIMESTAMP;
+
+  // Part of the active txn set. Start timestamps are handed out in increasing order, so an ordered set mostly appends,
+  // and the oldest txn of the shard is always its first one.
+  struct alignas(common::Constants::CACHELINE_SIZE) Shard {
+    std::set<timestamp_t> running_txns_;
+    common::SpinLatch latch_;
+  };
+
+  struct alignas(common::Constants::CACHELINE_SIZE) BeginSlot {
+    std::atomic<timestamp_t> lower_bound_{FREE_SLOT};
+  };
+
+  timestamp_t BeginTransaction();
 
   /**
    * Remove a timestamp from active txn set
@@ -89,22 +104,25 @@ class TimestampManager {
   void RemoveTransaction(timestamp_t timestamp);
 
   /**
-   * Bulk remove a set of timestamps from the active txn set. Only grabs the curr_running_txns_latch_ once for all the
-   * timestamps.
+   * Bulk remove a set of timestamps from the active txn set. Only grabs the latch of each shard once for all the
+   * timestamps in it.
    * @param timestamps vector of timestamps to remove
    */
   void RemoveTransactions(const std::vector<timestamp_t> &timestamps);
 
-  // TODO(Tianyu): Timestamp generation needs to be more efficient (batches)
+  static uint32_t ShardOf(const timestamp_t timestamp) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(!timestamp) % NUM_SHARDS);
+  }
+
+  // Timestamps are not handed out in batches: a start timestamp taken from a batch reserved earlier would miss commits
+  // made in the meantime, including those of the same thread, and commit timestamps must be totally ordered anyway.
   // TODO(Tianyu): We don't handle timestamp wrap-arounds. I doubt this would be an issue any time soon.
   std::atomic<timestamp_t> time_{INITIAL_TXN_TIMESTAMP};
   // We cache the oldest txn start time
   std::atomic<timestamp_t> cached_oldest_txn_start_time_{INITIAL_TXN_TIMESTAMP};
-  // TODO(Matt): consider a different data structure if this becomes a measured bottleneck
-  // TODO(Gus): This data structure initially only held items in the order of # of workers. With the logging change, it
-  // can hold many more, since txns are only removed when serialized. We should consider if there is a possible better
-  // data structure
-  std::unordered_set<timestamp_t> curr_running_txns_;
-  mutable common::SpinLatch curr_running_txns_latch_;
+  // Time of the clock when RecentOldestTransactionStartTime last refreshed the cached timestamp
+  std::atomic<timestamp_t> cache_refresh_time_{INITIAL_TXN_TIMESTAMP};
+  std::array<Shard, NUM_SHARDS> shards_;
+  std::array<BeginSlot, NUM_BEGIN_SLOTS> begin_slots_;
 };
 }  // namespace terrier::transaction
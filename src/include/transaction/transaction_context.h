@@ -11,6 +11,7 @@
 #include "storage/tuple_access_strategy.h"
 #include "storage/undo_record.h"
 #include "storage/write_ahead_log/log_record.h"
+#include "transaction/timestamp_manager.h"
 #include "transaction/transaction_util.h"
 
 namespace terrier::storage {
@@ -42,14 +43,18 @@ class TransactionContext {
    * MVCC semantics
    * @param buffer_pool the buffer pool to draw this transaction's undo buffer from
    * @param log_manager pointer to log manager in the system, or nullptr, if logging is disabled
+   * @param timestamp_manager pointer to the timestamp manager that started the transaction, or nullptr, in which case
+   * the transaction does not prune the version chains it writes to
    */
   TransactionContext(const timestamp_t start, const timestamp_t finish,
                      const common::ManagedPointer<storage::RecordBufferSegmentPool> buffer_pool,
-                     const common::ManagedPointer<storage::LogManager> log_manager)
+                     const common::ManagedPointer<storage::LogManager> log_manager,
+                     const common::ManagedPointer<TimestampManager> timestamp_manager = DISABLED)
       : start_time_(start),
         finish_time_(finish),
         undo_buffer_(buffer_pool.Get()),
-        redo_buffer_(log_manager.Get(), buffer_pool.Get()) {}
+        redo_buffer_(log_manager.Get(), buffer_pool.Get()),
+        timestamp_manager_(timestamp_manager) {}
 
   /**
    * @warning In the src/ folder this should only be called by the Garbage Collector to adhere to MVCC semantics. Tests
@@ -82,6 +87,16 @@ class TransactionContext {
    */
   timestamp_t FinishTime() const { return finish_time_.load(); }
 
+  /**
+   * @return timestamp that is older than any transactions alive, possibly stale, below which the versions of the tuples
+   * this transaction writes can be pruned. This is INITIAL_TXN_TIMESTAMP, which prunes nothing, if the transaction was
+   * not started by a TransactionManager.
+   */
+  timestamp_t PruneTimestamp() const {
+    return timestamp_manager_ == DISABLED ? INITIAL_TXN_TIMESTAMP
+                                         : timestamp_manager_->RecentOldestTransactionStartTime();
+  }
+
   /**
    * Reserve space on this transaction's undo buffer for a record to log the update given
    * @param table pointer to the updated DataTable object
@@ -216,6 +231,7 @@ class TransactionContext {
   std::atomic<timestamp_t> finish_time_;
   storage::UndoBuffer undo_buffer_;
   storage::RedoBuffer redo_buffer_;
+  const common::ManagedPointer<TimestampManager> timestamp_manager_;
   // TODO(Tianyu): Maybe not so much of a good idea to do this. Make explicit queue in GC?
   //
   std::vector<const byte *> loose_ptrs_;
@@ -32,13 +32,4 @@ using callback_fn = void (*)(void *);
  * It is given a handle to the DeferredActionManager in case it needs to register a deferred action.
  */
 using TransactionEndAction = std::function<void(DeferredActionManager *)>;
-/**
- * A DeferredAction is an action that can only be safely performed after all transactions that could
- * have access to something has finished. (e.g. pruning of version chains)
- *
- * When applied, the start time of the oldest transaction alive in the system is supplied. The reason
- * for this is that this value can be larger than the timestamp the action originally registered for,
- * and in cases such as GC knowing the actual time enables optimizations.
- */
-using DeferredAction = std::function<void(timestamp_t)>;
 }  // namespace terrier::transaction
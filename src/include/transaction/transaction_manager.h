@@ -14,6 +14,10 @@
 #include "transaction/transaction_context.h"
 #include "transaction/transaction_defs.h"
 
+namespace terrier::storage {
+class CheckpointManager;
+}  // namespace terrier::storage
+
 namespace terrier::transaction {
 /**
  * A transaction manager maintains global state about all running transactions, and is responsible for creating,
@@ -65,6 +69,14 @@ class TransactionManager {
    */
   timestamp_t Abort(TransactionContext *txn);
 
+  /**
+   * Persists the log, so that the callbacks of every commit issued so far have run once this returns. With logging
+   * disabled, commit callbacks run within Commit, so there is nothing to do.
+   */
+  void FlushLog() {
+    if (log_manager_ != DISABLED) log_manager_->ForceFlush();
+  }
+
   /**
    * @return true if gc_enabled and storing completed txns in local queue, false otherwise
    */
@@ -77,6 +89,8 @@ class TransactionManager {
   TransactionQueue CompletedTransactionsForGC();
 
  private:
+  // Needs the oldest active transaction and the log manager to drop log segments a checkpoint has made obsolete
+  friend class storage::CheckpointManager;
   const common::ManagedPointer<TimestampManager> timestamp_manager_;
   const common::ManagedPointer<DeferredActionManager> deferred_action_manager_;
   const common::ManagedPointer<storage::RecordBufferSegmentPool> buffer_pool_;
@@ -85,6 +99,8 @@ class TransactionManager {
 
   bool gc_enabled_ = false;
   TransactionQueue completed_txns_;
+  // Only guards completed_txns_, see Commit for why it does not need to be the timestamp manager's latch
+  common::SpinLatch completed_txns_latch_;
   const common::ManagedPointer<storage::LogManager> log_manager_;
 
   timestamp_t UpdatingCommitCriticalSection(TransactionContext *txn);
@@ -82,6 +82,8 @@ int main(int argc, char *argv[]) {
                      .SetUseMetrics(true)
                      .SetUseMetricsThread(true)
                      .SetUseLogging(true)
+                     .SetUseRecovery(true)
+                     .SetUseCheckpoints(true)
                      .SetUseGC(true)
                      .SetUseCatalog(true)
                      .SetUseGCThread(true)
@@ -3,6 +3,7 @@
 #include <utility>
 #include "network/connection_handle.h"
 #include "network/connection_handle_factory.h"
+#include "traffic_cop/traffic_cop.h"
 
 namespace terrier::network {
 
@@ -13,6 +14,13 @@ ConnectionHandlerTask::ConnectionHandlerTask(const int task_id,
       RegisterEvent(-1, EV_READ | EV_PERSIST, METHOD_AS_CALLBACK(ConnectionHandlerTask, HandleDispatch), this);
 }
 
+ConnectionHandlerTask::~ConnectionHandlerTask() {
+  // The event loop has stopped, so no connection issues another commit. Persisting the log runs the callbacks of those
+  // that are pending instead of leaving them to the next persist.
+  if (pending_commits_.load() > 0) connection_handle_factory_->GetTrafficCop()->FlushLog();
+  TERRIER_ASSERT(pending_commits_.load() == 0, "Persisting the log should have run every pending commit callback.");
+}
+
 void ConnectionHandlerTask::Notify(int conn_fd, std::unique_ptr<ProtocolInterpreter> protocol_interpreter) {
   {
     /**
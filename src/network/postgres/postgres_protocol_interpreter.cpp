@@ -37,6 +37,12 @@ Transition PostgresProtocolInterpreter::Process(common::ManagedPointer<ReadBuffe
   Transition ret = command->Exec(common::ManagedPointer<ProtocolInterpreter>(this),
                                  common::ManagedPointer<PostgresPacketWriter>(&writer), t_cop, context);
   curr_input_packet_.Clear();
+  if (context->CommitPending()) {
+    context->SetCommitPending(false);
+    // The response must not reach the client before the commit is durable, so wait for the commit callback to wake
+    // the ConnectionHandle up before writing it out
+    if (ret == Transition::PROCEED) return Transition::NEED_RESULT;
+  }
   return ret;
 }
 
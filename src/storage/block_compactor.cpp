@@ -194,6 +194,8 @@ bool BlockCompactor::MoveTuple(CompactionGroup *cg, TupleSlot from, TupleSlot to
 
 bool BlockCompactor::CheckForVersionsAndGaps(const TupleAccessStrategy &accessor, RawBlock *block) {
   const BlockLayout &layout = accessor.GetBlockLayout();
+  // The version synopsis tells us about live versions without scanning the version pointers
+  if (block->num_versioned_slots_.load() != 0) return false;
 
   auto *allocation_bitmap = accessor.AllocationBitmap(block);
   auto *version_ptrs = reinterpret_cast<UndoRecord **>(accessor.ColumnStart(block, VERSION_POINTER_COLUMN_ID));
@@ -0,0 +1,220 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "storage/storage_defs.h"
+
+namespace terrier::storage {
+
+void BlockStore::FreeList::Push(BlockStore *const store, const uint32_t index) {
+  std::atomic<uint64_t> &next = store->NodeAt(index)->next_;
+  uint64_t head = head_.load();
+  uint64_t desired;
+  do {
+    next.store(head & UINT32_MAX, std::memory_order_relaxed);
+    desired = ((head >> 32) + 1) << 32 | (index + 1);
+  } while (!head_.compare_exchange_weak(head, desired));
+}
+
+bool BlockStore::FreeList::Pop(BlockStore *const store, uint32_t *const index) {
+  uint64_t head = head_.load();
+  while (true) {
+    if ((head & UINT32_MAX) == 0) return false;
+    const auto top = static_cast<uint32_t>((head & UINT32_MAX) - 1);
+    // The node may be popped and pushed again concurrently, in which case the link read is stale, but the counter in
+    // the head has changed and the exchange below fails
+    const uint64_t next = store->NodeAt(top)->next_.load(std::memory_order_relaxed);
+    if (head_.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next)) {
+      *index = top;
+      return true;
+    }
+  }
+}
+
+BlockStore::BlockStore(const uint64_t size_limit, const uint64_t reuse_limit)
+    : size_limit_(size_limit), reuse_limit_(reuse_limit) {}
+
+BlockStore::~BlockStore() {
+  // Blocks that were never released may still be referenced by whoever leaked them, so leave their memory alone
+  const bool unmap = current_size_.load() == num_reusable_.load();
+  Region *region = regions_.load();
+  while (region != nullptr) {
+    Region *const next = region->next_region_;
+    if (unmap) munmap(region->base_, REGION_SIZE);
+    delete region;
+    region = next;
+  }
+  for (auto &segment : node_segments_) delete[] segment.load();
+}
+
+RawBlock *BlockStore::Get() {
+  const uint32_t node = CurrentNumaNode();
+  RawBlock *result = PopReusable(node);
+  if (result == nullptr) {
+    // A new block needs to be backed by memory, which the size limit must allow
+    uint64_t size = current_size_.load();
+    do {
+      if (size >= size_limit_.load()) throw common::NoMoreObjectException(size_limit_.load());
+    } while (!current_size_.compare_exchange_weak(size, size + 1));
+
+    {
+      common::SpinLatch::ScopedSpinLatch guard(&nodes_[node].unbacked_latch_);
+      if (!nodes_[node].unbacked_.empty()) {
+        result = nodes_[node].unbacked_.back();
+        nodes_[node].unbacked_.pop_back();
+      }
+    }
+    if (result == nullptr) result = NewBlock(node);
+    if (result == nullptr) {
+      current_size_--;
+      throw common::AllocatorFailureException();
+    }
+    // The memory of the block gets placed on this node when the caller first touches it
+    result->numa_node_ = static_cast<uint16_t>(node);
+  }
+  return result;
+}
+
+void BlockStore::Release(RawBlock *const block) {
+  TERRIER_ASSERT(block != nullptr, "releasing a null pointer");
+  const uint32_t node = block->numa_node_ % MAX_NUMA_NODES;
+  if (num_reusable_.fetch_add(1) < reuse_limit_.load()) {
+    PushReusable(node, block);
+    return;
+  }
+  num_reusable_--;
+  Unback(block);
+  common::SpinLatch::ScopedSpinLatch guard(&nodes_[node].unbacked_latch_);
+  nodes_[node].unbacked_.push_back(block);
+}
+
+bool BlockStore::SetSizeLimit(const uint64_t new_size) {
+  // Like the object pool, this does not shrink the store, so concurrent Gets can at most reach the old limit
+  if (new_size < current_size_.load()) return false;
+  size_limit_ = new_size;
+  return true;
+}
+
+void BlockStore::SetReuseLimit(const uint64_t new_reuse_limit) {
+  reuse_limit_ = new_reuse_limit;
+  while (num_reusable_.load() > reuse_limit_.load()) {
+    RawBlock *const block = PopReusable(0);
+    if (block == nullptr) break;
+    const uint32_t node = block->numa_node_ % MAX_NUMA_NODES;
+    Unback(block);
+    common::SpinLatch::ScopedSpinLatch guard(&nodes_[node].unbacked_latch_);
+    nodes_[node].unbacked_.push_back(block);
+  }
+}
+
+uint32_t BlockStore::CurrentNumaNode() {
+#if defined(__linux__)
+  unsigned cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return node % MAX_NUMA_NODES;
+#endif
+  return 0;
+}
+
+BlockStore::Region *BlockStore::MapRegion(const uint32_t node) {
+  // Over-map by a huge page so that the region can be aligned to a huge page boundary, then trim the excess
+  const uint64_t mapped_size = REGION_SIZE + HUGE_PAGE_SIZE;
+  void *const mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) return nullptr;
+  const auto start = reinterpret_cast<uintptr_t>(mapped);
+  const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  if (aligned != start) munmap(mapped, aligned - start);
+  if (aligned + REGION_SIZE != start + mapped_size) {
+    munmap(reinterpret_cast<void *>(aligned + REGION_SIZE), start + mapped_size - aligned - REGION_SIZE);
+  }
+  auto *const base = reinterpret_cast<byte *>(aligned);
+
+#if defined(__linux__)
+  // Both calls are hints only. Without transparent huge pages or on machines with a single node they fail, and the
+  // region is simply backed by regular pages wherever the kernel likes.
+  madvise(base, REGION_SIZE, MADV_HUGEPAGE);
+  const uint64_t node_mask = uint64_t{1} << node;
+  syscall(SYS_mbind, base, REGION_SIZE, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8, 0);
+#endif
+
+  auto *const region = new Region;
+  region->base_ = base;
+  return region;
+}
+
+RawBlock *BlockStore::NewBlock(const uint32_t node) {
+  std::atomic<Region *> &current = nodes_[node].region_;
+  Region *region = current.load();
+  while (true) {
+    if (region != nullptr) {
+      const uint64_t index = region->next_block_.fetch_add(1);
+      if (index < BLOCKS_PER_REGION) {
+        return reinterpret_cast<RawBlock *>(region->base_ + index * common::Constants::BLOCK_SIZE);
+      }
+    }
+    // The region is exhausted. Others may race to replace it, in which case the loser unmaps its own.
+    Region *const fresh = MapRegion(node);
+    if (fresh == nullptr) return nullptr;
+    if (!current.compare_exchange_strong(region, fresh)) {
+      munmap(fresh->base_, REGION_SIZE);
+      delete fresh;
+      continue;
+    }
+    region = fresh;
+    Region *head = regions_.load();
+    do {
+      fresh->next_region_ = head;
+    } while (!regions_.compare_exchange_weak(head, fresh));
+  }
+}
+
+BlockStore::FreeNode *BlockStore::NodeAt(const uint32_t index) const {
+  // Segment i starts at index FIRST_NODE_SEGMENT_SIZE * (2^i - 1)
+  const auto segment = static_cast<uint32_t>(63 - __builtin_clzll(index / FIRST_NODE_SEGMENT_SIZE + 1));
+  const uint64_t offset = index - FIRST_NODE_SEGMENT_SIZE * ((uint64_t{1} << segment) - 1);
+  return &node_segments_[segment].load()[offset];
+}
+
+void BlockStore::PushReusable(const uint32_t node, RawBlock *const block) {
+  uint32_t free_node;
+  if (!spare_nodes_.Pop(this, &free_node)) {
+    free_node = num_nodes_.fetch_add(1);
+    const auto segment = static_cast<uint32_t>(63 - __builtin_clzll(free_node / FIRST_NODE_SEGMENT_SIZE + 1));
+    TERRIER_ASSERT(segment < NUM_NODE_SEGMENTS, "Block store has run out of free list nodes.");
+    // Whoever first needs a node in the segment allocates it, but others might race to do so as well
+    FreeNode *entries = node_segments_[segment].load();
+    if (entries == nullptr) {
+      auto *const allocated = new FreeNode[FIRST_NODE_SEGMENT_SIZE << segment]();
+      if (!node_segments_[segment].compare_exchange_strong(entries, allocated)) delete[] allocated;
+    }
+  }
+  // The node is ours until it is pushed, and whoever pops it next synchronizes with that push
+  NodeAt(free_node)->block_ = block;
+  nodes_[node].reusable_.Push(this, free_node);
+}
+
+RawBlock *BlockStore::PopReusable(const uint32_t node) {
+  // Prefer blocks on the local node, but take remote ones over allocating more memory. Reused blocks keep their memory,
+  // and thus the node it was placed on.
+  for (uint32_t i = 0; i < MAX_NUMA_NODES; i++) {
+    uint32_t free_node;
+    if (nodes_[(node + i) % MAX_NUMA_NODES].reusable_.Pop(this, &free_node)) {
+      RawBlock *const block = NodeAt(free_node)->block_;
+      spare_nodes_.Push(this, free_node);
+      num_reusable_--;
+      return block;
+    }
+  }
+  return nullptr;
+}
+
+void BlockStore::Unback(RawBlock *const block) {
+  // The address range stays mapped, and reads zero once touched again. Failing to give the memory back is harmless.
+  madvise(block, common::Constants::BLOCK_SIZE, MADV_DONTNEED);
+  current_size_--;
+}
+
+}  // namespace terrier::storage
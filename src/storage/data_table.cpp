@@ -1,6 +1,8 @@
 #include "storage/data_table.h"
 
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 #include "common/allocator.h"
 #include "storage/block_access_controller.h"
@@ -9,6 +11,16 @@
 #include "transaction/transaction_util.h"
 
 namespace terrier::storage {
+
+namespace {
+// Threads are assigned insertion heads round-robin the first time they insert into any DataTable
+uint32_t InsertionHeadOfCurrentThread() {
+  static std::atomic<uint32_t> next_insertion_head{0};
+  thread_local const uint32_t insertion_head = next_insertion_head.fetch_add(1) % DataTable::NUM_INSERTION_HEADS;
+  return insertion_head;
+}
+}  // namespace
+
 DataTable::DataTable(const common::ManagedPointer<BlockStore> store, const BlockLayout &layout,
                      const layout_version_t layout_version)
     : block_store_(store), layout_version_(layout_version), accessor_(layout) {
@@ -19,14 +31,13 @@ DataTable::DataTable(const common::ManagedPointer<BlockStore> store, const Block
   if (block_store_ != nullptr) {
     RawBlock *new_block = NewBlock();
     // insert block
-    blocks_.push_back(new_block);
+    blocks_.Append(new_block);
   }
-  insertion_head_ = blocks_.begin();
 }
 
 DataTable::~DataTable() {
-  common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
-  for (RawBlock *block : blocks_) {
+  for (uint64_t i = 0; i < blocks_.Size(); i++) {
+    RawBlock *const block = blocks_.At(i);
     StorageUtil::DeallocateVarlens(block, accessor_);
     for (col_id_t i : accessor_.GetBlockLayout().Varlens())
       accessor_.GetArrowBlockMetadata(block).GetColumnInfo(accessor_.GetBlockLayout(), i).Deallocate();
@@ -41,53 +52,158 @@ bool DataTable::Select(const common::ManagedPointer<transaction::TransactionCont
 }
 
 void DataTable::Scan(const common::ManagedPointer<transaction::TransactionContext> txn, SlotIterator *const start_pos,
-                     ProjectedColumns *const out_buffer) const {
-  // TODO(Tianyu): So far this is not that much better than tuple-at-a-time access,
-  // but can be improved if block is read-only, or if we implement version synopsis, to just use std::memcpy when it's
-  // safe
+                     const SlotIterator &end_pos, ProjectedColumns *const out_buffer) const {
+  const uint32_t num_slots = accessor_.GetBlockLayout().NumSlots();
   uint32_t filled = 0;
-  while (filled < out_buffer->MaxTuples() && *start_pos != end()) {
-    ProjectedColumns::RowView row = out_buffer->InterpretAsRow(filled);
-    const TupleSlot slot = **start_pos;
-    // Only fill the buffer with valid, visible tuples
-    if (SelectIntoBuffer(txn, slot, &row)) {
-      out_buffer->TupleSlots()[filled] = slot;
-      filled++;
-    }
-    ++(*start_pos);
+  // Scan a block at a time, so that the bitmaps and version synopsis of a block are looked up once per block
+  while (filled < out_buffer->MaxTuples() && *start_pos != end_pos) {
+    RawBlock *const block = start_pos->current_slot_.GetBlock();
+    const uint32_t begin = start_pos->current_slot_.GetOffset();
+    uint32_t end = end_pos.current_slot_.GetBlock() == block ? end_pos.current_slot_.GetOffset() : num_slots;
+    end = std::min(end, begin + (out_buffer->MaxTuples() - filled));
+    filled = ScanBlock(txn, block, begin, end, out_buffer, filled);
+    start_pos->AdvanceTo(end);
   }
   out_buffer->SetNumTuples(filled);
 }
 
-DataTable::SlotIterator &DataTable::SlotIterator::operator++() {
-  common::SpinLatch::ScopedSpinLatch guard(&table_->blocks_latch_);
-  // Jump to the next block if already the last slot in the block.
-  if (current_slot_.GetOffset() == table_->accessor_.GetBlockLayout().NumSlots() - 1) {
-    ++block_;
-    // Cannot dereference if the next block is end(), so just use nullptr to denote
-    current_slot_ = {block_ == table_->blocks_.end() ? nullptr : *block_, 0};
-  } else {
-    current_slot_ = {*block_, current_slot_.GetOffset() + 1};
+uint32_t DataTable::ScanBlock(const common::ManagedPointer<transaction::TransactionContext> txn, RawBlock *const block,
+                              const uint32_t begin, const uint32_t end, ProjectedColumns *const out_buffer,
+                              uint32_t filled) const {
+  const common::RawConcurrentBitmap *const allocation_bitmap = accessor_.AllocationBitmap(block);
+  const common::RawConcurrentBitmap *const presence_bitmap =
+      accessor_.ColumnNullBitmap(block, VERSION_POINTER_COLUMN_ID);
+  const auto *const version_ptrs =
+      reinterpret_cast<std::atomic<UndoRecord *> *>(accessor_.ColumnStart(block, VERSION_POINTER_COLUMN_ID));
+  // If the version synopsis says that nothing in the block has a version chain, the version pointers need not be read.
+  // CopyUnversionedRange checks the synopsis again after copying, which catches any writer that came in meanwhile.
+  const bool unversioned_block = block->num_versioned_slots_.load() == 0;
+  // A tuple without a version chain that is present is visible to every transaction as it is in the block
+  const auto unversioned = [&](const uint32_t offset) {
+    return allocation_bitmap->Test(offset) && presence_bitmap->Test(offset) &&
+           (unversioned_block || version_ptrs[offset].load() == nullptr);
+  };
+
+  uint32_t offset = begin;
+  while (offset < end) {
+    uint32_t run_end = offset;
+    while (run_end < end && unversioned(run_end)) run_end++;
+    if (run_end > offset) {
+      if (CopyUnversionedRange(block, offset, run_end, out_buffer, filled)) {
+        filled += run_end - offset;
+        offset = run_end;
+        continue;
+      }
+      // A concurrent writer raced with the copy, so fall back to reading the tuples one at a time, which handles that
+    } else {
+      run_end = offset + 1;
+    }
+    for (; offset < run_end; offset++) {
+      const TupleSlot slot(block, offset);
+      ProjectedColumns::RowView row = out_buffer->InterpretAsRow(filled);
+      // Only fill the buffer with valid, visible tuples
+      if (SelectIntoBuffer(txn, slot, &row)) {
+        out_buffer->TupleSlots()[filled] = slot;
+        filled++;
+      }
+    }
+  }
+  return filled;
+}
+
+bool DataTable::CopyUnversionedRange(RawBlock *const block, const uint32_t begin, const uint32_t end,
+                                     ProjectedColumns *const out_buffer, const uint32_t filled) const {
+  const BlockLayout &layout = accessor_.GetBlockLayout();
+  const uint32_t num_tuples = end - begin;
+  for (uint16_t i = 0; i < out_buffer->NumColumns(); i++) {
+    const col_id_t col_id = out_buffer->ColumnIds()[i];
+    TERRIER_ASSERT(col_id != VERSION_POINTER_COLUMN_ID, "Output buffer should not read the version pointer column.");
+    const uint8_t attr_size = layout.AttrSize(col_id);
+    std::memcpy(out_buffer->ColumnStart(i) + attr_size * filled,
+                accessor_.ColumnStart(block, col_id) + attr_size * begin, attr_size * num_tuples);
+    const common::RawConcurrentBitmap *const from_nulls = accessor_.ColumnNullBitmap(block, col_id);
+    common::RawBitmap *const to_nulls = out_buffer->ColumnNullBitmap(i);
+    for (uint32_t j = 0; j < num_tuples; j++) to_nulls->Set(filled + j, from_nulls->Test(begin + j));
   }
+  for (uint32_t j = 0; j < num_tuples; j++) out_buffer->TupleSlots()[filled + j] = {block, begin + j};
+
+  // Same protocol as SelectIntoBuffer: if a version pointer was installed while we copied, an in-place update could
+  // have been half-way through, and the copy cannot be used. Make sure the copies are done before checking.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // No version chain was started anywhere in the block. The GC cannot have truncated one in the meantime either, since
+  // our transaction is still running.
+  if (block->num_versioned_slots_.load() == 0) return true;
+  const common::RawConcurrentBitmap *const allocation_bitmap = accessor_.AllocationBitmap(block);
+  const common::RawConcurrentBitmap *const presence_bitmap =
+      accessor_.ColumnNullBitmap(block, VERSION_POINTER_COLUMN_ID);
+  const auto *const version_ptrs =
+      reinterpret_cast<std::atomic<UndoRecord *> *>(accessor_.ColumnStart(block, VERSION_POINTER_COLUMN_ID));
+  for (uint32_t offset = begin; offset < end; offset++) {
+    if (version_ptrs[offset].load() != nullptr || !allocation_bitmap->Test(offset) || !presence_bitmap->Test(offset))
+      return false;
+  }
+  return true;
+}
+
+DataTable::SlotIterator &DataTable::SlotIterator::operator++() {
+  AdvanceTo(current_slot_.GetOffset() + 1);
   return *this;
 }
 
+void DataTable::SlotIterator::AdvanceTo(const uint32_t offset) {
+  TERRIER_ASSERT(offset > current_slot_.GetOffset() && offset <= table_->accessor_.GetBlockLayout().NumSlots(),
+                 "The iterator can only move forward within its block, or onto the next block.");
+  if (offset < table_->accessor_.GetBlockLayout().NumSlots()) {
+    current_slot_ = {current_slot_.GetBlock(), offset};
+    return;
+  }
+  ++block_index_;
+  // Cannot dereference if there is no next block, so just use nullptr to denote
+  current_slot_ = {block_index_ < table_->blocks_.Size() ? table_->blocks_.At(block_index_) : nullptr, 0};
+}
+
 DataTable::SlotIterator DataTable::end() const {  // NOLINT for STL name compability
-  common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
   // TODO(Tianyu): Need to look in detail at how this interacts with compaction when that gets in.
 
   // The end iterator could either point to an unfilled slot in a block, or point to nothing if every block in the
-  // table is full. In the case that it points to nothing, we will use the end-iterator of the blocks list and
-  // 0 to denote that this is the case. This solution makes increment logic simple and natural.
-  if (blocks_.empty()) return {this, blocks_.end(), 0};
-  auto last_block = --blocks_.end();
-  uint32_t insert_head = (*last_block)->GetInsertHead();
+  // table is full. In the case that it points to nothing, we will use the number of blocks and 0 to denote that this
+  // is the case. This solution makes increment logic simple and natural.
+  const uint64_t num_blocks = blocks_.Size();
+  if (num_blocks == 0) return {this, 0, 0};
+  const uint64_t last_block = num_blocks - 1;
+  uint32_t insert_head = blocks_.At(last_block)->GetInsertHead();
   // Last block is full, return the default end iterator that doesn't point to anything
-  if (insert_head == accessor_.GetBlockLayout().NumSlots()) return {this, blocks_.end(), 0};
+  if (insert_head == accessor_.GetBlockLayout().NumSlots()) return {this, num_blocks, 0};
   // Otherwise, insert head points to the slot that will be inserted next, which would be exactly what we want.
   return {this, last_block, insert_head};
 }
 
+std::vector<DataTable::SlotIterator> DataTable::BlockBoundaries() const {
+  std::vector<SlotIterator> boundaries;
+  const uint64_t num_blocks = blocks_.Size();
+  boundaries.reserve(num_blocks + 1);
+  for (uint64_t i = 0; i < num_blocks; i++) boundaries.push_back({this, i, 0});
+  // Blocks appended in the meantime end up in the last range
+  boundaries.emplace_back(end());
+  return boundaries;
+}
+
+void DataTable::PruneVersionChain(UndoRecord *const head, const transaction::timestamp_t oldest) {
+  // The GC only truncates a version chain below its head too, and both of us only ever store nullptr, so no CAS is
+  // needed. Records that get cut off are not freed before the GC has unlinked their txns and waited out all readers.
+  UndoRecord *curr = head;
+  for (uint32_t depth = 0; depth < MAX_PRUNE_DEPTH; depth++) {
+    UndoRecord *const next = curr->Next().load();
+    if (next == nullptr) return;
+    // Versions are sorted newest-to-oldest, so the rest of the chain is also invisible to any running txn
+    if (transaction::TransactionUtil::NewerThan(oldest, next->Timestamp().load())) {
+      curr->Next().store(nullptr);
+      return;
+    }
+    curr = next;
+  }
+}
+
 bool DataTable::Update(const common::ManagedPointer<transaction::TransactionContext> txn, const TupleSlot slot,
                        const ProjectedRow &redo) {
   TERRIER_ASSERT(redo.NumColumns() <= accessor_.GetBlockLayout().NumColumns() - NUM_RESERVED_COLUMNS,
@@ -116,6 +232,10 @@ bool DataTable::Update(const common::ManagedPointer<transaction::TransactionCont
     undo->Next() = version_ptr;
   } while (!CompareAndSwapVersionPtr(slot, accessor_, version_ptr, undo));
 
+  // We own the head of the version chain now, so prune the versions below it that no one can see anymore while they
+  // are likely still in cache, instead of letting hot tuples grow long version chains until the next GC run.
+  PruneVersionChain(undo, txn->PruneTimestamp());
+
   // Update in place with the new value.
   for (uint16_t i = 0; i < redo.NumColumns(); i++) {
     TERRIER_ASSERT(redo.ColumnIds()[i] != VERSION_POINTER_COLUMN_ID,
@@ -130,76 +250,57 @@ bool DataTable::Update(const common::ManagedPointer<transaction::TransactionCont
   return true;
 }
 
-void DataTable::CheckMoveHead(std::list<RawBlock *>::iterator block) {
-  // Assume block is full
-  common::SpinLatch::ScopedSpinLatch guard_head(&header_latch_);
-  if (block == insertion_head_) {
-    // If the header block is full, move the header to point to the next block
-    insertion_head_++;
-  }
-
-  // If there are no more free blocks, create a new empty block and  point the insertion_head to it
-  if (insertion_head_ == blocks_.end()) {
-    RawBlock *new_block = NewBlock();
-    // take latch
-    common::SpinLatch::ScopedSpinLatch guard_block(&blocks_latch_);
-    // insert block
-    blocks_.push_back(new_block);
-    // set insertion header to --end()
-    insertion_head_ = --blocks_.end();
-  }
-}
-
 TupleSlot DataTable::Insert(const common::ManagedPointer<transaction::TransactionContext> txn,
                             const ProjectedRow &redo) {
   TERRIER_ASSERT(redo.NumColumns() == accessor_.GetBlockLayout().NumColumns() - NUM_RESERVED_COLUMNS,
                  "The input buffer never changes the version pointer column, so it should have  exactly 1 fewer "
                  "attribute than the DataTable's layout.");
 
-  // Insertion header points to the first block that has free tuple slots
-  // Once a txn arrives, it will start from the insertion header to find the first
-  // idle (no other txn is trying to get tuple slots in that block) and non-full block.
-  // If no such block is found, the txn will create a new block.
-  // Before the txn writes to the block, it will set block status to busy.
-  // The first bit of block insert_head_ is used to indicate if the block is busy
-  // If the first bit is 1, it indicates one txn is writing to the block.
-
+  // Every thread starts from the block it last inserted into, and only looks further when that block is full. Blocks
+  // are claimed by setting their busy bit for the duration of the slot allocation, so a thread that finds its block
+  // busy moves on as well, and concurrent inserters quickly end up in different blocks. If no block has space, the
+  // thread creates a new one.
+  std::atomic<uint64_t> &insertion_head = insertion_heads_[InsertionHeadOfCurrentThread()].block_index_;
   TupleSlot result;
-  auto block = insertion_head_;
+  uint64_t block_index = std::max(insertion_head.load(std::memory_order_relaxed), first_free_block_.load());
+  RawBlock *block;
   while (true) {
     // No free block left
-    if (block == blocks_.end()) {
-      RawBlock *new_block = NewBlock();
-      TERRIER_ASSERT(accessor_.SetBlockBusyStatus(new_block), "Status of new block should not be busy");
+    if (block_index >= blocks_.Size()) {
+      block = NewBlock();
+      TERRIER_ASSERT(accessor_.SetBlockBusyStatus(block), "Status of new block should not be busy");
       // No need to flip the busy status bit
-      accessor_.Allocate(new_block, &result);
-      // take latch
-      common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
-      // insert block
-      blocks_.push_back(new_block);
-      block = --blocks_.end();
+      accessor_.Allocate(block, &result);
+      block_index = blocks_.Append(block);
       break;
     }
 
-    if (accessor_.SetBlockBusyStatus(*block)) {
+    block = blocks_.At(block_index);
+    if (accessor_.SetBlockBusyStatus(block)) {
       // No one is inserting into this block
-      if (accessor_.Allocate(*block, &result)) {
+      if (accessor_.Allocate(block, &result)) {
         // The block is not full, succeed
         break;
       }
       // Fail to insert into the block, flip back the status bit
-      accessor_.ClearBlockBusyStatus(*block);
-      // if the full block is the insertion_header, move the insertion_header
-      // Next insert txn will search from the new insertion_header
-      CheckMoveHead(block);
+      accessor_.ClearBlockBusyStatus(block);
+      // Move the first free block past this one if it pointed here, and skip ahead to it if it is further along
+      uint64_t expected = block_index;
+      first_free_block_.compare_exchange_strong(expected, block_index + 1);
+      const uint64_t first_free = first_free_block_.load();
+      if (first_free > block_index + 1) {
+        block_index = first_free;
+        continue;
+      }
     }
     // The block is full or the block is being inserted by other txn, try next block
-    ++block;
+    ++block_index;
   }
+  insertion_head.store(block_index, std::memory_order_relaxed);
 
   // Do not need to wait unit finish inserting,
   // can flip back the status bit once the thread gets the allocated tuple slot
-  accessor_.ClearBlockBusyStatus(*block);
+  accessor_.ClearBlockBusyStatus(block);
   InsertInto(txn, redo, result);
 
   data_table_counter_.IncrementNumInsert(1);
@@ -351,7 +452,8 @@ void DataTable::AtomicallyWriteVersionPtr(const TupleSlot slot, const TupleAcces
                                           UndoRecord *const desired) {
   // Okay to ignore presence bit, because we use that for logical delete, not for validity of the version pointer value
   byte *ptr_location = accessor.AccessWithoutNullCheck(slot, VERSION_POINTER_COLUMN_ID);
-  reinterpret_cast<std::atomic<UndoRecord *> *>(ptr_location)->store(desired);
+  UndoRecord *const previous = reinterpret_cast<std::atomic<UndoRecord *> *>(ptr_location)->exchange(desired);
+  UpdateVersionSynopsis(slot, previous, desired);
 }
 
 bool DataTable::Visible(const TupleSlot slot, const TupleAccessStrategy &accessor) const {
@@ -376,7 +478,18 @@ bool DataTable::CompareAndSwapVersionPtr(const TupleSlot slot, const TupleAccess
                                          UndoRecord *expected, UndoRecord *const desired) {
   // Okay to ignore presence bit, because we use that for logical delete, not for validity of the version pointer value
   byte *ptr_location = accessor.AccessWithoutNullCheck(slot, VERSION_POINTER_COLUMN_ID);
-  return reinterpret_cast<std::atomic<UndoRecord *> *>(ptr_location)->compare_exchange_strong(expected, desired);
+  UndoRecord *const previous = expected;
+  if (!reinterpret_cast<std::atomic<UndoRecord *> *>(ptr_location)->compare_exchange_strong(expected, desired))
+    return false;
+  UpdateVersionSynopsis(slot, previous, desired);
+  return true;
+}
+
+void DataTable::UpdateVersionSynopsis(const TupleSlot slot, UndoRecord *const previous, UndoRecord *const desired) {
+  // Writers count a new version chain before they modify the tuple in place, so readers that see a count of 0 both
+  // before and after copying out of a block know that none of the tuples they copied were being modified.
+  if (previous == nullptr && desired != nullptr) slot.GetBlock()->num_versioned_slots_.fetch_add(1);
+  if (previous != nullptr && desired == nullptr) slot.GetBlock()->num_versioned_slots_.fetch_sub(1);
 }
 
 RawBlock *DataTable::NewBlock() {
@@ -1,8 +1,14 @@
 #include "storage/garbage_collector.h"
+#include <memory>
 #include <unordered_set>
 #include <utility>
+#include <vector>
+#include "common/hash_util.h"
 #include "common/macros.h"
+#include "common/scoped_timer.h"
+#include "common/thread_context.h"
 #include "loggers/storage_logger.h"
+#include "metrics/metrics_store.h"
 #include "storage/data_table.h"
 #include "transaction/deferred_action_manager.h"
 #include "transaction/transaction_context.h"
@@ -13,22 +19,39 @@
 namespace terrier::storage {
 
 std::pair<uint32_t, uint32_t> GarbageCollector::PerformGarbageCollection() {
-  if (observer_ != nullptr) observer_->ObserveGCInvocation();
-  timestamp_manager_->CheckOutTimestamp();
-  const transaction::timestamp_t oldest_txn = timestamp_manager_->OldestTransactionStartTime();
-  uint32_t txns_deallocated = ProcessDeallocateQueue(oldest_txn);
-  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_deallocated: {}", txns_deallocated);
-  uint32_t txns_unlinked = ProcessUnlinkQueue(oldest_txn);
-  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_unlinked: {}", txns_unlinked);
-  if (txns_unlinked > 0) {
-    // Only update this field if we actually unlinked anything, otherwise we're being too conservative about when it's
-    // safe to deallocate the transactions in our queue.
-    last_unlinked_ = timestamp_manager_->CheckOutTimestamp();
+  uint64_t elapsed_us = 0;
+  uint32_t txns_deallocated, txns_unlinked;
+  transaction::timestamp_t oldest_txn;
+  {
+    common::ScopedTimer<std::chrono::microseconds> scoped_timer(&elapsed_us);
+    if (observer_ != nullptr) observer_->ObserveGCInvocation();
+    timestamp_manager_->CheckOutTimestamp();
+    oldest_txn = timestamp_manager_->OldestTransactionStartTime();
+    {
+      // Deallocation, unlinking and index GC touch disjoint data and run alongside each other on the workers. The
+      // indexes must stay registered until their tasks are done.
+      common::SharedLatch::ScopedSharedLatch guard(&indexes_latch_);
+      txns_deallocated = ProcessDeallocateQueue(oldest_txn);
+      STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_deallocated: {}", txns_deallocated);
+      txns_unlinked = ProcessUnlinkQueue(oldest_txn);
+      STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): txns_unlinked: {}", txns_unlinked);
+      ProcessIndexes(oldest_txn);
+      if (worker_pool_ != nullptr) worker_pool_->WaitUntilAllFinished();
+    }
+    CollectLoosePointers();
+    if (txns_unlinked > 0) {
+      // Only update this field if we actually unlinked anything, otherwise we're being too conservative about when
+      // it's safe to deallocate the transactions in our queue.
+      last_unlinked_ = timestamp_manager_->CheckOutTimestamp();
+    }
+    STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): last_unlinked_: {}",
+                      static_cast<uint64_t>(last_unlinked_));
+    ProcessDeferredActions(oldest_txn);
+  }
+  if (common::thread_context.metrics_store_ != nullptr &&
+      common::thread_context.metrics_store_->ComponentEnabled(metrics::MetricsComponent::GARBAGECOLLECTION)) {
+    common::thread_context.metrics_store_->RecordGCData(elapsed_us, txns_deallocated, txns_unlinked, unlink_backlog_);
   }
-  STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): last_unlinked_: {}",
-                    static_cast<uint64_t>(last_unlinked_));
-  ProcessDeferredActions(oldest_txn);
-  ProcessIndexes();
   return std::make_pair(txns_deallocated, txns_unlinked);
 }
 
@@ -39,9 +62,21 @@ uint32_t GarbageCollector::ProcessDeallocateQueue(transaction::timestamp_t oldes
     // All of the transactions in my deallocation queue were unlinked before the oldest running txn in the system, and
     // have been serialized by the log manager. We are now safe to deallocate these txns because no running
     // transaction should hold a reference to them anymore
-    for (auto &txn : txns_to_deallocate_) {
-      delete txn;
-      txns_processed++;
+    if (worker_pool_ == nullptr) {
+      for (auto &txn : txns_to_deallocate_) {
+        delete txn;
+        txns_processed++;
+      }
+    } else {
+      // Deal the txns out to the workers
+      const uint32_t num_workers = worker_pool_->NumWorkers();
+      auto chunks = std::make_shared<std::vector<std::vector<transaction::TransactionContext *>>>(num_workers);
+      for (auto &txn : txns_to_deallocate_) (*chunks)[txns_processed++ % num_workers].push_back(txn);
+      for (uint32_t i = 0; i < num_workers; i++) {
+        RunTask([chunks, i] {
+          for (auto *const txn : (*chunks)[i]) delete txn;
+        });
+      }
     }
     txns_to_deallocate_.clear();
   }
@@ -59,12 +94,9 @@ uint32_t GarbageCollector::ProcessUnlinkQueue(transaction::timestamp_t oldest_tx
   }
 
   uint32_t txns_processed = 0;
+  unlink_backlog_ = 0;
   // Certain transactions might not be yet safe to gc. Need to requeue them
   transaction::TransactionQueue requeue;
-  // It is sufficient to truncate each version chain once in a GC invocation because we only read the maximal safe
-  // timestamp once, and the version chain is sorted by timestamp. Here we keep a set of slots to truncate to avoid
-  // wasteful traversals of the version chain.
-  std::unordered_set<TupleSlot> visited_slots;
 
   // Process every transaction in the unlink queue
   while (!txns_to_unlink_.empty()) {
@@ -76,19 +108,13 @@ uint32_t GarbageCollector::ProcessUnlinkQueue(transaction::timestamp_t oldest_tx
       delete txn;
       txns_processed++;
     } else if (transaction::TransactionUtil::NewerThan(oldest_txn, txn->FinishTime())) {
-      // Safe to garbage collect.
+      // Safe to garbage collect. Hand the records to the worker of their table.
       for (auto &undo_record : txn->undo_buffer_) {
         // It is possible for the table field to be null, for aborted transaction's last conflicting record
-        DataTable *&table = undo_record.Table();
-        // Each version chain needs to be traversed and truncated at most once every GC period. Check
-        // if we have already visited this tuple slot; if not, proceed to prune the version chain.
-        if (table != nullptr && visited_slots.insert(undo_record.Slot()).second)
-          TruncateVersionChain(table, undo_record.Slot(), oldest_txn);
-        // Regardless of the version chain we will need to reclaim deleted slots and any dangling pointers to varlens,
-        // unless the transaction is aborted, and the record holds a version that is still visible.
-        if (!txn->Aborted()) {
-          ReclaimSlotIfDeleted(&undo_record);
-          ReclaimBufferIfVarlen(txn, &undo_record);
+        DataTable *const table = undo_record.Table();
+        if (table != nullptr) {
+          const uint64_t partition = common::HashUtil::Hash(table) % unlink_partitions_.size();
+          unlink_partitions_[partition].records_.emplace_back(txn, &undo_record);
         }
         if (observer_ != nullptr) observer_->ObserveWrite(undo_record.Slot().GetBlock());
       }
@@ -97,15 +123,49 @@ uint32_t GarbageCollector::ProcessUnlinkQueue(transaction::timestamp_t oldest_tx
     } else {
       // This is a committed txn that is still visible, requeue for next GC run
       requeue.push_front(txn);
+      unlink_backlog_++;
     }
   }
 
   // Requeue any txns that we were still visible to running transactions
   txns_to_unlink_ = transaction::TransactionQueue(std::move(requeue));
 
+  for (auto &partition : unlink_partitions_) {
+    if (!partition.records_.empty()) RunTask([this, &partition, oldest_txn] { UnlinkRecords(&partition, oldest_txn); });
+  }
   return txns_processed;
 }
 
+void GarbageCollector::UnlinkRecords(UnlinkPartition *const partition,
+                                     const transaction::timestamp_t oldest_txn) const {
+  // It is sufficient to truncate each version chain once in a GC invocation because we only read the maximal safe
+  // timestamp once, and the version chain is sorted by timestamp. Here we keep a set of slots to truncate to avoid
+  // wasteful traversals of the version chain.
+  std::unordered_set<TupleSlot> visited_slots;
+  for (const auto &record : partition->records_) {
+    transaction::TransactionContext *const txn = record.first;
+    UndoRecord *const undo_record = record.second;
+    // Each version chain needs to be traversed and truncated at most once every GC period. Check
+    // if we have already visited this tuple slot; if not, proceed to prune the version chain.
+    if (visited_slots.insert(undo_record->Slot()).second)
+      TruncateVersionChain(undo_record->Table(), undo_record->Slot(), oldest_txn);
+    // Regardless of the version chain we will need to reclaim deleted slots and any dangling pointers to varlens,
+    // unless the transaction is aborted, and the record holds a version that is still visible.
+    if (!txn->Aborted()) {
+      ReclaimSlotIfDeleted(undo_record);
+      ReclaimBufferIfVarlen(txn, undo_record, partition);
+    }
+  }
+}
+
+void GarbageCollector::CollectLoosePointers() {
+  for (auto &partition : unlink_partitions_) {
+    for (const auto &loose_ptr : partition.loose_ptrs_) loose_ptr.first->loose_ptrs_.push_back(loose_ptr.second);
+    partition.records_.clear();
+    partition.loose_ptrs_.clear();
+  }
+}
+
 void GarbageCollector::ProcessDeferredActions(transaction::timestamp_t oldest_txn) {
   if (deferred_action_manager_ != DISABLED) {
     // TODO(Tianyu): Eventually we will remove the GC and implement version chain pruning with deferred actions
@@ -132,8 +192,13 @@ void GarbageCollector::TruncateVersionChain(DataTable *const table, const TupleS
     return;
   }
 
-  // a version chain is guaranteed to not change when not at the head (assuming single-threaded GC), so we are safe
-  // to traverse and update pointers without CAS
+  // The head of a version chain is only swapped with a CAS, which is why it is special cased above. Below the head, a
+  // chain only ever gets cut: Next() is set to anything but nullptr only before its record is installed as the head.
+  // The GC worker that handles the table and writers pruning in DataTable::PruneVersionChain may cut the same chain
+  // concurrently, but every cut stores nullptr into a Next() whose successors are older than every running txn.
+  // Whichever order the stores land in, the chain still holds every version a running txn can see, and a record that
+  // one of them cut off stays readable until every txn that could have reached it has finished. So we are safe to
+  // traverse and update pointers without CAS
   UndoRecord *curr = version_ptr;
   UndoRecord *next;
   // Traverse until we find the earliest UndoRecord that can be unlinked.
@@ -159,8 +224,8 @@ void GarbageCollector::ReclaimSlotIfDeleted(UndoRecord *const undo_record) const
   if (undo_record->Type() == DeltaRecordType::DELETE) undo_record->Table()->accessor_.Deallocate(undo_record->Slot());
 }
 
-void GarbageCollector::ReclaimBufferIfVarlen(transaction::TransactionContext *const txn,
-                                             UndoRecord *const undo_record) const {
+void GarbageCollector::ReclaimBufferIfVarlen(transaction::TransactionContext *const txn, UndoRecord *const undo_record,
+                                             UnlinkPartition *const partition) const {
   const TupleAccessStrategy &accessor = undo_record->Table()->accessor_;
   const BlockLayout &layout = accessor.GetBlockLayout();
   switch (undo_record->Type()) {
@@ -173,7 +238,7 @@ void GarbageCollector::ReclaimBufferIfVarlen(transaction::TransactionContext *co
         // Okay to include version vector, as it is never varlen
         if (layout.IsVarlen(col_id)) {
           auto *varlen = reinterpret_cast<VarlenEntry *>(accessor.AccessWithNullCheck(undo_record->Slot(), col_id));
-          if (varlen != nullptr && varlen->NeedReclaim()) txn->loose_ptrs_.push_back(varlen->Content());
+          if (varlen != nullptr && varlen->NeedReclaim()) partition->loose_ptrs_.emplace_back(txn, varlen->Content());
         }
       }
       break;
@@ -183,7 +248,7 @@ void GarbageCollector::ReclaimBufferIfVarlen(transaction::TransactionContext *co
         col_id_t col_id = undo_record->Delta()->ColumnIds()[i];
         if (layout.IsVarlen(col_id)) {
           auto *varlen = reinterpret_cast<VarlenEntry *>(undo_record->Delta()->AccessWithNullCheck(i));
-          if (varlen != nullptr && varlen->NeedReclaim()) txn->loose_ptrs_.push_back(varlen->Content());
+          if (varlen != nullptr && varlen->NeedReclaim()) partition->loose_ptrs_.emplace_back(txn, varlen->Content());
         }
       }
       break;
@@ -206,9 +271,12 @@ void GarbageCollector::UnregisterIndexForGC(const common::ManagedPointer<index::
   indexes_.erase(index);
 }
 
-void GarbageCollector::ProcessIndexes() {
-  common::SharedLatch::ScopedSharedLatch guard(&indexes_latch_);
-  for (const auto &index : indexes_) index->PerformGarbageCollection();
+void GarbageCollector::ProcessIndexes(const transaction::timestamp_t oldest_txn) {
+  // Anything an index took off its retired lists during the previous invocation was unlinked before this time
+  const transaction::timestamp_t current_time = timestamp_manager_->CurrentTime();
+  for (const auto &index : indexes_) {
+    RunTask([index, oldest_txn, current_time] { index->PerformGarbageCollection(oldest_txn, current_time); });
+  }
 }
 
 }  // namespace terrier::storage
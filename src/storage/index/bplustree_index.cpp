@@ -1,6 +1,7 @@
 #include "storage/index/bplustree_index.h"
 #include "storage/index/compact_ints_key.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace terrier::storage::index {
 
@@ -13,4 +14,10 @@ template class BPlusTreeIndex<GenericKey<64>>;
 template class BPlusTreeIndex<GenericKey<128>>;
 template class BPlusTreeIndex<GenericKey<256>>;
 
+template class BPlusTreeIndex<NormalizedKey<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>>;
+template class BPlusTreeIndex<NormalizedKey<128>>;
+template class BPlusTreeIndex<NormalizedKey<256>>;
+
 }  // namespace terrier::storage::index
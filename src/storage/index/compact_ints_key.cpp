@@ -1,5 +1,8 @@
 #include "storage/index/compact_ints_key.h"
 
+#include "execution/util/cpu_info.h"
+#include "execution/util/simd.h"
+
 namespace terrier::storage::index {
 
 template class CompactIntsKey<8>;
@@ -7,4 +10,126 @@ template class CompactIntsKey<16>;
 template class CompactIntsKey<24>;
 template class CompactIntsKey<32>;
 
+namespace {
+
+/*
+ * Keys compare bytewise, which is the order of their 64-bit words read as unsigned big-endian integers. Reversing the
+ * bytes of a word and flipping its top bit gives a signed integer with the same order, so that keys can be compared
+ * with signed SIMD comparisons.
+ */
+constexpr int64_t WORD_SIGN_BIT = INT64_MIN;
+
+int64_t LoadOrderedWord(const byte *const word) {
+  uint64_t data;
+  std::memcpy(&data, word, sizeof(data));
+  return static_cast<int64_t>(be64toh(data)) ^ WORD_SIGN_BIT;
+}
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define COMPACT_INTS_KEY_VECTORIZED_SEARCH
+using WordVector = execution::util::simd::Vec8;
+constexpr execution::CpuInfo::Feature VECTORIZED_SEARCH_FEATURE = execution::CpuInfo::AVX512;
+
+ALWAYS_INLINE inline WordVector LoadOrderedWords(const byte *const words) {
+  const __m512i reverse = _mm512_broadcast_i32x4(_mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+  const WordVector data(_mm512_shuffle_epi8(_mm512_loadu_si512(words), reverse));
+  return data ^ WordVector(WORD_SIGN_BIT);
+}
+
+ALWAYS_INLINE inline WordVector BroadcastPair(const int64_t first, const int64_t second) {
+  return WordVector(first, second, first, second, first, second, first, second);
+}
+
+ALWAYS_INLINE inline uint32_t ToBits(const execution::util::simd::Vec8Mask &mask) {
+  return static_cast<__mmask8>(mask);
+}
+#elif defined(__AVX2__) && !defined(__AVX512F__)
+#define COMPACT_INTS_KEY_VECTORIZED_SEARCH
+using WordVector = execution::util::simd::Vec4;
+constexpr execution::CpuInfo::Feature VECTORIZED_SEARCH_FEATURE = execution::CpuInfo::AVX2;
+
+ALWAYS_INLINE inline WordVector LoadOrderedWords(const byte *const words) {
+  const __m256i reverse =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+  const WordVector data(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words)), reverse));
+  return data ^ WordVector(WORD_SIGN_BIT);
+}
+
+ALWAYS_INLINE inline WordVector BroadcastPair(const int64_t first, const int64_t second) {
+  return WordVector(first, second, first, second);
+}
+
+ALWAYS_INLINE inline uint32_t ToBits(const execution::util::simd::Vec4Mask &mask) {
+  return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+}
+#endif
+
+#ifdef COMPACT_INTS_KEY_VECTORIZED_SEARCH
+constexpr uint32_t WORDS_PER_VECTOR = WordVector::Size();
+constexpr uint32_t ALL_WORDS = (1u << WORDS_PER_VECTOR) - 1;
+// Selects the bit of the first word of every 16-byte key in a vector
+constexpr uint32_t FIRST_WORDS = ALL_WORDS & 0x55u;
+
+// The binary was compiled for the instruction set, but the CPU it runs on may not support it
+bool UseVectorizedSearch() {
+  static const bool supported = execution::CpuInfo::Instance()->HasFeature(VECTORIZED_SEARCH_FEATURE);
+  return supported;
+}
+#endif
+
+template <uint8_t KeySize>
+uint32_t ScalarSearchBound(const CompactIntsKey<KeySize> *const keys, uint32_t pos, const uint32_t num_keys,
+                           const CompactIntsKey<KeySize> &key, const bool upper) {
+  for (; pos < num_keys; pos++) {
+    const int cmp = std::memcmp(keys[pos].KeyData(), key.KeyData(), KeySize);
+    if (upper ? cmp > 0 : cmp >= 0) break;
+  }
+  return pos;
+}
+
+}  // namespace
+
+template <>
+uint32_t CompactIntsKey<8>::SearchBound(const CompactIntsKey *const keys, const uint32_t num_keys,
+                                        const CompactIntsKey &key, const bool upper) {
+  uint32_t pos = 0;
+#ifdef COMPACT_INTS_KEY_VECTORIZED_SEARCH
+  if (UseVectorizedSearch()) {
+    const WordVector target(LoadOrderedWord(key.KeyData()));
+    for (; pos + WORDS_PER_VECTOR <= num_keys; pos += WORDS_PER_VECTOR) {
+      const WordVector words = LoadOrderedWords(keys[pos].KeyData());
+      const uint32_t in_bound = upper ? ~ToBits(words > target) & ALL_WORDS : ToBits(target > words);
+      // The keys are sorted, so the keys within the bound are a prefix of the vector
+      const auto count = static_cast<uint32_t>(__builtin_popcount(in_bound));
+      if (count < WORDS_PER_VECTOR) return pos + count;
+    }
+  }
+#endif
+  return ScalarSearchBound(keys, pos, num_keys, key, upper);
+}
+
+template <>
+uint32_t CompactIntsKey<16>::SearchBound(const CompactIntsKey *const keys, const uint32_t num_keys,
+                                         const CompactIntsKey &key, const bool upper) {
+  uint32_t pos = 0;
+#ifdef COMPACT_INTS_KEY_VECTORIZED_SEARCH
+  if (UseVectorizedSearch()) {
+    constexpr uint32_t keys_per_vector = WORDS_PER_VECTOR / 2;
+    const WordVector target =
+        BroadcastPair(LoadOrderedWord(key.KeyData()), LoadOrderedWord(key.KeyData() + sizeof(uint64_t)));
+    for (; pos + keys_per_vector <= num_keys; pos += keys_per_vector) {
+      const WordVector words = LoadOrderedWords(keys[pos].KeyData());
+      // Compare every word, then combine the results of each key's two words lexicographically
+      const uint32_t less = ToBits(target > words);
+      const uint32_t equal = ToBits(target == words);
+      uint32_t in_bound = less | (equal & (less >> 1));
+      if (upper) in_bound |= equal & (equal >> 1);
+      const auto count = static_cast<uint32_t>(__builtin_popcount(in_bound & FIRST_WORDS));
+      if (count < keys_per_vector) return pos + count;
+    }
+  }
+#endif
+  return ScalarSearchBound(keys, pos, num_keys, key, upper);
+}
+
 }  // namespace terrier::storage::index
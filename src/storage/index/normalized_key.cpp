@@ -0,0 +1,11 @@
+#include "storage/index/normalized_key.h"
+
+namespace terrier::storage::index {
+
+template class NormalizedKey<16>;
+template class NormalizedKey<32>;
+template class NormalizedKey<64>;
+template class NormalizedKey<128>;
+template class NormalizedKey<256>;
+
+}  // namespace terrier::storage::index
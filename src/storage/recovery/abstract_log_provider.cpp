@@ -10,9 +10,11 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
   std::vector<byte *> varlen_contents;
   // Read in LogRecord header data
   auto size = ReadValue<uint32_t>();
-  byte *buf = common::AllocationUtil::AllocateAligned(size);
   auto record_type = ReadValue<storage::LogRecordType>();
   auto txn_begin = ReadValue<transaction::timestamp_t>();
+  // The record size is only trusted if the log did not end before it
+  if (truncated_) return {nullptr, varlen_contents};
+  byte *buf = common::AllocationUtil::AllocateAligned(size);
 
   switch (record_type) {
     case (storage::LogRecordType::COMMIT): {
@@ -45,7 +47,7 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
       auto table_oid = ReadValue<catalog::table_oid_t>();
       auto tuple_slot = ReadValue<storage::TupleSlot>();
 
-      // TODO(Gus, PR #468): Future addition of checksums should validate these values in case of data corruption.
+      // Log frames are checksummed, so this only catches bugs in serialization
       auto num_cols = ReadValue<uint16_t>();
       if (num_cols > common::Constants::MAX_COL) {
         throw std::runtime_error("Number of columns deserialized exceeds max columns. possible data corrution");
@@ -67,6 +69,12 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
         attr_size_boundaries.push_back(ReadValue<uint16_t>());
       }
 
+      // Without the whole layout, a row cannot be sized to fit into the record
+      if (truncated_) {
+        delete[] buf;
+        return {nullptr, varlen_contents};
+      }
+
       // Compute attr sizes
       std::vector<uint16_t> attr_sizes;
       attr_sizes.reserve(num_cols);
@@ -87,7 +95,7 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
       // read in. It doesn't populate the delta's bitmap yet. This will happen naturally as we proceed column-by-column.
       auto bitmap_num_bytes = common::RawBitmap::SizeInBytes(num_cols);
       auto *bitmap_buffer = new uint8_t[bitmap_num_bytes];
-      Read(bitmap_buffer, bitmap_num_bytes);
+      ReadOrTruncate(bitmap_buffer, bitmap_num_bytes);
       auto *bitmap = reinterpret_cast<common::RawBitmap *>(bitmap_buffer);
 
       for (uint16_t i = 0; i < num_cols; i++) {
@@ -109,13 +117,13 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
           if (varlen_attribute_size <= storage::VarlenEntry::InlineThreshold()) {
             // Because it's inline, we can just read it into a stack object, as the varlen constructor will memcpy it
             byte varlen_attribute_content[varlen_attribute_size];
-            Read(&varlen_attribute_content, varlen_attribute_size);
+            ReadOrTruncate(&varlen_attribute_content, varlen_attribute_size);
             varlen_entry = storage::VarlenEntry::CreateInline(varlen_attribute_content, varlen_attribute_size);
           } else {
             // Allocate a varlen buffer of this many bytes.
             auto *varlen_attribute_content = common::AllocationUtil::AllocateAligned(varlen_attribute_size);
             // Fill the entry with the next bytes from the log file.
-            Read(varlen_attribute_content, varlen_attribute_size);
+            ReadOrTruncate(varlen_attribute_content, varlen_attribute_size);
 
             varlen_entry = storage::VarlenEntry::Create(varlen_attribute_content, varlen_attribute_size, true);
             varlen_contents.push_back(varlen_attribute_content);
@@ -127,7 +135,7 @@ std::pair<LogRecord *, std::vector<byte *>> AbstractLogProvider::ReadNextRecord(
           // Store reference to varlen content to clean up incase of abort
         } else {
           // For inlined attributes, just directly read into the ProjectedRow.
-          Read(column_value_address, attr_sizes[i]);
+          ReadOrTruncate(column_value_address, attr_sizes[i]);
         }
       }
 
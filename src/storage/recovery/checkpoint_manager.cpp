@@ -0,0 +1,385 @@
+#include "storage/recovery/checkpoint_manager.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/postgres/pg_attribute.h"
+#include "catalog/postgres/pg_class.h"
+#include "catalog/postgres/pg_constraint.h"
+#include "catalog/postgres/pg_database.h"
+#include "catalog/postgres/pg_index.h"
+#include "catalog/postgres/pg_language.h"
+#include "catalog/postgres/pg_namespace.h"
+#include "catalog/postgres/pg_proc.h"
+#include "catalog/postgres/pg_type.h"
+#include "storage/write_ahead_log/log_frame.h"
+#include "storage/write_ahead_log/log_io.h"
+
+namespace terrier::storage {
+
+namespace {
+template <typename T>
+void Append(std::vector<byte> *const out, const T &value) {
+  const auto *bytes = reinterpret_cast<const byte *>(&value);
+  out->insert(out->end(), bytes, bytes + sizeof(T));
+}
+
+void AppendBytes(std::vector<byte> *const out, const void *const data, const size_t size) {
+  const auto *bytes = reinterpret_cast<const byte *>(data);
+  out->insert(out->end(), bytes, bytes + size);
+}
+
+// Advances pos past the given number of bytes of a section that ends at end, and returns where they start
+const byte *Advance(const byte **const pos, const byte *const end, const uint64_t size) {
+  if (size > static_cast<uint64_t>(end - *pos)) {
+    throw std::runtime_error("Checkpoint section ends before its contents. possible data corruption");
+  }
+  const byte *const result = *pos;
+  *pos += size;
+  return result;
+}
+
+template <typename T>
+T Take(const byte **const pos, const byte *const end) {
+  T result;
+  std::memcpy(&result, Advance(pos, end, sizeof(T)), sizeof(T));
+  return result;
+}
+
+uint32_t SectionChecksum(const uint64_t size, const byte *const contents) {
+  uint32_t crc = LogFrame::Checksum(&size, sizeof(size));
+  // The checksum takes 32-bit sizes
+  for (uint64_t done = 0; done < size;) {
+    const auto chunk = static_cast<uint32_t>(std::min<uint64_t>(size - done, UINT32_MAX));
+    crc = LogFrame::Checksum(contents + done, chunk, crc);
+    done += chunk;
+  }
+  return crc;
+}
+
+uint32_t ValidityBitmapSize(const uint32_t num_tuples) { return (num_tuples + 7) / 8; }
+
+// Calls f with a RowView and projection map for every tuple of the table that is visible to txn, scanning max_tuples
+// at a time
+template <typename F>
+void ForEachTuple(const common::ManagedPointer<transaction::TransactionContext> txn, SqlTable *const table,
+                  const std::vector<catalog::col_oid_t> &col_oids, const uint32_t max_tuples, F f) {
+  auto initializer = table->InitializerForProjectedColumns(col_oids, max_tuples);
+  const auto pr_map = table->ProjectionMapForOids(col_oids);
+  // Owned by a unique_ptr, because the scan and f can throw
+  const std::unique_ptr<byte[]> buffer(common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize()));
+  auto *const columns = initializer.Initialize(buffer.get());
+  auto it = table->begin();
+  while (it != table->end()) {
+    table->Scan(txn, &it, columns);
+    for (uint32_t i = 0; i < columns->NumTuples(); i++) f(columns->InterpretAsRow(i), pr_map);
+  }
+}
+}  // namespace
+
+std::unique_ptr<CheckpointSection> CheckpointSection::Read(const int fd) {
+  uint64_t size;
+  const uint32_t header_read = PosixIoWrappers::ReadFully(fd, &size, sizeof(size));
+  if (header_read == 0) return nullptr;
+  uint32_t checksum;
+  if (header_read != sizeof(size) || PosixIoWrappers::ReadFully(fd, &checksum, sizeof(checksum)) != sizeof(checksum)) {
+    throw std::runtime_error("Checkpoint file ends in the middle of a section");
+  }
+  // The size is checked against the file before it is trusted with an allocation
+  struct stat file_stat;
+  const off_t offset = lseek(fd, 0, SEEK_CUR);
+  if (offset == -1 || fstat(fd, &file_stat) == -1) {
+    throw std::runtime_error("Failed to stat checkpoint file with errno " + std::to_string(errno));
+  }
+  if (size > static_cast<uint64_t>(file_stat.st_size - offset)) {
+    throw std::runtime_error("Checkpoint file ends in the middle of a section");
+  }
+
+  auto section = std::make_unique<CheckpointSection>();
+  section->contents_ = std::unique_ptr<byte[]>(new byte[size]);
+  if (PosixIoWrappers::ReadFully(fd, section->contents_.get(), size) != size) {
+    throw std::runtime_error("Checkpoint file ends in the middle of a section");
+  }
+  if (SectionChecksum(size, section->contents_.get()) != checksum) {
+    throw std::runtime_error("Checkpoint section fails its checksum. possible data corruption");
+  }
+
+  const byte *pos = section->contents_.get();
+  const byte *const end = pos + size;
+  section->db_oid_ = Take<catalog::db_oid_t>(&pos, end);
+  section->table_oid_ = Take<catalog::table_oid_t>(&pos, end);
+  section->num_tuples_ = Take<uint32_t>(&pos, end);
+  const uint64_t num_tuples = section->num_tuples_;
+  const auto num_cols = Take<uint16_t>(&pos, end);
+  if (num_cols > common::Constants::MAX_COL) {
+    throw std::runtime_error("Number of columns in checkpoint exceeds max columns. possible data corruption");
+  }
+  section->slots_ = Advance(&pos, end, num_tuples * sizeof(TupleSlot));
+  for (uint16_t i = 0; i < num_cols; i++) section->col_oids_.push_back(Take<catalog::col_oid_t>(&pos, end));
+  for (uint16_t i = 0; i < num_cols; i++) section->attr_sizes_.push_back(Take<uint16_t>(&pos, end));
+
+  for (uint16_t i = 0; i < num_cols; i++) {
+    section->validity_.push_back(Advance(&pos, end, ValidityBitmapSize(section->num_tuples_)));
+    if (section->attr_sizes_[i] == VARLEN_COLUMN) {
+      const byte *const offsets = Advance(&pos, end, (num_tuples + 1) * sizeof(uint32_t));
+      // Values are read at these offsets, so they have to stay within the data. The last offset is its size.
+      uint32_t data_size = 0;
+      for (uint64_t row = 0; row <= num_tuples; row++) {
+        uint32_t offset;
+        std::memcpy(&offset, offsets + row * sizeof(uint32_t), sizeof(uint32_t));
+        if (offset < data_size) {
+          throw std::runtime_error("Checkpoint varlen offsets are out of order. possible data corruption");
+        }
+        data_size = offset;
+      }
+      section->offsets_.push_back(offsets);
+      section->values_.push_back(Advance(&pos, end, data_size));
+    } else {
+      section->offsets_.push_back(nullptr);
+      section->values_.push_back(Advance(&pos, end, num_tuples * AttrSizeBytes(section->attr_sizes_[i])));
+    }
+  }
+  if (pos != end) throw std::runtime_error("Checkpoint section has an unexpected size");
+  return section;
+}
+
+TupleSlot CheckpointSection::OriginalTupleSlot(const uint32_t row) const {
+  TERRIER_ASSERT(row < num_tuples_, "Row out of bounds.");
+  TupleSlot result;
+  std::memcpy(&result, slots_ + row * sizeof(TupleSlot), sizeof(TupleSlot));
+  return result;
+}
+
+bool CheckpointSection::IsNull(const uint32_t row, const uint16_t col) const {
+  TERRIER_ASSERT(row < num_tuples_, "Row out of bounds.");
+  const auto bits = static_cast<uint8_t>(validity_[col][row / 8]);
+  return (bits & (1U << (row % 8))) == 0;
+}
+
+void CheckpointSection::CopyToRow(const uint32_t row, ProjectedRow *const pr, const ProjectionMap &pr_map) const {
+  for (uint16_t col = 0; col < col_oids_.size(); col++) {
+    const uint16_t offset = pr_map.at(col_oids_[col]);
+    if (IsNull(row, col)) {
+      pr->SetNull(offset);
+      continue;
+    }
+    if (attr_sizes_[col] != VARLEN_COLUMN) {
+      const uint16_t size = AttrSizeBytes(attr_sizes_[col]);
+      std::memcpy(pr->AccessForceNotNull(offset), values_[col] + row * size, size);
+      continue;
+    }
+    uint32_t begin, end;
+    std::memcpy(&begin, offsets_[col] + row * sizeof(uint32_t), sizeof(uint32_t));
+    std::memcpy(&end, offsets_[col] + (row + 1) * sizeof(uint32_t), sizeof(uint32_t));
+    const uint32_t size = end - begin;
+    VarlenEntry entry;
+    if (size <= VarlenEntry::InlineThreshold()) {
+      entry = VarlenEntry::CreateInline(values_[col] + begin, size);
+    } else {
+      auto *const contents = common::AllocationUtil::AllocateAligned(size);
+      std::memcpy(contents, values_[col] + begin, size);
+      entry = VarlenEntry::Create(contents, size, true);
+    }
+    *reinterpret_cast<VarlenEntry *>(pr->AccessForceNotNull(offset)) = entry;
+  }
+}
+
+void CheckpointManager::CheckpointTask::RunTask() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait_for(lock, checkpoint_interval_, [&] { return !run_task_; });
+    if (!run_task_) break;
+    lock.unlock();
+    try {
+      checkpoint_manager_->Checkpoint();
+    } catch (std::runtime_error &e) {
+      // The previous checkpoint is still intact, so just try again next time
+      STORAGE_LOG_ERROR("Checkpoint failed: {}", e.what());
+    }
+    lock.lock();
+  }
+}
+
+void CheckpointManager::CheckpointTask::Terminate() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    run_task_ = false;
+  }
+  cv_.notify_one();
+}
+
+transaction::timestamp_t CheckpointManager::Checkpoint() {
+  std::unique_lock<std::mutex> guard(checkpoint_latch_);
+  // Every transaction that started before this has finished by the time the snapshot is taken, so it is either in the
+  // checkpoint or aborted, and its log records are no longer needed once the checkpoint is complete
+  const transaction::timestamp_t oldest_txn = txn_manager_->timestamp_manager_->OldestTransactionStartTime();
+  auto *const txn = txn_manager_->BeginTransaction();
+  const transaction::timestamp_t snapshot_ts = txn->StartTime();
+
+  const std::string temp_path = checkpoint_path_ + ".tmp";
+  int fd = -1;
+  try {
+    fd = PosixIoWrappers::Open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    WriteCheckpoint(common::ManagedPointer(txn), fd);
+    if (fsync(fd) == -1) throw std::runtime_error("fsync failed with errno " + std::to_string(errno));
+    const int written_fd = fd;
+    fd = -1;
+    PosixIoWrappers::Close(written_fd);
+  } catch (...) {
+    // A failed checkpoint must not hold back the oldest running txn, or leave a partial file for the next one to trip
+    // over. The previous checkpoint is untouched.
+    if (fd != -1) close(fd);
+    std::remove(temp_path.c_str());
+    txn_manager_->Abort(txn);
+    throw;
+  }
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Only replace the previous checkpoint once this one is complete
+  if (std::rename(temp_path.c_str(), checkpoint_path_.c_str()) == -1) {
+    const int rename_errno = errno;
+    std::remove(temp_path.c_str());
+    throw std::runtime_error("Failed to rename checkpoint with errno " + std::to_string(rename_errno));
+  }
+  // The rename has to be durable before the log that the old checkpoint still needs is removed
+  PosixIoWrappers::SyncParentDirectory(checkpoint_path_);
+  if (txn_manager_->log_manager_ != DISABLED) txn_manager_->log_manager_->RemoveSegmentsBefore(oldest_txn);
+  return snapshot_ts;
+}
+
+void CheckpointManager::WriteCheckpoint(const common::ManagedPointer<transaction::TransactionContext> txn,
+                                        const int fd) {
+  const transaction::timestamp_t snapshot_ts = txn->StartTime();
+  PosixIoWrappers::WriteFully(fd, &MAGIC, sizeof(MAGIC));
+  PosixIoWrappers::WriteFully(fd, &snapshot_ts, sizeof(snapshot_ts));
+
+  // Databases go first, so that recovery can create them before filling in their catalog tables
+  WriteTable(txn, fd, catalog::INVALID_DATABASE_OID, catalog::postgres::DATABASE_TABLE_OID, catalog_->databases_);
+  std::vector<catalog::db_oid_t> db_oids;
+  ForEachTuple(txn, catalog_->databases_, {catalog::postgres::DATOID_COL_OID}, TUPLES_PER_SECTION,
+               [&](const ProjectedColumns::RowView &row, const ProjectionMap &pr_map) {
+                 db_oids.push_back(*reinterpret_cast<const catalog::db_oid_t *>(
+                     row.AccessWithNullCheck(pr_map.at(catalog::postgres::DATOID_COL_OID))));
+               });
+
+  // Then the catalog tables of every database. Pointers to schemas and tables are meaningless after a restart, so
+  // recovery recreates those objects from the rest of the catalog.
+  for (const auto db_oid : db_oids) {
+    auto db_catalog = catalog_->GetDatabaseCatalog(txn, db_oid);
+    WriteTable(txn, fd, db_oid, catalog::postgres::NAMESPACE_TABLE_OID, db_catalog->namespaces_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::CLASS_TABLE_OID, db_catalog->classes_,
+               {catalog::postgres::REL_SCHEMA_COL_OID, catalog::postgres::REL_PTR_COL_OID});
+    WriteTable(txn, fd, db_oid, catalog::postgres::COLUMN_TABLE_OID, db_catalog->columns_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::CONSTRAINT_TABLE_OID, db_catalog->constraints_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::INDEX_TABLE_OID, db_catalog->indexes_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::TYPE_TABLE_OID, db_catalog->types_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::LANGUAGE_TABLE_OID, db_catalog->languages_);
+    WriteTable(txn, fd, db_oid, catalog::postgres::PRO_TABLE_OID, db_catalog->procs_);
+  }
+
+  // User tables go last, recovery loads them in parallel once all tables exist again
+  for (const auto db_oid : db_oids) {
+    auto db_catalog = catalog_->GetDatabaseCatalog(txn, db_oid);
+    std::vector<catalog::table_oid_t> table_oids;
+    ForEachTuple(txn, db_catalog->classes_, {catalog::postgres::RELOID_COL_OID, catalog::postgres::RELKIND_COL_OID},
+                 TUPLES_PER_SECTION, [&](const ProjectedColumns::RowView &row, const ProjectionMap &pr_map) {
+                   const auto class_oid = *reinterpret_cast<const uint32_t *>(
+                       row.AccessWithNullCheck(pr_map.at(catalog::postgres::RELOID_COL_OID)));
+                   const auto class_kind = *reinterpret_cast<const catalog::postgres::ClassKind *>(
+                       row.AccessWithNullCheck(pr_map.at(catalog::postgres::RELKIND_COL_OID)));
+                   if (class_kind == catalog::postgres::ClassKind::REGULAR_TABLE && class_oid >= catalog::START_OID)
+                     table_oids.emplace_back(class_oid);
+                 });
+    for (const auto table_oid : table_oids) {
+      WriteTable(txn, fd, db_oid, table_oid, db_catalog->GetTable(txn, table_oid).Get());
+    }
+  }
+}
+
+void CheckpointManager::WriteTable(const common::ManagedPointer<transaction::TransactionContext> txn, const int fd,
+                                   const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid,
+                                   SqlTable *const table, const std::vector<catalog::col_oid_t> &excluded_oids) {
+  std::vector<catalog::col_oid_t> col_oids;
+  col_oids.reserve(table->table_.column_map_.size());
+  for (const auto &entry : table->table_.column_map_) col_oids.push_back(entry.first);
+
+  auto initializer = table->InitializerForProjectedColumns(col_oids, TUPLES_PER_SECTION);
+  const auto pr_map = table->ProjectionMapForOids(col_oids);
+  std::vector<catalog::col_oid_t> projected_oids(col_oids.size());
+  std::vector<bool> excluded(col_oids.size(), false);
+  for (const auto &entry : pr_map) {
+    projected_oids[entry.second] = entry.first;
+    excluded[entry.second] = std::find(excluded_oids.begin(), excluded_oids.end(), entry.first) != excluded_oids.end();
+  }
+
+  // Owned by a unique_ptr, because writing the sections can throw
+  const std::unique_ptr<byte[]> buffer(common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize()));
+  auto *const columns = initializer.Initialize(buffer.get());
+  auto it = table->begin();
+  while (it != table->end()) {
+    table->Scan(txn, &it, columns);
+    if (columns->NumTuples() > 0) WriteSection(fd, db_oid, table_oid, *table, projected_oids, excluded, columns);
+  }
+}
+
+void CheckpointManager::WriteSection(const int fd, const catalog::db_oid_t db_oid,
+                                     const catalog::table_oid_t table_oid, const SqlTable &table,
+                                     const std::vector<catalog::col_oid_t> &col_oids, const std::vector<bool> &excluded,
+                                     ProjectedColumns *const columns) {
+  const uint32_t num_tuples = columns->NumTuples();
+  const auto num_cols = static_cast<uint16_t>(col_oids.size());
+  std::vector<byte> out;
+  Append(&out, db_oid);
+  Append(&out, table_oid);
+  Append(&out, num_tuples);
+  Append(&out, num_cols);
+  AppendBytes(&out, columns->TupleSlots(), num_tuples * sizeof(TupleSlot));
+  for (const auto col_oid : col_oids) Append(&out, col_oid);
+
+  std::vector<bool> varlen(num_cols);
+  for (uint16_t i = 0; i < num_cols; i++) {
+    const col_id_t col_id = columns->ColumnIds()[i];
+    varlen[i] = table.table_.layout_.IsVarlen(col_id);
+    Append(&out, varlen[i] ? VARLEN_COLUMN : table.table_.layout_.AttrSize(col_id));
+  }
+
+  std::vector<uint8_t> validity(ValidityBitmapSize(num_tuples));
+  for (uint16_t i = 0; i < num_cols; i++) {
+    std::fill(validity.begin(), validity.end(), 0);
+    const common::RawBitmap *const nulls = columns->ColumnNullBitmap(i);
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      if (!excluded[i] && nulls->Test(row)) validity[row / 8] = static_cast<uint8_t>(validity[row / 8] | 1U << row % 8);
+    }
+    AppendBytes(&out, validity.data(), validity.size());
+
+    if (!varlen[i]) {
+      AppendBytes(&out, columns->ColumnStart(i), num_tuples * columns->AttrSizeForColumn(i));
+      continue;
+    }
+    // Arrow-style offsets followed by all the values of the column back to back
+    const auto *const entries = reinterpret_cast<const VarlenEntry *>(columns->ColumnStart(i));
+    uint32_t offset = 0;
+    Append(&out, offset);
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      if (validity[row / 8] & (1U << row % 8)) offset += entries[row].Size();
+      Append(&out, offset);
+    }
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      if (validity[row / 8] & (1U << row % 8)) AppendBytes(&out, entries[row].Content(), entries[row].Size());
+    }
+  }
+
+  const uint64_t size = out.size();
+  const uint32_t checksum = SectionChecksum(size, out.data());
+  PosixIoWrappers::WriteFully(fd, &size, sizeof(size));
+  PosixIoWrappers::WriteFully(fd, &checksum, sizeof(checksum));
+  PosixIoWrappers::WriteFully(fd, out.data(), size);
+}
+
+}  // namespace terrier::storage
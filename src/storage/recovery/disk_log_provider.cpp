@@ -0,0 +1,54 @@
+#include "storage/recovery/disk_log_provider.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace terrier::storage {
+
+DiskLogProvider::DiskLogProvider(std::vector<std::vector<std::string>> stream_file_paths)
+    : in_(stream_file_paths.front()) {
+  // A crash can tear the last rounds of some streams but not of others. None of the transactions in such rounds were
+  // reported as committed, and those in the intact streams may depend on ones that were lost.
+  const uint64_t last_round = stream_file_paths.size() > 1 ? LogFile::CommonRound(stream_file_paths) : 0;
+  for (uint32_t i = 1; i < stream_file_paths.size(); i++) {
+    // The other streams are read by providers of a single stream each
+    std::vector<std::vector<std::string>> single_stream;
+    single_stream.emplace_back(std::move(stream_file_paths[i]));
+    other_streams_.emplace_back(new DiskLogProvider(std::move(single_stream)));
+    other_streams_.back()->in_.StopAfterRound(last_round);
+  }
+  if (!other_streams_.empty()) in_.StopAfterRound(last_round);
+  heads_.resize(stream_file_paths.size());
+  head_read_.resize(stream_file_paths.size(), false);
+}
+
+std::pair<LogRecord *, std::vector<byte *>> DiskLogProvider::GetNextRecord() {
+  if (other_streams_.empty()) return AbstractLogProvider::GetNextRecord();
+
+  // Records other than commits only matter to their own transaction, whose records are all in the same stream, so they
+  // can be handed out as soon as they are read
+  for (uint32_t stream = 0; stream < heads_.size(); stream++) {
+    if (head_read_[stream]) continue;
+    auto record = GetNextStreamRecord(stream);
+    if (record.first != nullptr && record.first->RecordType() != LogRecordType::COMMIT) return record;
+    heads_[stream] = std::move(record);
+    head_read_[stream] = true;
+  }
+
+  // Every stream is at a commit record or exhausted, hand out the commit that happened first
+  uint32_t next = 0;
+  for (uint32_t stream = 1; stream < heads_.size(); stream++) {
+    if (heads_[stream].first == nullptr) continue;
+    if (heads_[next].first == nullptr ||
+        heads_[stream].first->GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime() <
+            heads_[next].first->GetUnderlyingRecordBodyAs<CommitRecord>()->CommitTime()) {
+      next = stream;
+    }
+  }
+  if (heads_[next].first == nullptr) return {nullptr, {}};
+  head_read_[next] = false;
+  return std::move(heads_[next]);
+}
+
+}  // namespace terrier::storage
@@ -1,8 +1,16 @@
 #include "storage/recovery/recovery_manager.h"
 
 #include <catalog/postgres/pg_proc.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -16,15 +24,113 @@
 #include "catalog/postgres/pg_language.h"
 #include "catalog/postgres/pg_namespace.h"
 #include "catalog/postgres/pg_type.h"
+#include "common/worker_pool.h"
 #include "storage/index/index_builder.h"
+#include "storage/recovery/checkpoint_manager.h"
 #include "storage/write_ahead_log/log_io.h"
 
 namespace terrier::storage {
 
-void RecoveryManager::RecoverFromLogs() {
+namespace {
+// Closes a file when it goes out of scope, so that the file is not leaked when reading it throws
+class ScopedFile {
+ public:
+  explicit ScopedFile(const int fd) : fd_(fd) {}
+  ~ScopedFile() { close(fd_); }
+  DISALLOW_COPY_AND_MOVE(ScopedFile)
+  int Get() const { return fd_; }
+
+ private:
+  const int fd_;
+};
+
+// Decodes log records on a background thread, so that reading the log overlaps with replaying it. Records are handed
+// over in batches to keep synchronization off the per-record path.
+class LogRecordPrefetcher {
+ public:
+  using Record = std::pair<LogRecord *, std::vector<byte *>>;
+
+  LogRecordPrefetcher(const common::ManagedPointer<AbstractLogProvider> log_provider, const bool background)
+      : log_provider_(log_provider) {
+    if (background) reader_ = std::thread([this] { Prefetch(); });
+  }
+
+  ~LogRecordPrefetcher() {
+    if (!reader_.joinable()) return;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    reader_.join();
+  }
+
+  DISALLOW_COPY_AND_MOVE(LogRecordPrefetcher)
+
+  Record GetNextRecord() {
+    if (!reader_.joinable()) return log_provider_->GetNextRecord();
+    if (position_ == current_.size()) {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [&] { return !batches_.empty(); });
+      current_ = std::move(batches_.front());
+      batches_.pop();
+      position_ = 0;
+      cv_.notify_all();
+    }
+    return std::move(current_[position_++]);
+  }
+
+ private:
+  static constexpr uint32_t BATCH_SIZE = 1024;
+  static constexpr uint32_t MAX_BATCHES = 16;
+
+  void Prefetch() {
+    bool done = false;
+    while (!done) {
+      std::vector<Record> batch;
+      batch.reserve(BATCH_SIZE);
+      while (!done && batch.size() < BATCH_SIZE) {
+        batch.push_back(log_provider_->GetNextRecord());
+        // The end of the log is passed on as a nullptr record
+        done = batch.back().first == nullptr;
+      }
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [&] { return stopped_ || batches_.size() < MAX_BATCHES; });
+      if (stopped_) return;
+      batches_.push(std::move(batch));
+      cv_.notify_all();
+    }
+  }
+
+  const common::ManagedPointer<AbstractLogProvider> log_provider_;
+  std::thread reader_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::queue<std::vector<Record>> batches_;
+  bool stopped_ = false;
+  // Batch being consumed, only touched by the consumer
+  std::vector<Record> current_;
+  uint32_t position_ = 0;
+};
+
+uint32_t ReplayPartitionIndex(const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid,
+                              const uint32_t num_partitions) {
+  return static_cast<uint32_t>(std::hash<uint64_t>()(static_cast<uint64_t>(!db_oid) << 32 | !table_oid) %
+                               num_partitions);
+}
+}  // namespace
+
+void RecoveryManager::RecoverFromLogs(const transaction::timestamp_t checkpoint_ts) {
+  if (num_replay_threads_ > 1) {
+    replay_pool_ = std::make_unique<common::WorkerPool>(num_replay_threads_, common::TaskQueue());
+    replay_pool_->Startup();
+    replay_partitions_ = std::vector<ReplayPartition>(num_replay_threads_ * PARTITIONS_PER_REPLAY_THREAD);
+  }
+  LogRecordPrefetcher prefetcher(log_provider_, num_replay_threads_ > 1);
+
   // Replay logs until the log provider no longer gives us logs
   while (true) {
-    auto pair = log_provider_->GetNextRecord();
+    auto pair = prefetcher.GetNextRecord();
     auto *log_record = pair.first;
 
     // If we have exhausted all the logs, break from the loop
@@ -43,8 +149,14 @@ void RecoveryManager::RecoverFromLogs() {
         TERRIER_ASSERT(pair.second.empty(), "Commit records should not have any varlen pointers");
         auto *commit_record = log_record->GetUnderlyingRecordBodyAs<CommitRecord>();
 
-        // We defer all transactions initially
-        deferred_txns_.insert(log_record->TxnBegin());
+        if (commit_record->CommitTime() < checkpoint_ts) {
+          // The transaction's changes are already in the checkpoint
+          DeferRecordDeletes(log_record->TxnBegin(), true);
+          buffered_changes_map_.erase(log_record->TxnBegin());
+        } else {
+          // We defer all transactions initially
+          deferred_txns_.insert(log_record->TxnBegin());
+        }
 
         // Process any deferred transactions that are safe to execute
         recovered_txns_ += ProcessDeferredTransactions(commit_record->OldestActiveTxn());
@@ -64,6 +176,12 @@ void RecoveryManager::RecoverFromLogs() {
   // Process all deferred txns
   ProcessDeferredTransactions(transaction::INVALID_TXN_TIMESTAMP);
   TERRIER_ASSERT(deferred_txns_.empty(), "We should have no unprocessed deferred transactions at the end of recovery");
+  if (replay_pool_ != nullptr) {
+    WaitForDispatchedTransactions();
+    replay_pool_->Shutdown();
+    replay_pool_ = nullptr;
+    replay_partitions_.clear();
+  }
 
   // If we have unprocessed buffered changes, then these transactions were in-process at the time of system shutdown.
   // They are unrecoverable, so we need to clean up the memory of their records.
@@ -75,6 +193,184 @@ void RecoveryManager::RecoverFromLogs() {
   }
 }
 
+void RecoveryManager::SetAside(const std::string &log_file_path, const std::string &checkpoint_path) {
+  const std::string log_aside_path = log_file_path + SET_ASIDE_SUFFIX;
+  const std::string checkpoint_aside_path = checkpoint_path + SET_ASIDE_SUFFIX;
+  // The files are moved one by one, so markers tell how far setting them aside got: while moving, the files not moved
+  // yet are still at their original paths. While recovering, the files at the original paths were written by recovery.
+  const std::string moving_path = log_aside_path + ".moving";
+  const std::string recovering_path = log_aside_path + ".recovering";
+
+  if (access(recovering_path.c_str(), F_OK) == 0) {
+    LogFile::Remove(log_file_path);
+    if (unlink(checkpoint_path.c_str()) == -1 && errno != ENOENT) {
+      throw std::runtime_error("Failed to remove checkpoint with errno " + std::to_string(errno));
+    }
+    return;
+  }
+
+  if (access(moving_path.c_str(), F_OK) == -1) {
+    // Whatever is still set aside was left behind by a recovery that finished
+    RemoveSetAside(log_file_path, checkpoint_path);
+    PosixIoWrappers::Close(PosixIoWrappers::Open(moving_path.c_str(), O_WRONLY | O_CREAT, 0644));
+    PosixIoWrappers::SyncParentDirectory(moving_path);
+  }
+  LogFile::Rename(log_file_path, log_aside_path);
+  if (rename(checkpoint_path.c_str(), checkpoint_aside_path.c_str()) == -1 && errno != ENOENT) {
+    throw std::runtime_error("Failed to set checkpoint aside with errno " + std::to_string(errno));
+  }
+  PosixIoWrappers::SyncParentDirectory(log_file_path);
+  PosixIoWrappers::SyncParentDirectory(checkpoint_path);
+  if (rename(moving_path.c_str(), recovering_path.c_str()) == -1) {
+    throw std::runtime_error("Failed to rename recovery marker with errno " + std::to_string(errno));
+  }
+  PosixIoWrappers::SyncParentDirectory(recovering_path);
+}
+
+void RecoveryManager::RemoveSetAside(const std::string &log_file_path, const std::string &checkpoint_path) {
+  const std::string log_aside_path = log_file_path + SET_ASIDE_SUFFIX;
+  const std::string checkpoint_aside_path = checkpoint_path + SET_ASIDE_SUFFIX;
+  const std::string recovering_path = log_aside_path + ".recovering";
+  // Once the marker is gone, a restart recovers from the new log, and the rest is only removed to free the space
+  if (unlink(recovering_path.c_str()) == 0) {
+    PosixIoWrappers::SyncParentDirectory(recovering_path);
+  } else if (errno != ENOENT) {
+    throw std::runtime_error("Failed to remove recovery marker with errno " + std::to_string(errno));
+  }
+  LogFile::Remove(log_aside_path);
+  if (unlink(checkpoint_aside_path.c_str()) == -1 && errno != ENOENT) {
+    throw std::runtime_error("Failed to remove checkpoint with errno " + std::to_string(errno));
+  }
+}
+
+transaction::timestamp_t RecoveryManager::RecoverFromCheckpoint() {
+  // Nothing to load if no checkpoint was ever completed
+  if (access(checkpoint_path_.c_str(), F_OK) == -1) return transaction::INITIAL_TXN_TIMESTAMP;
+  const ScopedFile file(PosixIoWrappers::Open(checkpoint_path_.c_str(), O_RDONLY));
+  const int fd = file.Get();
+  uint64_t magic;
+  transaction::timestamp_t checkpoint_ts;
+  if (PosixIoWrappers::ReadFully(fd, &magic, sizeof(magic)) != sizeof(magic) || magic != CheckpointManager::MAGIC ||
+      PosixIoWrappers::ReadFully(fd, &checkpoint_ts, sizeof(checkpoint_ts)) != sizeof(checkpoint_ts)) {
+    throw std::runtime_error("Checkpoint file " + checkpoint_path_ + " is not a valid checkpoint");
+  }
+
+  // Step 1: Load the catalog tables. Databases come first, then the catalog tables of every database. We remember the
+  // tables and indexes in pg_class to recreate them once their metadata is loaded.
+  auto *txn = txn_manager_->BeginTransaction();
+  std::vector<std::tuple<catalog::db_oid_t, uint32_t, catalog::postgres::ClassKind>> classes;
+  std::unique_ptr<CheckpointSection> section;
+  std::unordered_map<catalog::db_oid_t, std::unordered_map<catalog::table_oid_t, SqlTable *>> tables;
+  try {
+    for (section = CheckpointSection::Read(fd); section != nullptr && (!section->TableOid()) < catalog::START_OID;
+         section = CheckpointSection::Read(fd)) {
+      const auto db_oid = section->DatabaseOid();
+      const auto table_oid = section->TableOid();
+      auto sql_table = GetSqlTable(txn, db_oid, table_oid);
+      auto pr_init = sql_table->InitializerForProjectedRow(section->ColumnOids());
+      auto pr_map = sql_table->ProjectionMapForOids(section->ColumnOids());
+
+      if (table_oid == catalog::postgres::DATABASE_TABLE_OID) {
+        // Databases are created through the catalog, which also inserts their entries into pg_database
+        auto *buffer = common::AllocationUtil::AllocateAligned(pr_init.ProjectedRowSize());
+        auto *pr = pr_init.InitializeRow(buffer);
+        for (uint32_t row = 0; row < section->NumTuples(); row++) {
+          section->CopyToRow(row, pr, pr_map);
+          catalog::db_oid_t recovered_db_oid(
+              *(reinterpret_cast<uint32_t *>(pr->AccessWithNullCheck(pr_map[catalog::postgres::DATOID_COL_OID]))));
+          auto name_varlen =
+              *(reinterpret_cast<VarlenEntry *>(pr->AccessWithNullCheck(pr_map[catalog::postgres::DATNAME_COL_OID])));
+          tuple_slot_map_[section->OriginalTupleSlot(row)] =
+              RecreateDatabase(txn, recovered_db_oid, std::string(name_varlen.StringView()));
+          // The row is not inserted into a table, so nothing takes over the name's buffer
+          if (name_varlen.NeedReclaim()) delete[] name_varlen.Content();
+        }
+        delete[] buffer;
+        continue;
+      }
+
+      for (uint32_t row = 0; row < section->NumTuples(); row++) {
+        auto *redo = txn->StageWrite(db_oid, table_oid, pr_init);
+        section->CopyToRow(row, redo->Delta(), pr_map);
+        auto new_tuple_slot = sql_table->Insert(common::ManagedPointer(txn), redo);
+        UpdateIndexesOnTable(txn, db_oid, table_oid, sql_table, new_tuple_slot, redo->Delta(), true /* insert */);
+        tuple_slot_map_[section->OriginalTupleSlot(row)] = new_tuple_slot;
+        if (table_oid == catalog::postgres::CLASS_TABLE_OID) {
+          classes.emplace_back(db_oid,
+                               *(reinterpret_cast<uint32_t *>(
+                                   redo->Delta()->AccessWithNullCheck(pr_map[catalog::postgres::RELOID_COL_OID]))),
+                               *(reinterpret_cast<catalog::postgres::ClassKind *>(
+                                   redo->Delta()->AccessWithNullCheck(pr_map[catalog::postgres::RELKIND_COL_OID]))));
+        }
+      }
+    }
+
+    // Step 2: Recreate the tables, so that the user tables can be loaded
+    for (const auto &[db_oid, class_oid, class_kind] : classes) {
+      if (class_kind == catalog::postgres::ClassKind::REGULAR_TABLE) {
+        tables[db_oid][catalog::table_oid_t(class_oid)] = RecreateTable(txn, db_oid, catalog::table_oid_t(class_oid));
+      }
+    }
+  } catch (...) {
+    // Do not leave the oldest running txn behind, or the GC stops collecting anything from here on
+    txn_manager_->Abort(txn);
+    throw;
+  }
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Step 3: Load the user tables. Sections are independent of each other, so they are read here and inserted in
+  // parallel, each in its own transaction. Indexes on user tables are built afterwards in bulk.
+  common::WorkerPool thread_pool(std::max(1U, std::thread::hardware_concurrency()), {});
+  thread_pool.Startup();
+  std::mutex tuple_slot_map_latch;
+  try {
+    for (; section != nullptr; section = CheckpointSection::Read(fd)) {
+      TERRIER_ASSERT(tables[section->DatabaseOid()].count(section->TableOid()) > 0,
+                     "Checkpointed user table should have an entry in pg_class");
+      SqlTable *const sql_table = tables[section->DatabaseOid()][section->TableOid()];
+      std::shared_ptr<CheckpointSection> user_section(std::move(section));
+      thread_pool.SubmitTask([this, sql_table, user_section, &tuple_slot_map_latch] {
+        auto *load_txn = txn_manager_->BeginTransaction();
+        auto pr_init = sql_table->InitializerForProjectedRow(user_section->ColumnOids());
+        auto pr_map = sql_table->ProjectionMapForOids(user_section->ColumnOids());
+        std::vector<std::pair<TupleSlot, TupleSlot>> slots;
+        slots.reserve(user_section->NumTuples());
+        for (uint32_t row = 0; row < user_section->NumTuples(); row++) {
+          auto *redo = load_txn->StageWrite(user_section->DatabaseOid(), user_section->TableOid(), pr_init);
+          user_section->CopyToRow(row, redo->Delta(), pr_map);
+          slots.emplace_back(user_section->OriginalTupleSlot(row),
+                             sql_table->Insert(common::ManagedPointer(load_txn), redo));
+        }
+        txn_manager_->Commit(load_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+        std::lock_guard<std::mutex> guard(tuple_slot_map_latch);
+        tuple_slot_map_.insert(slots.begin(), slots.end());
+      });
+    }
+  } catch (...) {
+    // Loads that were already handed out use the latch on this stack, so they have to finish before it unwinds
+    thread_pool.WaitUntilAllFinished();
+    thread_pool.Shutdown();
+    throw;
+  }
+  thread_pool.WaitUntilAllFinished();
+  thread_pool.Shutdown();
+
+  // Step 4: Recreate the indexes. Indexes on catalog tables were maintained while loading, the rest are built now.
+  txn = txn_manager_->BeginTransaction();
+  try {
+    for (const auto &[db_oid, class_oid, class_kind] : classes) {
+      if (class_kind == catalog::postgres::ClassKind::INDEX) {
+        RecreateIndex(txn, db_oid, catalog::index_oid_t(class_oid));
+      }
+    }
+  } catch (...) {
+    txn_manager_->Abort(txn);
+    throw;
+  }
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  return checkpoint_ts;
+}
+
 void RecoveryManager::ProcessCommittedTransaction(terrier::transaction::timestamp_t txn_id) {
   // Begin a txn to replay changes with.
   auto *txn = txn_manager_->BeginTransaction();
@@ -103,6 +399,238 @@ void RecoveryManager::ProcessCommittedTransaction(terrier::transaction::timestam
   txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
 }
 
+void RecoveryManager::ReplayCommittedTransaction(const transaction::timestamp_t txn_id) {
+  if (replay_pool_ == nullptr) {
+    ProcessCommittedTransaction(txn_id);
+    return;
+  }
+  // Catalog changes are replayed serially, as they may change what later transactions replay into
+  const auto &changes = buffered_changes_map_[txn_id];
+  const bool changes_catalog = std::any_of(changes.begin(), changes.end(), [](const auto &change) {
+    const auto table_oid = change.first->RecordType() == LogRecordType::REDO
+                               ? change.first->template GetUnderlyingRecordBodyAs<RedoRecord>()->GetTableOid()
+                               : change.first->template GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTableOid();
+    return (!table_oid) < catalog::START_OID;
+  });
+  if (changes_catalog) {
+    WaitForDispatchedTransactions();
+    ProcessCommittedTransaction(txn_id);
+    // The catalog may have changed what a table oid refers to
+    replay_targets_.clear();
+    return;
+  }
+  DispatchCommittedTransaction(txn_id);
+}
+
+void RecoveryManager::DispatchCommittedTransaction(const transaction::timestamp_t txn_id) {
+  {
+    // Don't let buffered records pile up if decoding is faster than replay
+    std::unique_lock<std::mutex> lock(dispatched_txns_latch_);
+    dispatched_txns_cv_.wait(lock, [&] { return num_dispatched_txns_ < MAX_DISPATCHED_TXNS; });
+    num_dispatched_txns_++;
+  }
+
+  auto *dispatched = new DispatchedTransaction;
+  dispatched->changes_ = std::move(buffered_changes_map_[txn_id]);
+  buffered_changes_map_.erase(txn_id);
+
+  // Split the changes by partition, keeping their order within each partition
+  std::unordered_map<uint32_t, ReplayPiece> pieces;
+  for (const auto &change : dispatched->changes_) {
+    auto *record = change.first;
+    catalog::db_oid_t db_oid;
+    catalog::table_oid_t table_oid;
+    if (record->RecordType() == LogRecordType::REDO) {
+      db_oid = record->GetUnderlyingRecordBodyAs<RedoRecord>()->GetDatabaseOid();
+      table_oid = record->GetUnderlyingRecordBodyAs<RedoRecord>()->GetTableOid();
+    } else {
+      db_oid = record->GetUnderlyingRecordBodyAs<DeleteRecord>()->GetDatabaseOid();
+      table_oid = record->GetUnderlyingRecordBodyAs<DeleteRecord>()->GetTableOid();
+    }
+    auto &piece = pieces[ReplayPartitionIndex(db_oid, table_oid, static_cast<uint32_t>(replay_partitions_.size()))];
+    piece.txn_ = dispatched;
+    piece.records_.emplace_back(record, GetReplayTarget(db_oid, table_oid));
+  }
+
+  if (pieces.empty()) {
+    // Nothing to replay, the transaction is done
+    deferred_action_manager_->RegisterDeferredAction([=] { delete dispatched; });
+    std::unique_lock<std::mutex> lock(dispatched_txns_latch_);
+    num_dispatched_txns_--;
+    return;
+  }
+
+  dispatched->remaining_pieces_ = static_cast<uint32_t>(pieces.size());
+  for (auto &entry : pieces) {
+    ReplayPartition *const partition = &replay_partitions_[entry.first];
+    bool schedule;
+    {
+      std::unique_lock<std::mutex> lock(partition->latch_);
+      partition->pending_.push(std::move(entry.second));
+      schedule = !partition->scheduled_;
+      partition->scheduled_ = true;
+    }
+    // Only one task at a time replays a partition, which keeps its pieces in commit order
+    if (schedule) replay_pool_->SubmitTask([this, partition] { ReplayPartitionPieces(partition); });
+  }
+}
+
+void RecoveryManager::ReplayPartitionPieces(ReplayPartition *const partition) {
+  while (true) {
+    ReplayPiece piece;
+    {
+      std::unique_lock<std::mutex> lock(partition->latch_);
+      if (partition->pending_.empty()) {
+        partition->scheduled_ = false;
+        return;
+      }
+      piece = std::move(partition->pending_.front());
+      partition->pending_.pop();
+    }
+    ReplayPartitionPiece(partition, piece);
+
+    if (--piece.txn_->remaining_pieces_ == 0) {
+      // The last partition to finish cleans up the transaction's records, like ProcessCommittedTransaction does
+      DispatchedTransaction *const dispatched = piece.txn_;
+      deferred_action_manager_->RegisterDeferredAction([=] {
+        for (auto &buffered_pair : dispatched->changes_) delete[] reinterpret_cast<byte *>(buffered_pair.first);
+        delete dispatched;
+      });
+      {
+        std::unique_lock<std::mutex> lock(dispatched_txns_latch_);
+        num_dispatched_txns_--;
+      }
+      dispatched_txns_cv_.notify_all();
+    }
+  }
+}
+
+void RecoveryManager::ReplayPartitionPiece(ReplayPartition *const partition, const ReplayPiece &piece) {
+  // Mappings are only changed by the partition that owns the table, so the shared map is read-only until the barrier
+  auto lookup_slot = [&](const TupleSlot old_slot, TupleSlot *const new_slot) {
+    auto inserted = partition->inserted_slots_.find(old_slot);
+    if (inserted != partition->inserted_slots_.end()) {
+      *new_slot = inserted->second;
+      return true;
+    }
+    if (partition->deleted_slots_.count(old_slot) > 0) return false;
+    auto shared = tuple_slot_map_.find(old_slot);
+    if (shared == tuple_slot_map_.end()) return false;
+    *new_slot = shared->second;
+    return true;
+  };
+
+  // Index changes in the order they happened. Deleted rows are copied out of the table before the delete.
+  struct IndexChange {
+    const ReplayTarget *target_;
+    TupleSlot slot_;
+    const ProjectedRow *row_;
+    byte *buffer_;
+    bool insert_;
+  };
+  std::vector<IndexChange> index_changes;
+
+  auto *txn = txn_manager_->BeginTransaction();
+  for (const auto &[record, target] : piece.records_) {
+    if (record->RecordType() == LogRecordType::REDO) {
+      auto *redo_record = record->GetUnderlyingRecordBodyAs<RedoRecord>();
+      const TupleSlot old_tuple_slot = redo_record->GetTupleSlot();
+      TupleSlot new_tuple_slot;
+      if (!lookup_slot(old_tuple_slot, &new_tuple_slot)) {
+        redo_record->SetTupleSlot(TupleSlot(nullptr, 0));
+        auto *staged_record = txn->StageRecoveryWrite(record);
+        new_tuple_slot = target->table_->Insert(common::ManagedPointer(txn), staged_record);
+        partition->inserted_slots_[old_tuple_slot] = new_tuple_slot;
+        // The log record stays alive until the transaction is cleaned up, unlike the staged one
+        if (!target->indexes_.empty()) {
+          index_changes.push_back({target, new_tuple_slot, redo_record->Delta(), nullptr, true});
+        }
+      } else {
+        redo_record->SetTupleSlot(new_tuple_slot);
+        auto *staged_record = txn->StageRecoveryWrite(record);
+        bool result UNUSED_ATTRIBUTE = target->table_->Update(common::ManagedPointer(txn), staged_record);
+        TERRIER_ASSERT(result, "Buffered changes should always succeed during commit");
+      }
+      continue;
+    }
+
+    auto *delete_record = record->GetUnderlyingRecordBodyAs<DeleteRecord>();
+    TupleSlot new_tuple_slot;
+    bool found UNUSED_ATTRIBUTE = lookup_slot(delete_record->GetTupleSlot(), &new_tuple_slot);
+    TERRIER_ASSERT(found, "No tuple slot mapping exists");
+    txn->StageDelete(delete_record->GetDatabaseOid(), delete_record->GetTableOid(), new_tuple_slot);
+    if (!target->indexes_.empty()) {
+      auto *buffer = common::AllocationUtil::AllocateAligned(target->row_initializer_.ProjectedRowSize());
+      auto *pr = target->row_initializer_.InitializeRow(buffer);
+      target->table_->Select(common::ManagedPointer(txn), new_tuple_slot, pr);
+      index_changes.push_back({target, new_tuple_slot, pr, buffer, false});
+    }
+    bool result UNUSED_ATTRIBUTE = target->table_->Delete(common::ManagedPointer(txn), new_tuple_slot);
+    TERRIER_ASSERT(result, "Buffered changes should always succeed during commit");
+    partition->inserted_slots_.erase(delete_record->GetTupleSlot());
+    partition->deleted_slots_.insert(delete_record->GetTupleSlot());
+  }
+
+  // Apply the index changes a table and an index at a time, reusing one key buffer per index
+  std::stable_sort(index_changes.begin(), index_changes.end(),
+                   [](const IndexChange &a, const IndexChange &b) { return a.target_ < b.target_; });
+  for (auto begin = index_changes.begin(); begin != index_changes.end();) {
+    const ReplayTarget *target = begin->target_;
+    auto end = std::find_if(begin, index_changes.end(), [=](const IndexChange &c) { return c.target_ != target; });
+    for (const auto &[index, schema] : target->indexes_) {
+      const auto &key_initializer = index->GetProjectedRowInitializer();
+      auto *key_buffer = common::AllocationUtil::AllocateAligned(key_initializer.ProjectedRowSize());
+      auto *key = key_initializer.InitializeRow(key_buffer);
+      const bool unique = index->metadata_.GetSchema().Unique();
+      for (auto change = begin; change != end; change++) {
+        BuildIndexKey(index, schema, *change->row_, target->row_map_, key);
+        if (change->insert_) {
+          bool result UNUSED_ATTRIBUTE = unique ? index->InsertUnique(common::ManagedPointer(txn), *key, change->slot_)
+                                                : index->Insert(common::ManagedPointer(txn), *key, change->slot_);
+          TERRIER_ASSERT(result, "Insert into index should always succeed for a committed transaction");
+        } else {
+          index->Delete(common::ManagedPointer(txn), *key, change->slot_);
+        }
+      }
+      delete[] key_buffer;
+    }
+    begin = end;
+  }
+  for (const auto &change : index_changes) delete[] change.buffer_;
+
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
+void RecoveryManager::WaitForDispatchedTransactions() {
+  {
+    std::unique_lock<std::mutex> lock(dispatched_txns_latch_);
+    dispatched_txns_cv_.wait(lock, [&] { return num_dispatched_txns_ == 0; });
+  }
+  for (auto &partition : replay_partitions_) {
+    for (const auto &slot : partition.deleted_slots_) tuple_slot_map_.erase(slot);
+    for (const auto &mapping : partition.inserted_slots_) tuple_slot_map_[mapping.first] = mapping.second;
+    partition.deleted_slots_.clear();
+    partition.inserted_slots_.clear();
+  }
+}
+
+const RecoveryManager::ReplayTarget *RecoveryManager::GetReplayTarget(const catalog::db_oid_t db_oid,
+                                                                      const catalog::table_oid_t table_oid) {
+  auto &target = replay_targets_[db_oid][table_oid];
+  if (target != nullptr) return target.get();
+
+  // Look up everything replay needs once, as workers can't take the catalog's DDL lock concurrently
+  auto *txn = txn_manager_->BeginTransaction();
+  auto db_catalog = GetDatabaseCatalog(txn, db_oid);
+  std::vector<catalog::col_oid_t> all_table_oids;
+  for (const auto &col : GetTableSchema(txn, db_catalog, table_oid).GetColumns()) all_table_oids.push_back(col.Oid());
+  target = std::make_unique<ReplayTarget>(GetSqlTable(txn, db_oid, table_oid),
+                                          db_catalog->GetIndexes(common::ManagedPointer(txn), table_oid),
+                                          all_table_oids);
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  return target.get();
+}
+
 void RecoveryManager::DeferRecordDeletes(terrier::transaction::timestamp_t txn_id, bool delete_varlens) {
   // Capture the changes by value except for changes which we can move
   deferred_action_manager_->RegisterDeferredAction([=, buffered_changes{std::move(buffered_changes_map_[txn_id])}]() {
@@ -126,7 +654,7 @@ uint32_t RecoveryManager::ProcessDeferredTransactions(terrier::transaction::time
   auto upper_bound_it = deferred_txns_.upper_bound(upper_bound_ts);
 
   for (auto it = deferred_txns_.begin(); it != upper_bound_it; it++) {
-    ProcessCommittedTransaction(*it);
+    ReplayCommittedTransaction(*it);
     txns_processed++;
   }
 
@@ -318,31 +846,13 @@ void RecoveryManager::UpdateIndexesOnTable(transaction::TransactionContext *txn,
   auto pr_map = table_ptr->ProjectionMapForOids(all_table_oids);
   TERRIER_ASSERT(pr_map.size() == table_pr->NumColumns(), "Projected row should contain all attributes");
 
-  // TODO(Gus): We are going to assume no indexes on expressions below. Having indexes on expressions would require to
-  // evaluate expressions and that's a nightmare
   for (const auto &index_obj : index_objects) {
     auto index = index_obj.first;
     const auto &schema = index_obj.second;
-    const auto &indexed_attributes = schema.GetIndexedColOids();
 
     // Build the index PR
     auto *index_pr = index->GetProjectedRowInitializer().InitializeRow(index_buffer);
-
-    // Copy in each value from the table PR into the index PR
-    auto num_index_cols = schema.GetColumns().size();
-    TERRIER_ASSERT(num_index_cols == indexed_attributes.size(), "Only support index keys that are a single column oid");
-    for (uint32_t col_idx = 0; col_idx < num_index_cols; col_idx++) {
-      const auto &col = schema.GetColumn(col_idx);
-      auto index_col_oid = col.Oid();
-      const catalog::col_oid_t &table_col_oid = indexed_attributes[col_idx];
-      if (table_pr->IsNull(pr_map[table_col_oid])) {
-        index_pr->SetNull(index->GetKeyOidToOffsetMap().at(index_col_oid));
-      } else {
-        auto size = AttrSizeBytes(col.AttrSize());
-        std::memcpy(index_pr->AccessForceNotNull(index->GetKeyOidToOffsetMap().at(index_col_oid)),
-                    table_pr->AccessWithNullCheck(pr_map[table_col_oid]), size);
-      }
-    }
+    BuildIndexKey(index, schema, *table_pr, pr_map, index_pr);
 
     if (insert) {
       bool result UNUSED_ATTRIBUTE = (index->metadata_.GetSchema().Unique())
@@ -357,6 +867,30 @@ void RecoveryManager::UpdateIndexesOnTable(transaction::TransactionContext *txn,
   delete[] index_buffer;
 }
 
+void RecoveryManager::BuildIndexKey(const common::ManagedPointer<index::Index> index,
+                                    const catalog::IndexSchema &schema, const ProjectedRow &table_pr,
+                                    const ProjectionMap &pr_map, ProjectedRow *const index_pr) {
+  // TODO(Gus): We are going to assume no indexes on expressions below. Having indexes on expressions would require to
+  // evaluate expressions and that's a nightmare
+  const auto &indexed_attributes = schema.GetIndexedColOids();
+
+  // Copy in each value from the table PR into the index PR
+  auto num_index_cols = schema.GetColumns().size();
+  TERRIER_ASSERT(num_index_cols == indexed_attributes.size(), "Only support index keys that are a single column oid");
+  for (uint32_t col_idx = 0; col_idx < num_index_cols; col_idx++) {
+    const auto &col = schema.GetColumn(col_idx);
+    auto index_col_oid = col.Oid();
+    const catalog::col_oid_t &table_col_oid = indexed_attributes[col_idx];
+    if (table_pr.IsNull(pr_map.at(table_col_oid))) {
+      index_pr->SetNull(index->GetKeyOidToOffsetMap().at(index_col_oid));
+    } else {
+      auto size = AttrSizeBytes(col.AttrSize());
+      std::memcpy(index_pr->AccessForceNotNull(index->GetKeyOidToOffsetMap().at(index_col_oid)),
+                  table_pr.AccessWithNullCheck(pr_map.at(table_col_oid)), size);
+    }
+  }
+}
+
 uint32_t RecoveryManager::ProcessSpecialCaseCatalogRecord(
     transaction::TransactionContext *txn, std::vector<std::pair<LogRecord *, std::vector<byte *>>> *buffered_changes,
     uint32_t start_idx) {
@@ -432,25 +966,8 @@ uint32_t RecoveryManager::ProcessSpecialCasePGDatabaseRecord(
         redo_record->Delta()->AccessWithNullCheck(pr_map[catalog::postgres::DATNAME_COL_OID])));
     std::string name_string(name_varlen.StringView());
 
-    // Step 2: Recreate the database
-    auto result UNUSED_ATTRIBUTE = catalog_->CreateDatabase(common::ManagedPointer(txn), name_string, false, db_oid);
-    TERRIER_ASSERT(result, "Database recreation should succeed");
-    catalog_->UpdateNextOid(db_oid);
-    // Manually bootstrap the PRIs
-    catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid)->BootstrapPRIs();
-
-    // Step 3: Update metadata. We need to use the indexes on pg_database to find what tuple slot we just inserted into.
-    // We get the new tuple slot using the oid index.
-    auto pg_database_oid_index = catalog_->databases_oid_index_;
-    auto pr_init = pg_database_oid_index->GetProjectedRowInitializer();
-    auto *buffer = common::AllocationUtil::AllocateAligned(pr_init.ProjectedRowSize());
-    auto *pr = pr_init.InitializeRow(buffer);
-    *(reinterpret_cast<catalog::db_oid_t *>(pr->AccessForceNotNull(0))) = db_oid;
-    std::vector<TupleSlot> tuple_slot_result;
-    pg_database_oid_index->ScanKey(*txn, *pr, &tuple_slot_result);
-    TERRIER_ASSERT(tuple_slot_result.size() == 1, "Index scan should only yield one result");
-    tuple_slot_map_[redo_record->GetTupleSlot()] = tuple_slot_result[0];
-    delete[] buffer;
+    // Step 2: Recreate the database and update metadata
+    tuple_slot_map_[redo_record->GetTupleSlot()] = RecreateDatabase(txn, db_oid, name_string);
 
     return 0;  // No additional records processed
   }
@@ -584,98 +1101,18 @@ uint32_t RecoveryManager::ProcessSpecialCasePGClassRecord(
         auto class_kind = *(reinterpret_cast<catalog::postgres::ClassKind *>(
             pr->AccessWithNullCheck(pr_map[catalog::postgres::RELKIND_COL_OID])));
 
+        delete[] buffer;
+
+        // Step 2: Recreate the object
         switch (class_kind) {
           case (catalog::postgres::ClassKind::REGULAR_TABLE): {
-            // Step 2: Query pg_attribute for the columns of the table
-            auto schema_cols =
-                db_catalog->GetColumns<catalog::Schema::Column, catalog::table_oid_t, catalog::col_oid_t>(
-                    common::ManagedPointer(txn), catalog::table_oid_t(class_oid));
-
-            // Step 3: Create and set schema in catalog
-            auto *schema = new catalog::Schema(std::move(schema_cols));
-            bool result UNUSED_ATTRIBUTE =
-                db_catalog->SetTableSchemaPointer(common::ManagedPointer(txn), catalog::table_oid_t(class_oid), schema);
-            TERRIER_ASSERT(result, "Setting table schema pointer should succeed, entry should be in pg_class already");
-
-            // Step 4: Create and set table pointers in catalog
-            storage::SqlTable *sql_table;
-            if (class_oid < catalog::START_OID) {  // All catalog tables/indexes have OIDS less than START_OID
-              // Use of the -> operator is ok here, since we are the ones who wrapped the table with the ManagedPointer
-              sql_table = GetSqlTable(txn, redo_record->GetDatabaseOid(), catalog::table_oid_t(class_oid)).operator->();
-            } else {
-              sql_table = new SqlTable(block_store_, *schema);
-            }
-            result =
-                db_catalog->SetTablePointer(common::ManagedPointer(txn), catalog::table_oid_t(class_oid), sql_table);
-            TERRIER_ASSERT(result, "Setting table pointer should succeed, entry should be in pg_class already");
-
-            // Step 5: Update catalog oid
-            db_catalog->UpdateNextOid(class_oid);
-
-            delete[] buffer;
+            RecreateTable(txn, redo_record->GetDatabaseOid(), catalog::table_oid_t(class_oid));
             return 0;  // No additional records processed
           }
 
           case (catalog::postgres::ClassKind::INDEX): {
-            // Step 2: Query pg_attribute for the columns of the index
-            auto index_cols =
-                db_catalog->GetColumns<catalog::IndexSchema::Column, catalog::index_oid_t, catalog::indexkeycol_oid_t>(
-                    common::ManagedPointer(txn), catalog::index_oid_t(class_oid));
-
-            // Step 3: Query pg_index for the metadata we need for the index schema
-            auto pg_indexes_index = db_catalog->indexes_oid_index_;
-            pr = pg_indexes_index->GetProjectedRowInitializer().InitializeRow(buffer);
-            *(reinterpret_cast<uint32_t *>(pr->AccessForceNotNull(0))) = class_oid;
-            std::vector<TupleSlot> tuple_slot_result;
-            pg_indexes_index->ScanKey(*txn, *pr, &tuple_slot_result);
-            TERRIER_ASSERT(tuple_slot_result.size() == 1, "Index scan should yield one result");
-
-            // NOLINTNEXTLINE
-            col_oids.clear();
-            col_oids = {catalog::postgres::INDISUNIQUE_COL_OID, catalog::postgres::INDISPRIMARY_COL_OID,
-                        catalog::postgres::INDISEXCLUSION_COL_OID, catalog::postgres::INDIMMEDIATE_COL_OID,
-                        catalog::postgres::IND_TYPE_COL_OID};
-            auto pg_index_pr_init = db_catalog->indexes_->InitializerForProjectedRow(col_oids);
-            auto pg_index_pr_map = db_catalog->indexes_->ProjectionMapForOids(col_oids);
-            delete[] buffer;  // Delete old buffer, it won't be large enough for this PR
-            buffer = common::AllocationUtil::AllocateAligned(pg_index_pr_init.ProjectedRowSize());
-            pr = pg_index_pr_init.InitializeRow(buffer);
-            bool result UNUSED_ATTRIBUTE =
-                db_catalog->indexes_->Select(common::ManagedPointer(txn), tuple_slot_result[0], pr);
-            TERRIER_ASSERT(result, "Select into pg_index should succeed during recovery");
-            bool is_unique = *(reinterpret_cast<bool *>(
-                pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISUNIQUE_COL_OID])));
-            bool is_primary = *(reinterpret_cast<bool *>(
-                pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISPRIMARY_COL_OID])));
-            bool is_exclusion = *(reinterpret_cast<bool *>(
-                pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISEXCLUSION_COL_OID])));
-            bool is_immediate = *(reinterpret_cast<bool *>(
-                pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDIMMEDIATE_COL_OID])));
-            storage::index::IndexType index_type = *(reinterpret_cast<storage::index::IndexType *>(
-                pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::IND_TYPE_COL_OID])));
-
-            // Step 4: Create and set IndexSchema in catalog
-            auto *index_schema =
-                new catalog::IndexSchema(index_cols, index_type, is_unique, is_primary, is_exclusion, is_immediate);
-            result = db_catalog->SetIndexSchemaPointer(common::ManagedPointer(txn), catalog::index_oid_t(class_oid),
-                                                       index_schema);
-            TERRIER_ASSERT(result, "Setting index schema pointer should succeed, entry should be in pg_class already");
-
-            // Step 5: Create and set index pointer in catalog
-            storage::index::Index *index;
-            if (class_oid < catalog::START_OID) {  // All catalog tables/indexes have OIDS less than START_OID
-              index = GetCatalogIndex(catalog::index_oid_t(class_oid), db_catalog);
-            } else {
-              index = index::IndexBuilder().SetKeySchema(*index_schema).Build();
-            }
-            result = db_catalog->SetIndexPointer(common::ManagedPointer(txn), catalog::index_oid_t(class_oid), index);
-            TERRIER_ASSERT(result, "Setting index pointer should succeed, entry should be in pg_class already");
-
-            // Step 6: Update catalog oid
-            db_catalog->UpdateNextOid(class_oid);
-
-            delete[] buffer;
-            return 0;
+            RecreateIndex(txn, redo_record->GetDatabaseOid(), catalog::index_oid_t(class_oid));
+            return 0;  // No additional records processed
           }
 
           default:
@@ -794,6 +1231,128 @@ uint32_t RecoveryManager::ProcessSpecialCasePGClassRecord(
   return 0;  // No additional logs processed
 }
 
+TupleSlot RecoveryManager::RecreateDatabase(transaction::TransactionContext *txn, const catalog::db_oid_t db_oid,
+                                            const std::string &name) {
+  // Step 1: Recreate the database
+  auto result UNUSED_ATTRIBUTE = catalog_->CreateDatabase(common::ManagedPointer(txn), name, false, db_oid);
+  TERRIER_ASSERT(result, "Database recreation should succeed");
+  catalog_->UpdateNextOid(db_oid);
+  // Manually bootstrap the PRIs
+  catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid)->BootstrapPRIs();
+
+  // Step 2: We need to use the indexes on pg_database to find what tuple slot we just inserted into. We get the new
+  // tuple slot using the oid index.
+  auto pg_database_oid_index = catalog_->databases_oid_index_;
+  auto pr_init = pg_database_oid_index->GetProjectedRowInitializer();
+  auto *buffer = common::AllocationUtil::AllocateAligned(pr_init.ProjectedRowSize());
+  auto *pr = pr_init.InitializeRow(buffer);
+  *(reinterpret_cast<catalog::db_oid_t *>(pr->AccessForceNotNull(0))) = db_oid;
+  std::vector<TupleSlot> tuple_slot_result;
+  pg_database_oid_index->ScanKey(*txn, *pr, &tuple_slot_result);
+  TERRIER_ASSERT(tuple_slot_result.size() == 1, "Index scan should only yield one result");
+  delete[] buffer;
+  return tuple_slot_result[0];
+}
+
+SqlTable *RecoveryManager::RecreateTable(transaction::TransactionContext *txn, const catalog::db_oid_t db_oid,
+                                         const catalog::table_oid_t table_oid) {
+  auto db_catalog = GetDatabaseCatalog(txn, db_oid);
+
+  // Step 1: Query pg_attribute for the columns of the table
+  auto schema_cols = db_catalog->GetColumns<catalog::Schema::Column, catalog::table_oid_t, catalog::col_oid_t>(
+      common::ManagedPointer(txn), table_oid);
+
+  // Step 2: Create and set schema in catalog
+  auto *schema = new catalog::Schema(std::move(schema_cols));
+  bool result UNUSED_ATTRIBUTE = db_catalog->SetTableSchemaPointer(common::ManagedPointer(txn), table_oid, schema);
+  TERRIER_ASSERT(result, "Setting table schema pointer should succeed, entry should be in pg_class already");
+
+  // Step 3: Create and set table pointers in catalog
+  storage::SqlTable *sql_table;
+  if ((!table_oid) < catalog::START_OID) {  // All catalog tables/indexes have OIDS less than START_OID
+    // Use of the -> operator is ok here, since we are the ones who wrapped the table with the ManagedPointer
+    sql_table = GetSqlTable(txn, db_oid, table_oid).operator->();
+  } else {
+    sql_table = new SqlTable(block_store_, *schema);
+  }
+  result = db_catalog->SetTablePointer(common::ManagedPointer(txn), table_oid, sql_table);
+  TERRIER_ASSERT(result, "Setting table pointer should succeed, entry should be in pg_class already");
+
+  // Step 4: Update catalog oid
+  db_catalog->UpdateNextOid(!table_oid);
+  return sql_table;
+}
+
+void RecoveryManager::RecreateIndex(transaction::TransactionContext *txn, const catalog::db_oid_t db_oid,
+                                    const catalog::index_oid_t index_oid) {
+  auto db_catalog = GetDatabaseCatalog(txn, db_oid);
+
+  // Step 1: Query pg_attribute for the columns of the index
+  auto index_cols =
+      db_catalog->GetColumns<catalog::IndexSchema::Column, catalog::index_oid_t, catalog::indexkeycol_oid_t>(
+          common::ManagedPointer(txn), index_oid);
+
+  // Step 2: Query pg_index for the metadata we need for the index schema
+  auto pg_indexes_index = db_catalog->indexes_oid_index_;
+  auto index_pr_init = pg_indexes_index->GetProjectedRowInitializer();
+  auto *buffer = common::AllocationUtil::AllocateAligned(index_pr_init.ProjectedRowSize());
+  auto *pr = index_pr_init.InitializeRow(buffer);
+  *(reinterpret_cast<catalog::index_oid_t *>(pr->AccessForceNotNull(0))) = index_oid;
+  std::vector<TupleSlot> tuple_slot_result;
+  pg_indexes_index->ScanKey(*txn, *pr, &tuple_slot_result);
+  TERRIER_ASSERT(tuple_slot_result.size() == 1, "Index scan should yield one result");
+  delete[] buffer;
+
+  std::vector<catalog::col_oid_t> col_oids = {
+      catalog::postgres::INDRELID_COL_OID,      catalog::postgres::INDISUNIQUE_COL_OID,
+      catalog::postgres::INDISPRIMARY_COL_OID,  catalog::postgres::INDISEXCLUSION_COL_OID,
+      catalog::postgres::INDIMMEDIATE_COL_OID, catalog::postgres::IND_TYPE_COL_OID};
+  auto pg_index_pr_init = db_catalog->indexes_->InitializerForProjectedRow(col_oids);
+  auto pg_index_pr_map = db_catalog->indexes_->ProjectionMapForOids(col_oids);
+  buffer = common::AllocationUtil::AllocateAligned(pg_index_pr_init.ProjectedRowSize());
+  pr = pg_index_pr_init.InitializeRow(buffer);
+  bool result UNUSED_ATTRIBUTE = db_catalog->indexes_->Select(common::ManagedPointer(txn), tuple_slot_result[0], pr);
+  TERRIER_ASSERT(result, "Select into pg_index should succeed during recovery");
+  auto table_oid = *(reinterpret_cast<catalog::table_oid_t *>(
+      pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDRELID_COL_OID])));
+  bool is_unique =
+      *(reinterpret_cast<bool *>(pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISUNIQUE_COL_OID])));
+  bool is_primary =
+      *(reinterpret_cast<bool *>(pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISPRIMARY_COL_OID])));
+  bool is_exclusion = *(
+      reinterpret_cast<bool *>(pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDISEXCLUSION_COL_OID])));
+  bool is_immediate = *(
+      reinterpret_cast<bool *>(pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::INDIMMEDIATE_COL_OID])));
+  storage::index::IndexType index_type = *(reinterpret_cast<storage::index::IndexType *>(
+      pr->AccessWithNullCheck(pg_index_pr_map[catalog::postgres::IND_TYPE_COL_OID])));
+  delete[] buffer;
+
+  // Step 3: Create and set IndexSchema in catalog
+  auto *index_schema =
+      new catalog::IndexSchema(index_cols, index_type, is_unique, is_primary, is_exclusion, is_immediate);
+  result = db_catalog->SetIndexSchemaPointer(common::ManagedPointer(txn), index_oid, index_schema);
+  TERRIER_ASSERT(result, "Setting index schema pointer should succeed, entry should be in pg_class already");
+
+  // Step 4: Create and set index pointer in catalog
+  storage::index::Index *index;
+  if ((!index_oid) < catalog::START_OID) {  // All catalog tables/indexes have OIDS less than START_OID
+    index = GetCatalogIndex(index_oid, db_catalog);
+  } else {
+    // Rebuild the index from the tuples that were already replayed into its table. Tuples replayed from here on are
+    // added to the index by UpdateIndexesOnTable.
+    index::IndexBuilder index_builder;
+    index_builder.SetKeySchema(*index_schema);
+    index = index_builder.Build();
+    result = index_builder.BulkInsert(index, GetSqlTable(txn, db_oid, table_oid), common::ManagedPointer(txn));
+    TERRIER_ASSERT(result, "Rebuilding an index should always succeed for a committed transaction");
+  }
+  result = db_catalog->SetIndexPointer(common::ManagedPointer(txn), index_oid, index);
+  TERRIER_ASSERT(result, "Setting index pointer should succeed, entry should be in pg_class already");
+
+  // Step 5: Update catalog oid
+  db_catalog->UpdateNextOid(!index_oid);
+}
+
 common::ManagedPointer<storage::SqlTable> RecoveryManager::GetSqlTable(transaction::TransactionContext *txn,
                                                                        const catalog::db_oid_t db_oid,
                                                                        const catalog::table_oid_t table_oid) {
@@ -27,6 +27,7 @@ void TupleAccessStrategy::InitializeRawBlock(storage::DataTable *const data_tabl
   raw->data_table_ = data_table;
   raw->layout_version_ = layout_version;
   raw->insert_head_ = 0;
+  raw->num_versioned_slots_ = 0;
   raw->controller_.Initialize();
   auto *result = reinterpret_cast<TupleAccessStrategy::Block *>(raw);
   result->GetArrowBlockMetadata().Initialize(GetBlockLayout().NumColumns());
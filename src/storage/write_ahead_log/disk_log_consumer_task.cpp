@@ -1,11 +1,20 @@
 #include "storage/write_ahead_log/disk_log_consumer_task.h"
 
+#include <algorithm>
+
 #include "common/scoped_timer.h"
 #include "common/thread_context.h"
 #include "metrics/metrics_store.h"
 
 namespace terrier::storage {
 
+namespace {
+// Weight of the newest sample in the moving averages used to adapt the persist interval
+constexpr double ADAPTATION_WEIGHT = 0.125;
+// Commits expected to arrive during a persist for waiting on them to be worthwhile
+constexpr double MIN_GROUP_SIZE = 2.0;
+}  // namespace
+
 void DiskLogConsumerTask::RunTask() {
   run_task_ = true;
   DiskLogConsumerTaskLoop();
@@ -40,12 +49,10 @@ void DiskLogConsumerTask::WriteBuffersToLogFile() {
 }
 
 uint64_t DiskLogConsumerTask::PersistLogFile() {
-  // buffers_ may be empty but we have callbacks to invoke due to read-only txns
-  if (!buffers_->empty()) {
-    // Force the buffers to be written to disk. Because all buffers log to the same file, it suffices to call persist on
-    // any buffer.
-    buffers_->front().Persist();
-  }
+  // Force the buffers to be written to disk. Nothing may have been written, but we have callbacks to invoke due to
+  // read-only txns. A callback may belong to a transaction that depends on one in another stream, so every stream is
+  // persisted before any callback is invoked.
+  for (auto *const log_file : log_files_) log_file->Persist();
   const auto num_buffers = commit_callbacks_.size();
   // Execute the callbacks for the transactions that have been persisted
   for (auto &callback : commit_callbacks_) callback.first(callback.second);
@@ -53,6 +60,27 @@ uint64_t DiskLogConsumerTask::PersistLogFile() {
   return num_buffers;
 }
 
+void DiskLogConsumerTask::AdaptPersistInterval(const std::chrono::microseconds since_last_persist,
+                                               const uint64_t persist_us, const uint64_t num_commits,
+                                               const uint64_t num_bytes) {
+  const auto elapsed_us = static_cast<double>(std::max<int64_t>(since_last_persist.count(), 1));
+  avg_persist_us_ += ADAPTATION_WEIGHT * (static_cast<double>(persist_us) - avg_persist_us_);
+  avg_commits_per_us_ += ADAPTATION_WEIGHT * (static_cast<double>(num_commits) / elapsed_us - avg_commits_per_us_);
+  avg_bytes_per_us_ += ADAPTATION_WEIGHT * (static_cast<double>(num_bytes) / elapsed_us - avg_bytes_per_us_);
+
+  if (avg_commits_per_us_ * avg_persist_us_ < MIN_GROUP_SIZE) {
+    // Nobody would share the persist, so waiting only adds latency
+    persist_interval_ = max_persist_interval_;
+    persist_threshold_ = 0;
+    return;
+  }
+  persist_interval_ = std::clamp(std::chrono::microseconds(static_cast<int64_t>(avg_persist_us_)),
+                                 std::chrono::microseconds(1), max_persist_interval_);
+  persist_threshold_ = std::clamp(static_cast<uint64_t>(avg_bytes_per_us_ * avg_persist_us_),
+                                  std::min<uint64_t>(common::Constants::LOG_BUFFER_SIZE, max_persist_threshold_),
+                                  max_persist_threshold_);
+}
+
 void DiskLogConsumerTask::DiskLogConsumerTaskLoop() {
   uint64_t write_us = 0, persist_us = 0, num_bytes = 0, num_buffers = 0;
   // Keeps track of how much data we've written to the log file since the last persist
@@ -87,11 +115,15 @@ void DiskLogConsumerTask::DiskLogConsumerTaskLoop() {
     // 2) We have written more data since the last persist than the threshold
     // 3) We are signaled to persist
     // 4) We are shutting down this task
-    bool timeout = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() -
-                                                                         last_persist) > persist_interval_;
-    if (timeout || current_data_written_ > persist_threshold_ || do_persist_ || !run_task_) {
-      common::ScopedTimer<std::chrono::microseconds> scoped_timer(&elapsed_us);
+    const auto since_last_persist = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - last_persist);
+    bool timeout = since_last_persist > persist_interval_;
+    // A zero threshold means that every commit is persisted right away, including read-only ones without any data
+    bool over_threshold = current_data_written_ > persist_threshold_ ||
+                          (adaptive_persist_ && persist_threshold_ == 0 && !commit_callbacks_.empty());
+    if (timeout || over_threshold || do_persist_ || !run_task_) {
       {
+        common::ScopedTimer<std::chrono::microseconds> scoped_timer(&elapsed_us);
         std::unique_lock<std::mutex> lock(persist_lock_);
         num_buffers = PersistLogFile();
         num_bytes = current_data_written_;
@@ -102,6 +134,7 @@ void DiskLogConsumerTask::DiskLogConsumerTaskLoop() {
       }
       // Signal anyone who forced a persist that the persist has finished
       persist_cv_.notify_all();
+      if (adaptive_persist_) AdaptPersistInterval(since_last_persist, elapsed_us, num_buffers, num_bytes);
     }
     persist_us = elapsed_us;
 
@@ -0,0 +1,173 @@
+#include "storage/write_ahead_log/io_uring.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TERRIER_HAS_IO_URING 1
+#endif
+#endif
+
+namespace terrier::storage {
+
+#ifdef TERRIER_HAS_IO_URING
+
+namespace {
+// The kernel reads the submission queue tail and writes the completion queue tail concurrently
+uint32_t LoadAcquire(const uint32_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void StoreRelease(uint32_t *p, uint32_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+template <class T>
+T *At(void *base, uint32_t offset) {
+  return reinterpret_cast<T *>(reinterpret_cast<char *>(base) + offset);
+}
+
+void *MapRing(int ring_fd, uint64_t size, off_t offset) {
+  void *const mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return mapped == MAP_FAILED ? nullptr : mapped;
+}
+}  // namespace
+
+std::unique_ptr<IoUring> IoUring::Create(const uint32_t num_entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  const auto ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, num_entries, &params));
+  // Fails without kernel support, or where io_uring is disabled, e.g. by a seccomp profile
+  if (ring_fd < 0) return nullptr;
+  std::unique_ptr<IoUring> ring(new IoUring(ring_fd, params.sq_entries));
+  // Writes at an offset came with the same kernel version as this feature, older kernels only get posix writes
+  if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) return nullptr;
+
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    ring->sq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    ring->sq_ring_ = MapRing(ring_fd, ring->sq_ring_size_, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == nullptr) return nullptr;
+  } else {
+    ring->sq_ring_ = MapRing(ring_fd, ring->sq_ring_size_, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == nullptr) return nullptr;
+    ring->cq_ring_ = MapRing(ring_fd, ring->cq_ring_size_, IORING_OFF_CQ_RING);
+    if (ring->cq_ring_ == nullptr) return nullptr;
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes_ = MapRing(ring_fd, ring->sqes_size_, IORING_OFF_SQES);
+  if (ring->sqes_ == nullptr) return nullptr;
+
+  void *const cq_ring = ring->cq_ring_ == nullptr ? ring->sq_ring_ : ring->cq_ring_;
+  ring->sq_head_ = At<uint32_t>(ring->sq_ring_, params.sq_off.head);
+  ring->sq_tail_ = At<uint32_t>(ring->sq_ring_, params.sq_off.tail);
+  ring->sq_mask_ = At<uint32_t>(ring->sq_ring_, params.sq_off.ring_mask);
+  ring->sq_array_ = At<uint32_t>(ring->sq_ring_, params.sq_off.array);
+  ring->cq_head_ = At<uint32_t>(cq_ring, params.cq_off.head);
+  ring->cq_tail_ = At<uint32_t>(cq_ring, params.cq_off.tail);
+  ring->cq_mask_ = At<uint32_t>(cq_ring, params.cq_off.ring_mask);
+  ring->cqes_ = At<void>(cq_ring, params.cq_off.cqes);
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IoUring::QueueWrite(const int fd, const void *const buf, const uint32_t nbyte, const uint64_t offset,
+                         const uint64_t user_data) {
+  auto *const sqe = reinterpret_cast<io_uring_sqe *>(NextEntry());
+  if (sqe == nullptr) return false;
+  sqe->opcode = IORING_OP_WRITE;
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = nbyte;
+  sqe->user_data = user_data;
+  PushEntry();
+  return true;
+}
+
+bool IoUring::QueueDataSync(const int fd, const uint64_t user_data) {
+  auto *const sqe = reinterpret_cast<io_uring_sqe *>(NextEntry());
+  if (sqe == nullptr) return false;
+  sqe->opcode = IORING_OP_FSYNC;
+  // Requests in flight complete in any order, so the sync has to wait for the writes it is meant to persist
+  sqe->flags = IOSQE_IO_DRAIN;
+  sqe->fd = fd;
+  sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+  sqe->user_data = user_data;
+  PushEntry();
+  return true;
+}
+
+IoUring::Completion IoUring::WaitCompletion() {
+  if (to_submit_ > 0) Enter(0);
+  Completion result;
+  while (!PopCompletion(&result)) Enter(1);
+  return result;
+}
+
+void *IoUring::NextEntry() {
+  // Only this thread moves the tail, the kernel moves the head as it consumes entries
+  const uint32_t tail = *sq_tail_;
+  if (tail - LoadAcquire(sq_head_) == num_entries_) return nullptr;
+  auto *const sqe = reinterpret_cast<io_uring_sqe *>(sqes_) + (tail & *sq_mask_);
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  return sqe;
+}
+
+void IoUring::PushEntry() {
+  const uint32_t tail = *sq_tail_;
+  const uint32_t index = tail & *sq_mask_;
+  sq_array_[index] = index;
+  StoreRelease(sq_tail_, tail + 1);
+  to_submit_++;
+}
+
+bool IoUring::PopCompletion(Completion *const completion) {
+  const uint32_t head = *cq_head_;
+  if (head == LoadAcquire(cq_tail_)) return false;
+  const io_uring_cqe &cqe = reinterpret_cast<io_uring_cqe *>(cqes_)[head & *cq_mask_];
+  completion->user_data_ = cqe.user_data;
+  completion->result_ = cqe.res;
+  StoreRelease(cq_head_, head + 1);
+  return true;
+}
+
+void IoUring::Enter(const uint32_t min_complete) {
+  while (true) {
+    const int64_t ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_complete,
+                                min_complete > 0 ? IORING_ENTER_GETEVENTS : 0U, nullptr, 0);
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("io_uring_enter failed with errno " + std::to_string(errno));
+    }
+    to_submit_ -= static_cast<uint32_t>(ret);
+    return;
+  }
+}
+
+#else
+
+std::unique_ptr<IoUring> IoUring::Create(uint32_t) { return nullptr; }
+IoUring::~IoUring() = default;
+bool IoUring::QueueWrite(int, const void *, uint32_t, uint64_t, uint64_t) { return false; }
+bool IoUring::QueueDataSync(int, uint64_t) { return false; }
+IoUring::Completion IoUring::WaitCompletion() { throw std::runtime_error("io_uring is not supported"); }
+void *IoUring::NextEntry() { return nullptr; }
+void IoUring::PushEntry() {}
+bool IoUring::PopCompletion(Completion *) { return false; }
+void IoUring::Enter(uint32_t) {}
+
+#endif
+
+}  // namespace terrier::storage
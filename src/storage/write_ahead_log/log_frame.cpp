@@ -0,0 +1,210 @@
+#include "storage/write_ahead_log/log_frame.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace terrier::storage {
+
+namespace {
+template <class T>
+T Load(const byte *src) {
+  T result;
+  std::memcpy(&result, src, sizeof(T));
+  return result;
+}
+
+template <class T>
+void Store(byte *dest, const T value) {
+  std::memcpy(dest, &value, sizeof(T));
+}
+
+#ifndef __SSE4_2__
+// Table for the byte at a time CRC32C (Castagnoli, reflected polynomial 0x82F63B78)
+const std::array<uint32_t, 256> &CrcTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> result{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (uint32_t bit = 0; bit < 8; bit++) crc = (crc >> 1U) ^ ((crc & 1U) != 0 ? 0x82F63B78 : 0);
+      result[i] = crc;
+    }
+    return result;
+  }();
+  return table;
+}
+#endif
+
+// Writes the part of a run length above what fits into its token as a sequence of bytes, each but the last 255
+byte *WriteLength(byte *op, uint32_t length) {
+  for (; length >= UINT8_MAX; length -= UINT8_MAX) *op++ = static_cast<byte>(UINT8_MAX);
+  *op++ = static_cast<byte>(length);
+  return op;
+}
+
+// Reads a run length written by WriteLength on top of the token's value, returns false if the input ends first
+bool ReadLength(const byte **ip, const byte *const end, uint32_t *length) {
+  uint8_t next;
+  do {
+    if (*ip == end) return false;
+    next = static_cast<uint8_t>(*(*ip)++);
+    *length += next;
+  } while (next == UINT8_MAX);
+  return true;
+}
+
+constexpr uint32_t RUN_MASK = 15;
+}  // namespace
+
+void LogFrame::WriteHeader(byte *const frame, const uint16_t flags, const uint32_t size, const uint32_t decoded_size) {
+  Store<uint16_t>(frame, MAGIC);
+  Store<uint16_t>(frame + 2, flags);
+  Store<uint32_t>(frame + 4, size);
+  Store<uint32_t>(frame + 8, decoded_size);
+  // The checksum covers the header before it, so that a torn header cannot pass for a shorter frame
+  Store<uint32_t>(frame + 12, Checksum(frame + HEADER_SIZE, size, Checksum(frame, 12)));
+}
+
+bool LogFrame::ReadHeader(const byte *const frame, const uint32_t max_size, uint16_t *const flags,
+                          uint32_t *const size, uint32_t *const decoded_size) {
+  if (Load<uint16_t>(frame) != MAGIC) return false;
+  *flags = Load<uint16_t>(frame + 2);
+  *size = Load<uint32_t>(frame + 4);
+  *decoded_size = Load<uint32_t>(frame + 8);
+  if (*size > max_size || *decoded_size > max_size) return false;
+  // Round markers hold nothing but the round number
+  if ((*flags & END_OF_ROUND) != 0) {
+    return *flags == END_OF_ROUND && *size == sizeof(uint64_t) && *decoded_size == sizeof(uint64_t);
+  }
+  return (*flags & COMPRESSED) != 0 || *size == *decoded_size;
+}
+
+bool LogFrame::Verify(const byte *const frame) {
+  return Load<uint32_t>(frame + 12) == Checksum(frame + HEADER_SIZE, Load<uint32_t>(frame + 4), Checksum(frame, 12));
+}
+
+uint32_t LogFrame::Checksum(const void *const data, uint32_t size, uint32_t crc) {
+  const auto *p = reinterpret_cast<const byte *>(data);
+  crc = ~crc;
+#ifdef __SSE4_2__
+  uint64_t crc64 = crc;
+  for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+    crc64 = _mm_crc32_u64(crc64, Load<uint64_t>(p));
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; size--, p++) crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*p));
+#else
+  const auto &table = CrcTable();
+  for (; size > 0; size--, p++) crc = table[(crc ^ static_cast<uint8_t>(*p)) & 0xFFU] ^ (crc >> 8U);
+#endif
+  return ~crc;
+}
+
+uint32_t LogFrame::Compress(const byte *const src, const uint32_t size, byte *const dest, const uint32_t capacity) {
+  // Positions of earlier occurrences of 4 byte sequences, by their hash. Stale or colliding entries are weeded out by
+  // comparing the bytes.
+  std::array<uint32_t, 1U << HASH_BITS> table{};
+  const auto hash = [](const uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); };
+
+  byte *op = dest;
+  byte *const op_end = dest + capacity;
+  uint32_t anchor = 0;  // start of the literals not yet written
+  // Whether a sequence fits, with a generous estimate of the bytes its run lengths take
+  const auto fits = [&](const uint32_t literals, const uint32_t match_length) {
+    const uint64_t match_bytes = match_length == 0 ? 0 : sizeof(uint16_t) + match_length / UINT8_MAX + 1;
+    return 1 + literals / UINT8_MAX + 1 + literals + match_bytes <= static_cast<uint64_t>(op_end - op);
+  };
+
+  if (size > MATCH_LIMIT) {
+    const uint32_t match_limit = size - MATCH_LIMIT;
+    const uint32_t match_end = size - LAST_LITERALS;
+    uint32_t ip = 0;
+    while (ip < match_limit) {
+      const auto sequence = Load<uint32_t>(src + ip);
+      uint32_t &entry = table[hash(sequence)];
+      const uint32_t ref = entry;
+      entry = ip;
+      if (ref >= ip || ip - ref > MAX_OFFSET || Load<uint32_t>(src + ref) != sequence) {
+        ip++;
+        continue;
+      }
+
+      uint32_t match_length = MIN_MATCH;
+      while (ip + match_length < match_end && src[ref + match_length] == src[ip + match_length]) match_length++;
+      const uint32_t literals = ip - anchor;
+      if (!fits(literals, match_length)) return 0;
+
+      byte *const token = op++;
+      *token = static_cast<byte>((std::min(literals, RUN_MASK) << 4U) | std::min(match_length - MIN_MATCH, RUN_MASK));
+      if (literals >= RUN_MASK) op = WriteLength(op, literals - RUN_MASK);
+      std::memcpy(op, src + anchor, literals);
+      op += literals;
+      Store<uint16_t>(op, static_cast<uint16_t>(ip - ref));
+      op += sizeof(uint16_t);
+      if (match_length - MIN_MATCH >= RUN_MASK) op = WriteLength(op, match_length - MIN_MATCH - RUN_MASK);
+
+      ip += match_length;
+      anchor = ip;
+    }
+  }
+
+  // The remaining bytes are written as literals without a match
+  const uint32_t literals = size - anchor;
+  if (!fits(literals, 0)) return 0;
+  *op++ = static_cast<byte>(std::min(literals, RUN_MASK) << 4U);
+  if (literals >= RUN_MASK) op = WriteLength(op, literals - RUN_MASK);
+  std::memcpy(op, src + anchor, literals);
+  op += literals;
+  return static_cast<uint32_t>(op - dest);
+}
+
+bool LogFrame::Decompress(const byte *const src, const uint32_t size, byte *const dest, const uint32_t decoded_size) {
+  const byte *ip = src;
+  const byte *const ip_end = src + size;
+  byte *op = dest;
+  byte *const op_end = dest + decoded_size;
+  while (ip < ip_end) {
+    const auto token = static_cast<uint8_t>(*ip++);
+
+    uint32_t literals = token >> 4U;
+    if (literals == RUN_MASK && !ReadLength(&ip, ip_end, &literals)) return false;
+    if (literals > static_cast<uint64_t>(ip_end - ip) || literals > static_cast<uint64_t>(op_end - op)) return false;
+    std::memcpy(op, ip, literals);
+    ip += literals;
+    op += literals;
+    // The last sequence has no match
+    if (ip == ip_end) break;
+
+    if (ip_end - ip < static_cast<int64_t>(sizeof(uint16_t))) return false;
+    const uint32_t offset = Load<uint16_t>(ip);
+    ip += sizeof(uint16_t);
+    if (offset == 0 || offset > static_cast<uint64_t>(op - dest)) return false;
+    uint32_t match_length = token & RUN_MASK;
+    if (match_length == RUN_MASK && !ReadLength(&ip, ip_end, &match_length)) return false;
+    match_length += MIN_MATCH;
+    if (match_length > static_cast<uint64_t>(op_end - op)) return false;
+
+    const byte *match = op - offset;
+    if (offset >= match_length) {
+      std::memcpy(op, match, match_length);
+      op += match_length;
+    } else if (offset >= sizeof(uint64_t)) {
+      // An overlapping match repeats the offset bytes before it, which can be copied in chunks of that size
+      for (uint32_t copied = 0; copied < match_length; copied += offset) {
+        const uint32_t chunk = std::min(offset, match_length - copied);
+        std::memcpy(op, match, chunk);
+        op += chunk;
+        match += chunk;
+      }
+    } else {
+      for (uint32_t i = 0; i < match_length; i++) *op++ = *match++;
+    }
+  }
+  return op == op_end;
+}
+
+}  // namespace terrier::storage
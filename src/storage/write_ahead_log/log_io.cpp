@@ -1,5 +1,11 @@
 #include "storage/write_ahead_log/log_io.h"
+#include <dirent.h>
+#include <sys/mman.h>
 #include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
 namespace terrier::storage {
 void PosixIoWrappers::Close(int fd) {
   while (true) {
@@ -38,6 +44,396 @@ void PosixIoWrappers::WriteFully(int fd, const void *buf, size_t nbyte) {
   }
 }
 
+void PosixIoWrappers::WriteFullyAt(int fd, const void *buf, size_t nbyte, off_t offset) {
+  ssize_t written = 0;
+  while (static_cast<size_t>(written) < nbyte) {
+    ssize_t ret = pwrite(fd, reinterpret_cast<const char *>(buf) + written, nbyte - written, offset + written);
+    if (ret == -1) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Write to log file failed with errno " + std::to_string(errno));
+    }
+    written += ret;
+  }
+}
+
+void PosixIoWrappers::DataSync(int fd) {
+  if (fdatasync(fd) == -1) throw std::runtime_error("fdatasync failed with errno " + std::to_string(errno));
+}
+
+void PosixIoWrappers::SyncParentDirectory(const std::string &path) {
+  const auto slash = path.find_last_of('/');
+  const std::string dir = slash == std::string::npos ? "." : path.substr(0, std::max<size_t>(slash, 1));
+  const int fd = Open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  const int ret = fsync(fd);
+  const int sync_errno = errno;
+  Close(fd);
+  if (ret == -1) throw std::runtime_error("fsync of directory failed with errno " + std::to_string(sync_errno));
+}
+
+void PosixIoWrappers::Preallocate(int fd, off_t offset, off_t len) {
+#if defined(__linux__)
+  // Failure, e.g. because the file system does not support it, only means that appends allocate as they go
+  fallocate(fd, FALLOC_FL_KEEP_SIZE, offset, len);
+#endif
+}
+
+namespace {
+// Number of digits of the segment id appended to the log file path, so that segments sort by name as well
+constexpr uint32_t SEGMENT_ID_DIGITS = 10;
+
+// Splits the segments in a directory listing off the log file's path. Returns (id, path) pairs in order of id.
+std::vector<std::pair<uint64_t, std::string>> ListSegments(const std::string &log_file_path) {
+  const auto separator = log_file_path.find_last_of('/');
+  const std::string dir = separator == std::string::npos ? "." : log_file_path.substr(0, separator + 1);
+  const std::string prefix =
+      (separator == std::string::npos ? log_file_path : log_file_path.substr(separator + 1)) + ".";
+
+  std::vector<std::pair<uint64_t, std::string>> result;
+  DIR *listing = opendir(dir.c_str());
+  if (listing == nullptr) return result;
+  for (dirent *entry = readdir(listing); entry != nullptr; entry = readdir(listing)) {
+    const std::string name(entry->d_name);
+    if (name.size() != prefix.size() + SEGMENT_ID_DIGITS || name.compare(0, prefix.size(), prefix) != 0) continue;
+    const std::string id = name.substr(prefix.size());
+    if (!std::all_of(id.begin(), id.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+    result.emplace_back(std::stoull(id), (separator == std::string::npos ? "" : dir) + name);
+  }
+  closedir(listing);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// Walks the longest prefix of a log file that consists of whole frames with matching checksums, stopping early after
+// the marker of the given round. Returns the length of the prefix walked, and the last round marked in it or 0.
+std::pair<uint64_t, uint64_t> ScanFrames(const std::string &path, const uint64_t stop_round = UINT64_MAX) {
+  const int fd = PosixIoWrappers::Open(path.c_str(), O_RDONLY);
+  std::vector<byte> frame(LogFrame::HEADER_SIZE + common::Constants::LOG_BUFFER_SIZE);
+  uint64_t valid_size = 0, last_round = 0;
+  while (last_round != stop_round) {
+    uint16_t flags;
+    uint32_t size, decoded_size;
+    if (PosixIoWrappers::ReadFully(fd, frame.data(), LogFrame::HEADER_SIZE) != LogFrame::HEADER_SIZE ||
+        !LogFrame::ReadHeader(frame.data(), common::Constants::LOG_BUFFER_SIZE, &flags, &size, &decoded_size) ||
+        PosixIoWrappers::ReadFully(fd, frame.data() + LogFrame::HEADER_SIZE, size) != size ||
+        !LogFrame::Verify(frame.data())) {
+      break;
+    }
+    if ((flags & LogFrame::END_OF_ROUND) != 0) std::memcpy(&last_round, frame.data() + LogFrame::HEADER_SIZE, size);
+    valid_size += LogFrame::HEADER_SIZE + size;
+  }
+  PosixIoWrappers::Close(fd);
+  return {valid_size, last_round};
+}
+
+void Truncate(const std::string &path, const uint64_t size) {
+  if (truncate(path.c_str(), static_cast<off_t>(size)) == -1) {
+    throw std::runtime_error("truncate failed with errno " + std::to_string(errno));
+  }
+}
+
+// Cuts off the frames at the end of a log file that a crash tore. Appending after them would leave them in the middle
+// of the log, where readers take them for corruption.
+uint64_t TruncateTornFrames(const std::string &path) {
+  const uint64_t valid_size = ScanFrames(path).first;
+  Truncate(path, valid_size);
+  return valid_size;
+}
+
+// Returns the last round marked in the files of a log stream, or 0 if there is none
+uint64_t LastRound(const std::vector<std::string> &file_paths) {
+  // A segment starts with the marker of the round before it, so this rarely looks further back than the last file
+  for (auto path = file_paths.rbegin(); path != file_paths.rend(); ++path) {
+    const uint64_t last_round = ScanFrames(*path).second;
+    if (last_round != 0) return last_round;
+  }
+  return 0;
+}
+}  // namespace
+
+LogFile::LogFile(std::string log_file_path, const uint64_t segment_size, const bool use_io_uring)
+    : log_file_path_(std::move(log_file_path)), segment_size_(segment_size) {
+  if (use_io_uring) {
+    // One more entry than batches, for the fdatasync
+    ring_ = IoUring::Create(NUM_IO_BATCHES + 1);
+    if (ring_ != nullptr) {
+      void *const memory = mmap(nullptr, uint64_t{IO_BATCH_SIZE} * NUM_IO_BATCHES, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (memory == MAP_FAILED) throw std::runtime_error("mmap failed with errno " + std::to_string(errno));
+      batch_memory_ = reinterpret_cast<byte *>(memory);
+      batches_.resize(NUM_IO_BATCHES);
+      for (uint32_t i = 0; i < NUM_IO_BATCHES; i++) batches_[i].buffer_ = batch_memory_ + uint64_t{IO_BATCH_SIZE} * i;
+    }
+  }
+
+  if (segment_size_ == 0) {
+    // Batches in flight may complete in any order, so io_uring writes at explicit offsets instead of appending
+    const int append = ring_ == nullptr ? O_APPEND : 0;
+    out_ = PosixIoWrappers::Open(log_file_path_.c_str(), O_WRONLY | append | O_CREAT, S_IRUSR | S_IWUSR);
+    size_ = preallocated_size_ = TruncateTornFrames(log_file_path_);
+    return;
+  }
+  // Everything in the segments of an earlier run was persisted before the restart, and has been recovered since. Only
+  // the last one can have been torn by a crash.
+  const auto segments = ListSegments(log_file_path_);
+  for (const auto &segment : segments) {
+    closed_segments_.emplace_back(segment.first, transaction::INVALID_TXN_TIMESTAMP);
+    segment_id_ = segment.first + 1;
+  }
+  if (!segments.empty()) TruncateTornFrames(segments.back().second);
+  OpenSegment();
+}
+
+void LogFile::Rename(const std::string &log_file_path, const std::string &new_log_file_path) {
+  const auto stream_file_paths = StreamFilePaths(log_file_path);
+  for (uint32_t stream = 0; stream < stream_file_paths.size(); stream++) {
+    // Files of a stream are named after the stream's path, segments with their id appended to it
+    const std::string stream_path = StreamPath(log_file_path, stream);
+    const std::string new_stream_path = StreamPath(new_log_file_path, stream);
+    for (const auto &path : stream_file_paths[stream]) {
+      const std::string new_path = new_stream_path + path.substr(stream_path.size());
+      if (rename(path.c_str(), new_path.c_str()) == -1) {
+        throw std::runtime_error("Failed to rename log file " + path + " with errno " + std::to_string(errno));
+      }
+    }
+  }
+}
+
+void LogFile::Remove(const std::string &log_file_path) {
+  for (const auto &file_paths : StreamFilePaths(log_file_path)) {
+    for (const auto &path : file_paths) {
+      if (unlink(path.c_str()) == -1 && errno != ENOENT) {
+        throw std::runtime_error("Failed to remove log file " + path + " with errno " + std::to_string(errno));
+      }
+    }
+  }
+}
+
+uint64_t LogFile::CommonRound(const std::vector<std::vector<std::string>> &stream_file_paths) {
+  uint64_t common_round = UINT64_MAX;
+  for (const auto &file_paths : stream_file_paths) common_round = std::min(common_round, LastRound(file_paths));
+  return stream_file_paths.empty() ? 0 : common_round;
+}
+
+uint64_t LogFile::TruncateToCommonRound(const std::string &log_file_path) {
+  const auto stream_file_paths = StreamFilePaths(log_file_path);
+  // A log with a single stream does not mark rounds
+  if (stream_file_paths.size() < 2) return 0;
+  const uint64_t round = CommonRound(stream_file_paths);
+  for (const auto &file_paths : stream_file_paths) {
+    if (file_paths.empty()) continue;
+    // The marker can be in two files, at the end of a segment and at the start of the next one, which is where the
+    // stream is cut. If no file has it, everything left of the stream came after the round.
+    uint64_t keep = 0, size = 0;
+    for (uint64_t i = file_paths.size(); round != 0 && i-- > 0;) {
+      const auto scanned = ScanFrames(file_paths[i], round);
+      if (scanned.second == round) {
+        keep = i;
+        size = scanned.first;
+        break;
+      }
+    }
+    Truncate(file_paths[keep], size);
+    for (uint64_t i = keep + 1; i < file_paths.size(); i++) {
+      if (unlink(file_paths[i].c_str()) == -1 && errno != ENOENT) {
+        throw std::runtime_error("Failed to remove log file " + file_paths[i] + " with errno " + std::to_string(errno));
+      }
+    }
+  }
+  return round;
+}
+
+std::vector<std::string> LogFile::FilePaths(const std::string &log_file_path) {
+  std::vector<std::string> result;
+  if (access(log_file_path.c_str(), F_OK) == 0) result.push_back(log_file_path);
+  for (auto &segment : ListSegments(log_file_path)) result.emplace_back(std::move(segment.second));
+  return result;
+}
+
+std::string LogFile::StreamPath(const std::string &log_file_path, const uint32_t stream) {
+  return stream == 0 ? log_file_path : log_file_path + ".stream" + std::to_string(stream);
+}
+
+std::vector<std::vector<std::string>> LogFile::StreamFilePaths(const std::string &log_file_path) {
+  // Streams are numbered without gaps. The first one is always there, even if nothing was logged yet.
+  std::vector<std::vector<std::string>> result;
+  for (uint32_t stream = 0;; stream++) {
+    auto paths = FilePaths(StreamPath(log_file_path, stream));
+    if (paths.empty() && stream > 0) break;
+    result.emplace_back(std::move(paths));
+  }
+  return result;
+}
+
+void LogFile::Write(const void *data, const uint32_t size) {
+  // Segments are preallocated in full when opened, and only overrun by the tail of their last record
+  if (segment_size_ == 0 && size_ + size > preallocated_size_) {
+    const uint64_t grow_by = std::max<uint64_t>(size, PREALLOCATION_SIZE);
+    PosixIoWrappers::Preallocate(out_, static_cast<off_t>(preallocated_size_), static_cast<off_t>(grow_by));
+    preallocated_size_ += grow_by;
+  }
+  if (ring_ == nullptr) {
+    PosixIoWrappers::WriteFully(out_, data, size);
+  } else {
+    uint32_t written = 0;
+    while (written < size) {
+      IoBatch &batch = batches_[current_batch_];
+      if (batch.size_ == 0) batch.offset_ = size_ + written;
+      const uint32_t to_copy = std::min(size - written, IO_BATCH_SIZE - batch.size_);
+      std::memcpy(batch.buffer_ + batch.size_, reinterpret_cast<const byte *>(data) + written, to_copy);
+      batch.size_ += to_copy;
+      written += to_copy;
+      if (batch.size_ == IO_BATCH_SIZE) SubmitBatch();
+    }
+  }
+  size_ += size;
+  unpersisted_ = true;
+}
+
+void LogFile::EndSegment(const transaction::timestamp_t max_txn_begin) {
+  TERRIER_ASSERT(segment_size_ != 0, "A single file log has no segments");
+  Persist();
+  // The unused tail of the preallocation goes back to the file system. Recovery reads up to the end of the file.
+  if (ftruncate(out_, static_cast<off_t>(size_)) == -1) {
+    throw std::runtime_error("ftruncate failed with errno " + std::to_string(errno));
+  }
+  PosixIoWrappers::Close(out_);
+  const uint64_t closed_segment_id = segment_id_++;
+  OpenSegment();
+  // Only removable once the next segment has persisted the marker of the last round, if any
+  common::SpinLatch::ScopedSpinLatch guard(&segments_latch_);
+  closed_segments_.emplace_back(closed_segment_id, max_txn_begin);
+}
+
+void LogFile::MarkRounds(const uint64_t last_round) {
+  marks_rounds_ = true;
+  last_round_ = last_round;
+  // The current segment was just opened, and starts with the marker like any other
+  if (segment_size_ != 0 && last_round_ != 0) {
+    WriteRoundMarker();
+    Persist();
+  }
+}
+
+uint32_t LogFile::RemoveSegmentsBefore(const transaction::timestamp_t oldest_txn) {
+  std::vector<uint64_t> removed;
+  {
+    common::SpinLatch::ScopedSpinLatch guard(&segments_latch_);
+    // Only a prefix can go, as a recovery must see every segment from the oldest one it needs onwards
+    auto it = closed_segments_.begin();
+    while (it != closed_segments_.end() &&
+           (it->second == transaction::INVALID_TXN_TIMESTAMP || it->second < oldest_txn)) {
+      removed.push_back(it->first);
+      ++it;
+    }
+    closed_segments_.erase(closed_segments_.begin(), it);
+  }
+  for (const uint64_t segment_id : removed) {
+    const std::string path = SegmentPath(segment_id);
+    if (unlink(path.c_str()) == -1 && errno != ENOENT) {
+      throw std::runtime_error("Failed to remove log segment " + path + " with errno " + std::to_string(errno));
+    }
+  }
+  return static_cast<uint32_t>(removed.size());
+}
+
+void LogFile::Close() {
+  Persist();
+  if (preallocated_size_ > size_ && ftruncate(out_, static_cast<off_t>(size_)) == -1) {
+    throw std::runtime_error("ftruncate failed with errno " + std::to_string(errno));
+  }
+  PosixIoWrappers::Close(out_);
+  if (ring_ != nullptr) {
+    ring_.reset();
+    munmap(batch_memory_, uint64_t{IO_BATCH_SIZE} * NUM_IO_BATCHES);
+    batch_memory_ = nullptr;
+    batches_.clear();
+  }
+}
+
+std::string LogFile::SegmentPath(const uint64_t segment_id) const {
+  std::string id = std::to_string(segment_id);
+  return log_file_path_ + "." + std::string(SEGMENT_ID_DIGITS - std::min<size_t>(id.size(), SEGMENT_ID_DIGITS), '0') +
+         id;
+}
+
+void LogFile::OpenSegment() {
+  out_ = PosixIoWrappers::Open(SegmentPath(segment_id_).c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  size_ = 0;
+  PosixIoWrappers::Preallocate(out_, 0, static_cast<off_t>(segment_size_));
+  preallocated_size_ = segment_size_;
+  if (marks_rounds_ && last_round_ != 0) {
+    WriteRoundMarker();
+    Persist();
+  }
+}
+
+void LogFile::WriteRoundMarker() {
+  byte frame[LogFrame::HEADER_SIZE + sizeof(uint64_t)];
+  std::memcpy(frame + LogFrame::HEADER_SIZE, &last_round_, sizeof(uint64_t));
+  LogFrame::WriteHeader(frame, LogFrame::END_OF_ROUND, sizeof(uint64_t), sizeof(uint64_t));
+  Write(frame, sizeof(frame));
+}
+
+void LogFile::SubmitBatch() {
+  IoBatch &batch = batches_[current_batch_];
+  while (!ring_->QueueWrite(out_, batch.buffer_, batch.size_, batch.offset_, current_batch_)) ReapCompletion();
+  ring_->Submit();
+  batch.in_flight_ = true;
+  current_batch_ = (current_batch_ + 1) % NUM_IO_BATCHES;
+  while (batches_[current_batch_].in_flight_) ReapCompletion();
+}
+
+void LogFile::PersistBatches() {
+  if (batches_[current_batch_].size_ > 0) SubmitBatch();
+  while (!ring_->QueueDataSync(out_, SYNC_REQUEST)) ReapCompletion();
+  sync_in_flight_ = true;
+  // Every batch has to be reaped as well, as failed writes are only redone when they are
+  const auto in_flight = [](const IoBatch &batch) { return batch.in_flight_; };
+  while (sync_in_flight_ || std::any_of(batches_.begin(), batches_.end(), in_flight)) ReapCompletion();
+  if (needs_sync_) {
+    PosixIoWrappers::DataSync(out_);
+    needs_sync_ = false;
+  }
+}
+
+void LogFile::ReapCompletion() {
+  const IoUring::Completion completion = ring_->WaitCompletion();
+  if (completion.user_data_ == SYNC_REQUEST) {
+    sync_in_flight_ = false;
+    if (completion.result_ < 0) needs_sync_ = true;
+    return;
+  }
+  // Short or failed writes are finished with posix calls, which throw if they fail as well
+  IoBatch &batch = batches_[completion.user_data_];
+  const auto written = static_cast<uint32_t>(std::max(completion.result_, 0));
+  if (written < batch.size_) {
+    PosixIoWrappers::WriteFullyAt(out_, batch.buffer_ + written, batch.size_ - written,
+                                  static_cast<off_t>(batch.offset_ + written));
+    needs_sync_ = true;
+  }
+  batch.size_ = 0;
+  batch.in_flight_ = false;
+}
+
+void BufferedLogWriter::SealFrame() {
+  TERRIER_ASSERT(!sealed_, "Buffer is sealed already");
+  sealed_ = true;
+  if (compressed_ != nullptr && buffer_size_ > 0) {
+    // Only worth it if the frame gets smaller
+    const uint32_t size = LogFrame::Compress(buffer_ + LogFrame::HEADER_SIZE, buffer_size_,
+                                             compressed_.get() + LogFrame::HEADER_SIZE, buffer_size_ - 1);
+    if (size > 0) {
+      LogFrame::WriteHeader(compressed_.get(), LogFrame::COMPRESSED, size, buffer_size_);
+      frame_compressed_ = true;
+      frame_size_ = LogFrame::HEADER_SIZE + size;
+      return;
+    }
+  }
+  LogFrame::WriteHeader(buffer_, 0, buffer_size_, buffer_size_);
+  frame_compressed_ = false;
+  frame_size_ = LogFrame::HEADER_SIZE + buffer_size_;
+}
+
 bool BufferedLogReader::Read(void *dest, uint32_t size) {
   if (read_head_ + size <= filled_size_) {
     // bytes to read are already buffered.
@@ -47,9 +443,8 @@ bool BufferedLogReader::Read(void *dest, uint32_t size) {
   // Not enough left in the buffer.
   uint32_t bytes_read = 0;
   while (bytes_read < size) {
-    if (!HasMore()) return false;
+    if (!HasMore()) return false;  // refills the buffer when all contents in it are read
     uint32_t read_size = std::min(size - bytes_read, filled_size_ - read_head_);
-    if (read_size == 0) RefillBuffer();  // when all contents in the buffer is fully read
     ReadFromBuffer(reinterpret_cast<char *>(dest) + bytes_read, read_size);
     bytes_read += read_size;
   }
@@ -58,14 +453,83 @@ bool BufferedLogReader::Read(void *dest, uint32_t size) {
 
 void BufferedLogReader::RefillBuffer() {
   TERRIER_ASSERT(read_head_ == filled_size_, "Refilling a buffer that is not fully read results in loss of data");
-  if (in_ == -1) throw std::runtime_error("No more bytes left in the log file");
   read_head_ = 0;
-  filled_size_ = PosixIoWrappers::ReadFully(in_, buffer_, common::Constants::LOG_BUFFER_SIZE);
-  if (filled_size_ < common::Constants::LOG_BUFFER_SIZE) {
-    // TODO(Tianyu): Is it better to make this an explicit close?
-    PosixIoWrappers::Close(in_);
-    in_ = -1;
+  filled_size_ = 0;
+  // Writers do not write empty frames, but skipping them costs nothing
+  while (filled_size_ == 0) {
+    if (stopped_) {
+      // The rest of the log belongs to rounds that were not persisted in every stream
+      current_path_ = static_cast<uint32_t>(paths_.size());
+      OpenNextFile();
+      return;
+    }
+    if (!FillRawBuffer(1)) {
+      // The current file ends at a frame boundary
+      if (!OpenNextFile()) return;
+      continue;
+    }
+    uint16_t flags = 0;
+    uint32_t size = 0, decoded_size = 0;
+    const bool valid = FillRawBuffer(LogFrame::HEADER_SIZE) &&
+                       LogFrame::ReadHeader(raw_ + raw_head_, common::Constants::LOG_BUFFER_SIZE, &flags, &size,
+                                            &decoded_size) &&
+                       FillRawBuffer(LogFrame::HEADER_SIZE + size) && LogFrame::Verify(raw_ + raw_head_);
+    const byte *const payload = raw_ + raw_head_ + LogFrame::HEADER_SIZE;
+    if (valid && (flags & LogFrame::END_OF_ROUND) != 0) {
+      uint64_t round;
+      std::memcpy(&round, payload, sizeof(uint64_t));
+      // A later round shows up first if the segments up to the marker of the round were removed
+      stopped_ = round >= stop_round_;
+      raw_head_ += LogFrame::HEADER_SIZE + size;
+      continue;
+    }
+    if (valid && (flags & LogFrame::COMPRESSED) != 0) {
+      if (LogFrame::Decompress(payload, size, buffer_, decoded_size)) filled_size_ = decoded_size;
+    } else if (valid) {
+      std::memcpy(buffer_, payload, size);
+      filled_size_ = size;
+    }
+
+    if (!valid || filled_size_ != decoded_size) {
+      // A crash only tears the frames written after the last persist, at the end of the last file of the log. A log
+      // file cuts off such frames when it is opened again, so the files of earlier runs end in whole frames. Anywhere
+      // else, dropping the rest of the file would silently lose transactions that were reported as committed.
+      if (current_path_ + 1 < paths_.size()) {
+        throw std::runtime_error("Log file " + paths_[current_path_] + " is corrupted");
+      }
+      // The transactions in the torn frames had not committed yet, so the log ends here
+      filled_size_ = 0;
+      OpenNextFile();
+      return;
+    }
+    raw_head_ += LogFrame::HEADER_SIZE + size;
   }
 }
 
+bool BufferedLogReader::FillRawBuffer(const uint32_t size) {
+  TERRIER_ASSERT(size <= RAW_BUFFER_SIZE, "Frame does not fit into the buffer");
+  if (raw_size_ - raw_head_ >= size) return true;
+  std::memmove(raw_, raw_ + raw_head_, raw_size_ - raw_head_);
+  raw_size_ -= raw_head_;
+  raw_head_ = 0;
+  // Frames never span two files, so this only reads up to the end of the current one
+  while (raw_size_ < size && in_ != -1) {
+    raw_size_ += PosixIoWrappers::ReadFully(in_, raw_ + raw_size_, RAW_BUFFER_SIZE - raw_size_);
+    if (raw_size_ < RAW_BUFFER_SIZE) {
+      // TODO(Tianyu): Is it better to make this an explicit close?
+      PosixIoWrappers::Close(in_);
+      in_ = -1;
+    }
+  }
+  return raw_size_ - raw_head_ >= size;
+}
+
+bool BufferedLogReader::OpenNextFile() {
+  if (in_ != -1) PosixIoWrappers::Close(in_);
+  raw_head_ = raw_size_ = 0;
+  if (current_path_ < paths_.size()) current_path_++;
+  in_ = current_path_ < paths_.size() ? PosixIoWrappers::Open(paths_[current_path_].c_str(), O_RDONLY) : -1;
+  return in_ != -1;
+}
+
 }  // namespace terrier::storage
@@ -6,9 +6,21 @@ namespace terrier::storage {
 
 void LogManager::Start() {
   TERRIER_ASSERT(!run_log_manager_, "Can't call Start on already started LogManager");
-  // Initialize buffers for logging
+  // Streams continue from the last round all of them persisted, anything after it was lost by some stream
+  const uint64_t last_round = num_serializers_ > 1 ? LogFile::TruncateToCommonRound(log_file_path_) : 0;
+  std::vector<LogFile *> log_files;
+  for (uint32_t i = 0; i < num_serializers_; i++) {
+    log_files_.emplace_back(
+        std::make_unique<LogFile>(LogFile::StreamPath(log_file_path_, i), segment_size_, use_io_uring_));
+    if (num_serializers_ > 1) log_files_.back()->MarkRounds(last_round);
+    log_files.push_back(log_files_.back().get());
+  }
+  if (use_io_uring_ && !log_files.front()->UsesIoUring()) {
+    STORAGE_LOG_WARN("io_uring is not available, the log is written with posix calls");
+  }
+  // Initialize buffers for logging. They are shared by all streams.
   for (size_t i = 0; i < num_buffers_; i++) {
-    buffers_.emplace_back(BufferedLogWriter(log_file_path_.c_str()));
+    buffers_.emplace_back(BufferedLogWriter(log_files.front(), compress_));
   }
   for (size_t i = 0; i < num_buffers_; i++) {
     empty_buffer_queue_.Enqueue(&buffers_[i]);
@@ -18,13 +30,13 @@ void LogManager::Start() {
 
   // Register DiskLogConsumerTask
   disk_log_writer_task_ = thread_registry_->RegisterDedicatedThread<DiskLogConsumerTask>(
-      this /* requester */, persist_interval_, persist_threshold_, &buffers_, &empty_buffer_queue_,
-      &filled_buffer_queue_);
+      this /* requester */, persist_interval_, persist_threshold_, log_files, &empty_buffer_queue_,
+      &filled_buffer_queue_, adaptive_persist_);
 
   // Register LogSerializerTask
   log_serializer_task_ = thread_registry_->RegisterDedicatedThread<LogSerializerTask>(
       this /* requester */, serialization_interval_, buffer_pool_, &empty_buffer_queue_, &filled_buffer_queue_,
-      &disk_log_writer_task_->disk_log_writer_thread_cv_);
+      &disk_log_writer_task_->disk_log_writer_thread_cv_, log_files, segment_size_);
 }
 
 void LogManager::ForceFlush() {
@@ -54,10 +66,9 @@ void LogManager::PersistAndStop() {
   TERRIER_ASSERT(result, "DiskLogConsumerTask should have been stopped");
   TERRIER_ASSERT(filled_buffer_queue_.Empty(), "disk log consumer task should have processed all filled buffers\n");
 
-  // Close the buffers corresponding to the log file
-  for (auto buf : buffers_) {
-    buf.Close();
-  }
+  // Close the log files
+  for (const auto &log_file : log_files_) log_file->Close();
+  log_files_.clear();
   // Clear buffer queues
   empty_buffer_queue_.Clear();
   filled_buffer_queue_.Clear();
@@ -3,6 +3,7 @@
 #include <queue>
 #include <utility>
 #include <vector>
+#include "common/hash_util.h"
 #include "common/scoped_timer.h"
 #include "common/thread_context.h"
 #include "metrics/metrics_store.h"
@@ -56,25 +57,48 @@ bool LogSerializerTask::Process() {
         flush_queue_ = std::queue<RecordBufferSegment *>();
       }
 
-      // Loop over all the new buffers we found
+      // Loop over all the new buffers we found, and hand them to the stream of their transaction
       while (!temp_flush_queue_.empty()) {
         RecordBufferSegment *buffer = temp_flush_queue_.front();
         temp_flush_queue_.pop();
+        StreamOf(buffer)->pending_.push_back(buffer);
+      }
 
-        // Serialize the Redo buffer and release it to the buffer pool
-        IterableBufferSegment<LogRecord> task_buffer(buffer);
-        const auto num_bytes_and_records = SerializeBuffer(&task_buffer);
-        buffer_pool_->Release(buffer);
-        num_bytes += num_bytes_and_records.first;
-        num_records += num_bytes_and_records.second;
+      // Serialize all streams, this thread takes the first one
+      for (uint32_t i = 1; i < streams_.size(); i++) {
+        LogStream *const stream = &streams_[i];
+        if (!stream->pending_.empty()) serializer_pool_->SubmitTask([this, stream] { SerializeStream(stream); });
+      }
+      SerializeStream(&streams_[0]);
+      if (serializer_pool_ != nullptr) serializer_pool_->WaitUntilAllFinished();
+
+      // Mark the last buffer of every stream as full, and only then hand over the commit callbacks of the round, so
+      // that none of them is invoked before all records serialized so far have been persisted. With several streams,
+      // each marks the end of the round, so that recovery does not replay a round that some stream lost in a crash.
+      std::vector<CommitCallback> commits;
+      for (auto &stream : streams_) {
+        if (streams_.size() > 1) GetCurrentWriteBuffer(&stream)->EndRound();
+        if (stream.filled_buffer_ != nullptr) HandFilledBufferToWriter(&stream);
+        commits.insert(commits.end(), stream.commits_.begin(), stream.commits_.end());
+        stream.commits_.clear();
+        for (auto &txns : stream.serialized_txns_) {
+          auto &serialized = serialized_txns_[txns.first];
+          serialized.insert(serialized.end(), txns.second.begin(), txns.second.end());
+        }
+        stream.serialized_txns_.clear();
+        num_bytes += stream.num_bytes_;
+        num_records += stream.num_records_;
+        stream.num_bytes_ = stream.num_records_ = 0;
+      }
+      if (!commits.empty()) {
+        // Read-only txns and txns whose commit record was in a handed over buffer are all the same to the consumer
+        filled_buffer_queue_->Enqueue(SerializedLogs(nullptr, std::move(commits)));
+        disk_log_writer_thread_cv_->notify_one();
       }
 
       buffers_processed = true;
     }
 
-    // Mark the last buffer that was written to as full
-    if (buffers_processed) HandFilledBufferToWriter();
-
     // Bulk remove all the transactions we serialized. This prevents having to take the TimestampManager's latch once
     // for each timestamp we remove.
     for (const auto &txns : serialized_txns_) {
@@ -89,32 +113,54 @@ bool LogSerializerTask::Process() {
   return buffers_processed;
 }
 
+LogSerializerTask::LogStream *LogSerializerTask::StreamOf(RecordBufferSegment *const buffer) {
+  if (streams_.size() == 1) return &streams_[0];
+  // A transaction only hands over buffers with records in them
+  IterableBufferSegment<LogRecord> records(buffer);
+  const transaction::timestamp_t txn_begin = (*records.begin()).TxnBegin();
+  return &streams_[common::HashUtil::Hash(txn_begin) % streams_.size()];
+}
+
+void LogSerializerTask::SerializeStream(LogStream *const stream) {
+  for (RecordBufferSegment *const buffer : stream->pending_) {
+    // Serialize the Redo buffer and release it to the buffer pool
+    IterableBufferSegment<LogRecord> task_buffer(buffer);
+    const auto num_bytes_and_records = SerializeBuffer(stream, &task_buffer);
+    buffer_pool_->Release(buffer);
+    stream->num_bytes_ += num_bytes_and_records.first;
+    stream->num_records_ += num_bytes_and_records.second;
+  }
+  stream->pending_.clear();
+}
+
 /**
- * Used by the serializer thread to get a buffer to serialize data to
+ * Used by the serializer threads to get a buffer to serialize data to
  * @return buffer to write to
  */
-BufferedLogWriter *LogSerializerTask::GetCurrentWriteBuffer() {
-  if (filled_buffer_ == nullptr) {
-    empty_buffer_queue_->Dequeue(&filled_buffer_);
+BufferedLogWriter *LogSerializerTask::GetCurrentWriteBuffer(LogStream *const stream) {
+  if (stream->filled_buffer_ == nullptr) {
+    empty_buffer_queue_->Dequeue(&stream->filled_buffer_);
+    stream->filled_buffer_->SetLogFile(stream->log_file_);
   }
-  return filled_buffer_;
+  return stream->filled_buffer_;
 }
 
 /**
- * Hand over the current buffer and commit callbacks for commit records in that buffer to the log consumer task
+ * Hand over the current buffer of a stream to the log consumer task. Commit callbacks are handed over separately.
  */
-void LogSerializerTask::HandFilledBufferToWriter() {
+void LogSerializerTask::HandFilledBufferToWriter(LogStream *const stream) {
+  // Encode the buffer here rather than in the consumer task, which is shared by all streams
+  stream->filled_buffer_->SealFrame();
   // Hand over the filled buffer
-  filled_buffer_queue_->Enqueue(std::make_pair(filled_buffer_, commits_in_buffer_));
+  filled_buffer_queue_->Enqueue(std::make_pair(stream->filled_buffer_, std::vector<CommitCallback>()));
   // Signal disk log consumer task thread that a buffer has been handed over
   disk_log_writer_thread_cv_->notify_one();
-  // Mark that the task doesn't have a buffer in its possession to which it can write to
-  commits_in_buffer_.clear();
-  filled_buffer_ = nullptr;
+  // Mark that the stream doesn't have a buffer in its possession to which it can write to
+  stream->filled_buffer_ = nullptr;
 }
 
 std::pair<uint64_t, uint64_t> LogSerializerTask::SerializeBuffer(
-    IterableBufferSegment<LogRecord> *buffer_to_serialize) {
+    LogStream *const stream, IterableBufferSegment<LogRecord> *buffer_to_serialize) {
   uint64_t num_bytes = 0, num_records = 0;
 
   // Iterate over all redo records in the redo buffer through the provided iterator
@@ -126,24 +172,24 @@ std::pair<uint64_t, uint64_t> LogSerializerTask::SerializeBuffer(
         // If a transaction is read-only, then the only record it generates is its commit record. This commit record is
         // necessary for the transaction's callback function to be invoked, but there is no need to serialize it, as
         // it corresponds to a transaction with nothing to redo.
-        if (!commit_record->IsReadOnly()) num_bytes += SerializeRecord(record);
-        commits_in_buffer_.emplace_back(commit_record->CommitCallback(), commit_record->CommitCallbackArg());
+        if (!commit_record->IsReadOnly()) num_bytes += SerializeRecord(stream, record);
+        stream->commits_.emplace_back(commit_record->CommitCallback(), commit_record->CommitCallbackArg());
         // Once serialization is done, we notify the txn manager to let GC know this txn is ready to clean up
-        serialized_txns_[commit_record->TimestampManager()].push_back(record.TxnBegin());
+        stream->serialized_txns_[commit_record->TimestampManager()].push_back(record.TxnBegin());
         break;
       }
 
       case (LogRecordType::ABORT): {
         // If an abort record shows up at all, the transaction cannot be read-only
-        num_bytes += SerializeRecord(record);
+        num_bytes += SerializeRecord(stream, record);
         auto *abord_record = record.GetUnderlyingRecordBodyAs<AbortRecord>();
-        serialized_txns_[abord_record->TimestampManager()].push_back(record.TxnBegin());
+        stream->serialized_txns_[abord_record->TimestampManager()].push_back(record.TxnBegin());
         break;
       }
 
       default:
         // Any record that is not a commit record is always serialized.`
-        num_bytes += SerializeRecord(record);
+        num_bytes += SerializeRecord(stream, record);
     }
     num_records++;
   }
@@ -151,7 +197,16 @@ std::pair<uint64_t, uint64_t> LogSerializerTask::SerializeBuffer(
   return {num_bytes, num_records};
 }
 
-uint64_t LogSerializerTask::SerializeRecord(const terrier::storage::LogRecord &record) {
+uint64_t LogSerializerTask::SerializeRecord(LogStream *const stream, const terrier::storage::LogRecord &record) {
+  // Segments are only ended between records, so that a segment can be dropped without leaving half a record behind
+  if (segment_size_ != 0 && stream->segment_bytes_ >= segment_size_) {
+    GetCurrentWriteBuffer(stream)->EndSegment(stream->segment_max_txn_begin_);
+    HandFilledBufferToWriter(stream);
+    stream->segment_bytes_ = 0;
+    stream->segment_max_txn_begin_ = transaction::INITIAL_TXN_TIMESTAMP;
+  }
+  stream->segment_max_txn_begin_ = std::max(stream->segment_max_txn_begin_, record.TxnBegin());
+
   uint64_t num_bytes = 0;
   // First, serialize out fields common across all LogRecordType's.
 
@@ -160,23 +215,24 @@ uint64_t LogSerializerTask::SerializeRecord(const terrier::storage::LogRecord &r
   // manager generates in this function. In particular, the later value is very likely to be strictly smaller when the
   // LogRecordType is REDO. On recovery, the goal is to turn the serialized format back into an in-memory log record of
   // this size.
-  num_bytes += WriteValue(record.Size());
+  num_bytes += WriteValue(stream, record.Size());
 
-  num_bytes += WriteValue(record.RecordType());
-  num_bytes += WriteValue(record.TxnBegin());
+  num_bytes += WriteValue(stream, record.RecordType());
+  num_bytes += WriteValue(stream, record.TxnBegin());
 
   switch (record.RecordType()) {
     case LogRecordType::REDO: {
       auto *record_body = record.GetUnderlyingRecordBodyAs<RedoRecord>();
-      num_bytes += WriteValue(record_body->GetDatabaseOid());
-      num_bytes += WriteValue(record_body->GetTableOid());
-      num_bytes += WriteValue(record_body->GetTupleSlot());
+      num_bytes += WriteValue(stream, record_body->GetDatabaseOid());
+      num_bytes += WriteValue(stream, record_body->GetTableOid());
+      num_bytes += WriteValue(stream, record_body->GetTupleSlot());
 
       auto *delta = record_body->Delta();
       // Write out which column ids this redo record is concerned with. On recovery, we can construct the appropriate
       // ProjectedRowInitializer from these ids and their corresponding block layout.
-      num_bytes += WriteValue(delta->NumColumns());
-      num_bytes += WriteValue(delta->ColumnIds(), static_cast<uint32_t>(sizeof(col_id_t)) * delta->NumColumns());
+      num_bytes += WriteValue(stream, delta->NumColumns());
+      num_bytes +=
+          WriteValue(stream, delta->ColumnIds(), static_cast<uint32_t>(sizeof(col_id_t)) * delta->NumColumns());
 
       // Write out the attr sizes boundaries, this way we can deserialize the records without the need of the block
       // layout
@@ -184,10 +240,10 @@ uint64_t LogSerializerTask::SerializeRecord(const terrier::storage::LogRecord &r
       uint16_t boundaries[NUM_ATTR_BOUNDARIES];
       memset(boundaries, 0, sizeof(uint16_t) * NUM_ATTR_BOUNDARIES);
       StorageUtil::ComputeAttributeSizeBoundaries(block_layout, delta->ColumnIds(), delta->NumColumns(), boundaries);
-      WriteValue(boundaries, sizeof(uint16_t) * NUM_ATTR_BOUNDARIES);
+      WriteValue(stream, boundaries, sizeof(uint16_t) * NUM_ATTR_BOUNDARIES);
 
       // Write out the null bitmap.
-      num_bytes += WriteValue(&(delta->Bitmap()), common::RawBitmap::SizeInBytes(delta->NumColumns()));
+      num_bytes += WriteValue(stream, &(delta->Bitmap()), common::RawBitmap::SizeInBytes(delta->NumColumns()));
 
       // Write out attribute values
       for (uint16_t i = 0; i < delta->NumColumns(); i++) {
@@ -204,34 +260,34 @@ uint64_t LogSerializerTask::SerializeRecord(const terrier::storage::LogRecord &r
           // Inline column value is a pointer to a VarlenEntry, so reinterpret as such.
           const auto *varlen_entry = reinterpret_cast<const VarlenEntry *>(column_value_address);
           // Serialize out length of the varlen entry.
-          num_bytes += WriteValue(varlen_entry->Size());
+          num_bytes += WriteValue(stream, varlen_entry->Size());
           if (varlen_entry->IsInlined()) {
             // Serialize out the prefix of the varlen entry.
-            num_bytes += WriteValue(varlen_entry->Prefix(), varlen_entry->Size());
+            num_bytes += WriteValue(stream, varlen_entry->Prefix(), varlen_entry->Size());
           } else {
             // Serialize out the content field of the varlen entry.
-            num_bytes += WriteValue(varlen_entry->Content(), varlen_entry->Size());
+            num_bytes += WriteValue(stream, varlen_entry->Content(), varlen_entry->Size());
           }
         } else {
           // Inline column value is the actual data we want to serialize out.
           // Note that by writing out AttrSize(col_id) bytes instead of just the difference between successive offsets
           // of the delta record, we avoid serializing out any potential padding.
-          num_bytes += WriteValue(column_value_address, block_layout.AttrSize(col_id));
+          num_bytes += WriteValue(stream, column_value_address, block_layout.AttrSize(col_id));
         }
       }
       break;
     }
     case LogRecordType::DELETE: {
       auto *record_body = record.GetUnderlyingRecordBodyAs<DeleteRecord>();
-      num_bytes += WriteValue(record_body->GetDatabaseOid());
-      num_bytes += WriteValue(record_body->GetTableOid());
-      num_bytes += WriteValue(record_body->GetTupleSlot());
+      num_bytes += WriteValue(stream, record_body->GetDatabaseOid());
+      num_bytes += WriteValue(stream, record_body->GetTableOid());
+      num_bytes += WriteValue(stream, record_body->GetTupleSlot());
       break;
     }
     case LogRecordType::COMMIT: {
       auto *record_body = record.GetUnderlyingRecordBodyAs<CommitRecord>();
-      num_bytes += WriteValue(record_body->CommitTime());
-      num_bytes += WriteValue(record_body->OldestActiveTxn());
+      num_bytes += WriteValue(stream, record_body->CommitTime());
+      num_bytes += WriteValue(stream, record_body->OldestActiveTxn());
       break;
     }
     case LogRecordType::ABORT: {
@@ -240,12 +296,13 @@ uint64_t LogSerializerTask::SerializeRecord(const terrier::storage::LogRecord &r
     }
   }
 
+  stream->segment_bytes_ += num_bytes;
   return num_bytes;
 }
 
-uint32_t LogSerializerTask::WriteValue(const void *val, const uint32_t size) {
+uint32_t LogSerializerTask::WriteValue(LogStream *const stream, const void *val, const uint32_t size) {
   // Serialize the value and copy it to the buffer
-  BufferedLogWriter *out = GetCurrentWriteBuffer();
+  BufferedLogWriter *out = GetCurrentWriteBuffer(stream);
   uint32_t size_written = 0;
 
   while (size_written < size) {
@@ -253,9 +310,9 @@ uint32_t LogSerializerTask::WriteValue(const void *val, const uint32_t size) {
     size_written += out->BufferWrite(val_byte, size - size_written);
     if (out->IsBufferFull()) {
       // Mark the buffer full for the disk log consumer task thread to flush it
-      HandFilledBufferToWriter();
+      HandFilledBufferToWriter(stream);
       // Get an empty buffer for writing this value
-      out = GetCurrentWriteBuffer();
+      out = GetCurrentWriteBuffer(stream);
     }
   }
   return size;
@@ -46,13 +46,23 @@ void TrafficCop::EndTransaction(const common::ManagedPointer<network::Connection
   if (query_type == network::QueryType::QUERY_COMMIT) {
     TERRIER_ASSERT(connection_ctx->TransactionState() == network::NetworkTransactionStateType::BLOCK,
                    "Invalid ConnectionContext state, not in a transaction that can be committed.");
-    // Set up a blocking callback. Will be invoked when we can tell the client that commit is complete.
-    std::promise<bool> promise;
-    auto future = promise.get_future();
-    TERRIER_ASSERT(future.valid(), "future must be valid for synchronization to work.");
-    txn_manager_->Commit(txn.Get(), CommitCallback, &promise);
-    future.wait();
-    TERRIER_ASSERT(future.get(), "Got past the wait() without the value being set to true. That's weird.");
+    if (connection_ctx->Callback() != nullptr) {
+      // The commit is visible to other txns once Commit returns, only the response to the client has to wait until it
+      // is durable. Instead of blocking the thread until then, the ConnectionHandle holds back the response and gets
+      // woken up by its callback, so that the thread can serve other connections in the meantime.
+      connection_ctx->SetCommitPending(true);
+      // Counted before the commit is issued, since the callback may run before Commit returns
+      connection_ctx->PendingCommits()->fetch_add(1);
+      txn_manager_->Commit(txn.Get(), connection_ctx->Callback(), connection_ctx->CallbackArg());
+    } else {
+      // Set up a blocking callback. Will be invoked when we can tell the client that commit is complete.
+      std::promise<bool> promise;
+      auto future = promise.get_future();
+      TERRIER_ASSERT(future.valid(), "future must be valid for synchronization to work.");
+      txn_manager_->Commit(txn.Get(), CommitCallback, &promise);
+      future.wait();
+      TERRIER_ASSERT(future.get(), "Got past the wait() without the value being set to true. That's weird.");
+    }
   } else {
     TERRIER_ASSERT(connection_ctx->TransactionState() != network::NetworkTransactionStateType::IDLE,
                    "Invalid ConnectionContext state, not in a transaction that can be aborted.");
@@ -62,6 +72,8 @@ void TrafficCop::EndTransaction(const common::ManagedPointer<network::Connection
   connection_ctx->SetAccessor(nullptr);
 }
 
+void TrafficCop::FlushLog() const { txn_manager_->FlushLog(); }
+
 void TrafficCop::HandBufferToReplication(std::unique_ptr<network::ReadBuffer> buffer) {
   TERRIER_ASSERT(replication_log_provider_ != DISABLED, "Should not be handing off logs if no log provider was given");
   replication_log_provider_->HandBufferToReplication(std::move(buffer));
@@ -330,7 +342,8 @@ void TrafficCop::CodegenAndRunPhysicalPlan(const common::ManagedPointer<network:
       connection_ctx->GetDatabaseOid(), connection_ctx->Transaction(), writer, physical_plan->GetOutputSchema().Get(),
       connection_ctx->Accessor());
 
-  auto exec_query = execution::ExecutableQuery(common::ManagedPointer(physical_plan), common::ManagedPointer(exec_ctx));
+  auto exec_query = execution::ExecutableQuery(common::ManagedPointer(physical_plan), common::ManagedPointer(exec_ctx),
+                                               parallel_execution_);
 
   if (query_type == network::QueryType::QUERY_SELECT)
     out->WriteRowDescription(physical_plan->GetOutputSchema()->GetColumns());
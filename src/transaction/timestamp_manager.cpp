@@ -1,30 +1,85 @@
 #include "transaction/timestamp_manager.h"
 #include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
 #include <vector>
 
 namespace terrier::transaction {
 
+timestamp_t TimestampManager::BeginTransaction() {
+  // There is a three-way race that needs to be prevented.  Specifically, we cannot allow both a transaction to commit
+  // and the GC to poll for the oldest running transaction in between this transaction acquiring its begin timestamp and
+  // getting inserted into the current running transactions set. Before acquiring the timestamp, the transaction
+  // therefore announces a lower bound of it in a begin slot, which it only clears once it is in the set. A poll reads
+  // the time first and the begin slots before the shards, so it either sees the announcement, or the transaction in
+  // its shard, or the transaction started after the time it read.
+  const uint64_t hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  BeginSlot *slot;
+  for (uint64_t i = hash;; i++) {
+    slot = &begin_slots_[i % NUM_BEGIN_SLOTS];
+    timestamp_t expected = FREE_SLOT;
+    if (slot->lower_bound_.load(std::memory_order_relaxed) == FREE_SLOT &&
+        slot->lower_bound_.compare_exchange_strong(expected, time_.load())) {
+      break;
+    }
+  }
+
+  const timestamp_t start_time = time_++;
+  Shard *const shard = &shards_[ShardOf(start_time)];
+  {
+    common::SpinLatch::ScopedSpinLatch guard(&shard->latch_);
+    const size_t num_running UNUSED_ATTRIBUTE = shard->running_txns_.size();
+    shard->running_txns_.emplace_hint(shard->running_txns_.end(), start_time);
+    TERRIER_ASSERT(shard->running_txns_.size() == num_running + 1, "commit start time should be globally unique");
+  }
+  slot->lower_bound_.store(FREE_SLOT);
+  return start_time;
+}
+
 timestamp_t TimestampManager::OldestTransactionStartTime() {
-  common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-  const auto &oldest_txn = std::min_element(curr_running_txns_.cbegin(), curr_running_txns_.cend());
-  timestamp_t result = (oldest_txn != curr_running_txns_.end()) ? *oldest_txn : time_.load();
+  timestamp_t result = time_.load();
+  for (const auto &slot : begin_slots_) {
+    const timestamp_t lower_bound = slot.lower_bound_.load();
+    if (lower_bound != FREE_SLOT) result = std::min(result, lower_bound);
+  }
+  for (auto &shard : shards_) {
+    common::SpinLatch::ScopedSpinLatch guard(&shard.latch_);
+    if (!shard.running_txns_.empty()) result = std::min(result, *shard.running_txns_.cbegin());
+  }
   cached_oldest_txn_start_time_.store(result);  // Cache the timestamp
   return result;
 }
 
 timestamp_t TimestampManager::CachedOldestTransactionStartTime() { return cached_oldest_txn_start_time_.load(); }
 
+timestamp_t TimestampManager::RecentOldestTransactionStartTime() {
+  const timestamp_t now = time_.load();
+  timestamp_t refresh_time = cache_refresh_time_.load();
+  // Whoever wins the CAS refreshes, everyone else makes do with the cached timestamp until then
+  if (!now - !refresh_time > CACHE_REFRESH_INTERVAL && cache_refresh_time_.compare_exchange_strong(refresh_time, now))
+    return OldestTransactionStartTime();
+  return cached_oldest_txn_start_time_.load();
+}
+
 void TimestampManager::RemoveTransaction(timestamp_t timestamp) {
-  common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-  const size_t ret UNUSED_ATTRIBUTE = curr_running_txns_.erase(timestamp);
+  Shard *const shard = &shards_[ShardOf(timestamp)];
+  common::SpinLatch::ScopedSpinLatch guard(&shard->latch_);
+  const size_t ret UNUSED_ATTRIBUTE = shard->running_txns_.erase(timestamp);
   TERRIER_ASSERT(ret == 1, "erased timestamp did not exist");
 }
 
 void TimestampManager::RemoveTransactions(const std::vector<terrier::transaction::timestamp_t> &timestamps) {
-  common::SpinLatch::ScopedSpinLatch guard(&curr_running_txns_latch_);
-  for (const auto &timestamp : timestamps) {
-    const size_t ret UNUSED_ATTRIBUTE = curr_running_txns_.erase(timestamp);
-    TERRIER_ASSERT(ret == 1, "erased timestamp did not exist");
+  // Group the timestamps by shard, so that each latch is taken once
+  std::vector<timestamp_t> sorted(timestamps);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const timestamp_t a, const timestamp_t b) { return ShardOf(a) < ShardOf(b); });
+  for (auto it = sorted.cbegin(); it != sorted.cend();) {
+    Shard *const shard = &shards_[ShardOf(*it)];
+    common::SpinLatch::ScopedSpinLatch guard(&shard->latch_);
+    for (; it != sorted.cend() && &shards_[ShardOf(*it)] == shard; it++) {
+      const size_t ret UNUSED_ATTRIBUTE = shard->running_txns_.erase(*it);
+      TERRIER_ASSERT(ret == 1, "erased timestamp did not exist");
+    }
   }
 }
 
@@ -14,7 +14,8 @@ TransactionContext *TransactionManager::BeginTransaction() {
   TransactionContext *result;
   {
     start_time = timestamp_manager_->BeginTransaction();
-    result = new TransactionContext(start_time, start_time + INT64_MIN, buffer_pool_, log_manager_);
+    result = new TransactionContext(start_time, start_time + INT64_MIN, buffer_pool_, log_manager_,
+                                    timestamp_manager_);
     // Ensure we do not return from this function if there are ongoing write commits
     if (common::thread_context.metrics_store_ != nullptr &&
         common::thread_context.metrics_store_->ComponentEnabled(metrics::MetricsComponent::TRANSACTION))
@@ -106,7 +107,8 @@ timestamp_t TransactionManager::Commit(TransactionContext *const txn, transactio
 
     // We hand off txn to GC, however, it won't be GC'd until the LogManager marks it as serialized
     if (gc_enabled_) {
-      common::SpinLatch::ScopedSpinLatch guard(&timestamp_manager_->curr_running_txns_latch_);
+      // The GC only unlinks versions older than the oldest txn it polled, so the queue needs no ordering with begins
+      common::SpinLatch::ScopedSpinLatch guard(&completed_txns_latch_);
       // It is not necessary to have to GC process read-only transactions, but it's probably faster to call free off
       // the critical path there anyway
       // Also note here that GC will figure out what varlen entries to GC, as opposed to in the abort case.
@@ -181,7 +183,7 @@ timestamp_t TransactionManager::Abort(TransactionContext *const txn) {
 
   // We hand off txn to GC, however, it won't be GC'd until the LogManager marks it as serialized
   if (gc_enabled_) {
-    common::SpinLatch::ScopedSpinLatch guard(&timestamp_manager_->curr_running_txns_latch_);
+    common::SpinLatch::ScopedSpinLatch guard(&completed_txns_latch_);
     // It is not necessary to have to GC process read-only transactions, but it's probably faster to call free off
     // the critical path there anyway
     // Also note here that GC will figure out what varlen entries to GC, as opposed to in the abort case.
@@ -226,7 +228,7 @@ void TransactionManager::GCLastUpdateOnAbort(TransactionContext *const txn) {
 }
 
 TransactionQueue TransactionManager::CompletedTransactionsForGC() {
-  common::SpinLatch::ScopedSpinLatch guard(&timestamp_manager_->curr_running_txns_latch_);
+  common::SpinLatch::ScopedSpinLatch guard(&completed_txns_latch_);
   return std::move(completed_txns_);
 }
 
@@ -65,6 +65,36 @@ class DDLExecutorsTests : public TerrierTest {
 
   transaction::TransactionContext *txn_;
   std::unique_ptr<catalog::CatalogAccessor> accessor_;
+
+  /**
+   * Creates a table from table_schema_ for the index tests to build indexes on
+   * @return oid of the new table
+   */
+  catalog::table_oid_t CreateIndexedTable() {
+    planner::CreateTablePlanNode::Builder builder;
+    auto create_table_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
+                                 .SetTableSchema(std::move(table_schema_))
+                                 .SetTableName("bar")
+                                 .SetBlockStore(block_store_)
+                                 .Build();
+    EXPECT_TRUE(execution::sql::DDLExecutors::CreateTableExecutor(
+        common::ManagedPointer<planner::CreateTablePlanNode>(create_table_node),
+        common::ManagedPointer<catalog::CatalogAccessor>(accessor_), db_));
+    return accessor_->GetTableOid(CatalogTestUtil::TEST_NAMESPACE_OID, "bar");
+  }
+
+  /**
+   * Inserts a tuple into a table created by CreateIndexedTable
+   * @param table_oid oid of the table
+   * @param value value of the tuple's only attribute
+   */
+  void InsertIntoIndexedTable(const catalog::table_oid_t table_oid, const int32_t value) {
+    auto table = accessor_->GetTable(table_oid);
+    const auto initializer = table->InitializerForProjectedRow({catalog::col_oid_t(1)});
+    auto *const redo = txn_->StageWrite(db_, table_oid, initializer);
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(0)) = value;
+    table->Insert(common::ManagedPointer(txn_), redo);
+  }
 };
 
 // NOLINTNEXTLINE
@@ -252,9 +282,10 @@ TEST_F(DDLExecutorsTests, CreateTablePlanNodePKeyNameConflict) {
 
 // NOLINTNEXTLINE
 TEST_F(DDLExecutorsTests, CreateIndexPlanNode) {
+  const auto table_oid = CreateIndexedTable();
   planner::CreateIndexPlanNode::Builder builder;
   auto create_index_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
-                               .SetTableOid(CatalogTestUtil::TEST_TABLE_OID)
+                               .SetTableOid(table_oid)
                                .SetSchema(std::move(index_schema_))
                                .SetIndexName("foo")
                                .Build();
@@ -270,9 +301,10 @@ TEST_F(DDLExecutorsTests, CreateIndexPlanNode) {
 
 // NOLINTNEXTLINE
 TEST_F(DDLExecutorsTests, CreateIndexPlanNodeAbort) {
+  const auto table_oid = CreateIndexedTable();
   planner::CreateIndexPlanNode::Builder builder;
   auto create_index_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
-                               .SetTableOid(CatalogTestUtil::TEST_TABLE_OID)
+                               .SetTableOid(table_oid)
                                .SetSchema(std::move(index_schema_))
                                .SetIndexName("foo")
                                .Build();
@@ -288,9 +320,10 @@ TEST_F(DDLExecutorsTests, CreateIndexPlanNodeAbort) {
 
 // NOLINTNEXTLINE
 TEST_F(DDLExecutorsTests, CreateIndexPlanNodeIndexNameConflict) {
+  const auto table_oid = CreateIndexedTable();
   planner::CreateIndexPlanNode::Builder builder;
   auto create_index_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
-                               .SetTableOid(CatalogTestUtil::TEST_TABLE_OID)
+                               .SetTableOid(table_oid)
                                .SetSchema(std::move(index_schema_))
                                .SetIndexName("foo")
                                .Build();
@@ -307,6 +340,58 @@ TEST_F(DDLExecutorsTests, CreateIndexPlanNodeIndexNameConflict) {
   txn_manager_->Abort(txn_);
 }
 
+// Creating an index on a table that already holds tuples populates the index with them
+// NOLINTNEXTLINE
+TEST_F(DDLExecutorsTests, CreateIndexPlanNodeExistingTable) {
+  const int32_t num_tuples = 1000;
+  const auto table_oid = CreateIndexedTable();
+  for (int32_t i = 0; i < num_tuples; i++) InsertIntoIndexedTable(table_oid, i);
+
+  planner::CreateIndexPlanNode::Builder builder;
+  auto create_index_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
+                               .SetTableOid(table_oid)
+                               .SetSchema(std::move(index_schema_))
+                               .SetIndexName("foo")
+                               .Build();
+  EXPECT_TRUE(execution::sql::DDLExecutors::CreateIndexExecutor(
+      common::ManagedPointer<planner::CreateIndexPlanNode>(create_index_node),
+      common::ManagedPointer<catalog::CatalogAccessor>(accessor_)));
+  auto index_ptr = accessor_->GetIndex(accessor_->GetIndexOid(CatalogTestUtil::TEST_NAMESPACE_OID, "foo"));
+  EXPECT_NE(index_ptr, nullptr);
+
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index_ptr->GetProjectedRowInitializer().ProjectedRowSize());
+  auto *const key = index_ptr->GetProjectedRowInitializer().InitializeRow(key_buffer);
+  std::vector<storage::TupleSlot> results;
+  for (int32_t i = 0; i <= num_tuples; i++) {
+    *reinterpret_cast<int32_t *>(key->AccessForceNotNull(0)) = i;
+    index_ptr->ScanKey(*txn_, *key, &results);
+    EXPECT_EQ(results.size(), i < num_tuples ? 1 : 0);
+    results.clear();
+  }
+  delete[] key_buffer;
+  txn_manager_->Commit(txn_, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
+// Creating a unique index on a table whose tuples violate the uniqueness constraint fails
+// NOLINTNEXTLINE
+TEST_F(DDLExecutorsTests, CreateIndexPlanNodeUniqueViolation) {
+  const auto table_oid = CreateIndexedTable();
+  InsertIntoIndexedTable(table_oid, 15721);
+  InsertIntoIndexedTable(table_oid, 15721);
+
+  planner::CreateIndexPlanNode::Builder builder;
+  auto create_index_node = builder.SetNamespaceOid(CatalogTestUtil::TEST_NAMESPACE_OID)
+                               .SetTableOid(table_oid)
+                               .SetSchema(std::move(index_schema_))
+                               .SetIndexName("foo")
+                               .Build();
+  EXPECT_FALSE(execution::sql::DDLExecutors::CreateIndexExecutor(
+      common::ManagedPointer<planner::CreateIndexPlanNode>(create_index_node),
+      common::ManagedPointer<catalog::CatalogAccessor>(accessor_)));
+  txn_manager_->Abort(txn_);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DDLExecutorsTests, DropTablePlanNode) {
   planner::CreateTablePlanNode::Builder create_builder;
@@ -6,6 +6,7 @@
 
 #include "catalog/catalog_defs.h"
 #include "execution/sql/table_vector_iterator.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/util/timer.h"
 
 namespace terrier::execution::sql::test {
@@ -129,4 +130,65 @@ TEST_F(TableVectorIteratorTest, IteratorColOidsTest) {
   EXPECT_EQ(sql::TEST2_SIZE, num_tuples);
 }
 
+// NOLINTNEXTLINE
+TEST_F(TableVectorIteratorTest, ParallelScanTest) {
+  //
+  // Ensure that a parallel scan visits every tuple of the table exactly once
+  //
+
+  struct Counter {
+    uint32_t num_tuples_;
+    int64_t sum_;
+  };
+
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "test_1");
+  std::array<uint32_t, 1> col_oids{1};
+
+  // Count and sum the values with a serial scan first
+  Counter expected{0, 0};
+  TableVectorIterator iter(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+  iter.Init();
+  ProjectedColumnsIterator *pci = iter.GetProjectedColumnsIterator();
+  while (iter.Advance()) {
+    for (; pci->HasNext(); pci->Advance()) {
+      expected.num_tuples_++;
+      expected.sum_ += *pci->Get<int32_t, false>(0, nullptr);
+    }
+    pci->Reset();
+  }
+  EXPECT_EQ(sql::TEST1_SIZE, expected.num_tuples_);
+
+  ThreadStateContainer thread_states(exec_ctx_->GetMemoryPool());
+  thread_states.Reset(
+      sizeof(Counter), [](UNUSED_ATTRIBUTE auto *_, auto *s) { new (s) Counter{0, 0}; }, nullptr, nullptr);
+  auto scan_fn = [](UNUSED_ATTRIBUTE void *query_state, void *thread_state, TableVectorIterator *tvi) {
+    auto *counter = reinterpret_cast<Counter *>(thread_state);
+    ProjectedColumnsIterator *pci = tvi->GetProjectedColumnsIterator();
+    while (tvi->Advance()) {
+      for (; pci->HasNext(); pci->Advance()) {
+        counter->num_tuples_++;
+        counter->sum_ += *pci->Get<int32_t, false>(0, nullptr);
+      }
+      pci->Reset();
+    }
+  };
+  EXPECT_TRUE(TableVectorIterator::ParallelScan(exec_ctx_.get(), !table_oid, col_oids.data(),
+                                                static_cast<uint32_t>(col_oids.size()), nullptr, &thread_states,
+                                                scan_fn, 1));
+
+  Counter actual{0, 0};
+  thread_states.ForEach<Counter>([&](Counter *counter) {
+    actual.num_tuples_ += counter->num_tuples_;
+    actual.sum_ += counter->sum_;
+  });
+  EXPECT_EQ(expected.num_tuples_, actual.num_tuples_);
+  EXPECT_EQ(expected.sum_, actual.sum_);
+
+  // Scanning an empty table never calls the scan function
+  auto empty_table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "empty_table");
+  EXPECT_TRUE(TableVectorIterator::ParallelScan(
+      exec_ctx_.get(), !empty_table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()), nullptr,
+      &thread_states, [](void *, void *, TableVectorIterator *) { FAIL(); }));
+}
+
 }  // namespace terrier::execution::sql::test
@@ -200,4 +200,45 @@ TEST_F(MetricsTests, TransactionCSVTest) {
 
   metrics_manager_->UnregisterThread();
 }
+
+/**
+ *  Testing garbage collection metric stats collection and persistence, single thread
+ */
+// NOLINTNEXTLINE
+TEST_F(MetricsTests, GarbageCollectionCSVTest) {
+  for (const auto &file : metrics::GarbageCollectionMetricRawData::FILES) unlink(std::string(file).c_str());
+  const settings::setter_callback_fn setter_callback = MetricsTests::EmptySetterCallback;
+  auto action_context = std::make_unique<common::ActionContext>(common::action_id_t(1));
+  settings_manager_->SetBool(settings::Param::metrics_gc, true, common::ManagedPointer(action_context),
+                             setter_callback);
+  const auto gc = db_main_->GetStorageLayer()->GetGarbageCollector();
+
+  metrics_manager_->RegisterThread();
+
+  Insert();
+  gc->PerformGarbageCollection();
+
+  metrics_manager_->Aggregate();
+  const auto aggregated_data = reinterpret_cast<GarbageCollectionMetricRawData *>(
+      metrics_manager_->AggregatedMetrics().at(static_cast<uint8_t>(MetricsComponent::GARBAGECOLLECTION)).get());
+  EXPECT_NE(aggregated_data, nullptr);
+  EXPECT_EQ(aggregated_data->gc_data_.size(), 1U);  // 1 GC invocation recorded
+  metrics_manager_->ToCSV();
+  EXPECT_EQ(aggregated_data->gc_data_.size(), 0U);
+
+  Insert();
+  gc->PerformGarbageCollection();
+  gc->PerformGarbageCollection();
+
+  metrics_manager_->Aggregate();
+  EXPECT_EQ(aggregated_data->gc_data_.size(), 2U);  // 2 GC invocations recorded
+  metrics_manager_->ToCSV();
+  EXPECT_EQ(aggregated_data->gc_data_.size(), 0U);
+
+  action_context = std::make_unique<common::ActionContext>(common::action_id_t(2));
+  settings_manager_->SetBool(settings::Param::metrics_gc, false, common::ManagedPointer(action_context),
+                             setter_callback);
+
+  metrics_manager_->UnregisterThread();
+}
 }  // namespace terrier::metrics
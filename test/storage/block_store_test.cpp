@@ -0,0 +1,115 @@
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/storage_defs.h"
+#include "test_util/multithread_test_util.h"
+#include "test_util/random_test_util.h"
+
+namespace terrier {
+
+// New blocks should be aligned to their size, as TupleSlot relies on this, and come zeroed from the OS
+// NOLINTNEXTLINE
+TEST(BlockStoreTests, AlignedAndZeroed) {
+  const uint64_t num_blocks = 100;
+  storage::BlockStore tested(num_blocks, num_blocks);
+  std::unordered_set<storage::RawBlock *> blocks;
+  for (uint64_t i = 0; i < num_blocks; i++) {
+    storage::RawBlock *block = tested.Get();
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % common::Constants::BLOCK_SIZE);
+    EXPECT_TRUE(blocks.insert(block).second);
+    EXPECT_EQ(nullptr, block->data_table_);
+    EXPECT_EQ(static_cast<byte>(0), block->content_[sizeof(block->content_) - 1]);
+    // Write to the whole block, which should not overlap with any other block
+    std::memset(block->content_, 0xFF, sizeof(block->content_));
+  }
+  EXPECT_THROW(tested.Get(), common::NoMoreObjectException);
+  for (auto *block : blocks) tested.Release(block);
+}
+
+// Released blocks should be handed out again, whether or not their memory was given back to the OS in between
+// NOLINTNEXTLINE
+TEST(BlockStoreTests, Reuse) {
+  const uint32_t repeat = 10;
+  storage::BlockStore reusing(1, 1);
+  storage::RawBlock *reused = reusing.Get();
+  reusing.Release(reused);
+  for (uint32_t i = 0; i < repeat; i++) {
+    storage::RawBlock *block = reusing.Get();
+    EXPECT_EQ(reused, block);
+    EXPECT_THROW(reusing.Get(), common::NoMoreObjectException);
+    reusing.Release(block);
+  }
+
+  // Without reuse, the address is still recycled but the memory is zeroed again
+  storage::BlockStore unbacking(1, 0);
+  storage::RawBlock *unbacked = unbacking.Get();
+  unbacked->content_[0] = static_cast<byte>(42);
+  unbacking.Release(unbacked);
+  for (uint32_t i = 0; i < repeat; i++) {
+    storage::RawBlock *block = unbacking.Get();
+    EXPECT_EQ(unbacked, block);
+    EXPECT_EQ(static_cast<byte>(0), block->content_[0]);
+    block->content_[0] = static_cast<byte>(42);
+    unbacking.Release(block);
+  }
+}
+
+// Shrinking the limits should give back memory and refuse to shrink below what is in use
+// NOLINTNEXTLINE
+TEST(BlockStoreTests, ResetLimit) {
+  const uint64_t size_limit = 10;
+  storage::BlockStore tested(size_limit, size_limit);
+  std::vector<storage::RawBlock *> blocks;
+  for (uint64_t i = 0; i < size_limit; i++) blocks.push_back(tested.Get());
+  EXPECT_FALSE(tested.SetSizeLimit(size_limit / 2));
+  for (auto *block : blocks) tested.Release(block);
+
+  tested.SetReuseLimit(size_limit / 2);
+  EXPECT_TRUE(tested.SetSizeLimit(size_limit / 2));
+  EXPECT_EQ(size_limit / 2, tested.GetSizeLimit());
+  blocks.clear();
+  for (uint64_t i = 0; i < size_limit / 2; i++) blocks.push_back(tested.Get());
+  EXPECT_THROW(tested.Get(), common::NoMoreObjectException);
+  for (auto *block : blocks) tested.Release(block);
+}
+
+// Threads getting and releasing blocks at random should never be handed the same block at the same time
+// NOLINTNEXTLINE
+TEST(BlockStoreTests, ConcurrentCorrectness) {
+  const uint64_t size_limit = 100;
+  const uint64_t reuse_limit = 50;
+  storage::BlockStore tested(size_limit, reuse_limit);
+  auto workload = [&](uint32_t tid) {
+    std::default_random_engine generator;
+    std::vector<storage::RawBlock *> blocks;
+    auto allocate = [&] {
+      try {
+        storage::RawBlock *block = tested.Get();
+        // Mark the block with the thread using it, using a field the store does not touch
+        block->insert_head_ = tid;
+        blocks.push_back(block);
+      } catch (common::NoMoreObjectException &) {
+        // Other threads hold all the blocks, which is fine
+      }
+    };
+    auto free = [&] {
+      if (!blocks.empty()) {
+        auto pos = RandomTestUtil::UniformRandomElement(&blocks, &generator);
+        EXPECT_EQ(tid, (*pos)->insert_head_.load());
+        tested.Release(*pos);
+        blocks.erase(pos);
+      }
+    };
+    RandomTestUtil::InvokeWorkloadWithDistribution({free, allocate}, {0.5, 0.5}, &generator, 1000);
+    for (auto *block : blocks) {
+      EXPECT_EQ(tid, block->insert_head_.load());
+      tested.Release(block);
+    }
+  };
+  common::WorkerPool thread_pool(MultiThreadTestUtil::HardwareConcurrency(), {});
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, MultiThreadTestUtil::HardwareConcurrency(), workload, 100);
+}
+
+}  // namespace terrier
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include <limits>
@@ -27,7 +28,7 @@
 namespace terrier::storage::index {
 
 class BPlusTreeIndexTests : public TerrierTest {
- private:
+ protected:
   catalog::Schema table_schema_;
   catalog::IndexSchema unique_schema_;
   catalog::IndexSchema default_schema_;
@@ -247,6 +248,135 @@ TEST_F(BPlusTreeIndexTests, DefaultInsert) {
   txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
 }
 
+/**
+ * Populates new indexes from a table that already holds tuples, only some of which are visible to the txn building the
+ * index.
+ */
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTests, BulkInsert) {
+  const int32_t num_keys = 10000;
+  // Every key is inserted twice
+  auto *const insert_txn = txn_manager_->BeginTransaction();
+  for (int32_t i = 0; i < 2 * num_keys; i++) {
+    auto *const insert_redo =
+        insert_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+    *reinterpret_cast<int32_t *>(insert_redo->Delta()->AccessForceNotNull(0)) = i % num_keys;
+    sql_table_->Insert(common::ManagedPointer(insert_txn), insert_redo);
+  }
+  txn_manager_->Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // This tuple is not visible to the txn that builds the index
+  auto *const uncommitted_txn = txn_manager_->BeginTransaction();
+  auto *const uncommitted_redo =
+      uncommitted_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+  *reinterpret_cast<int32_t *>(uncommitted_redo->Delta()->AccessForceNotNull(0)) = num_keys;
+  sql_table_->Insert(common::ManagedPointer(uncommitted_txn), uncommitted_redo);
+
+  auto *const build_txn = txn_manager_->BeginTransaction();
+
+  // The duplicate keys violate the uniqueness constraint
+  IndexBuilder unique_builder;
+  unique_builder.SetKeySchema(unique_schema_);
+  auto *const unique_index = unique_builder.Build();
+  EXPECT_FALSE(unique_builder.BulkInsert(unique_index, common::ManagedPointer(sql_table_),
+                                         common::ManagedPointer(build_txn)));
+  delete unique_index;
+
+  IndexBuilder default_builder;
+  default_builder.SetKeySchema(default_schema_).SetBulkLoadFillFactor(0.5);
+  auto *const index = default_builder.Build();
+  EXPECT_TRUE(default_builder.BulkInsert(index, common::ManagedPointer(sql_table_), common::ManagedPointer(build_txn)));
+
+  std::vector<storage::TupleSlot> results;
+  auto *const key_pr = index->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+  for (int32_t i = 0; i <= num_keys; i++) {
+    *reinterpret_cast<int32_t *>(key_pr->AccessForceNotNull(0)) = i;
+    index->ScanKey(*build_txn, *key_pr, &results);
+    EXPECT_EQ(results.size(), i < num_keys ? 2 : 0);
+    results.clear();
+  }
+
+  // The bulk loaded index supports regular inserts
+  auto *const insert_redo =
+      build_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+  *reinterpret_cast<int32_t *>(insert_redo->Delta()->AccessForceNotNull(0)) = 0;
+  const auto tuple_slot = sql_table_->Insert(common::ManagedPointer(build_txn), insert_redo);
+  *reinterpret_cast<int32_t *>(key_pr->AccessForceNotNull(0)) = 0;
+  EXPECT_TRUE(index->Insert(common::ManagedPointer(build_txn), *key_pr, tuple_slot));
+  index->ScanKey(*build_txn, *key_pr, &results);
+  EXPECT_EQ(results.size(), 3);
+
+  txn_manager_->Commit(build_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn_manager_->Abort(uncommitted_txn);
+  db_main_->GetTransactionLayer()->GetDeferredActionManager()->RegisterDeferredAction([=]() { delete index; });
+}
+
+/**
+ * Batched lookups return the same visible values as looking up every key on its own
+ */
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTests, ScanKeyBatch) {
+  const int32_t num_keys = 1000;
+  auto *const insert_txn = txn_manager_->BeginTransaction();
+  auto *const key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+  // Every even key is inserted twice, every odd key once
+  for (int32_t i = 0; i < num_keys + num_keys / 2; i++) {
+    const int32_t key = i < num_keys ? i : 2 * (i - num_keys);
+    auto *const insert_redo =
+        insert_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+    *reinterpret_cast<int32_t *>(insert_redo->Delta()->AccessForceNotNull(0)) = key;
+    const auto tuple_slot = sql_table_->Insert(common::ManagedPointer(insert_txn), insert_redo);
+    *reinterpret_cast<int32_t *>(key_pr->AccessForceNotNull(0)) = key;
+    EXPECT_TRUE(default_index_->Insert(common::ManagedPointer(insert_txn), *key_pr, tuple_slot));
+  }
+  txn_manager_->Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // This key is not visible to other txns
+  auto *const uncommitted_txn = txn_manager_->BeginTransaction();
+  auto *const uncommitted_redo =
+      uncommitted_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+  *reinterpret_cast<int32_t *>(uncommitted_redo->Delta()->AccessForceNotNull(0)) = num_keys;
+  const auto uncommitted_slot = sql_table_->Insert(common::ManagedPointer(uncommitted_txn), uncommitted_redo);
+  *reinterpret_cast<int32_t *>(key_pr->AccessForceNotNull(0)) = num_keys;
+  EXPECT_TRUE(default_index_->Insert(common::ManagedPointer(uncommitted_txn), *key_pr, uncommitted_slot));
+
+  // Random keys, some out of range, followed by the uncommitted key
+  const auto key_size = default_index_->GetProjectedRowInitializer().ProjectedRowSize();
+  const uint32_t batch_size = 256;
+  std::vector<uint64_t> key_buffer((batch_size + 1) * ((key_size + 7) / 8));
+  std::vector<const ProjectedRow *> keys;
+  std::uniform_int_distribution<int32_t> dist(-10, num_keys + 10);
+  for (uint32_t i = 0; i <= batch_size; i++) {
+    auto *const batch_key =
+        default_index_->GetProjectedRowInitializer().InitializeRow(&key_buffer[i * ((key_size + 7) / 8)]);
+    *reinterpret_cast<int32_t *>(batch_key->AccessForceNotNull(0)) = i < batch_size ? dist(generator_) : num_keys;
+    keys.emplace_back(batch_key);
+  }
+
+  auto *const scan_txn = txn_manager_->BeginTransaction();
+  for (auto *const txn : {scan_txn, uncommitted_txn}) {
+    std::vector<TupleSlot> results;
+    std::vector<uint32_t> offsets;
+    default_index_->ScanKeyBatch(*txn, keys, &results, &offsets);
+    ASSERT_EQ(offsets.size(), keys.size() + 1);
+    EXPECT_EQ(offsets.back(), results.size());
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      std::vector<TupleSlot> expected;
+      default_index_->ScanKey(*txn, *keys[i], &expected);
+      std::vector<TupleSlot> batch_results(results.begin() + offsets[i], results.begin() + offsets[i + 1]);
+      EXPECT_EQ(batch_results.size(), expected.size());
+      for (const auto &slot : expected) {
+        EXPECT_NE(std::find(batch_results.begin(), batch_results.end(), slot), batch_results.end());
+      }
+    }
+    // Only the txn that inserted the last key sees it
+    EXPECT_EQ(offsets[batch_size + 1] - offsets[batch_size], txn == uncommitted_txn ? 1 : 0);
+  }
+
+  txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  txn_manager_->Abort(uncommitted_txn);
+}
+
 /**
  * Tests basic scan behavior using various windows to scan over (some out of of bounds of keyspace, some matching
  * exactly, etc.)
@@ -532,6 +662,75 @@ TEST_F(BPlusTreeIndexTests, ScanLimitDescending) {
   txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
 }
 
+/**
+ * Tests that scan cursors return a range spanning many leaves in batches, in both directions, and stop at their limit
+ */
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeIndexTests, ScanCursor) {
+  const int32_t num_keys = 10000;
+  std::vector<storage::TupleSlot> reference;
+  auto *const insert_txn = txn_manager_->BeginTransaction();
+  for (int32_t i = 0; i < num_keys; i++) {
+    auto *const insert_redo =
+        insert_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+    *reinterpret_cast<int32_t *>(insert_redo->Delta()->AccessForceNotNull(0)) = i;
+    const auto tuple_slot = sql_table_->Insert(common::ManagedPointer(insert_txn), insert_redo);
+
+    auto *const insert_key = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+    *reinterpret_cast<int32_t *>(insert_key->AccessForceNotNull(0)) = i;
+    EXPECT_TRUE(default_index_->Insert(common::ManagedPointer(insert_txn), *insert_key, tuple_slot));
+    reference.emplace_back(tuple_slot);
+  }
+  txn_manager_->Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  auto *const scan_txn = txn_manager_->BeginTransaction();
+  auto *const low_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+  auto *const high_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_2_);
+  *reinterpret_cast<int32_t *>(low_key_pr->AccessForceNotNull(0)) = 100;
+  *reinterpret_cast<int32_t *>(high_key_pr->AccessForceNotNull(0)) = 8999;
+
+  // The keys are copied, so the ProjectedRows can be reused while the cursors are open
+  auto ascending = default_index_->OpenAscendingCursor(*scan_txn, ScanType::Closed, 1, low_key_pr, high_key_pr, 0);
+  auto descending = default_index_->OpenDescendingCursor(*scan_txn, *low_key_pr, *high_key_pr, 0);
+  auto limited = default_index_->OpenAscendingCursor(*scan_txn, ScanType::OpenLow, 1, low_key_pr, high_key_pr, 150);
+  std::memset(key_buffer_1_, 0, default_index_->GetProjectedRowInitializer().ProjectedRowSize());
+  std::memset(key_buffer_2_, 0, default_index_->GetProjectedRowInitializer().ProjectedRowSize());
+
+  // Interleave the cursors to check that each resumes where it left off
+  std::vector<storage::TupleSlot> batch;
+  int32_t next_ascending = 100, next_descending = 8999;
+  bool ascending_done = false, descending_done = false;
+  while (!ascending_done || !descending_done) {
+    if (!ascending_done) {
+      ascending_done = !ascending->Next(&batch, 64);
+      EXPECT_LE(batch.size(), 64);
+      for (const auto slot : batch) EXPECT_EQ(reference[next_ascending++], slot);
+    }
+    if (!descending_done) {
+      descending_done = !descending->Next(&batch, 100);
+      EXPECT_LE(batch.size(), 100);
+      for (const auto slot : batch) EXPECT_EQ(reference[next_descending--], slot);
+    }
+  }
+  EXPECT_EQ(next_ascending, 9000);
+  EXPECT_EQ(next_descending, 99);
+
+  // An exhausted cursor stays exhausted
+  EXPECT_FALSE(ascending->Next(&batch, 64));
+  EXPECT_TRUE(batch.empty());
+
+  // OpenLow starts from the smallest key, and the limit applies across batches
+  EXPECT_TRUE(limited->Next(&batch, 100));
+  EXPECT_EQ(batch.size(), 100);
+  EXPECT_EQ(reference[0], batch.front());
+  EXPECT_TRUE(limited->Next(&batch, 100));
+  EXPECT_EQ(batch.size(), 50);
+  EXPECT_EQ(reference[149], batch.back());
+  EXPECT_FALSE(limited->Next(&batch, 100));
+
+  txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
 // Verifies that primary key insert fails on write-write conflict
 // NOLINTNEXTLINE
 TEST_F(BPlusTreeIndexTests, UniqueKey1) {
@@ -1,9 +1,697 @@
+#include "storage/index/bplustree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include "storage/index/compact_ints_key.h"
+#include "test_util/multithread_test_util.h"
 #include "test_util/test_harness.h"
 
 namespace terrier::storage::index {
 
-struct BPlusTreeTests : public TerrierTest {};
+struct BPlusTreeTests : public TerrierTest {
+  using TreeType = BPlusTree<int64_t, int64_t>;
+
+  const uint32_t num_threads_ =
+      MultiThreadTestUtil::HardwareConcurrency() + (MultiThreadTestUtil::HardwareConcurrency() % 2);
+
+  /**
+   * A key type that is not safe to compare when torn, to exercise the copy-and-validate search path of the tree.
+   */
+  struct WideKey {
+    int64_t key_;
+    int64_t padding_[3];
+  };
+
+  /**
+   * Comparator for WideKey
+   */
+  struct WideKeyComparator {
+    bool operator()(const WideKey &lhs, const WideKey &rhs) const { return lhs.key_ < rhs.key_; }
+  };
+
+  /**
+   * Equality checker for WideKey
+   */
+  struct WideKeyEqualityChecker {
+    bool operator()(const WideKey &lhs, const WideKey &rhs) const { return lhs.key_ == rhs.key_; }
+  };
 
+  using WideTreeType = BPlusTree<WideKey, int64_t, WideKeyComparator, WideKeyEqualityChecker>;
+
+  /**
+   * Builds a CompactIntsKey out of one BIGINT for every 8 bytes of the key, in the key's big-endian sign-flipped format
+   */
+  template <uint8_t KeySize>
+  static CompactIntsKey<KeySize> MakeCompactIntsKey(const std::vector<int64_t> &fields) {
+    CompactIntsKey<KeySize> key;
+    for (uint8_t i = 0; i < KeySize / sizeof(int64_t); i++) {
+      const uint64_t data = htobe64(static_cast<uint64_t>(fields[i]) ^ (uint64_t{1} << 63));
+      std::memcpy(reinterpret_cast<byte *>(&key) + i * sizeof(data), &data, sizeof(data));
+    }
+    return key;
+  }
+
+  /**
+   * Checks CompactIntsKey::SearchBound against std::lower_bound and std::upper_bound on sorted arrays of every size up
+   * to a few vectors, searching for keys in the array, between its keys, and outside of its range.
+   */
+  template <uint8_t KeySize>
+  static void CheckSearchBound() {
+    std::default_random_engine generator;
+    // Few distinct values, so that the arrays have duplicates, and values with every combination of set sign bits
+    std::uniform_int_distribution<int64_t> distribution(-4, 4);
+    const int64_t scale = INT64_MAX / 5;
+    const std::less<CompactIntsKey<KeySize>> less;
+    for (uint32_t num_keys = 0; num_keys <= 40; num_keys++) {
+      std::vector<CompactIntsKey<KeySize>> keys;
+      for (uint32_t i = 0; i < num_keys; i++) {
+        keys.emplace_back(MakeCompactIntsKey<KeySize>(
+            {distribution(generator) * scale, distribution(generator) * scale}));
+      }
+      std::sort(keys.begin(), keys.end(), less);
+      for (int64_t first = -5; first <= 5; first++) {
+        for (int64_t second = -5; second <= 5; second++) {
+          const auto key = MakeCompactIntsKey<KeySize>({first * scale, second * scale});
+          const auto lower = std::lower_bound(keys.begin(), keys.end(), key, less) - keys.begin();
+          const auto upper = std::upper_bound(keys.begin(), keys.end(), key, less) - keys.begin();
+          EXPECT_EQ(CompactIntsKey<KeySize>::SearchBound(keys.data(), num_keys, key, false), lower);
+          EXPECT_EQ(CompactIntsKey<KeySize>::SearchBound(keys.data(), num_keys, key, true), upper);
+        }
+      }
+    }
+  }
+
+  static std::vector<int64_t> GetValues(const TreeType &tree, const int64_t key) {
+    std::vector<int64_t> values;
+    tree.GetValue(key, &values);
+    return values;
+  }
+};
+
+// Insert keys in random order and verify that every key can be found exactly once
 // NOLINTNEXTLINE
-TEST_F(BPlusTreeTests, EmptyTest) { EXPECT_TRUE(true); }
+TEST_F(BPlusTreeTests, RandomInsertAndLookup) {
+  const int64_t key_num = 256 * 1024;
+  TreeType tree;
+
+  std::vector<int64_t> keys(key_num);
+  for (int64_t i = 0; i < key_num; i++) keys[i] = i;
+  std::shuffle(keys.begin(), keys.end(), std::mt19937{std::random_device{}()});  // NOLINT
+
+  for (const auto key : keys) EXPECT_TRUE(tree.Insert(key, key * 2));
+  // Inserting the same pair again must fail
+  for (int64_t i = 0; i < key_num; i += 1000) EXPECT_FALSE(tree.Insert(i, i * 2));
+
+  for (int64_t i = 0; i < key_num; i++) {
+    const auto values = GetValues(tree, i);
+    EXPECT_EQ(values.size(), 1);
+    if (!values.empty()) {
+      EXPECT_EQ(values[0], i * 2);
+    }
+  }
+  EXPECT_TRUE(GetValues(tree, -1).empty());
+  EXPECT_TRUE(GetValues(tree, key_num).empty());
+}
+
+// Insert many values for a few keys, so that the entries of a key span several leaves
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, DuplicateKeys) {
+  const int64_t num_keys = 8;
+  const int64_t values_per_key = 4 * TreeType::LEAF_CAPACITY;
+  TreeType tree;
+
+  for (int64_t v = 0; v < values_per_key; v++) {
+    for (int64_t k = 0; k < num_keys; k++) EXPECT_TRUE(tree.Insert(k, v));
+  }
+  // Unique inserts fail for any existing key, but succeed for new ones
+  EXPECT_FALSE(tree.Insert(0, values_per_key, true));
+  EXPECT_TRUE(tree.Insert(num_keys, 0, true));
+  EXPECT_TRUE(tree.Delete(num_keys, 0));
+
+  for (int64_t k = 0; k < num_keys; k++) {
+    auto values = GetValues(tree, k);
+    EXPECT_EQ(values.size(), values_per_key);
+    std::sort(values.begin(), values.end());
+    for (int64_t v = 0; v < values_per_key; v++) EXPECT_EQ(values[v], v);
+  }
+
+  // Delete every other value of every key
+  for (int64_t k = 0; k < num_keys; k++) {
+    for (int64_t v = 0; v < values_per_key; v += 2) EXPECT_TRUE(tree.Delete(k, v));
+    // Deleting again or deleting a pair that never existed must fail
+    EXPECT_FALSE(tree.Delete(k, 0));
+    EXPECT_FALSE(tree.Delete(k, values_per_key));
+  }
+
+  for (int64_t k = 0; k < num_keys; k++) {
+    auto values = GetValues(tree, k);
+    EXPECT_EQ(values.size(), values_per_key / 2);
+    for (const auto v : values) EXPECT_EQ(v % 2, 1);
+  }
+}
+
+// Keys with many values keep them sorted in value pages, which grow as values are added, and whose values move back
+// into the leaf once few are left
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ValuePages) {
+  const int64_t num_keys = 4;
+  const int64_t values_per_key = 10 * TreeType::LEAF_CAPACITY;
+  TreeType tree;
+  const size_t empty_usage = tree.GetHeapUsage();
+
+  for (int64_t v = values_per_key - 1; v >= 0; v--) {
+    for (int64_t k = 0; k < num_keys; k++) EXPECT_TRUE(tree.Insert(k, v));
+  }
+  EXPECT_FALSE(tree.Insert(0, values_per_key / 2));
+  EXPECT_FALSE(tree.Insert(0, values_per_key, true));
+  bool predicate_satisfied;
+  EXPECT_FALSE(tree.ConditionalInsert(
+      1, values_per_key, [](const int64_t value) { return value == 7; }, &predicate_satisfied));
+  EXPECT_TRUE(predicate_satisfied);
+
+  // Every key has a single entry, so the root leaf never splits
+  for (int64_t k = 0; k < num_keys; k++) {
+    const auto values = GetValues(tree, k);
+    EXPECT_EQ(values.size(), values_per_key);
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+  }
+  int64_t count = 0;
+  for (auto itr = tree.Begin(1); !itr.IsEnd() && itr->first == 1; ++itr, count++) EXPECT_EQ(itr->second, count);
+  EXPECT_EQ(count, values_per_key);
+  for (auto itr = tree.ReverseBegin(2); !itr.IsREnd() && itr->first == 2; --itr) EXPECT_EQ(itr->second, --count);
+  EXPECT_EQ(count, 0);
+
+  // Delete all but two values of every key
+  for (int64_t k = 0; k < num_keys; k++) {
+    for (int64_t v = 2; v < values_per_key; v++) EXPECT_TRUE(tree.Delete(k, v));
+    EXPECT_FALSE(tree.Delete(k, values_per_key - 1));
+  }
+  for (int64_t k = 0; k < num_keys; k++) EXPECT_EQ(GetValues(tree, k), std::vector<int64_t>({0, 1}));
+  for (uint32_t i = 0; i < 3; i++) tree.PerformGarbageCollection(UINT64_MAX, 0);
+  EXPECT_EQ(tree.GetHeapUsage(), empty_usage);
+
+  // Bulk loading puts the values of keys with many of them into pages right away
+  TreeType loaded_tree;
+  std::vector<TreeType::KeyValuePair> entries;
+  for (int64_t v = 0; v < values_per_key; v++) entries.emplace_back(v % num_keys, v);
+  EXPECT_TRUE(loaded_tree.BulkLoad(&entries, false, 1.0));
+  EXPECT_EQ(GetValues(loaded_tree, 3).size(), values_per_key / num_keys);
+  EXPECT_TRUE(loaded_tree.Delete(3, 7));
+  EXPECT_FALSE(loaded_tree.Delete(3, 8));
+  EXPECT_TRUE(loaded_tree.Insert(3, 8));
+  EXPECT_EQ(GetValues(loaded_tree, 3).size(), values_per_key / num_keys);
+}
+
+// Batched lookups return the same values as looking up every key on its own, whatever the order of the batch
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, BatchLookup) {
+  const int64_t key_num = 64 * 1024;
+  TreeType tree;
+
+  // Only even keys exist, and every 1000th key has enough values to keep them in a value page
+  for (int64_t key = 0; key < key_num; key += 2) {
+    const int64_t num_values = key % 1000 == 0 ? 3 * TreeType::LEAF_CAPACITY : key % 3 + 1;
+    for (int64_t v = 0; v < num_values; v++) EXPECT_TRUE(tree.Insert(key, v));
+  }
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int64_t> dist(-10, key_num + 10);
+  std::vector<int64_t> keys;
+  for (uint32_t i = 0; i < 4096; i++) keys.emplace_back(dist(generator));
+  // Runs of neighbouring keys, repeated keys, and an empty batch
+  for (int64_t key = 990; key < 1010; key++) keys.emplace_back(key);
+  keys.emplace_back(keys.front());
+  std::vector<std::vector<int64_t>> batches{keys, keys, {}};
+  std::sort(batches[1].begin(), batches[1].end());
+
+  for (const auto &batch : batches) {
+    std::vector<int64_t> values{-1};
+    std::vector<uint32_t> offsets;
+    tree.GetValues(batch, &values, &offsets);
+    ASSERT_EQ(offsets.size(), batch.size() + 1);
+    // Values already in the list are kept
+    EXPECT_EQ(offsets.front(), 1);
+    EXPECT_EQ(offsets.back(), values.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      std::vector<int64_t> batch_values(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
+      auto expected = GetValues(tree, batch[i]);
+      std::sort(batch_values.begin(), batch_values.end());
+      std::sort(expected.begin(), expected.end());
+      EXPECT_EQ(batch_values, expected);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ConditionalInsert) {
+  TreeType tree;
+  bool predicate_satisfied;
+
+  EXPECT_TRUE(tree.ConditionalInsert(
+      1, 10, [](const int64_t) { return true; }, &predicate_satisfied));
+  EXPECT_FALSE(predicate_satisfied);
+
+  // Predicate is true for the existing value
+  EXPECT_FALSE(tree.ConditionalInsert(
+      1, 11, [](const int64_t value) { return value == 10; }, &predicate_satisfied));
+  EXPECT_TRUE(predicate_satisfied);
+
+  // Predicate is false for the existing value
+  EXPECT_TRUE(tree.ConditionalInsert(
+      1, 12, [](const int64_t value) { return value == 11; }, &predicate_satisfied));
+  EXPECT_FALSE(predicate_satisfied);
+
+  // The pair already exists
+  EXPECT_FALSE(tree.ConditionalInsert(
+      1, 12, [](const int64_t) { return false; }, &predicate_satisfied));
+  EXPECT_FALSE(predicate_satisfied);
+
+  EXPECT_EQ(GetValues(tree, 1).size(), 2);
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ForwardAndReverseIterator) {
+  const int64_t key_num = 64 * 1024;
+  TreeType tree;
+
+  // Even keys only, each with two values
+  for (int64_t i = 0; i < key_num; i += 2) {
+    EXPECT_TRUE(tree.Insert(i, i));
+    EXPECT_TRUE(tree.Insert(i, i + key_num));
+  }
+
+  int64_t count = 0;
+  int64_t last_key = -1;
+  for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) {
+    EXPECT_GE(itr->first, last_key);
+    EXPECT_EQ(itr->second % key_num, itr->first);
+    last_key = itr->first;
+    count++;
+  }
+  EXPECT_EQ(count, key_num);
+
+  // Odd keys are positioned at the next even key in both directions
+  auto itr = tree.Begin(1001);
+  EXPECT_EQ(itr->first, 1002);
+  itr = tree.ReverseBegin(1001);
+  EXPECT_EQ(itr->first, 1000);
+  // Reverse iteration from an existing key includes all of its duplicates
+  itr = tree.ReverseBegin(1000);
+  EXPECT_EQ(itr->first, 1000);
+  --itr;
+  EXPECT_EQ(itr->first, 1000);
+  --itr;
+  EXPECT_EQ(itr->first, 998);
+
+  count = 0;
+  last_key = key_num;
+  for (itr = tree.ReverseBegin(key_num); !itr.IsREnd(); --itr) {
+    EXPECT_LE(itr->first, last_key);
+    last_key = itr->first;
+    count++;
+  }
+  EXPECT_EQ(count, key_num);
+
+  EXPECT_TRUE(tree.Begin(key_num).IsEnd());
+  EXPECT_TRUE(tree.ReverseBegin(-1).IsREnd());
+
+  // Iterators can turn around at both ends
+  itr = tree.Begin(key_num - 2);
+  ++itr;
+  ++itr;
+  EXPECT_TRUE(itr.IsEnd());
+  --itr;
+  EXPECT_EQ(itr->first, key_num - 2);
+
+  TreeType empty_tree;
+  EXPECT_TRUE(empty_tree.Begin().IsEnd());
+  EXPECT_TRUE(empty_tree.ReverseBegin(0).IsREnd());
+}
+
+// Bulk load batches of various sizes and fill factors, and check that the result behaves like any other tree
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, BulkLoad) {
+  const int64_t values_per_key = 3;
+  std::default_random_engine generator;
+  for (const int64_t key_num : {int64_t{0}, int64_t{1}, int64_t{TreeType::LEAF_CAPACITY}, int64_t{100 * 1024}}) {
+    for (const double fill_factor : {0.01, 0.5, 1.0}) {
+      TreeType tree;
+      std::vector<TreeType::KeyValuePair> entries;
+      for (int64_t key = 0; key < key_num; key++) {
+        for (int64_t v = 0; v < values_per_key; v++) entries.emplace_back(key, key * values_per_key + v);
+      }
+      std::shuffle(entries.begin(), entries.end(), generator);
+      // Duplicate keys violate uniqueness, which must leave the tree untouched
+      if (key_num > 0) {
+        auto copy = entries;
+        EXPECT_FALSE(tree.BulkLoad(&copy, true, fill_factor));
+        EXPECT_TRUE(tree.Begin().IsEnd());
+      }
+      EXPECT_TRUE(tree.BulkLoad(&entries, false, fill_factor));
+
+      int64_t count = 0;
+      for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) {
+        EXPECT_EQ(itr->first, count / values_per_key);
+        count++;
+      }
+      EXPECT_EQ(count, key_num * values_per_key);
+      for (int64_t key = 0; key < key_num; key += std::max<int64_t>(1, key_num / 1000)) {
+        auto values = GetValues(tree, key);
+        std::sort(values.begin(), values.end());
+        EXPECT_EQ(values, std::vector<int64_t>({key * values_per_key, key * values_per_key + 1,
+                                                key * values_per_key + 2}));
+      }
+
+      // Only empty trees can be bulk loaded
+      std::vector<TreeType::KeyValuePair> more{{key_num, 0}};
+      if (key_num > 0) {
+        EXPECT_FALSE(tree.BulkLoad(&more, false, fill_factor));
+      }
+
+      // The loaded tree supports regular modifications, including splits of its packed nodes
+      for (int64_t key = 0; key < key_num; key++) {
+        EXPECT_FALSE(tree.Insert(key, key * values_per_key));
+        EXPECT_TRUE(tree.Insert(key, -1));
+        EXPECT_TRUE(tree.Delete(key, key * values_per_key + 1));
+      }
+      for (int64_t key = 0; key < key_num; key += std::max<int64_t>(1, key_num / 1000)) {
+        auto values = GetValues(tree, key);
+        std::sort(values.begin(), values.end());
+        EXPECT_EQ(values, std::vector<int64_t>({-1, key * values_per_key, key * values_per_key + 2}));
+      }
+    }
+  }
+
+  // A unique load succeeds if every key occurs once
+  TreeType tree;
+  std::vector<TreeType::KeyValuePair> entries;
+  for (int64_t key = 0; key < 1000; key++) entries.emplace_back(999 - key, key);
+  EXPECT_TRUE(tree.BulkLoad(&entries, true, 1.0));
+  EXPECT_FALSE(tree.Insert(500, 0, true));
+  EXPECT_EQ(GetValues(tree, 500), std::vector<int64_t>({499}));
+}
+
+// Retired nodes are only freed once the oldest active epoch has passed the epoch they were stamped with
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, GarbageCollection) {
+  TreeType tree;
+  const size_t empty_usage = tree.GetHeapUsage();
+  EXPECT_GT(empty_usage, 0);
+  for (int64_t key = 0; key < 100 * 1024; key++) tree.Insert(key, key);
+  EXPECT_GT(tree.GetHeapUsage(), empty_usage);
+  // Splits happen in place, nothing is retired
+  EXPECT_EQ(tree.PerformGarbageCollection(0, 1), 0);
+  EXPECT_EQ(tree.PerformGarbageCollection(1, 2), 0);
+
+  // Bulk loading replaces the empty root of the tree, which readers may still be looking at
+  TreeType loaded_tree;
+  std::vector<TreeType::KeyValuePair> entries;
+  for (int64_t key = 0; key < 100 * 1024; key++) entries.emplace_back(key, key);
+  EXPECT_TRUE(loaded_tree.BulkLoad(&entries, true, 1.0));
+  const size_t loaded_usage = loaded_tree.GetHeapUsage();
+  EXPECT_GT(loaded_usage, empty_usage);
+
+  // The first call takes the node off the retired list, the second stamps it with epoch 10
+  EXPECT_EQ(loaded_tree.PerformGarbageCollection(5, 5), 0);
+  EXPECT_EQ(loaded_tree.PerformGarbageCollection(5, 10), 0);
+  EXPECT_EQ(loaded_tree.PerformGarbageCollection(9, 11), 0);
+  EXPECT_EQ(loaded_tree.GetHeapUsage(), loaded_usage);
+  EXPECT_EQ(loaded_tree.PerformGarbageCollection(10, 12), 1);
+  EXPECT_EQ(loaded_tree.GetHeapUsage(), loaded_usage - empty_usage);
+  EXPECT_EQ(loaded_tree.PerformGarbageCollection(20, 20), 0);
+  EXPECT_EQ(GetValues(loaded_tree, 500), std::vector<int64_t>({500}));
+}
+
+// Deleting entries merges leaves and inner nodes and collapses the root, and Compact repacks the leaves that merges
+// could not clean up
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, DeleteShrinksTree) {
+  const int64_t num_keys = 100 * 1024;
+  TreeType tree;
+  const size_t empty_usage = tree.GetHeapUsage();
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) keys[key] = key;
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(0));
+  for (const int64_t key : keys) tree.Insert(key, key);
+  const size_t full_usage = tree.GetHeapUsage();
+
+  // Keep every tenth key, deleting the others in random order
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(1));
+  for (const int64_t key : keys) {
+    if (key % 10 != 0) {
+      EXPECT_TRUE(tree.Delete(key, key));
+    }
+  }
+  EXPECT_TRUE(tree.NeedsCompaction());
+  EXPECT_GT(tree.Compact(), 0);
+  EXPECT_FALSE(tree.NeedsCompaction());
+  // Retired nodes are stamped by the second collection after they were retired, and freed by the third
+  for (uint32_t i = 0; i < 3; i++) tree.PerformGarbageCollection(UINT64_MAX, 0);
+  EXPECT_LT(tree.GetHeapUsage(), full_usage / 4);
+
+  int64_t expected = 0;
+  for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr, expected += 10) EXPECT_EQ(itr->first, expected);
+  EXPECT_EQ(expected, num_keys);
+  for (auto itr = tree.ReverseBegin(num_keys); !itr.IsREnd(); --itr) {
+    expected -= 10;
+    EXPECT_EQ(itr->first, expected);
+  }
+  EXPECT_EQ(expected, 0);
+  EXPECT_EQ(GetValues(tree, 500), std::vector<int64_t>({500}));
+  EXPECT_TRUE(GetValues(tree, 501).empty());
+
+  // Deleting everything else, in order, leaves a single empty leaf
+  for (int64_t key = 0; key < num_keys; key += 10) EXPECT_TRUE(tree.Delete(key, key));
+  tree.Compact();
+  for (uint32_t i = 0; i < 3; i++) tree.PerformGarbageCollection(UINT64_MAX, 0);
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  EXPECT_EQ(tree.GetHeapUsage(), empty_usage);
+
+  // The tree is still usable after shrinking
+  for (int64_t key = 0; key < num_keys; key++) tree.Insert(key, key);
+  for (int64_t key = 0; key < num_keys; key += 1000) EXPECT_EQ(GetValues(tree, key), std::vector<int64_t>({key}));
+}
+
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, CompactIntsKeySearchBound) {
+  CheckSearchBound<8>();
+  CheckSearchBound<16>();
+}
+
+// Trees of 16-byte CompactIntsKeys search their nodes with the key's vectorized search
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, CompactIntsKeyTree) {
+  using CompactTreeType = BPlusTree<CompactIntsKey<16>, int64_t>;
+  const int64_t key_num = 64 * 1024;
+  const int64_t values_per_key = 2;
+  CompactTreeType tree;
+
+  // Keys span negative and positive values in both fields, and are inserted in random order
+  const auto make_key = [=](const int64_t i) {
+    const int64_t key = i - key_num / 2;
+    return MakeCompactIntsKey<16>({key / 256, key % 256});
+  };
+  std::vector<int64_t> keys(key_num);
+  for (int64_t i = 0; i < key_num; i++) keys[i] = i;
+  std::shuffle(keys.begin(), keys.end(), std::mt19937{std::random_device{}()});  // NOLINT
+  for (int64_t v = 0; v < values_per_key; v++) {
+    for (const auto i : keys) EXPECT_TRUE(tree.Insert(make_key(i), i * values_per_key + v));
+  }
+
+  for (int64_t i = 0; i < key_num; i++) {
+    std::vector<int64_t> values;
+    tree.GetValue(make_key(i), &values);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values, std::vector<int64_t>({i * values_per_key, i * values_per_key + 1}));
+  }
+  std::vector<int64_t> values;
+  tree.GetValue(make_key(-1), &values);
+  tree.GetValue(make_key(key_num), &values);
+  EXPECT_TRUE(values.empty());
+
+  int64_t count = 0;
+  for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) {
+    EXPECT_EQ(itr->second / values_per_key, count / values_per_key);
+    count++;
+  }
+  EXPECT_EQ(count, key_num * values_per_key);
+}
+
+// Threads insert disjoint keys while another set of threads reads them back
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ConcurrentInsertAndLookup) {
+  const uint32_t key_num = 128 * 1024;
+  common::WorkerPool thread_pool(num_threads_, {});
+  TreeType tree;
+  WideTreeType wide_tree;
+
+  auto workload = [&](uint32_t id) {
+    if (id % 2 == 0) {
+      const auto writer = static_cast<int64_t>(id / 2);
+      const auto num_writers = static_cast<int64_t>(num_threads_ / 2);
+      for (int64_t key = writer; key < key_num; key += num_writers) {
+        EXPECT_TRUE(tree.Insert(key, key));
+        EXPECT_TRUE(wide_tree.Insert(WideKey{key, {}}, key));
+      }
+    } else {
+      std::default_random_engine generator(id);
+      std::uniform_int_distribution<int64_t> dist(0, key_num - 1);
+      std::vector<int64_t> values;
+      std::vector<int64_t> batch;
+      std::vector<uint32_t> offsets;
+      for (uint32_t i = 0; i < key_num; i++) {
+        const int64_t key = dist(generator);
+        values.clear();
+        tree.GetValue(key, &values);
+        // The key is either not inserted yet or was inserted exactly once
+        EXPECT_LE(values.size(), 1);
+        for (const auto v : values) EXPECT_EQ(v, key);
+        values.clear();
+        wide_tree.GetValue(WideKey{key, {}}, &values);
+        EXPECT_LE(values.size(), 1);
+        for (const auto v : values) EXPECT_EQ(v, key);
+
+        // Every so often, look up a run of neighbouring keys in one batch
+        if (i % 64 != 0) continue;
+        batch.clear();
+        for (int64_t k = key; k < key + 256; k++) batch.emplace_back(k);
+        values.clear();
+        tree.GetValues(batch, &values, &offsets);
+        for (size_t k = 0; k < batch.size(); k++) {
+          EXPECT_LE(offsets[k + 1] - offsets[k], 1);
+          if (offsets[k + 1] > offsets[k]) {
+            EXPECT_EQ(values[offsets[k]], batch[k]);
+          }
+        }
+      }
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  for (int64_t key = 0; key < key_num; key++) {
+    EXPECT_EQ(GetValues(tree, key).size(), 1);
+    std::vector<int64_t> values;
+    wide_tree.GetValue(WideKey{key, {}}, &values);
+    EXPECT_EQ(values.size(), 1);
+  }
+
+  // Scans see every key exactly once and in order
+  int64_t expected = 0;
+  for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) EXPECT_EQ(itr->first, expected++);
+  EXPECT_EQ(expected, key_num);
+}
+
+// Threads race on a small key space to insert a value for each key if no other value exists
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ConcurrentConditionalInsert) {
+  const int64_t key_num = 16 * 1024;
+  common::WorkerPool thread_pool(num_threads_, {});
+  TreeType tree;
+  std::atomic<int64_t> successes = 0;
+
+  auto workload = [&](uint32_t id) {
+    for (int64_t key = 0; key < key_num; key++) {
+      bool predicate_satisfied;
+      if (tree.ConditionalInsert(
+              key, id, [](const int64_t) { return true; }, &predicate_satisfied)) {
+        successes++;
+      } else {
+        EXPECT_TRUE(predicate_satisfied);
+      }
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  EXPECT_EQ(successes.load(), key_num);
+  for (int64_t key = 0; key < key_num; key++) EXPECT_EQ(GetValues(tree, key).size(), 1);
+}
+
+// Half of the threads insert duplicate values while the other half delete them
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ConcurrentMixed) {
+  const int64_t value_num = 32 * 1024;
+  const int64_t num_keys = 16;
+  common::WorkerPool thread_pool(num_threads_, {});
+  TreeType tree;
+
+  auto workload = [&](uint32_t id) {
+    const auto pair = static_cast<int64_t>(id / 2);
+    for (int64_t v = 0; v < value_num; v++) {
+      const int64_t key = v % num_keys;
+      const int64_t value = v * num_threads_ + pair;
+      if (id % 2 == 0) {
+        EXPECT_TRUE(tree.Insert(key, value));
+      } else {
+        while (!tree.Delete(key, value)) {
+        }
+      }
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  for (int64_t key = 0; key < num_keys; key++) EXPECT_TRUE(GetValues(tree, key).empty());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+}
+
+// Threads repeatedly insert and delete most keys, which splits, merges and compacts leaves, while other threads iterate
+// in both directions and check that they see every key that is never deleted exactly once and in order
+// NOLINTNEXTLINE
+TEST_F(BPlusTreeTests, ConcurrentDeleteAndIterate) {
+  const int64_t num_keys = 64 * 1024;
+  const uint32_t num_rounds = 4;
+  common::WorkerPool thread_pool(num_threads_, {});
+  TreeType tree;
+  for (int64_t key = 0; key < num_keys; key += 3) tree.Insert(key, key);
+  std::atomic<uint32_t> writers_left = num_threads_ / 2;
+
+  auto workload = [&](uint32_t id) {
+    if (id % 2 == 0) {
+      // Every writer owns the unstable keys that are congruent to its id
+      const auto writer = static_cast<int64_t>(id / 2);
+      const auto num_writers = static_cast<int64_t>(num_threads_ / 2);
+      for (uint32_t round = 0; round < num_rounds; round++) {
+        for (int64_t key = writer; key < num_keys; key += num_writers) {
+          if (key % 3 != 0) {
+            EXPECT_TRUE(tree.Insert(key, key));
+          }
+        }
+        for (int64_t key = writer; key < num_keys; key += num_writers) {
+          if (key % 3 != 0) {
+            EXPECT_TRUE(tree.Delete(key, key));
+          }
+        }
+        if (writer == 0) tree.Compact();
+      }
+      writers_left--;
+      return;
+    }
+
+    do {
+      int64_t expected = 0;
+      for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) {
+        if (itr->first % 3 != 0) continue;
+        EXPECT_EQ(itr->first, expected);
+        expected += 3;
+      }
+      EXPECT_GE(expected, num_keys);
+      for (auto itr = tree.ReverseBegin(num_keys); !itr.IsREnd(); --itr) {
+        if (itr->first % 3 != 0) continue;
+        expected -= 3;
+        EXPECT_EQ(itr->first, expected);
+      }
+      EXPECT_EQ(expected, 0);
+    } while (writers_left > 0);
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  std::vector<int64_t> keys;
+  for (auto itr = tree.Begin(); !itr.IsEnd(); ++itr) keys.emplace_back(itr->first);
+  std::vector<int64_t> expected_keys;
+  for (int64_t key = 0; key < num_keys; key += 3) expected_keys.emplace_back(key);
+  EXPECT_EQ(keys, expected_keys);
+}
+
 }  // namespace terrier::storage::index
@@ -1,5 +1,6 @@
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "storage/data_table.h"
@@ -124,6 +125,53 @@ TEST_F(DataTableConcurrentTests, ConcurrentInsert) {
   }
 }
 
+// Spawns multiple transactions that insert enough tuples to fill several blocks, so that threads move between blocks
+// and append new ones concurrently. A sequential scan afterwards should find every inserted tuple exactly once.
+// NOLINTNEXTLINE
+TEST_F(DataTableConcurrentTests, ConcurrentInsertAcrossBlocks) {
+  const uint32_t num_iterations = 10;
+  const uint16_t max_columns = 20;
+  const uint32_t num_threads = MultiThreadTestUtil::HardwareConcurrency();
+  common::WorkerPool thread_pool(num_threads, {});
+  thread_pool.Startup();
+
+  for (uint32_t iteration = 0; iteration < num_iterations; iteration++) {
+    storage::BlockLayout layout = StorageTestUtil::RandomLayoutNoVarlen(max_columns, &generator_);
+    storage::DataTable tested(common::ManagedPointer<storage::BlockStore>(&block_store_), layout,
+                              storage::layout_version_t(0));
+    const uint32_t inserts_per_thread = 3 * layout.NumSlots() / num_threads + 1;
+    std::vector<std::unique_ptr<FakeTransaction>> fake_txns;
+    for (uint32_t thread = 0; thread < num_threads; thread++)
+      // timestamps are irrelevant for inserts
+      fake_txns.emplace_back(std::make_unique<FakeTransaction>(layout, &tested, null_ratio_(generator_),
+                                                               transaction::timestamp_t(0), transaction::timestamp_t(0),
+                                                               &buffer_pool_));
+    auto workload = [&](uint32_t id) {
+      std::default_random_engine thread_generator(id);
+      for (uint32_t i = 0; i < inserts_per_thread; i++) fake_txns[id]->InsertRandomTuple(&thread_generator);
+    };
+    MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+    std::unordered_set<storage::TupleSlot> inserted;
+    for (auto &fake_txn : fake_txns)
+      for (auto slot : fake_txn->InsertedTuples()) EXPECT_TRUE(inserted.insert(slot).second);
+
+    storage::ProjectedColumnsInitializer initializer(layout, StorageTestUtil::ProjectionListAllColumns(layout),
+                                                     common::Constants::K_DEFAULT_VECTOR_SIZE);
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+    uint32_t num_scanned = 0;
+    for (auto it = tested.begin(); it != tested.end();) {
+      tested.Scan(common::ManagedPointer(fake_txns[0]->GetTxn()), &it, columns);
+      for (uint32_t i = 0; i < columns->NumTuples(); i++)
+        EXPECT_EQ(1U, inserted.count(columns->TupleSlots()[i]));
+      num_scanned += columns->NumTuples();
+    }
+    EXPECT_EQ(inserted.size(), num_scanned);
+    delete[] buffer;
+  }
+}
+
 // Spawns multiple transactions that all begin at the same time.
 // Each transaction attempts to update the same tuple.
 // Therefore only one transaction should win, which is what we test for.
@@ -234,6 +234,102 @@ TEST_F(DataTableTests, SimpleSequentialScan) {
   }
 }
 
+// Insert tuples over multiple blocks, prune the version chains of a random subset of them the way the GC would, and
+// scan with a small buffer so that the scan has to switch between copying runs of unversioned tuples and reading
+// versioned tuples one at a time, and stop in the middle of blocks.
+// NOLINTNEXTLINE
+TEST_F(DataTableTests, SequentialScanPrunedVersionChains) {
+  const uint32_t num_iterations = 10;
+  const uint16_t max_columns = 20;
+  for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+    RandomDataTableTestObject tested(&block_store_, max_columns, null_ratio_(generator_), &generator_);
+    const uint32_t num_inserts = tested.Layout().NumSlots() + tested.Layout().NumSlots() / 2;
+    for (uint32_t i = 0; i < num_inserts; ++i)
+      tested.InsertRandomTuple(transaction::timestamp_t(0), &generator_, &buffer_pool_);
+
+    const storage::TupleAccessStrategy accessor(tested.Layout());
+    std::bernoulli_distribution prune(0.8);
+    for (const auto &slot : tested.InsertedTuples()) {
+      if (prune(generator_)) {
+        *reinterpret_cast<storage::UndoRecord **>(
+            accessor.AccessWithoutNullCheck(slot, storage::VERSION_POINTER_COLUMN_ID)) = nullptr;
+        slot.GetBlock()->num_versioned_slots_--;
+      }
+    }
+
+    std::vector<storage::col_id_t> all_cols = StorageTestUtil::ProjectionListAllColumns(tested.Layout());
+    const uint32_t max_tuples = std::uniform_int_distribution<uint32_t>(1, 100)(generator_);
+    storage::ProjectedColumnsInitializer initializer(tested.Layout(), all_cols, max_tuples);
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+
+    std::vector<storage::TupleSlot> scanned;
+    auto it = tested.GetTable().begin();
+    while (it != tested.GetTable().end()) {
+      tested.Scan(&it, transaction::timestamp_t(1), columns, &buffer_pool_);
+      for (uint32_t i = 0; i < columns->NumTuples(); i++) {
+        storage::ProjectedColumns::RowView stored = columns->InterpretAsRow(i);
+        const storage::ProjectedRow *ref =
+            tested.GetReferenceVersionedTuple(columns->TupleSlots()[i], transaction::timestamp_t(1));
+        EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), &stored, ref));
+        scanned.push_back(columns->TupleSlots()[i]);
+      }
+    }
+    EXPECT_EQ(tested.InsertedTuples(), scanned);
+    delete[] buffer;
+  }
+}
+
+// Check that the version synopsis of a block counts the slots with version chains, and that a scan of a block whose
+// synopsis says it has none still notices a version chain that is started afterwards.
+// NOLINTNEXTLINE
+TEST_F(DataTableTests, VersionSynopsis) {
+  const uint32_t num_iterations = 10;
+  const uint16_t max_columns = 20;
+  for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+    RandomDataTableTestObject tested(&block_store_, max_columns, null_ratio_(generator_), &generator_);
+    const uint32_t num_inserts = std::uniform_int_distribution<uint32_t>(2, tested.Layout().NumSlots())(generator_);
+    for (uint32_t i = 0; i < num_inserts; ++i)
+      tested.InsertRandomTuple(transaction::timestamp_t(0), &generator_, &buffer_pool_);
+    storage::RawBlock *const block = tested.InsertedTuples()[0].GetBlock();
+    EXPECT_EQ(num_inserts, block->num_versioned_slots_.load());
+
+    // An update to a tuple that already has a version chain does not start a new one
+    const storage::TupleSlot updated = tested.InsertedTuples()[num_inserts / 2];
+    EXPECT_TRUE(tested.RandomlyUpdateTuple(transaction::timestamp_t(1), updated, &generator_, &buffer_pool_));
+    EXPECT_EQ(num_inserts, block->num_versioned_slots_.load());
+
+    // Truncate all the version chains the way the GC would
+    const storage::TupleAccessStrategy accessor(tested.Layout());
+    for (const auto &slot : tested.InsertedTuples()) {
+      *reinterpret_cast<storage::UndoRecord **>(
+          accessor.AccessWithoutNullCheck(slot, storage::VERSION_POINTER_COLUMN_ID)) = nullptr;
+      block->num_versioned_slots_--;
+    }
+    EXPECT_EQ(0U, block->num_versioned_slots_.load());
+
+    // A new version chain is counted again, and scans at a snapshot before it read the old version from the chain
+    EXPECT_TRUE(tested.RandomlyUpdateTuple(transaction::timestamp_t(3), updated, &generator_, &buffer_pool_));
+    EXPECT_EQ(1U, block->num_versioned_slots_.load());
+
+    std::vector<storage::col_id_t> all_cols = StorageTestUtil::ProjectionListAllColumns(tested.Layout());
+    storage::ProjectedColumnsInitializer initializer(tested.Layout(), all_cols, num_inserts);
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+    for (const transaction::timestamp_t timestamp : {transaction::timestamp_t(2), transaction::timestamp_t(4)}) {
+      auto it = tested.GetTable().begin();
+      tested.Scan(&it, timestamp, columns, &buffer_pool_);
+      EXPECT_EQ(num_inserts, columns->NumTuples());
+      for (uint32_t i = 0; i < columns->NumTuples(); i++) {
+        storage::ProjectedColumns::RowView stored = columns->InterpretAsRow(i);
+        const storage::ProjectedRow *ref = tested.GetReferenceVersionedTuple(columns->TupleSlots()[i], timestamp);
+        EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), &stored, ref));
+      }
+    }
+    delete[] buffer;
+  }
+}
+
 // Generates a random table layout and coin flip bias for an attribute being null, inserts 1 random tuple into an empty
 // DataTable. Then, randomly updates the tuple num_updates times. Finally, Selects at each timestamp to verify that the
 // delta chain produces the correct tuple. Repeats for num_iterations.
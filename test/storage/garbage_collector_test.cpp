@@ -1,6 +1,7 @@
 #include "storage/garbage_collector.h"
 
 #include <cstring>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -114,9 +115,12 @@ TEST_F(GarbageCollectorTests, SingleInsert) {
     EXPECT_EQ(std::make_pair(0U, 0U), gc->PerformGarbageCollection());
 
     txn_manager->Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+    EXPECT_EQ(1U, slot.GetBlock()->num_versioned_slots_.load());
 
     // Unlink the Insert's UndoRecord, then deallocate it on the next run
     EXPECT_EQ(std::make_pair(0U, 1U), gc->PerformGarbageCollection());
+    // Truncating the version chain is reflected in the block's version synopsis
+    EXPECT_EQ(0U, slot.GetBlock()->num_versioned_slots_.load());
     EXPECT_EQ(std::make_pair(1U, 0U), gc->PerformGarbageCollection());
   }
 }
@@ -699,4 +703,115 @@ TEST_F(GarbageCollectorTests, InsertUpdate1) {
     EXPECT_EQ(std::make_pair(2U, 0U), gc->PerformGarbageCollection());
   }
 }
+
+// Run txns that write to a number of tables with a GC that partitions them among its workers. Confirm that the version
+// chains of every table are truncated, and that the txns are processed as with a single GC thread.
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, ParallelMultipleTables) {
+  const uint32_t num_tables = 8;
+  for (uint32_t iteration = 0; iteration < num_iterations_; ++iteration) {
+    auto db_main = DBMain::Builder().SetUseGC(true).SetNumGCWorkers(4).Build();
+    auto txn_manager = db_main->GetTransactionLayer()->GetTransactionManager();
+    auto gc = db_main->GetStorageLayer()->GetGarbageCollector();
+
+    std::vector<std::unique_ptr<GarbageCollectorDataTableTestObject>> tested;
+    std::vector<storage::TupleSlot> slots;
+    std::vector<storage::ProjectedRow *> versions;
+    auto *txn0 = txn_manager->BeginTransaction();
+    for (uint32_t i = 0; i < num_tables; i++) {
+      tested.emplace_back(std::make_unique<GarbageCollectorDataTableTestObject>(
+          db_main->GetStorageLayer()->GetBlockStore().Get(), max_columns_, &generator_));
+      versions.push_back(tested[i]->GenerateRandomTuple(&generator_));
+      slots.push_back(tested[i]->table_.Insert(common::ManagedPointer(txn0), *versions[i]));
+    }
+    txn_manager->Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    auto *txn1 = txn_manager->BeginTransaction();
+    for (uint32_t i = 0; i < num_tables; i++) {
+      auto *update = tested[i]->GenerateRandomUpdate(&generator_);
+      EXPECT_TRUE(tested[i]->table_.Update(common::ManagedPointer(txn1), slots[i], *update));
+      versions[i] = tested[i]->GenerateVersionFromUpdate(*update, *versions[i]);
+    }
+    txn_manager->Commit(txn1, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // Unlink both transactions and then deallocate them
+    EXPECT_EQ(std::make_pair(0U, 2U), gc->PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(2U, 0U), gc->PerformGarbageCollection());
+
+    auto *txn2 = txn_manager->BeginTransaction();
+    for (uint32_t i = 0; i < num_tables; i++) {
+      EXPECT_EQ(0U, slots[i].GetBlock()->num_versioned_slots_.load());
+      storage::ProjectedRow *select_tuple = tested[i]->SelectIntoBuffer(txn2, slots[i]);
+      EXPECT_TRUE(tested[i]->select_result_);
+      EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested[i]->Layout(), select_tuple, versions[i]));
+    }
+    txn_manager->Commit(txn2, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    EXPECT_EQ(std::make_pair(0U, 1U), gc->PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(0U, 0U), gc->PerformGarbageCollection());
+  }
+}
+
+// Update a tuple over and over without running the GC, first while an old reader is alive and then without it. Confirm
+// that the updates never prune the version the reader sees, but keep the version chain short once it is gone.
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, PruneOnUpdate) {
+  const uint32_t num_updates = 4 * transaction::TimestampManager::CACHE_REFRESH_INTERVAL;
+  for (uint32_t iteration = 0; iteration < 10; ++iteration) {
+    auto db_main = DBMain::Builder().SetUseGC(true).Build();
+    auto txn_manager = db_main->GetTransactionLayer()->GetTransactionManager();
+    auto gc = db_main->GetStorageLayer()->GetGarbageCollector();
+
+    GarbageCollectorDataTableTestObject tested(db_main->GetStorageLayer()->GetBlockStore().Get(), max_columns_,
+                                               &generator_);
+    const storage::TupleAccessStrategy accessor(tested.Layout());
+    const auto chain_length = [&](const storage::TupleSlot slot) {
+      uint32_t length = 0;
+      for (storage::UndoRecord *record = *reinterpret_cast<storage::UndoRecord **>(
+               accessor.AccessWithoutNullCheck(slot, storage::VERSION_POINTER_COLUMN_ID));
+           record != nullptr; record = record->Next().load())
+        length++;
+      return length;
+    };
+
+    auto *insert_tuple = tested.GenerateRandomTuple(&generator_);
+    auto *txn = txn_manager->BeginTransaction();
+    storage::TupleSlot slot = tested.table_.Insert(common::ManagedPointer(txn), *insert_tuple);
+    txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    auto *reader = txn_manager->BeginTransaction();
+    storage::ProjectedRow *version = insert_tuple;
+    for (uint32_t phase = 0; phase < 2; phase++) {
+      for (uint32_t i = 0; i < num_updates; i++) {
+        auto *update = tested.GenerateRandomUpdate(&generator_);
+        txn = txn_manager->BeginTransaction();
+        EXPECT_TRUE(tested.table_.Update(common::ManagedPointer(txn), slot, *update));
+        txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+        version = tested.GenerateVersionFromUpdate(*update, *version);
+      }
+
+      if (phase == 0) {
+        // The reader holds on to the whole version chain
+        EXPECT_LE(num_updates, chain_length(slot));
+        storage::ProjectedRow *select_tuple = tested.SelectIntoBuffer(reader, slot);
+        EXPECT_TRUE(tested.select_result_);
+        EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, insert_tuple));
+        txn_manager->Commit(reader, transaction::TransactionUtil::EmptyCallback, nullptr);
+      } else {
+        EXPECT_GE(transaction::TimestampManager::CACHE_REFRESH_INTERVAL, chain_length(slot));
+      }
+    }
+
+    txn = txn_manager->BeginTransaction();
+    storage::ProjectedRow *select_tuple = tested.SelectIntoBuffer(txn, slot);
+    EXPECT_TRUE(tested.select_result_);
+    EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), select_tuple, version));
+    txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+    // The GC still processes the txns whose versions were pruned, and only the read-only ones are not deallocated
+    const uint32_t num_txns = 2 * num_updates + 3;
+    EXPECT_EQ(std::make_pair(0U, num_txns), gc->PerformGarbageCollection());
+    EXPECT_EQ(std::make_pair(num_txns - 2, 0U), gc->PerformGarbageCollection());
+  }
+}
 }  // namespace terrier
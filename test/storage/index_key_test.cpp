@@ -3,7 +3,9 @@
 #include <functional>
 #include <limits>
 #include <map>
+#include <optional>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "catalog/index_schema.h"
@@ -14,6 +16,7 @@
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_key.h"
 #include "storage/index/index_builder.h"
+#include "storage/index/normalized_key.h"
 #include "storage/projected_row.h"
 #include "storage/sql_table.h"
 #include "test_util/catalog_test_util.h"
@@ -311,11 +314,10 @@ class IndexKeyTests : public TerrierTest {
   }
 
   /**
-   * Sets the generic key to contain the given string. If c_str is nullptr, the key is zeroed out.
+   * Sets the key to contain the given string. If c_str is nullptr, the key's attribute is NULL.
    */
-  template <uint8_t KeySize>
-  void SetGenericKeyFromString(const IndexMetadata &metadata, GenericKey<KeySize> *key, ProjectedRow *pr,
-                               const char *c_str) {
+  template <typename KeyType>
+  void SetKeyFromString(const IndexMetadata &metadata, KeyType *key, ProjectedRow *pr, const char *c_str) {
     if (c_str != nullptr) {
       auto len = static_cast<uint32_t>(std::strlen(c_str));
 
@@ -338,17 +340,16 @@ class IndexKeyTests : public TerrierTest {
   }
 
   /**
-   * Tests GenericKey's equality and comparison for the two null-terminated c_str's.
+   * Tests the key type's equality and comparison for the two null-terminated c_str's.
    */
-  template <uint8_t KeySize>
-  void TestGenericKeyStrings(const IndexMetadata &metadata, ProjectedRow *pr, char *c_str1, char *c_str2) {
-    const auto generic_eq64 =
-        std::equal_to<GenericKey<KeySize>>();                    // NOLINT transparent functors can't deduce template
-    const auto generic_lt64 = std::less<GenericKey<KeySize>>();  // NOLINT transparent functors can't deduce template
+  template <typename KeyType>
+  void TestKeyStrings(const IndexMetadata &metadata, ProjectedRow *pr, char *c_str1, char *c_str2) {
+    const auto key_eq = std::equal_to<KeyType>();  // NOLINT transparent functors can't deduce template
+    const auto key_lt = std::less<KeyType>();      // NOLINT transparent functors can't deduce template
 
-    GenericKey<KeySize> key1, key2;
-    SetGenericKeyFromString<KeySize>(metadata, &key1, pr, c_str1);
-    SetGenericKeyFromString<KeySize>(metadata, &key2, pr, c_str2);
+    KeyType key1, key2;
+    SetKeyFromString<KeyType>(metadata, &key1, pr, c_str1);
+    SetKeyFromString<KeyType>(metadata, &key2, pr, c_str2);
 
     bool ref_eq, ref_lt;
     if (c_str1 == nullptr && c_str2 == nullptr) {
@@ -369,8 +370,8 @@ class IndexKeyTests : public TerrierTest {
       ref_lt = strcmp(c_str1, c_str2) < 0;
     }
 
-    EXPECT_EQ(generic_eq64(key1, key2), ref_eq);
-    EXPECT_EQ(generic_lt64(key1, key2), ref_lt);
+    EXPECT_EQ(key_eq(key1, key2), ref_eq);
+    EXPECT_EQ(key_lt(key1, key2), ref_lt);
   }
 
  protected:
@@ -1184,34 +1185,153 @@ TEST_F(IndexKeyTests, GenericKeyNonInlineVarlenComparisons) {
   char johnathan_johnathan[20] = "johnathan_johnathan";
 
   // lhs: "johnathan_johnathan", rhs: "johnathan_johnathan" (same prefixes, same strings (both non-inline))
-  TestGenericKeyStrings<64>(metadata, pr, johnathan_johnathan, johnathan_johnathan);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnathan_johnathan, johnathan_johnathan);
 
   // lhs: "johnathan_johnathan", rhs: "johnny_johnny" (same prefixes, different strings (both non-inline))
-  TestGenericKeyStrings<64>(metadata, pr, johnathan_johnathan, johnny_johnny);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnathan_johnathan, johnny_johnny);
 
   // lhs: "johnny_johnny", rhs: "johnathan_johnathan" (same prefixes, different strings (both non-inline))
-  TestGenericKeyStrings<64>(metadata, pr, johnny_johnny, johnathan_johnathan);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnny_johnny, johnathan_johnathan);
 
   // lhs: "johnny_johnny", rhs: "john" (same prefixes, different strings (one <=prefix))
-  TestGenericKeyStrings<64>(metadata, pr, johnny_johnny, john);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnny_johnny, john);
 
   // lhs: "john", rhs: "johnny_johnny" (same prefixes, different strings (one <=prefix))
-  TestGenericKeyStrings<64>(metadata, pr, john, johnny_johnny);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, john, johnny_johnny);
 
   // lhs: "johnny", rhs: "johnny_johnny" (same prefixes, different strings (one inline))
-  TestGenericKeyStrings<64>(metadata, pr, johnny, johnny_johnny);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnny, johnny_johnny);
 
   // lhs: "johnny_johnny", rhs: "johnny" (same prefixes, different strings (one inline))
-  TestGenericKeyStrings<64>(metadata, pr, johnny_johnny, johnny);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnny_johnny, johnny);
 
   // lhs: "johnny_johnny", rhs: NULL
-  TestGenericKeyStrings<64>(metadata, pr, johnny_johnny, nullptr);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, johnny_johnny, nullptr);
 
   // lhs: NULL, rhs: NULL
-  TestGenericKeyStrings<64>(metadata, pr, nullptr, nullptr);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, nullptr, nullptr);
 
   // lhs: NULL, rhs: "johnny_johnny"
-  TestGenericKeyStrings<64>(metadata, pr, nullptr, johnny_johnny);
+  TestKeyStrings<GenericKey<64>>(metadata, pr, nullptr, johnny_johnny);
+
+  delete[] pr_buffer;
+}
+
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, NormalizedKeyNumericComparisons) {
+  NumericComparisons<NormalizedKey<16>, int8_t>(type::TypeId::TINYINT, true);
+  NumericComparisons<NormalizedKey<16>, int16_t>(type::TypeId::SMALLINT, true);
+  NumericComparisons<NormalizedKey<16>, int32_t>(type::TypeId::INTEGER, true);
+  NumericComparisons<NormalizedKey<16>, uint32_t>(type::TypeId::DATE, true);
+  NumericComparisons<NormalizedKey<16>, int64_t>(type::TypeId::BIGINT, true);
+  NumericComparisons<NormalizedKey<16>, double>(type::TypeId::DECIMAL, true);
+  NumericComparisons<NormalizedKey<16>, uint64_t>(type::TypeId::TIMESTAMP, true);
+}
+
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, NormalizedKeyVarlenComparisons) {
+  std::vector<catalog::IndexSchema::Column> key_cols;
+  key_cols.emplace_back("", type::TypeId::VARCHAR, 20, true,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::VARCHAR)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(0));
+
+  const IndexMetadata metadata(
+      catalog::IndexSchema(key_cols, storage::index::IndexType::BPLUSTREE, false, false, false, true));
+  const auto &initializer = metadata.GetProjectedRowInitializer();
+
+  auto *const pr_buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+  auto *const pr = initializer.InitializeRow(pr_buffer);
+
+  char empty[1] = "";
+  char john[5] = "john";
+  char johnny[7] = "johnny";
+  char johnny_johnny[14] = "johnny_johnny";
+  char johnathan_johnathan[20] = "johnathan_johnathan";
+  std::vector<char *> strings{nullptr, empty, john, johnny, johnny_johnny, johnathan_johnathan};
+
+  // Every pair of strings, including NULLs, the empty string, strings that are prefixes of each other, and strings of
+  // the column's maximum length
+  for (auto *const lhs : strings) {
+    for (auto *const rhs : strings) TestKeyStrings<NormalizedKey<32>>(metadata, pr, lhs, rhs);
+  }
+
+  delete[] pr_buffer;
+}
+
+// Composite keys must order the same way as their GenericKey counterparts, also when only a prefix of their attributes
+// is compared
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, NormalizedKeyMatchesGenericKey) {
+  std::vector<catalog::IndexSchema::Column> key_cols;
+  key_cols.emplace_back("", type::TypeId::INTEGER, true,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::INTEGER)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(0));
+  key_cols.emplace_back("", type::TypeId::DECIMAL, false,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::DECIMAL)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(1));
+  key_cols.emplace_back("", type::TypeId::VARCHAR, 20, true,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::VARCHAR)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(2));
+
+  const IndexMetadata metadata(
+      catalog::IndexSchema(key_cols, storage::index::IndexType::BPLUSTREE, false, false, false, true));
+  const auto &initializer = metadata.GetProjectedRowInitializer();
+  const auto &oid_offset_map = metadata.GetKeyOidToOffsetMap();
+  EXPECT_EQ(metadata.NormalizedKeySize(), (1 + 4) + 8 + (1 + 20 + 2));
+
+  auto *const pr_buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+  auto *const pr = initializer.InitializeRow(pr_buffer);
+
+  const std::vector<std::optional<int32_t>> integers{std::nullopt, std::numeric_limits<int32_t>::min(), -5, 0, 7,
+                                                     std::numeric_limits<int32_t>::max()};
+  const std::vector<double> decimals{-std::numeric_limits<double>::infinity(), -1.5, -0.0, 0.0, 2.25, 1e300};
+  std::vector<std::string> varchars{"", "a", "ab", "johnathan_johnathan", "johnny"};
+
+  std::vector<GenericKey<128>> generic_keys;
+  std::vector<NormalizedKey<64>> normalized_keys;
+  for (const auto &integer : integers) {
+    for (const auto decimal : decimals) {
+      for (uint32_t i = 0; i <= varchars.size(); i++) {
+        const auto integer_offset = oid_offset_map.at(catalog::indexkeycol_oid_t(0));
+        if (integer.has_value()) {
+          *reinterpret_cast<int32_t *>(pr->AccessForceNotNull(integer_offset)) = *integer;
+        } else {
+          pr->SetNull(integer_offset);
+        }
+        *reinterpret_cast<double *>(pr->AccessForceNotNull(oid_offset_map.at(catalog::indexkeycol_oid_t(1)))) =
+            decimal;
+        const auto varchar_offset = oid_offset_map.at(catalog::indexkeycol_oid_t(2));
+        if (i < varchars.size()) {
+          const auto &varchar = varchars[i];
+          *reinterpret_cast<VarlenEntry *>(pr->AccessForceNotNull(varchar_offset)) =
+              varchar.size() <= VarlenEntry::InlineThreshold()
+                  ? VarlenEntry::CreateInline(reinterpret_cast<const byte *>(varchar.data()),
+                                              static_cast<uint32_t>(varchar.size()))
+                  : VarlenEntry::Create(reinterpret_cast<const byte *>(varchar.data()),
+                                        static_cast<uint32_t>(varchar.size()), false);
+        } else {
+          pr->SetNull(varchar_offset);
+        }
+        generic_keys.emplace_back().SetFromProjectedRow(*pr, metadata, key_cols.size());
+        normalized_keys.emplace_back().SetFromProjectedRow(*pr, metadata, key_cols.size());
+      }
+    }
+  }
+
+  const auto generic_eq = std::equal_to<GenericKey<128>>();        // NOLINT transparent functors can't deduce template
+  const auto generic_lt = std::less<GenericKey<128>>();            // NOLINT transparent functors can't deduce template
+  const auto normalized_eq = std::equal_to<NormalizedKey<64>>();   // NOLINT transparent functors can't deduce template
+  const auto normalized_lt = std::less<NormalizedKey<64>>();       // NOLINT transparent functors can't deduce template
+  for (uint32_t i = 0; i < generic_keys.size(); i++) {
+    for (uint32_t j = 0; j < generic_keys.size(); j++) {
+      EXPECT_EQ(normalized_eq(normalized_keys[i], normalized_keys[j]), generic_eq(generic_keys[i], generic_keys[j]));
+      EXPECT_EQ(normalized_lt(normalized_keys[i], normalized_keys[j]), generic_lt(generic_keys[i], generic_keys[j]));
+      for (uint32_t num_attrs = 1; num_attrs <= key_cols.size(); num_attrs++) {
+        EXPECT_EQ(normalized_keys[i].PartialLessThan(normalized_keys[j], &metadata, num_attrs),
+                  generic_keys[i].PartialLessThan(generic_keys[j], &metadata, num_attrs));
+      }
+    }
+  }
 
   delete[] pr_buffer;
 }
@@ -1255,6 +1375,30 @@ TEST_F(IndexKeyTests, GenericKeyBuilderTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, NormalizedKeyBuilderTest) {
+  const uint32_t num_iters = 100;
+
+  const std::vector<type::TypeId> generic_key_types{
+      type::TypeId::BOOLEAN, type::TypeId::TINYINT,  type::TypeId::SMALLINT,  type::TypeId::INTEGER,
+      type::TypeId::BIGINT,  type::TypeId::DECIMAL,  type::TypeId::TIMESTAMP, type::TypeId::DATE,
+      type::TypeId::VARCHAR, type::TypeId::VARBINARY};
+
+  for (uint32_t i = 0; i < num_iters; i++) {
+    auto key_schema = StorageTestUtil::RandomGenericKeySchema(10, generic_key_types, &generator_);
+
+    key_schema.SetType(storage::index::IndexType::BPLUSTREE);
+
+    IndexBuilder builder;
+    builder.SetKeySchema(key_schema);
+    auto *index = builder.Build();
+    EXPECT_EQ(index->KeyKind(), storage::index::IndexKeyKind::NORMALIZEDKEY);
+    BasicOps(index);
+
+    delete index;
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(IndexKeyTests, HashKeyBuilderTest) {
   const uint32_t num_iters = 100;
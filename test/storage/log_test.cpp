@@ -451,4 +451,336 @@ TEST_F(WriteAheadLoggingTests, ReadOnlyCallbackTest) {
   // DeferredAction
   db_main_->GetTransactionLayer()->GetDeferredActionManager()->RegisterDeferredAction([=]() { delete sql_table; });
 }
+
+// Reads back the values written to a log with LogFile::Write, which bypasses framing
+std::vector<uint32_t> ReadRawValues(const std::string &log_file_path) {
+  std::vector<uint32_t> result;
+  for (const auto &path : LogFile::FilePaths(log_file_path)) {
+    const int fd = PosixIoWrappers::Open(path.c_str(), O_RDONLY);
+    uint32_t value;
+    while (PosixIoWrappers::ReadFully(fd, &value, sizeof(value)) == sizeof(value)) result.push_back(value);
+    PosixIoWrappers::Close(fd);
+  }
+  return result;
+}
+
+// A segmented log should read back as one stream, continue after existing segments when reopened, and only drop the
+// oldest segments whose transactions all started before the given timestamp
+// NOLINTNEXTLINE
+TEST(LogFileTests, SegmentRotationTest) {
+  const std::string log_file_path = LOG_FILE_NAME;
+  const auto remove_log = [&] {
+    for (const auto &path : LogFile::FilePaths(log_file_path)) unlink(path.c_str());
+  };
+  remove_log();
+
+  std::vector<uint32_t> written;
+  const auto write_values = [&](LogFile *log, uint32_t num_values) {
+    for (uint32_t i = 0; i < num_values; i++) {
+      const auto value = static_cast<uint32_t>(written.size());
+      log->Write(&value, sizeof(value));
+      written.push_back(value);
+    }
+  };
+  const auto read_values = [&] { return ReadRawValues(log_file_path); };
+
+  // Segments need not end at a buffer boundary
+  auto log = std::make_unique<LogFile>(log_file_path, uint64_t{common::Constants::LOG_BUFFER_SIZE});
+  write_values(log.get(), 1500);
+  log->EndSegment(transaction::timestamp_t(10));
+  write_values(log.get(), 700);
+  log->EndSegment(transaction::timestamp_t(20));
+  write_values(log.get(), 300);
+  log->Close();
+  EXPECT_EQ(3, LogFile::FilePaths(log_file_path).size());
+  EXPECT_EQ(written, read_values());
+
+  // Everything from before a restart is done with, but the new segment is still being written
+  log = std::make_unique<LogFile>(log_file_path, uint64_t{common::Constants::LOG_BUFFER_SIZE});
+  write_values(log.get(), 100);
+  log->EndSegment(transaction::timestamp_t(30));
+  write_values(log.get(), 100);
+  log->EndSegment(transaction::timestamp_t(40));
+  EXPECT_EQ(6, LogFile::FilePaths(log_file_path).size());
+  EXPECT_EQ(4, log->RemoveSegmentsBefore(transaction::timestamp_t(35)));
+  EXPECT_EQ(0, log->RemoveSegmentsBefore(transaction::timestamp_t(35)));
+  log->Close();
+  EXPECT_EQ(2, LogFile::FilePaths(log_file_path).size());
+  EXPECT_EQ(std::vector<uint32_t>(written.end() - 100, written.end()), read_values());
+  remove_log();
+}
+
+// Writing through io_uring should produce the same log as posix calls, falling back to them where unavailable
+// NOLINTNEXTLINE
+TEST(LogFileTests, IoUringTest) {
+  const std::string log_file_path = LOG_FILE_NAME;
+  const auto remove_log = [&] {
+    for (const auto &path : LogFile::FilePaths(log_file_path)) unlink(path.c_str());
+  };
+
+  // Enough values for many batches to be in flight, written in chunks that do not line up with batches
+  const uint32_t chunk_size = 999;
+  std::vector<uint32_t> written(1000 * chunk_size);
+  for (uint32_t i = 0; i < written.size(); i++) written[i] = i;
+  for (const uint64_t segment_size : {uint64_t{0}, uint64_t{1} << 20U}) {
+    remove_log();
+    LogFile log(log_file_path, segment_size, true);
+    for (uint32_t chunk = 0; chunk < written.size() / chunk_size; chunk++) {
+      log.Write(&written[chunk * chunk_size], chunk_size * sizeof(uint32_t));
+      if (chunk % 100 == 0) log.Persist();
+      if (segment_size != 0 && chunk % 300 == 299) log.EndSegment(transaction::timestamp_t(chunk));
+    }
+    log.Close();
+    EXPECT_EQ(written, ReadRawValues(log_file_path));
+  }
+  remove_log();
+}
+
+// Frames should read back the same whether compressed or not, and a log file should end at the first frame that was
+// torn or corrupted
+// NOLINTNEXTLINE
+TEST(LogFileTests, FrameTest) {
+  EXPECT_EQ(0xE3069283, LogFrame::Checksum("123456789", 9));
+
+  const std::string log_file_path = LOG_FILE_NAME;
+  const uint32_t num_frames = 10;
+  const uint32_t values_per_frame = common::Constants::LOG_BUFFER_SIZE / sizeof(uint32_t);
+  const auto read_values = [&] {
+    std::vector<uint32_t> result;
+    BufferedLogReader in(log_file_path.c_str());
+    uint32_t value;
+    while (in.Read(&value, sizeof(value))) result.push_back(value);
+    return result;
+  };
+
+  std::default_random_engine generator;
+  for (const bool compress : {false, true}) {
+    unlink(log_file_path.c_str());
+    // Half of every frame repeats one value and compresses well, the other half is random and does not
+    std::vector<uint32_t> written;
+    std::vector<uint64_t> frame_ends;
+    LogFile log(log_file_path, 0);
+    BufferedLogWriter writer(&log, compress);
+    uint64_t file_size = 0;
+    for (uint32_t frame = 0; frame < num_frames; frame++) {
+      for (uint32_t i = 0; i < values_per_frame; i++) {
+        const uint32_t value = i % 2 == 0 ? frame : std::uniform_int_distribution<uint32_t>()(generator);
+        writer.BufferWrite(&value, sizeof(value));
+        written.push_back(value);
+      }
+      file_size += writer.FlushBuffer();
+      frame_ends.push_back(file_size);
+    }
+    log.Close();
+    if (compress) {
+      EXPECT_LT(file_size, written.size() * sizeof(uint32_t));
+    }
+    EXPECT_EQ(written, read_values());
+
+    // A torn write of the last frame drops it
+    ASSERT_EQ(0, truncate(log_file_path.c_str(), static_cast<off_t>(frame_ends[num_frames - 1] - 1)));
+    written.resize((num_frames - 1) * values_per_frame);
+    EXPECT_EQ(written, read_values());
+
+    // Reopening the log cuts the torn frame off, so that appends follow the last whole frame
+    LogFile reopened(log_file_path, 0);
+    reopened.Close();
+    struct stat file_stat;
+    ASSERT_EQ(0, stat(log_file_path.c_str(), &file_stat));
+    EXPECT_EQ(static_cast<off_t>(frame_ends[num_frames - 2]), file_stat.st_size);
+    EXPECT_EQ(written, read_values());
+
+    // A corrupted frame ends the file, and thus a log that has only one
+    const int fd = PosixIoWrappers::Open(log_file_path.c_str(), O_RDWR);
+    const auto corrupted_at = static_cast<off_t>(frame_ends[4] + LogFrame::HEADER_SIZE + 10);
+    byte corrupted;
+    ASSERT_EQ(1, pread(fd, &corrupted, 1, corrupted_at));
+    corrupted = ~corrupted;
+    PosixIoWrappers::WriteFullyAt(fd, &corrupted, 1, corrupted_at);
+    PosixIoWrappers::Close(fd);
+    written.resize(5 * values_per_frame);
+    EXPECT_EQ(written, read_values());
+  }
+  unlink(log_file_path.c_str());
+}
+
+// A crash that tears the last frame of a segment should only drop that frame, which the restarted run cuts off before
+// starting new segments. A corrupted frame in any segment but the last one should fail the read instead.
+// NOLINTNEXTLINE
+TEST(LogFileTests, TornSegmentTest) {
+  const std::string log_file_path = LOG_FILE_NAME;
+  const auto remove_log = [&] {
+    for (const auto &path : LogFile::FilePaths(log_file_path)) unlink(path.c_str());
+  };
+  remove_log();
+
+  const uint32_t values_per_frame = common::Constants::LOG_BUFFER_SIZE / sizeof(uint32_t);
+  std::vector<uint32_t> written;
+  const auto write_frames = [&](uint32_t num_frames) {
+    LogFile log(log_file_path, uint64_t{1} << 20U);
+    BufferedLogWriter writer(&log, false);
+    for (uint32_t frame = 0; frame < num_frames; frame++) {
+      for (uint32_t i = 0; i < values_per_frame; i++) {
+        const auto value = static_cast<uint32_t>(written.size());
+        writer.BufferWrite(&value, sizeof(value));
+        written.push_back(value);
+      }
+      writer.FlushBuffer();
+    }
+    log.Close();
+  };
+
+  // The first run crashes while writing the last frame of its segment
+  write_frames(3);
+  const std::string torn_segment = LogFile::FilePaths(log_file_path).back();
+  struct stat file_stat;
+  ASSERT_EQ(0, stat(torn_segment.c_str(), &file_stat));
+  ASSERT_EQ(0, truncate(torn_segment.c_str(), file_stat.st_size - 1));
+  written.erase(written.begin() + 2 * values_per_frame, written.end());
+
+  // The restarted run continues in a new segment
+  write_frames(2);
+  EXPECT_EQ(2, LogFile::FilePaths(log_file_path).size());
+
+  ASSERT_EQ(0, stat(torn_segment.c_str(), &file_stat));
+  EXPECT_EQ(2 * (LogFrame::HEADER_SIZE + common::Constants::LOG_BUFFER_SIZE), file_stat.st_size);
+  const auto read_values = [&] {
+    std::vector<uint32_t> result;
+    BufferedLogReader in(LogFile::FilePaths(log_file_path));
+    uint32_t value;
+    while (in.Read(&value, sizeof(value))) result.push_back(value);
+    return result;
+  };
+  EXPECT_EQ(written, read_values());
+
+  const int fd = PosixIoWrappers::Open(torn_segment.c_str(), O_RDWR);
+  const off_t corrupted_at = LogFrame::HEADER_SIZE + 10;
+  byte corrupted;
+  ASSERT_EQ(1, pread(fd, &corrupted, 1, corrupted_at));
+  corrupted = ~corrupted;
+  PosixIoWrappers::WriteFullyAt(fd, &corrupted, 1, corrupted_at);
+  PosixIoWrappers::Close(fd);
+  EXPECT_THROW(read_values(), std::runtime_error);
+  remove_log();
+}
+
+// The streams of a log should only be read up to the last round that ended in all of them, which is also where they
+// are cut back to before being appended to again. Removing segments should not lose the marker of the last round.
+// NOLINTNEXTLINE
+TEST(LogFileTests, RoundTest) {
+  const std::string log_file_path = LOG_FILE_NAME;
+  const uint32_t num_streams = 2;
+  const auto remove_log = [&] {
+    for (const auto &paths : LogFile::StreamFilePaths(log_file_path)) {
+      for (const auto &path : paths) unlink(path.c_str());
+    }
+  };
+  remove_log();
+  EXPECT_EQ(0, LogFile::TruncateToCommonRound(log_file_path));
+
+  const uint32_t values_per_frame = common::Constants::LOG_BUFFER_SIZE / sizeof(uint32_t);
+  std::vector<std::vector<uint32_t>> written(num_streams);
+  std::vector<std::unique_ptr<LogFile>> logs;
+  const auto open_logs = [&](uint64_t last_round) {
+    logs.clear();
+    for (uint32_t stream = 0; stream < num_streams; stream++) {
+      logs.emplace_back(std::make_unique<LogFile>(LogFile::StreamPath(log_file_path, stream), uint64_t{1} << 20U));
+      logs.back()->MarkRounds(last_round);
+    }
+  };
+  const auto write_frame = [&](uint32_t stream, bool ends_round, bool ends_segment) {
+    BufferedLogWriter writer(logs[stream].get(), false);
+    for (uint32_t i = 0; i < values_per_frame; i++) {
+      const auto value = static_cast<uint32_t>(written[stream].size());
+      writer.BufferWrite(&value, sizeof(value));
+      written[stream].push_back(value);
+    }
+    if (ends_round) writer.EndRound();
+    if (ends_segment) writer.EndSegment(transaction::timestamp_t(0));
+    writer.FlushBuffer();
+  };
+  const auto read_values = [&](uint32_t stream, uint64_t last_round) {
+    std::vector<uint32_t> result;
+    BufferedLogReader in(LogFile::FilePaths(LogFile::StreamPath(log_file_path, stream)));
+    in.StopAfterRound(last_round);
+    uint32_t value;
+    while (in.Read(&value, sizeof(value))) result.push_back(value);
+    return result;
+  };
+
+  // Three rounds make it to both streams, the second stream ends a segment in the last one of them
+  open_logs(0);
+  for (uint32_t round = 0; round < 3; round++) {
+    write_frame(0, true, false);
+    write_frame(1, true, round == 2);
+  }
+  EXPECT_EQ(1, logs[1]->RemoveSegmentsBefore(transaction::timestamp_t(1)));
+  // The fourth round is only persisted in the first stream when the system crashes
+  write_frame(0, true, false);
+  write_frame(1, false, false);
+  for (auto &log : logs) log->Close();
+  const auto torn_segment = LogFile::FilePaths(LogFile::StreamPath(log_file_path, 1)).back();
+  struct stat file_stat;
+  ASSERT_EQ(0, stat(torn_segment.c_str(), &file_stat));
+  ASSERT_EQ(0, truncate(torn_segment.c_str(), file_stat.st_size - 1));
+
+  EXPECT_EQ(3, LogFile::CommonRound(LogFile::StreamFilePaths(log_file_path)));
+  const auto three_rounds = std::vector<uint32_t>(written[0].begin(), written[0].begin() + 3 * values_per_frame);
+  EXPECT_EQ(three_rounds, read_values(0, 3));
+  EXPECT_TRUE(read_values(1, 3).empty());
+  EXPECT_TRUE(read_values(0, 0).empty());
+
+  // The restarted run cuts the first stream back to the third round, and the rounds of both streams line up again
+  EXPECT_EQ(3, LogFile::TruncateToCommonRound(log_file_path));
+  written[0].resize(3 * values_per_frame);
+  written[1].resize(3 * values_per_frame);
+  open_logs(3);
+  write_frame(0, true, false);
+  write_frame(1, true, false);
+  for (auto &log : logs) log->Close();
+  EXPECT_EQ(4, LogFile::CommonRound(LogFile::StreamFilePaths(log_file_path)));
+  EXPECT_EQ(written[0], read_values(0, 4));
+  EXPECT_EQ(std::vector<uint32_t>(written[1].end() - values_per_frame, written[1].end()), read_values(1, 4));
+  remove_log();
+}
+
+// Renaming a log should move the files of every stream and segment, so that they read the same at the new path
+// NOLINTNEXTLINE
+TEST(LogFileTests, RenameTest) {
+  const std::string log_file_path = LOG_FILE_NAME;
+  const std::string new_log_file_path = std::string(LOG_FILE_NAME) + ".renamed";
+  LogFile::Remove(log_file_path);
+  LogFile::Remove(new_log_file_path);
+
+  // The first stream is segmented, the second one is not
+  std::vector<std::vector<uint32_t>> written(2);
+  for (uint32_t stream = 0; stream < written.size(); stream++) {
+    LogFile log(LogFile::StreamPath(log_file_path, stream),
+                stream == 0 ? uint64_t{common::Constants::LOG_BUFFER_SIZE} : 0);
+    for (uint32_t i = 0; i < 2000; i++) {
+      const auto value = static_cast<uint32_t>(written[stream].size());
+      log.Write(&value, sizeof(value));
+      written[stream].push_back(value);
+      if (stream == 0 && i % 500 == 499) log.EndSegment(transaction::timestamp_t(i));
+    }
+    log.Close();
+  }
+  const auto stream_file_paths = LogFile::StreamFilePaths(log_file_path);
+  ASSERT_EQ(2, stream_file_paths.size());
+  ASSERT_EQ(5, stream_file_paths[0].size());
+
+  LogFile::Rename(log_file_path, new_log_file_path);
+  EXPECT_EQ(1, LogFile::StreamFilePaths(log_file_path).size());
+  EXPECT_TRUE(LogFile::FilePaths(log_file_path).empty());
+  const auto new_stream_file_paths = LogFile::StreamFilePaths(new_log_file_path);
+  ASSERT_EQ(2, new_stream_file_paths.size());
+  EXPECT_EQ(stream_file_paths[0].size(), new_stream_file_paths[0].size());
+  for (uint32_t stream = 0; stream < written.size(); stream++) {
+    EXPECT_EQ(written[stream], ReadRawValues(LogFile::StreamPath(new_log_file_path, stream)));
+  }
+
+  LogFile::Remove(new_log_file_path);
+  EXPECT_EQ(1, LogFile::StreamFilePaths(new_log_file_path).size());
+  EXPECT_TRUE(LogFile::FilePaths(new_log_file_path).empty());
+}
 }  // namespace terrier::storage
@@ -1,3 +1,6 @@
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -9,6 +12,7 @@
 #include "main/db_main.h"
 #include "storage/garbage_collector_thread.h"
 #include "storage/index/index_builder.h"
+#include "storage/recovery/checkpoint_manager.h"
 #include "storage/recovery/disk_log_provider.h"
 #include "storage/recovery/recovery_manager.h"
 #include "storage/sql_table.h"
@@ -24,6 +28,7 @@
 // executions will read old test's data, and the cause of the errors will be hard to identify. Trust me it will drive
 // you nuts...
 #define LOG_FILE_NAME "./test.log"
+#define CHECKPOINT_FILE_NAME "./test.checkpoint"
 
 namespace terrier::storage {
 class RecoveryTests : public TerrierTest {
@@ -45,13 +50,30 @@ class RecoveryTests : public TerrierTest {
   common::ManagedPointer<catalog::Catalog> recovery_catalog_;
   common::ManagedPointer<common::DedicatedThreadRegistry> recovery_thread_registry_;
 
-  void SetUp() override {
-    // Unlink log file incase one exists from previous test iteration
-    unlink(LOG_FILE_NAME);
+  // Removes the files of every log stream
+  static void RemoveLogFiles() {
+    for (const auto &stream : LogFile::StreamFilePaths(LOG_FILE_NAME)) {
+      for (const auto &path : stream) unlink(path.c_str());
+    }
+  }
+
+  // Removes the files of every log stream, the checkpoint, and whatever a DBMain set aside to recover
+  static void RemoveFiles() {
+    RemoveLogFiles();
+    unlink(CHECKPOINT_FILE_NAME);
+    RecoveryManager::RemoveSetAside(LOG_FILE_NAME, CHECKPOINT_FILE_NAME);
+  }
 
+  void StartSystem(const uint32_t num_log_serializers, const uint64_t log_segment_size = 0,
+                   const bool recover = false) {
     db_main_ = terrier::DBMain::Builder()
                    .SetLogFilePath(LOG_FILE_NAME)
                    .SetUseLogging(true)
+                   .SetNumLogSerializers(num_log_serializers)
+                   .SetLogSegmentSize(log_segment_size)
+                   .SetUseRecovery(recover)
+                   .SetUseCheckpoints(recover)
+                   .SetCheckpointFilePath(CHECKPOINT_FILE_NAME)
                    .SetUseGC(true)
                    .SetUseGCThread(true)
                    .SetUseCatalog(true)
@@ -60,6 +82,13 @@ class RecoveryTests : public TerrierTest {
     log_manager_ = db_main_->GetLogManager();
     block_store_ = db_main_->GetStorageLayer()->GetBlockStore();
     catalog_ = db_main_->GetCatalogLayer()->GetCatalog();
+  }
+
+  void SetUp() override {
+    // Unlink log file incase one exists from previous test iteration
+    RemoveFiles();
+
+    StartSystem(1);
 
     recovery_db_main_ = terrier::DBMain::Builder()
                             .SetUseThreadRegistry(true)
@@ -77,7 +106,7 @@ class RecoveryTests : public TerrierTest {
 
   void TearDown() override {
     // Delete log file
-    unlink(LOG_FILE_NAME);
+    RemoveFiles();
   }
 
   catalog::IndexSchema DummyIndexSchema() {
@@ -158,6 +187,77 @@ class RecoveryTests : public TerrierTest {
     return table->table_.layout_;
   }
 
+  // Inserts the integers in [begin, end) into a table created by CreateTable, in one transaction
+  void InsertIntegers(const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid, const int32_t begin,
+                      const int32_t end) {
+    auto *txn = txn_manager_->BeginTransaction();
+    auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+    auto table_ptr = db_catalog->GetTable(common::ManagedPointer(txn), table_oid);
+    const auto &schema = db_catalog->GetSchema(common::ManagedPointer(txn), table_oid);
+    auto initializer = table_ptr->InitializerForProjectedRow({schema.GetColumn(0).Oid()});
+    for (int32_t i = begin; i < end; i++) {
+      auto *redo_record = txn->StageWrite(db_oid, table_oid, initializer);
+      *reinterpret_cast<int32_t *>(redo_record->Delta()->AccessForceNotNull(0)) = i;
+      table_ptr->Insert(common::ManagedPointer(txn), redo_record);
+    }
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  }
+
+  // Returns the sorted values of a table that InsertIntegers inserted into
+  static std::vector<int32_t> ReadIntegers(const common::ManagedPointer<catalog::Catalog> catalog,
+                                           const common::ManagedPointer<transaction::TransactionManager> txn_manager,
+                                           const catalog::db_oid_t db_oid, const catalog::table_oid_t table_oid) {
+    std::vector<int32_t> values;
+    auto *txn = txn_manager->BeginTransaction();
+    auto db_catalog = catalog->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+    EXPECT_TRUE(db_catalog);
+    auto table_ptr = db_catalog == nullptr ? common::ManagedPointer<SqlTable>(nullptr)
+                                           : db_catalog->GetTable(common::ManagedPointer(txn), table_oid);
+    EXPECT_TRUE(table_ptr);
+    if (table_ptr != nullptr) {
+      const auto &schema = db_catalog->GetSchema(common::ManagedPointer(txn), table_oid);
+      auto initializer = table_ptr->InitializerForProjectedRow({schema.GetColumn(0).Oid()});
+      auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+      auto *row = initializer.InitializeRow(buffer);
+      for (auto it = table_ptr->begin(); it != table_ptr->end(); it++) {
+        if (table_ptr->Select(common::ManagedPointer(txn), *it, row)) {
+          values.push_back(*reinterpret_cast<int32_t *>(row->AccessWithNullCheck(0)));
+        }
+      }
+      delete[] buffer;
+    }
+    txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    std::sort(values.begin(), values.end());
+    return values;
+  }
+
+  // Checks that every table of the workload was recovered with the same contents
+  void CheckRecoveredTables(LargeSqlTableTestObject *const tested, RecoveryManager *const recovery_manager) {
+    for (auto &database : tested->GetTables()) {
+      auto database_oid = database.first;
+      for (auto &table_oid : database.second) {
+        // Get original sql table
+        auto original_txn = txn_manager_->BeginTransaction();
+        auto original_sql_table = catalog_->GetDatabaseCatalog(common::ManagedPointer(original_txn), database_oid)
+                                      ->GetTable(common::ManagedPointer(original_txn), table_oid);
+
+        // Get Recovered table
+        auto *recovery_txn = recovery_txn_manager_->BeginTransaction();
+        auto db_catalog = recovery_catalog_->GetDatabaseCatalog(common::ManagedPointer(recovery_txn), database_oid);
+        EXPECT_TRUE(db_catalog != nullptr);
+        auto recovered_sql_table = db_catalog->GetTable(common::ManagedPointer(recovery_txn), table_oid);
+        EXPECT_TRUE(recovered_sql_table != nullptr);
+
+        EXPECT_TRUE(StorageTestUtil::SqlTableEqualDeep(
+            original_sql_table->table_.layout_, original_sql_table, recovered_sql_table,
+            tested->GetTupleSlotsForTable(database_oid, table_oid), recovery_manager->tuple_slot_map_,
+            txn_manager_.Get(), recovery_txn_manager_.Get()));
+        txn_manager_->Commit(original_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+        recovery_txn_manager_->Commit(recovery_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+      }
+    }
+  }
+
   // Simulates the system shutting down and restarting
   void ShutdownAndRestartSystem() {
     // Simulate the system "shutting down". Guarantee persist of log records
@@ -184,12 +284,21 @@ class RecoveryTests : public TerrierTest {
     recovery_manager.WaitForRecoveryToFinish();
   }
 
-  void RunTest(const LargeSqlTableTestConfiguration &config) {
+  void RunTest(const LargeSqlTableTestConfiguration &config, const bool checkpoint = false,
+               const uint32_t num_replay_threads = 1) {
     // Run workload
     auto *tested =
         new LargeSqlTableTestObject(config, txn_manager_.Get(), catalog_.Get(), block_store_.Get(), &generator_);
     tested->SimulateOltp(100, 4);
 
+    // Checkpoint in the middle of the workload, so that recovery needs both the checkpoint and the log after it
+    if (checkpoint) {
+      // The checkpoint is taken directly rather than by a background task, so no thread registry is needed
+      CheckpointManager checkpoint_manager{CHECKPOINT_FILE_NAME, catalog_, txn_manager_, nullptr};
+      checkpoint_manager.Checkpoint();
+      tested->SimulateOltp(100, 4);
+    }
+
     ShutdownAndRestartSystem();
 
     // Instantiate recovery manager, and recover the tables.
@@ -199,34 +308,14 @@ class RecoveryTests : public TerrierTest {
                                      recovery_txn_manager_,
                                      recovery_deferred_action_manager_,
                                      recovery_thread_registry_,
-                                     recovery_block_store_};
+                                     recovery_block_store_,
+                                     checkpoint ? CHECKPOINT_FILE_NAME : "",
+                                     num_replay_threads};
     recovery_manager.StartRecovery();
     recovery_manager.WaitForRecoveryToFinish();
 
     // Check we recovered all the original tables
-    for (auto &database : tested->GetTables()) {
-      auto database_oid = database.first;
-      for (auto &table_oid : database.second) {
-        // Get original sql table
-        auto original_txn = txn_manager_->BeginTransaction();
-        auto original_sql_table = catalog_->GetDatabaseCatalog(common::ManagedPointer(original_txn), database_oid)
-                                      ->GetTable(common::ManagedPointer(original_txn), table_oid);
-
-        // Get Recovered table
-        auto *recovery_txn = recovery_txn_manager_->BeginTransaction();
-        auto db_catalog = recovery_catalog_->GetDatabaseCatalog(common::ManagedPointer(recovery_txn), database_oid);
-        EXPECT_TRUE(db_catalog != nullptr);
-        auto recovered_sql_table = db_catalog->GetTable(common::ManagedPointer(recovery_txn), table_oid);
-        EXPECT_TRUE(recovered_sql_table != nullptr);
-
-        EXPECT_TRUE(StorageTestUtil::SqlTableEqualDeep(
-            original_sql_table->table_.layout_, original_sql_table, recovered_sql_table,
-            tested->GetTupleSlotsForTable(database_oid, table_oid), recovery_manager.tuple_slot_map_,
-            txn_manager_.Get(), recovery_txn_manager_.Get()));
-        txn_manager_->Commit(original_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
-        recovery_txn_manager_->Commit(recovery_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
-      }
-    }
+    CheckRecoveredTables(tested, &recovery_manager);
     // the table can't be freed until after all GC on it is guaranteed to be done. The easy way to do that is to use a
     // DeferredAction
     db_main_->GetTransactionLayer()->GetDeferredActionManager()->RegisterDeferredAction([=]() { delete tested; });
@@ -249,6 +338,465 @@ TEST_F(RecoveryTests, SingleTableTest) {
   RecoveryTests::RunTest(config);
 }
 
+// This test takes a checkpoint in the middle of a workload on multiple tables. It then recreates the tables from the
+// checkpoint and the log records of transactions that committed after it, and verifies that the recovered tables are
+// the same as the original tables
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, CheckpointTest) {
+  LargeSqlTableTestConfiguration config = LargeSqlTableTestConfiguration::Builder()
+                                              .SetNumDatabases(2)
+                                              .SetNumTables(2)
+                                              .SetMaxColumns(5)
+                                              .SetInitialTableSize(1000)
+                                              .SetTxnLength(5)
+                                              .SetInsertUpdateSelectDeleteRatio({0.2, 0.5, 0.2, 0.1})
+                                              .SetVarlenAllowed(true)
+                                              .Build();
+  RecoveryTests::RunTest(config, true /* checkpoint */);
+}
+
+// This test checkpoints a table with an index, and inserts more tuples into it after the checkpoint. It then recovers
+// from the checkpoint and the log tail, and verifies that the rebuilt index holds every tuple of the recovered table
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, CheckpointIndexTest) {
+  std::string database_name = "testdb";
+  auto namespace_oid = catalog::postgres::NAMESPACE_DEFAULT_NAMESPACE_OID;
+  const int32_t num_checkpointed = 1000;
+  const int32_t num_logged = 100;
+
+  // Create database, table and index
+  auto *txn = txn_manager_->BeginTransaction();
+  auto db_oid = CreateDatabase(txn, catalog_, database_name);
+  auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+  auto table_oid = CreateTable(txn, db_catalog, namespace_oid, "testtable");
+  auto index_oid = CreateIndex(txn, db_catalog, namespace_oid, table_oid, "testindex");
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Only the first batch of tuples is in the checkpoint, the second one has to be replayed from the log
+  InsertIntegers(db_oid, table_oid, 0, num_checkpointed);
+  CheckpointManager checkpoint_manager{CHECKPOINT_FILE_NAME, catalog_, txn_manager_, nullptr};
+  checkpoint_manager.Checkpoint();
+  InsertIntegers(db_oid, table_oid, num_checkpointed, num_checkpointed + num_logged);
+
+  ShutdownAndRestartSystem();
+
+  DiskLogProvider log_provider{LOG_FILE_NAME};
+  RecoveryManager recovery_manager{common::ManagedPointer<AbstractLogProvider>(&log_provider),
+                                   recovery_catalog_,
+                                   recovery_txn_manager_,
+                                   recovery_deferred_action_manager_,
+                                   recovery_thread_registry_,
+                                   recovery_block_store_,
+                                   CHECKPOINT_FILE_NAME};
+  recovery_manager.StartRecovery();
+  recovery_manager.WaitForRecoveryToFinish();
+
+  // Assert the index exists and finds every tuple by its key
+  txn = recovery_txn_manager_->BeginTransaction();
+  db_catalog = recovery_catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+  ASSERT_TRUE(db_catalog);
+  auto index_oids = db_catalog->GetIndexOids(common::ManagedPointer(txn), table_oid);
+  ASSERT_EQ(1, index_oids.size());
+  EXPECT_EQ(index_oid, index_oids[0]);
+  auto index = db_catalog->GetIndex(common::ManagedPointer(txn), index_oid);
+  ASSERT_TRUE(index);
+  auto table_ptr = db_catalog->GetTable(common::ManagedPointer(txn), table_oid);
+  const auto &schema = db_catalog->GetSchema(common::ManagedPointer(txn), table_oid);
+  auto row_initializer = table_ptr->InitializerForProjectedRow({schema.GetColumn(0).Oid()});
+  auto *row_buffer = common::AllocationUtil::AllocateAligned(row_initializer.ProjectedRowSize());
+  auto *row = row_initializer.InitializeRow(row_buffer);
+  auto *key_buffer = common::AllocationUtil::AllocateAligned(index->GetProjectedRowInitializer().ProjectedRowSize());
+  auto *key = index->GetProjectedRowInitializer().InitializeRow(key_buffer);
+  std::vector<TupleSlot> results;
+  for (int32_t i = 0; i <= num_checkpointed + num_logged; i++) {
+    *reinterpret_cast<int32_t *>(key->AccessForceNotNull(0)) = i;
+    results.clear();
+    index->ScanKey(*txn, *key, &results);
+    if (i == num_checkpointed + num_logged) {
+      // Past the last tuple that was inserted
+      EXPECT_TRUE(results.empty());
+      continue;
+    }
+    ASSERT_EQ(1, results.size());
+    EXPECT_TRUE(table_ptr->Select(common::ManagedPointer(txn), results[0], row));
+    EXPECT_EQ(i, *reinterpret_cast<int32_t *>(row->AccessWithNullCheck(0)));
+  }
+  delete[] key_buffer;
+  delete[] row_buffer;
+  recovery_txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
+// This test writes a segmented log and checkpoints in the middle of a workload, which removes the log segments the
+// checkpoint covers. It then recovers from the checkpoint and the remaining segments, and verifies that the recovered
+// tables are the same as the original tables
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, CheckpointRemoveSegmentsTest) {
+  // Start over with a log that is split into small segments
+  db_main_.reset();
+  RemoveLogFiles();
+  StartSystem(1, 1U << 14U);
+
+  LargeSqlTableTestConfiguration config = LargeSqlTableTestConfiguration::Builder()
+                                              .SetNumDatabases(1)
+                                              .SetNumTables(2)
+                                              .SetMaxColumns(5)
+                                              .SetInitialTableSize(1000)
+                                              .SetTxnLength(5)
+                                              .SetInsertUpdateSelectDeleteRatio({0.2, 0.5, 0.2, 0.1})
+                                              .SetVarlenAllowed(true)
+                                              .Build();
+  auto *tested =
+      new LargeSqlTableTestObject(config, txn_manager_.Get(), catalog_.Get(), block_store_.Get(), &generator_);
+  tested->SimulateOltp(100, 4);
+
+  // Make sure the workload so far is in closed segments, which the checkpoint makes obsolete
+  log_manager_->ForceFlush();
+  const size_t num_files = LogFile::FilePaths(LOG_FILE_NAME).size();
+  ASSERT_GT(num_files, 1);
+  CheckpointManager checkpoint_manager{CHECKPOINT_FILE_NAME, catalog_, txn_manager_, nullptr};
+  checkpoint_manager.Checkpoint();
+  EXPECT_LT(LogFile::FilePaths(LOG_FILE_NAME).size(), num_files);
+
+  // The rest of the workload is only in the log tail
+  tested->SimulateOltp(100, 4);
+  ShutdownAndRestartSystem();
+
+  DiskLogProvider log_provider{LOG_FILE_NAME};
+  RecoveryManager recovery_manager{common::ManagedPointer<AbstractLogProvider>(&log_provider),
+                                   recovery_catalog_,
+                                   recovery_txn_manager_,
+                                   recovery_deferred_action_manager_,
+                                   recovery_thread_registry_,
+                                   recovery_block_store_,
+                                   CHECKPOINT_FILE_NAME};
+  recovery_manager.StartRecovery();
+  recovery_manager.WaitForRecoveryToFinish();
+  CheckRecoveredTables(tested, &recovery_manager);
+
+  // the table can't be freed until after all GC on it is guaranteed to be done. The easy way to do that is to use a
+  // DeferredAction
+  db_main_->GetTransactionLayer()->GetDeferredActionManager()->RegisterDeferredAction([=]() { delete tested; });
+}
+
+// This test makes a checkpoint fail halfway through writing its file, and verifies that the checkpoint's transaction is
+// aborted, that no partial checkpoint file is left behind, and that the previous checkpoint is still intact
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, FailedCheckpointTest) {
+  const std::string temp_path = std::string(CHECKPOINT_FILE_NAME) + ".tmp";
+  unlink(temp_path.c_str());
+  CheckpointManager checkpoint_manager{CHECKPOINT_FILE_NAME, catalog_, txn_manager_, nullptr};
+  checkpoint_manager.Checkpoint();
+  struct stat original;
+  ASSERT_EQ(0, stat(CHECKPOINT_FILE_NAME, &original));
+
+  // Every write to /dev/full fails with ENOSPC, so the checkpoint fails after it has begun its transaction
+  ASSERT_EQ(0, symlink("/dev/full", temp_path.c_str()));
+  EXPECT_THROW(checkpoint_manager.Checkpoint(), std::runtime_error);
+  EXPECT_EQ(-1, access(temp_path.c_str(), F_OK));
+  struct stat after;
+  ASSERT_EQ(0, stat(CHECKPOINT_FILE_NAME, &after));
+  EXPECT_EQ(original.st_size, after.st_size);
+  EXPECT_EQ(original.st_mtime, after.st_mtime);
+
+  // The failed checkpoint's transaction must not hold back the oldest running transaction. The committed ones only
+  // leave the running set once their commit records are serialized.
+  log_manager_->ForceFlush();
+  auto *txn = txn_manager_->BeginTransaction();
+  EXPECT_EQ(txn->StartTime(), db_main_->GetTransactionLayer()->GetTimestampManager()->OldestTransactionStartTime());
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  unlink(temp_path.c_str());
+}
+
+// This test corrupts a checkpoint file, and verifies that reading its sections fails instead of trusting the sizes in
+// them
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, CorruptedCheckpointTest) {
+  CheckpointManager checkpoint_manager{CHECKPOINT_FILE_NAME, catalog_, txn_manager_, nullptr};
+  checkpoint_manager.Checkpoint();
+  const auto read_first_section = [] {
+    const int fd = PosixIoWrappers::Open(CHECKPOINT_FILE_NAME, O_RDONLY);
+    lseek(fd, sizeof(CheckpointManager::MAGIC) + sizeof(transaction::timestamp_t), SEEK_SET);
+    try {
+      CheckpointSection::Read(fd);
+    } catch (...) {
+      PosixIoWrappers::Close(fd);
+      throw;
+    }
+    PosixIoWrappers::Close(fd);
+  };
+  EXPECT_NO_THROW(read_first_section());
+
+  // Corrupted contents of a section fail its checksum
+  const int fd = PosixIoWrappers::Open(CHECKPOINT_FILE_NAME, O_RDWR);
+  const off_t section_start = sizeof(CheckpointManager::MAGIC) + sizeof(transaction::timestamp_t);
+  const off_t corrupted_at = section_start + sizeof(uint64_t) + sizeof(uint32_t) + 10;
+  byte corrupted;
+  ASSERT_EQ(1, pread(fd, &corrupted, 1, corrupted_at));
+  corrupted = ~corrupted;
+  PosixIoWrappers::WriteFullyAt(fd, &corrupted, 1, corrupted_at);
+  EXPECT_THROW(read_first_section(), std::runtime_error);
+
+  // A section that is larger than the rest of the file is rejected before its contents are allocated
+  const uint64_t huge_size = uint64_t{1} << 62U;
+  PosixIoWrappers::WriteFullyAt(fd, &huge_size, sizeof(huge_size), section_start);
+  PosixIoWrappers::Close(fd);
+  EXPECT_THROW(read_first_section(), std::runtime_error);
+}
+
+// This test replays the log of a workload on multiple tables with several threads, and verifies that the recovered
+// tables are the same as the original tables
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ParallelReplayTest) {
+  LargeSqlTableTestConfiguration config = LargeSqlTableTestConfiguration::Builder()
+                                              .SetNumDatabases(2)
+                                              .SetNumTables(4)
+                                              .SetMaxColumns(5)
+                                              .SetInitialTableSize(1000)
+                                              .SetTxnLength(5)
+                                              .SetInsertUpdateSelectDeleteRatio({0.2, 0.5, 0.2, 0.1})
+                                              .SetVarlenAllowed(true)
+                                              .Build();
+  RecoveryTests::RunTest(config, false /* checkpoint */, 4 /* num_replay_threads */);
+}
+
+// This test interleaves transactions that create, index and drop tables with transactions that insert into several
+// tables at once, so that replay with several threads has to wait for the dispatched transactions before every catalog
+// change. It verifies that the recovered tables and indexes hold exactly the tuples of the original ones.
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ParallelReplayCatalogTest) {
+  auto namespace_oid = catalog::postgres::NAMESPACE_DEFAULT_NAMESPACE_OID;
+  const int32_t num_tables = 8;
+  const int32_t rows_per_txn = 50;
+
+  auto *txn = txn_manager_->BeginTransaction();
+  auto db_oid = CreateDatabase(txn, catalog_, "testdb");
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Inserts the next rows_per_txn integers into every table in one transaction, whose changes span several partitions
+  std::vector<catalog::table_oid_t> table_oids;
+  std::unordered_map<catalog::table_oid_t, std::vector<int32_t>> expected;
+  int32_t next_value = 0;
+  auto insert_into_all = [&] {
+    auto *insert_txn = txn_manager_->BeginTransaction();
+    auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(insert_txn), db_oid);
+    for (const auto table_oid : table_oids) {
+      auto table_ptr = db_catalog->GetTable(common::ManagedPointer(insert_txn), table_oid);
+      const auto &schema = db_catalog->GetSchema(common::ManagedPointer(insert_txn), table_oid);
+      auto initializer = table_ptr->InitializerForProjectedRow({schema.GetColumn(0).Oid()});
+      for (int32_t i = next_value; i < next_value + rows_per_txn; i++) {
+        auto *redo_record = insert_txn->StageWrite(db_oid, table_oid, initializer);
+        *reinterpret_cast<int32_t *>(redo_record->Delta()->AccessForceNotNull(0)) = i;
+        table_ptr->Insert(common::ManagedPointer(insert_txn), redo_record);
+        expected[table_oid].push_back(i);
+      }
+    }
+    next_value += rows_per_txn;
+    txn_manager_->Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  };
+
+  // Every table is created by its own catalog transaction, between inserts into the tables created before it
+  for (int32_t i = 0; i < num_tables; i++) {
+    txn = txn_manager_->BeginTransaction();
+    auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+    table_oids.push_back(CreateTable(txn, db_catalog, namespace_oid, "table" + std::to_string(i)));
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    insert_into_all();
+  }
+
+  // Then drop every other table and index the rest, again with inserts in between
+  const std::vector<catalog::table_oid_t> created(table_oids);
+  std::vector<std::string> dropped;
+  std::unordered_map<catalog::table_oid_t, catalog::index_oid_t> index_oids;
+  for (int32_t i = 0; i < num_tables; i++) {
+    const catalog::table_oid_t table_oid = created[i];
+    txn = txn_manager_->BeginTransaction();
+    auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+    if (i % 2 == 0) {
+      DropTable(txn, db_catalog, table_oid);
+      dropped.push_back("table" + std::to_string(i));
+    } else {
+      index_oids[table_oid] = CreateIndex(txn, db_catalog, namespace_oid, table_oid, "index" + std::to_string(i));
+    }
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    if (i % 2 == 0) table_oids.erase(std::find(table_oids.begin(), table_oids.end(), table_oid));
+    insert_into_all();
+  }
+
+  ShutdownAndRestartSystem();
+
+  DiskLogProvider log_provider{LOG_FILE_NAME};
+  RecoveryManager recovery_manager{common::ManagedPointer<AbstractLogProvider>(&log_provider),
+                                   recovery_catalog_,
+                                   recovery_txn_manager_,
+                                   recovery_deferred_action_manager_,
+                                   recovery_thread_registry_,
+                                   recovery_block_store_,
+                                   "",
+                                   4 /* num_replay_threads */};
+  recovery_manager.StartRecovery();
+  recovery_manager.WaitForRecoveryToFinish();
+
+  txn = recovery_txn_manager_->BeginTransaction();
+  auto db_catalog = recovery_catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+  ASSERT_TRUE(db_catalog);
+
+  // Assert the tables we dropped don't exist
+  for (const auto &table_name : dropped) {
+    EXPECT_EQ(catalog::INVALID_TABLE_OID,
+              db_catalog->GetTableOid(common::ManagedPointer(txn), namespace_oid, table_name));
+  }
+
+  // Assert the remaining tables hold every tuple inserted into them, and their indexes find all of them
+  for (const auto table_oid : table_oids) {
+    auto table_ptr = db_catalog->GetTable(common::ManagedPointer(txn), table_oid);
+    ASSERT_TRUE(table_ptr);
+    const auto &schema = db_catalog->GetSchema(common::ManagedPointer(txn), table_oid);
+    auto initializer = table_ptr->InitializerForProjectedRow({schema.GetColumn(0).Oid()});
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    auto *row = initializer.InitializeRow(buffer);
+    std::vector<int32_t> values;
+    for (auto it = table_ptr->begin(); it != table_ptr->end(); it++) {
+      if (table_ptr->Select(common::ManagedPointer(txn), *it, row)) {
+        values.push_back(*reinterpret_cast<int32_t *>(row->AccessWithNullCheck(0)));
+      }
+    }
+    delete[] buffer;
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(expected[table_oid], values);
+
+    auto index = db_catalog->GetIndex(common::ManagedPointer(txn), index_oids.at(table_oid));
+    ASSERT_TRUE(index);
+    auto *key_buffer = common::AllocationUtil::AllocateAligned(index->GetProjectedRowInitializer().ProjectedRowSize());
+    auto *key = index->GetProjectedRowInitializer().InitializeRow(key_buffer);
+    std::vector<TupleSlot> results;
+    for (const int32_t value : expected[table_oid]) {
+      *reinterpret_cast<int32_t *>(key->AccessForceNotNull(0)) = value;
+      results.clear();
+      index->ScanKey(*txn, *key, &results);
+      EXPECT_EQ(1, results.size());
+    }
+    delete[] key_buffer;
+  }
+  recovery_txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
+// This test serializes the log of a workload on multiple tables into several log streams. It then recreates the tables
+// from the merged streams, and verifies that the recovered tables are the same as the original tables
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, ParallelSerializationTest) {
+  // Start over with a log manager that has several serializers
+  db_main_.reset();
+  RemoveLogFiles();
+  StartSystem(4);
+
+  LargeSqlTableTestConfiguration config = LargeSqlTableTestConfiguration::Builder()
+                                              .SetNumDatabases(2)
+                                              .SetNumTables(4)
+                                              .SetMaxColumns(5)
+                                              .SetInitialTableSize(1000)
+                                              .SetTxnLength(5)
+                                              .SetInsertUpdateSelectDeleteRatio({0.2, 0.5, 0.2, 0.1})
+                                              .SetVarlenAllowed(true)
+                                              .Build();
+  RecoveryTests::RunTest(config);
+}
+
+// This test tears the log stream of one serializer in the middle of the last round, as a crash that persisted the other
+// streams of the round would. Recovery should stop every stream at the end of the round before, and thus recover the
+// inserts up to the last transaction, whose commit was never reported.
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, TornStreamTest) {
+  // Start over with a log manager that has several serializers
+  db_main_.reset();
+  RemoveLogFiles();
+  StartSystem(4);
+
+  std::string database_name = "testdb";
+  auto namespace_oid = catalog::postgres::NAMESPACE_DEFAULT_NAMESPACE_OID;
+  const int32_t num_txns = 10;
+  const int32_t txn_size = 10;
+  auto *txn = txn_manager_->BeginTransaction();
+  auto db_oid = CreateDatabase(txn, catalog_, database_name);
+  auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+  auto table_oid = CreateTable(txn, db_catalog, namespace_oid, "testtable");
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Every transaction is persisted before the next one starts, so each is serialized in a round of its own
+  for (int32_t i = 0; i < num_txns; i++) {
+    InsertIntegers(db_oid, table_oid, i * txn_size, (i + 1) * txn_size);
+    txn_manager_->FlushLog();
+  }
+
+  db_main_->GetGarbageCollectorThread()->StopGC();
+  db_main_->GetTransactionLayer()->GetDeferredActionManager()->FullyPerformGC(
+      db_main_->GetStorageLayer()->GetGarbageCollector(), log_manager_);
+  log_manager_->PersistAndStop();
+
+  // Tear the second stream in the header of the frame after the marker of the second to last round
+  const std::string stream_path = LogFile::StreamPath(LOG_FILE_NAME, 1);
+  std::vector<off_t> round_ends;
+  const int fd = PosixIoWrappers::Open(stream_path.c_str(), O_RDONLY);
+  byte header[LogFrame::HEADER_SIZE];
+  off_t offset = 0;
+  while (pread(fd, header, LogFrame::HEADER_SIZE, offset) == static_cast<ssize_t>(LogFrame::HEADER_SIZE)) {
+    uint16_t flags;
+    uint32_t size, decoded_size;
+    ASSERT_TRUE(LogFrame::ReadHeader(header, common::Constants::LOG_BUFFER_SIZE, &flags, &size, &decoded_size));
+    offset += LogFrame::HEADER_SIZE + size;
+    if ((flags & LogFrame::END_OF_ROUND) != 0) round_ends.push_back(offset);
+  }
+  PosixIoWrappers::Close(fd);
+  ASSERT_GE(round_ends.size(), 2);
+  ASSERT_EQ(0, truncate(stream_path.c_str(), round_ends[round_ends.size() - 2] + LogFrame::HEADER_SIZE / 2));
+
+  SingleRecovery();
+
+  // Assert the table holds the inserts of every transaction but the last one
+  std::vector<int32_t> expected((num_txns - 1) * txn_size);
+  for (int32_t i = 0; i < (num_txns - 1) * txn_size; i++) expected[i] = i;
+  EXPECT_EQ(expected, ReadIntegers(recovery_catalog_, recovery_txn_manager_, db_oid, table_oid));
+
+  // The restarted log manager cuts the other streams back to the same round before appending to them
+  log_manager_->Start();
+  db_main_->GetGarbageCollectorThread()->StartGC();
+  EXPECT_EQ(round_ends.size() - 1, LogFile::CommonRound(LogFile::StreamFilePaths(LOG_FILE_NAME)));
+}
+
+// This test restarts a DBMain that recovers on its own twice, as the server does, and verifies that each run starts
+// with the inserts of the runs before it and the default database, that nothing set aside to recover is left behind,
+// and that the checkpoint taken after recovery leaves only the log segment still being written
+// NOLINTNEXTLINE
+TEST_F(RecoveryTests, DBMainRecoveryTest) {
+  db_main_.reset();
+  RemoveFiles();
+  StartSystem(1, 1U << 14U, true);
+
+  auto namespace_oid = catalog::postgres::NAMESPACE_DEFAULT_NAMESPACE_OID;
+  auto *txn = txn_manager_->BeginTransaction();
+  auto db_oid = CreateDatabase(txn, catalog_, "testdb");
+  auto db_catalog = catalog_->GetDatabaseCatalog(common::ManagedPointer(txn), db_oid);
+  auto table_oid = CreateTable(txn, db_catalog, namespace_oid, "testtable");
+  txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  std::vector<int32_t> expected;
+  for (int32_t run = 0; run < 2; run++) {
+    InsertIntegers(db_oid, table_oid, run * 10, (run + 1) * 10);
+    for (int32_t i = run * 10; i < (run + 1) * 10; i++) expected.push_back(i);
+
+    db_main_.reset();
+    StartSystem(1, 1U << 14U, true);
+
+    EXPECT_EQ(expected, ReadIntegers(catalog_, txn_manager_, db_oid, table_oid));
+    txn = txn_manager_->BeginTransaction();
+    EXPECT_NE(catalog::INVALID_DATABASE_OID,
+              catalog_->GetDatabaseOid(common::ManagedPointer(txn), catalog::DEFAULT_DATABASE));
+    txn_manager_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    EXPECT_TRUE(LogFile::FilePaths(std::string(LOG_FILE_NAME) + RecoveryManager::SET_ASIDE_SUFFIX).empty());
+    EXPECT_EQ(0, access(CHECKPOINT_FILE_NAME, F_OK));
+    EXPECT_EQ(1, LogFile::FilePaths(LOG_FILE_NAME).size());
+  }
+}
+
 // This test checks that we recover correctly in a high abort rate workload. We achieve the high abort rate by having
 // large transaction lengths (number of updates). Further, to ensure that more aborted transactions flush logs before
 // aborting, we have transactions make large updates (by having high number columns). This will cause RedoBuffers to
@@ -184,6 +184,7 @@ TEST_F(TupleAccessStrategyTests, MemorySafety) {
 
 // This test generates randomized block layouts, and checks its layout to ensure
 // that each columns null bitmap is aligned to 8 bytes, and that each column start is aligned to its attribute size.
+// The Arrow metadata also needs to be aligned to 8 bytes, or its column info runs into the attribute offsets.
 // These properties are necessary to ensure high performance by accessing aligned fields.
 // NOLINTNEXTLINE
 TEST_F(TupleAccessStrategyTests, Alignment) {
@@ -196,6 +197,7 @@ TEST_F(TupleAccessStrategyTests, Alignment) {
     // here we don't need to 0-initialize the block because we only
     // test layout, not the content.
     tested.InitializeRawBlock(nullptr, raw_block_, storage::layout_version_t(0));
+    StorageTestUtil::CheckAlignment(&tested.GetArrowBlockMetadata(raw_block_), 8);
 
     for (uint16_t j = 0; j < layout.NumColumns(); j++) {
       storage::col_id_t col_id(j);
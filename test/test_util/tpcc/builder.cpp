@@ -329,7 +329,7 @@ Database *Builder::Build(const storage::index::IndexType index_type) {
                    "Constructed the wrong index key type.");
     TERRIER_ASSERT(customer_index->KeyKind() == storage::index::IndexKeyKind::COMPACTINTSKEY,
                    "Constructed the wrong index key type.");
-    TERRIER_ASSERT(customer_secondary_index->KeyKind() == storage::index::IndexKeyKind::GENERICKEY,
+    TERRIER_ASSERT(customer_secondary_index->KeyKind() == storage::index::IndexKeyKind::NORMALIZEDKEY,
                    "Constructed the wrong index key type.");
     TERRIER_ASSERT(new_order_index->KeyKind() == storage::index::IndexKeyKind::COMPACTINTSKEY,
                    "Constructed the wrong index key type.");
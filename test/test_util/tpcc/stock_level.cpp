@@ -1,6 +1,6 @@
 #include "test_util/tpcc/stock_level.h"
 
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 
 namespace terrier::tpcc {
@@ -55,8 +55,9 @@ bool StockLevel::Execute(transaction::TransactionManager *const txn_manager, Dat
                  "ol_number can be between 5 and 15, and we're looking up 20 previous orders.");
 
   // Select matching S_I_ID and S_W_ID with S_QUANTITY lower than threshold.
-  // Aggregate quantity counts, report number of items with count < threshold.
-  std::unordered_map<int32_t, int32_t> item_counts;
+  // Collect the distinct items first, so that their stock can be looked up in one sorted batch.
+  std::vector<int32_t> item_ids;
+  item_ids.reserve(index_scan_results.size());
 
   for (const auto &order_line_tuple_slot : index_scan_results) {
     storage::ProjectedRow *order_line_select_tuple =
@@ -66,32 +67,39 @@ bool StockLevel::Execute(transaction::TransactionManager *const txn_manager, Dat
     TERRIER_ASSERT(select_result, "Order line index contained this.");
     const auto ol_i_id = *reinterpret_cast<int32_t *>(order_line_select_tuple->AccessForceNotNull(0));
     TERRIER_ASSERT(ol_i_id >= 1 && ol_i_id <= 100000, "Invalid ol_i_id read from the Order Line table.");
+    item_ids.emplace_back(ol_i_id);
+  }
 
-    if (item_counts.count(ol_i_id) > 0) continue;  // don't look up items we've already checked
-
-    const auto stock_key_pr_initializer = db->stock_primary_index_->GetProjectedRowInitializer();
-    auto *const stock_key = stock_key_pr_initializer.InitializeRow(worker->stock_key_buffer_);
+  std::sort(item_ids.begin(), item_ids.end());
+  item_ids.erase(std::unique(item_ids.begin(), item_ids.end()), item_ids.end());
+
+  // Every key starts at an 8-byte aligned offset of the buffer
+  const auto stock_key_pr_initializer = db->stock_primary_index_->GetProjectedRowInitializer();
+  const uint32_t stock_key_words = (stock_key_pr_initializer.ProjectedRowSize() + 7) / 8;
+  std::vector<uint64_t> stock_key_buffer(item_ids.size() * stock_key_words);
+  std::vector<const storage::ProjectedRow *> stock_keys;
+  stock_keys.reserve(item_ids.size());
+  for (size_t i = 0; i < item_ids.size(); i++) {
+    auto *const stock_key = stock_key_pr_initializer.InitializeRow(&stock_key_buffer[i * stock_key_words]);
     *reinterpret_cast<int8_t *>(stock_key->AccessForceNotNull(s_w_id_key_pr_offset_)) = args.w_id_;
-    *reinterpret_cast<int32_t *>(stock_key->AccessForceNotNull(s_i_id_key_pr_offset_)) = ol_i_id;
+    *reinterpret_cast<int32_t *>(stock_key->AccessForceNotNull(s_i_id_key_pr_offset_)) = item_ids[i];
+    stock_keys.emplace_back(stock_key);
+  }
 
-    std::vector<storage::TupleSlot> stock_index_scan_results;
-    stock_index_scan_results.clear();
-    db->stock_primary_index_->ScanKey(*txn, *stock_key, &stock_index_scan_results);
-    TERRIER_ASSERT(stock_index_scan_results.size() == 1, "Couldn't find a matching stock item.");
+  std::vector<storage::TupleSlot> stock_index_scan_results;
+  std::vector<uint32_t> stock_index_scan_offsets;
+  db->stock_primary_index_->ScanKeyBatch(*txn, stock_keys, &stock_index_scan_results, &stock_index_scan_offsets);
+  TERRIER_ASSERT(stock_index_scan_results.size() == item_ids.size(), "Couldn't find a matching stock item.");
 
+  // Report number of items with count < threshold.
+  uint16_t low_stock = 0;
+  for (const auto &stock_tuple_slot : stock_index_scan_results) {
     auto *const stock_select_tuple = stock_select_pr_initializer_.InitializeRow(worker->stock_tuple_buffer_);
-    select_result =
-        db->stock_table_->Select(common::ManagedPointer(txn), stock_index_scan_results[0], stock_select_tuple);
+    select_result = db->stock_table_->Select(common::ManagedPointer(txn), stock_tuple_slot, stock_select_tuple);
     TERRIER_ASSERT(select_result, "Stock index contained this.");
     const auto s_quantity = *reinterpret_cast<int16_t *>(stock_select_tuple->AccessForceNotNull(0));
     TERRIER_ASSERT(s_quantity >= 10 && s_quantity <= 100, "Invalid s_quantity read from the Stock table.");
-
-    item_counts[ol_i_id] = s_quantity;
-  }
-
-  uint16_t low_stock = 0;
-  for (const auto &it : item_counts) {
-    low_stock = static_cast<uint16_t>(low_stock + static_cast<uint16_t>(it.second < args.s_quantity_threshold_));
+    low_stock = static_cast<uint16_t>(low_stock + static_cast<uint16_t>(s_quantity < args.s_quantity_threshold_));
   }
 
   txn_manager->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
@@ -1,8 +1,11 @@
 #include "traffic_cop/traffic_cop.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <pqxx/pqxx>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -11,13 +14,16 @@
 #include "gtest/gtest.h"
 #include "main/db_main.h"
 #include "network/connection_handle_factory.h"
+#include "network/network_defs.h"
 #include "network/terrier_server.h"
+#include "settings/settings_callbacks.h"
 #include "storage/garbage_collector.h"
 #include "test_util/manual_packet_util.h"
 #include "test_util/test_harness.h"
 #include "traffic_cop/traffic_cop_defs.h"
 #include "transaction/deferred_action_manager.h"
 #include "transaction/transaction_manager.h"
+#include "type/transient_value_factory.h"
 
 namespace terrier::trafficcop {
 
@@ -26,7 +32,10 @@ class TrafficCopTests : public TerrierTest {
   void SetUp() override {
     std::unordered_map<settings::Param, settings::ParamInfo> param_map;
     terrier::settings::SettingsManager::ConstructParamMap(param_map);
+    StartServer(std::move(param_map));
+  }
 
+  void StartServer(std::unordered_map<settings::Param, settings::ParamInfo> &&param_map) {
     db_main_ = terrier::DBMain::Builder()
                    .SetSettingsParameterMap(std::move(param_map))
                    .SetUseSettingsManager(true)
@@ -180,6 +189,71 @@ TEST_F(TrafficCopTests, TemporaryNamespaceTest) {
   }
 }
 
+/**
+ * Test that commits from more connections than there are threads to handle them all go through. Each connection waits
+ * for its commits to become durable without blocking the thread that handles it.
+ */
+// NOLINTNEXTLINE
+TEST_F(TrafficCopTests, ConcurrentCommitTest) {
+  // Restart the server with a log that is only persisted when forced, so that commits stay pending until then
+  db_main_.reset();
+  std::unordered_map<settings::Param, settings::ParamInfo> param_map;
+  terrier::settings::SettingsManager::ConstructParamMap(param_map);
+  param_map.erase(settings::Param::log_persist_interval);
+  param_map.emplace(settings::Param::log_persist_interval,
+                    settings::ParamInfo("log_persist_interval", type::TransientValueFactory::GetInteger(10000), "",
+                                        type::TransientValueFactory::GetInteger(10), false, 1, 10000,
+                                        &settings::Callbacks::NoOp));
+  param_map.erase(settings::Param::log_adaptive_persist);
+  param_map.emplace(settings::Param::log_adaptive_persist,
+                    settings::ParamInfo("log_adaptive_persist", type::TransientValueFactory::GetBoolean(false), "",
+                                        type::TransientValueFactory::GetBoolean(true), false, 0, 0,
+                                        &settings::Callbacks::NoOp));
+  StartServer(std::move(param_map));
+
+  try {
+    // Connections are handed to the handler threads round robin, so the first and the last one share a thread
+    std::vector<std::unique_ptr<pqxx::connection>> connections;
+    for (uint32_t i = 0; i <= CONNECTION_THREAD_COUNT; i++) {
+      connections.emplace_back(std::make_unique<pqxx::connection>(fmt::format(
+          "host=127.0.0.1 port={0} user={1} sslmode=disable application_name=psql", port_, catalog::DEFAULT_DATABASE)));
+    }
+    auto &committing = *connections.front();
+    auto &other = *connections.back();
+
+    std::atomic<bool> flushed = false, committed = false;
+    std::thread commit_thread([&] {
+      try {
+        pqxx::work txn(committing);
+        txn.commit();
+        // The client may only hear about the commit once it is durable
+        EXPECT_TRUE(flushed);
+        committed = true;
+      } catch (const std::exception &e) {
+        EXPECT_TRUE(false);
+      }
+    });
+    // Give the COMMIT time to reach the server
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // The handler thread must keep serving the other connection while the commit waits on the log
+    for (uint32_t i = 0; i < 10; i++) {
+      pqxx::work txn(other);
+      txn.abort();
+    }
+    EXPECT_FALSE(committed);
+
+    flushed = true;
+    db_main_->GetLogManager()->ForceFlush();
+    commit_thread.join();
+    EXPECT_TRUE(committed);
+
+    for (auto &connection : connections) connection->disconnect();
+  } catch (const std::exception &e) {
+    EXPECT_TRUE(false);
+  }
+}
+
 // The tests below are from the old sqlite traffic cop era. Unclear if they should be removed at this time, but for now
 // they're disabled
 
@@ -1,12 +1,19 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
+#include "common/worker_pool.h"
 #include "main/db_main.h"
 #include "storage/garbage_collector.h"
 #include "storage/sql_table.h"
 #include "storage/storage_defs.h"
 #include "test_util/catalog_test_util.h"
 #include "test_util/data_table_test_util.h"
+#include "test_util/multithread_test_util.h"
 #include "test_util/test_harness.h"
 #include "transaction/deferred_action_manager.h"
 #include "transaction/transaction_context.h"
@@ -20,12 +27,14 @@ class DeferredActionsTest : public TerrierTest {
   void SetUp() override {
     db_main_ = terrier::DBMain::Builder().SetUseGC(true).Build();
     txn_mgr_ = db_main_->GetTransactionLayer()->GetTransactionManager();
+    timestamp_manager_ = db_main_->GetTransactionLayer()->GetTimestampManager();
     deferred_action_manager_ = db_main_->GetTransactionLayer()->GetDeferredActionManager();
     gc_ = db_main_->GetStorageLayer()->GetGarbageCollector();
   }
 
   std::unique_ptr<DBMain> db_main_;
   common::ManagedPointer<transaction::TransactionManager> txn_mgr_;
+  common::ManagedPointer<transaction::TimestampManager> timestamp_manager_;
   common::ManagedPointer<transaction::DeferredActionManager> deferred_action_manager_;
   common::ManagedPointer<storage::GarbageCollector> gc_;
 };
@@ -241,4 +250,84 @@ TEST_F(DeferredActionsTest, CommitBootstrapDefer) {
   EXPECT_TRUE(defer1);
   EXPECT_TRUE(defer2);
 }
+
+// Test that deferred actions registered concurrently by many threads all get executed, in the order of the timestamps
+// they were registered at, whether their closures are stored inline or not.
+// NOLINTNEXTLINE
+TEST_F(DeferredActionsTest, ConcurrentDefer) {
+  const uint32_t num_threads = 8;
+  const uint32_t num_actions = 1000;
+  std::vector<std::vector<transaction::timestamp_t>> registered(num_threads,
+                                                                std::vector<transaction::timestamp_t>(num_actions));
+  std::vector<transaction::timestamp_t> executed;
+  // Too large to be stored inline
+  std::array<uint64_t, transaction::DeferredAction::INLINE_SIZE / sizeof(uint64_t) + 1> payload{};
+  payload.back() = 42;
+
+  common::WorkerPool thread_pool(num_threads, {});
+  auto workload = [&](uint32_t id) {
+    for (uint32_t i = 0; i < num_actions; i++) {
+      auto *const txn = txn_mgr_->BeginTransaction();
+      transaction::timestamp_t *const timestamp = &registered[id][i];
+      if (i % 2 == 0) {
+        *timestamp = deferred_action_manager_->RegisterDeferredAction([&executed, timestamp](transaction::timestamp_t) {
+          executed.push_back(*timestamp);
+        });
+      } else {
+        *timestamp = deferred_action_manager_->RegisterDeferredAction([&executed, timestamp, payload] {
+          EXPECT_EQ(42, payload.back());
+          executed.push_back(*timestamp);
+        });
+      }
+      txn_mgr_->Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+  gc_->PerformGarbageCollection();
+  gc_->PerformGarbageCollection();
+
+  EXPECT_EQ(num_threads * num_actions, executed.size());
+  EXPECT_TRUE(std::is_sorted(executed.begin(), executed.end()));
+}
+
+// Test that actions registered by many threads, and thus into different shards, run in the order of their timestamps
+// even when they are processed while other threads are still registering
+// NOLINTNEXTLINE
+TEST_F(DeferredActionsTest, InterleavedShardsDefer) {
+  const uint32_t num_threads = 8;
+  const uint32_t num_actions = 1000;
+  std::vector<std::vector<transaction::timestamp_t>> registered(num_threads,
+                                                                std::vector<transaction::timestamp_t>(num_actions));
+  // Actions only ever run on the processing thread, or after all threads are done
+  std::vector<std::pair<uint32_t, uint32_t>> executed;
+  std::atomic<uint32_t> num_registering{num_threads - 1};
+
+  common::WorkerPool thread_pool(num_threads, {});
+  auto workload = [&](uint32_t id) {
+    if (id == 0) {
+      // Pretend that no txn is running, so that every action can run as soon as it has been handed off
+      while (num_registering.load() > 0) deferred_action_manager_->Process(timestamp_manager_->CurrentTime());
+      return;
+    }
+    for (uint32_t i = 0; i < num_actions; i++) {
+      // Advance the time, so that the threads' actions interleave in timestamp order
+      timestamp_manager_->CheckOutTimestamp();
+      registered[id][i] =
+          deferred_action_manager_->RegisterDeferredAction([&executed, id, i] { executed.emplace_back(id, i); });
+      // Give up the cpu often, so that registrations also land between the processing thread handing off two shards
+      std::this_thread::yield();
+    }
+    num_registering--;
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+
+  gc_->PerformGarbageCollection();
+  gc_->PerformGarbageCollection();
+
+  EXPECT_EQ((num_threads - 1) * num_actions, executed.size());
+  std::vector<transaction::timestamp_t> executed_timestamps;
+  for (const auto &action : executed) executed_timestamps.push_back(registered[action.first][action.second]);
+  EXPECT_TRUE(std::is_sorted(executed_timestamps.begin(), executed_timestamps.end()));
+}
 }  // namespace terrier
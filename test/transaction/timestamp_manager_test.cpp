@@ -0,0 +1,72 @@
+#include <atomic>
+#include <vector>
+
+#include "common/worker_pool.h"
+#include "storage/record_buffer.h"
+#include "test_util/multithread_test_util.h"
+#include "test_util/test_harness.h"
+#include "transaction/deferred_action_manager.h"
+#include "transaction/timestamp_manager.h"
+#include "transaction/transaction_context.h"
+#include "transaction/transaction_manager.h"
+#include "transaction/transaction_util.h"
+
+namespace terrier {
+
+class TimestampManagerTests : public TerrierTest {
+ protected:
+  storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
+  transaction::TimestampManager timestamp_manager_;
+  transaction::DeferredActionManager deferred_action_manager_{common::ManagedPointer(&timestamp_manager_)};
+  transaction::TransactionManager txn_manager_{common::ManagedPointer(&timestamp_manager_),
+                                               common::ManagedPointer(&deferred_action_manager_),
+                                               common::ManagedPointer(&buffer_pool_), false, DISABLED};
+};
+
+// Checks that the oldest running txn is found whichever shard of the active txn set it ends up in
+// NOLINTNEXTLINE
+TEST_F(TimestampManagerTests, OldestTransaction) {
+  EXPECT_EQ(timestamp_manager_.OldestTransactionStartTime(), timestamp_manager_.CurrentTime());
+
+  std::vector<transaction::TransactionContext *> txns;
+  for (uint32_t i = 0; i < 200; i++) txns.push_back(txn_manager_.BeginTransaction());
+  // Finish the txns out of order, the oldest one remaining is always the one to look for
+  for (uint32_t i = 0; i < txns.size(); i += 2) {
+    EXPECT_EQ(timestamp_manager_.OldestTransactionStartTime(), txns[i]->StartTime());
+    txn_manager_.Commit(txns[i + 1], transaction::TransactionUtil::EmptyCallback, nullptr);
+    EXPECT_EQ(timestamp_manager_.OldestTransactionStartTime(), txns[i]->StartTime());
+    txn_manager_.Abort(txns[i]);
+  }
+  EXPECT_EQ(timestamp_manager_.CachedOldestTransactionStartTime(), txns[txns.size() - 2]->StartTime());
+  EXPECT_EQ(timestamp_manager_.OldestTransactionStartTime(), timestamp_manager_.CurrentTime());
+  for (auto *const txn : txns) delete txn;
+}
+
+// Checks that no poll for the oldest running txn overtakes a txn that is running, including one that was beginning
+// while the poll was going on
+// NOLINTNEXTLINE
+TEST_F(TimestampManagerTests, ConcurrentOldestTransaction) {
+  const uint32_t num_threads = MultiThreadTestUtil::HardwareConcurrency() + 1;
+  common::WorkerPool thread_pool(num_threads, {});
+  std::atomic<uint64_t> last_poll = 0;
+  std::atomic<uint32_t> workers_done = 0;
+
+  auto workload = [&](uint32_t id) {
+    if (id == 0) {
+      while (workers_done.load() < num_threads - 1) last_poll = !timestamp_manager_.OldestTransactionStartTime();
+      return;
+    }
+    for (uint32_t i = 0; i < 10000; i++) {
+      auto *const txn = txn_manager_.BeginTransaction();
+      EXPECT_LE(last_poll.load(), !txn->StartTime());
+      EXPECT_LE(last_poll.load(), !txn->StartTime());
+      txn_manager_.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+      delete txn;
+    }
+    workers_done++;
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads, workload);
+  EXPECT_EQ(timestamp_manager_.OldestTransactionStartTime(), timestamp_manager_.CurrentTime());
+}
+
+}  // namespace terrier